@@ -0,0 +1,69 @@
+#include "bench.h"
+
+#include "SimpleAwkParser.h"
+
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+    const int LINES = 4096;
+
+    /** A KeyTable-style per-stock file: a ticker then eight numeric
+      * fields, whitespace separated.  Written once to /tmp and removed at
+      * exit. */
+    struct param_file {
+        std::string path;
+        param_file ( ) {
+            char buf[64];
+            snprintf(buf, sizeof(buf), "/tmp/awk_bench.%d.txt", (int) getpid());
+            path = buf;
+            FILE *f = fopen(path.c_str(), "w");
+            bench::lcg r(5);
+            for (int i = 0; i < LINES; ++i) {
+                fprintf(f, "S%04d", i);
+                for (int k = 0; k < 8; ++k)
+                    fprintf(f, "%s%.6f", k % 3? "\t" : " ", r.uniform() * 100.0);
+                fprintf(f, "\n");
+            }
+            fclose(f);
+        }
+        ~param_file ( ) { unlink(path.c_str()); }
+    };
+
+    const std::string &file ( ) {
+        static param_file f;
+        return f.path;
+    }
+
+    /// One line read and split; the file is reopened when it runs out.
+    void parse ( uint64_t iters, bool fields ) {
+        SimpleAwkParser p;
+        p.openF(file());
+        double sum = 0;
+        for (uint64_t i = 0; i < iters; ++i) {
+            if (!p.getLine()) {
+                p.closeF();
+                p.openF(file());
+                p.getLine();
+            }
+            if (fields) {
+                // as KeyTable does: every field out as a string, then converted
+                for (int k = 2; k <= p.NF(); ++k)
+                    sum += atof(p.getField(k).c_str());
+            } else {
+                sum += p.NF();
+            }
+        }
+        p.closeF();
+        bench::keep(sum);
+    }
+
+    void get_line ( uint64_t iters, int ) { parse(iters, false); }
+    void get_fields ( uint64_t iters, int ) { parse(iters, true); }
+
+    bench::registrar r1("awk.getLine", get_line);
+    bench::registrar r2("awk.getLine+fields", get_fields);
+}
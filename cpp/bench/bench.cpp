@@ -0,0 +1,119 @@
+#include "bench.h"
+
+#include <time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+namespace bench {
+
+    namespace {
+        struct fixture {
+            const char *name;
+            body fn;
+            int arg;
+        };
+
+        std::vector<fixture> &fixtures ( ) {
+            static std::vector<fixture> f;
+            return f;
+        }
+
+        int64_t now_ns ( ) {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return ts.tv_sec * (int64_t) 1000000000 + ts.tv_nsec;
+        }
+
+        int64_t run_once ( const fixture &f, uint64_t iters ) {
+            int64_t t0 = now_ns();
+            f.fn(iters, f.arg);
+            return now_ns() - t0;
+        }
+
+        void escape ( std::string &out, const char *s ) {
+            for (; *s; ++s) {
+                if (*s == '"' || *s == '\\') out += '\\';
+                out += *s;
+            }
+        }
+    }
+
+    registrar::registrar ( const char *name, body fn, int arg ) {
+        fixture f = { name, fn, arg };
+        fixtures().push_back(f);
+    }
+
+}
+
+using namespace bench;
+
+static void usage ( const char *argv0 ) {
+    fprintf(stderr, "usage: %s [--filter=SUBSTR] [--tag=TAG] [--reps=N] [--min-ms=MS] [--list]\n"
+                    "prints one JSON object per fixture: ns per operation, min/median/max over reps\n", argv0);
+}
+
+int main ( int argc, char **argv ) {
+    const char *filter = "";
+    const char *tag = getenv("BENCH_TAG");
+    int reps = 7;
+    int min_ms = 20;
+    bool list = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *a = argv[i];
+        if (!strncmp(a, "--filter=", 9)) filter = a + 9;
+        else if (!strncmp(a, "--tag=", 6)) tag = a + 6;
+        else if (!strncmp(a, "--reps=", 7)) reps = atoi(a + 7);
+        else if (!strncmp(a, "--min-ms=", 9)) min_ms = atoi(a + 9);
+        else if (!strcmp(a, "--list")) list = true;
+        else { usage(argv[0]); return 2; }
+    }
+    if (reps < 1) reps = 1;
+
+    std::vector<fixture> &fs = fixtures();
+    for (size_t i = 0; i < fs.size(); ++i) {
+        const fixture &f = fs[i];
+        if (!strstr(f.name, filter)) continue;
+        if (list) {
+            if (f.arg >= 0) printf("%s/%d\n", f.name, f.arg);
+            else printf("%s\n", f.name);
+            continue;
+        }
+
+        // warm up, then double iters until one run is long enough to time
+        f.fn(1, f.arg);
+        uint64_t iters = 1;
+        while (run_once(f, iters) < min_ms * (int64_t) 1000000 && iters < (1ULL << 40))
+            iters *= 2;
+
+        std::vector<double> ns(reps);
+        for (int r = 0; r < reps; ++r)
+            ns[r] = (double) run_once(f, iters) / iters;
+        std::sort(ns.begin(), ns.end());
+
+        std::string line = "{\"bench\":\"";
+        escape(line, f.name);
+        line += '"';
+        char buf[256];
+        if (f.arg >= 0) {
+            snprintf(buf, sizeof(buf), ",\"arg\":%d", f.arg);
+            line += buf;
+        }
+        snprintf(buf, sizeof(buf), ",\"iters\":%llu,\"reps\":%d,\"ns_min\":%.3f,\"ns_median\":%.3f,\"ns_max\":%.3f",
+                 (unsigned long long) iters, reps, ns[0], ns[reps / 2], ns[reps - 1]);
+        line += buf;
+        if (tag) {
+            line += ",\"tag\":\"";
+            escape(line, tag);
+            line += '"';
+        }
+        line += '}';
+        printf("%s\n", line.c_str());
+        fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+#ifndef __BENCH_BENCH_H__
+#define __BENCH_BENCH_H__
+
+#include <stdint.h>
+
+/** Microbenchmarks for the hot paths of client-lite and ntradesys.
+  *
+  * A fixture is a function that runs its operation iters times; the runner
+  * picks iters so one run takes at least --min-ms, repeats the run --reps
+  * times, and prints one JSON object per fixture to stdout:
+  *
+  *   {"bench":"dispatch.send","arg":16,"iters":262144,"reps":7,
+  *    "ns_min":41.2,"ns_median":41.9,"ns_max":45.0,"tag":"3128de5"}
+  *
+  * ns_* are nanoseconds per operation.  --tag (default $BENCH_TAG) is copied
+  * into every line so results from several commits can be concatenated and
+  * compared; python/bin/bench_compare.py does that for two runs.  Set-up
+  * inside a fixture is timed with its loop, so anything expensive to build
+  * (books, order repos) is built once in a static; results computed in the
+  * loop should go through keep() so the compiler can't drop them.
+  */
+namespace bench {
+
+    typedef void (*body) ( uint64_t iters, int arg );
+
+    /// Registers a fixture at static-initialization time; arg < 0 means
+    /// the fixture takes no argument and none is printed.
+    struct registrar {
+        registrar ( const char *name, body fn, int arg = -1 );
+    };
+
+    template <typename T>
+    inline void keep ( const T &x ) {
+        asm volatile ( "" : : "g"(&x) : "memory" );
+    }
+
+    /// Deterministic, cheap pseudo-random numbers for building fixtures.
+    class lcg {
+        uint64_t s_;
+        public:
+        explicit lcg ( uint64_t seed = 1 ) : s_(seed) { }
+        uint32_t next ( ) {
+            s_ = s_ * 6364136223846793005ULL + 1442695040888963407ULL;
+            return (uint32_t) (s_ >> 33);
+        }
+        /// Uniform in [0, n).
+        uint32_t below ( uint32_t n ) { return next() % n; }
+        double uniform ( ) { return next() / 2147483648.0; }
+    };
+
+}
+
+#endif // __BENCH_BENCH_H__
@@ -0,0 +1,179 @@
+#include "bench.h"
+
+#include <BookTools.h>
+#include <Client/lib2/CIndex.h>
+#include <Client/lib3/bookmanagement/common/MarketBook.h>
+
+#include <cl-util/factory.h>
+#include <cl-util/debug_stream.h>
+
+#include <cstdio>
+
+using namespace clite::util;
+using trc::compat::util::TimeVal;
+
+namespace {
+
+    const int SYMBOLS = 200;
+    const int LEVELS = 10;
+
+    /** A MarketBook with SYMBOLS stocks, each LEVELS deep on both sides at
+      * one-cent ticks around $20-$120, with 1-6 orders of 100-1000 shares
+      * per level; about what ISLD looks like for a liquid name.  Built once
+      * and shared by every fixture here. */
+    struct synthetic_book {
+        CIndex ci;
+        TimeVal clock;
+        factory<debug_stream>::pointer dbg;
+        lib3::MarketBook *book;
+
+        synthetic_book ( ) : dbg(factory<debug_stream>::get(std::string("bench"))) {
+            char sym[16];
+            for (int c = 0; c < SYMBOLS; ++c) {
+                snprintf(sym, sizeof(sym), "S%03d", c);
+                ci.add(sym);
+            }
+            book = new lib3::MarketBook(ci, ECN::ISLD, clock, dbg.get());
+
+            bench::lcg r(7);
+            long refnum = 1;
+            for (int c = 0; c < SYMBOLS; ++c) {
+                double mid = 20.0 + r.below(10000) / 100.0;
+                for (int s = 0; s < 2; ++s) {
+                    for (int l = 0; l < LEVELS; ++l) {
+                        double px = s == Mkt::BID? mid - 0.01 * (l + 1) : mid + 0.01 * (l + 1);
+                        int n = 1 + r.below(6);
+                        for (int k = 0; k < n; ++k) {
+                            lib3::BookOrder *bo = new lib3::BookOrder();
+                            bo->cid = c;
+                            bo->mm = ISLD;
+                            bo->refnum = refnum++;
+                            bo->dir = s == Mkt::BID? Mkt::BUY : Mkt::SELL;
+                            bo->px = px;
+                            bo->size = bo->entry_size = 100 * (1 + r.below(10));
+                            bo->add_time = bo->update_time = clock;
+                            book->onAdd(bo, true);
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    synthetic_book &book ( ) {
+        static synthetic_book b;
+        return b;
+    }
+
+    /// Random (cid, side) pairs, so lookups don't all hit one cached level.
+    struct queries {
+        enum { N = 4096 };
+        int cid[N];
+        Mkt::Side side[N];
+        int level[N];
+        queries ( ) {
+            bench::lcg r(11);
+            for (int i = 0; i < N; ++i) {
+                cid[i] = r.below(SYMBOLS);
+                side[i] = r.below(2)? Mkt::BID : Mkt::ASK;
+                level[i] = r.below(LEVELS);
+            }
+        }
+    };
+
+    const queries &q ( ) {
+        static queries qs;
+        return qs;
+    }
+
+    void get_market ( uint64_t iters, int arg ) {
+        lib3::MarketBook *bk = book().book;
+        const queries &qs = q();
+        double px, sum = 0;
+        size_t sz;
+        for (uint64_t i = 0; i < iters; ++i) {
+            int j = i & (queries::N - 1);
+            if (getMarket(bk, qs.cid[j], qs.side[j], arg < 0? qs.level[j] : arg, &px, &sz))
+                sum += px;
+        }
+        bench::keep(sum);
+    }
+
+    void get_market_size ( uint64_t iters, int ) {
+        lib3::MarketBook *bk = book().book;
+        const queries &qs = q();
+        size_t sum = 0;
+        for (uint64_t i = 0; i < iters; ++i) {
+            int j = i & (queries::N - 1);
+            sum += getMarketSize(bk, qs.cid[j], qs.side[j], qs.level[j]);
+        }
+        bench::keep(sum);
+    }
+
+    void get_market_size_px ( uint64_t iters, int ) {
+        lib3::MarketBook *bk = book().book;
+        const queries &qs = q();
+        int sum = 0;
+        for (uint64_t i = 0; i < iters; ++i) {
+            int j = i & (queries::N - 1);
+            double px;
+            getMarket(bk, qs.cid[j], qs.side[j], qs.level[j], &px);
+            sum += getMarketSize(bk, qs.cid[j], qs.side[j], px);
+        }
+        bench::keep(sum);
+    }
+
+    void get_market_cum_size ( uint64_t iters, int ) {
+        lib3::MarketBook *bk = book().book;
+        const queries &qs = q();
+        size_t sum = 0;
+        for (uint64_t i = 0; i < iters; ++i) {
+            int j = i & (queries::N - 1);
+            sum += getMarketCumSize(bk, qs.cid[j], qs.side[j], qs.level[j]);
+        }
+        bench::keep(sum);
+    }
+
+    void get_market_orders ( uint64_t iters, int ) {
+        lib3::MarketBook *bk = book().book;
+        const queries &qs = q();
+        size_t sum = 0;
+        for (uint64_t i = 0; i < iters; ++i) {
+            int j = i & (queries::N - 1);
+            sum += getMarketOrders(bk, qs.cid[j], qs.side[j], qs.level[j]);
+        }
+        bench::keep(sum);
+    }
+
+    void get_tradable_market ( uint64_t iters, int ) {
+        lib3::MarketBook *bk = book().book;
+        const queries &qs = q();
+        double px, sum = 0;
+        size_t sz;
+        for (uint64_t i = 0; i < iters; ++i) {
+            int j = i & (queries::N - 1);
+            if (getTradableMarket(bk, qs.cid[j], qs.side[j], 0, 500, &px, &sz))
+                sum += px;
+        }
+        bench::keep(sum);
+    }
+
+    void valid_market ( uint64_t iters, int ) {
+        lib3::MarketBook *bk = book().book;
+        const queries &qs = q();
+        int n = 0;
+        for (uint64_t i = 0; i < iters; ++i)
+            n += validMarket(bk, qs.cid[i & (queries::N - 1)]);
+        bench::keep(n);
+    }
+
+    bench::registrar r1("book.getMarket", get_market, 0);
+    bench::registrar r2("book.getMarket", get_market, 5);
+    bench::registrar r3("book.getMarket.random", get_market);
+    bench::registrar r4("book.getMarketSize.level", get_market_size);
+    bench::registrar r5("book.getMarketSize.price", get_market_size_px);
+    bench::registrar r6("book.getMarketCumSize.level", get_market_cum_size);
+    bench::registrar r7("book.getMarketOrders.level", get_market_orders);
+    bench::registrar r8("book.getTradableMarket", get_tradable_market);
+    bench::registrar r9("book.validMarket", valid_market);
+}
@@ -0,0 +1,88 @@
+#include "bench.h"
+
+#include "DecayingSums.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+    const int SYMBOLS = 5000;
+    const int PERIODS = 4;
+    const int period[PERIODS] = {1, 5, 30, 60};
+    const double lambda[PERIODS] = {0.017, 0.017, 0.1, 0.1};
+
+    /** The trades of one second: arg% of the universe trades, at random. */
+    struct trades {
+        std::vector<int> cid, size;
+        trades ( int pct, uint64_t seed ) {
+            bench::lcg r(seed);
+            int n = SYMBOLS * pct / 100;
+            for (int i = 0; i < n; ++i) {
+                cid.push_back(r.below(SYMBOLS));
+                size.push_back(100 * (1 + r.below(5)));
+            }
+        }
+    };
+
+    /// CapacityTracker's wakeup as it was: nested vectors, every symbol
+    /// every tick.
+    void nested ( uint64_t iters, int arg ) {
+        trades tr(arg, 31);
+        std::vector<double> acc(SYMBOLS, 0.0);
+        std::vector<std::vector<double> > est(PERIODS, std::vector<double>(SYMBOLS, 1000.0));
+        std::vector<std::vector<double> > last(PERIODS, std::vector<double>(SYMBOLS, 0.0));
+        for (uint64_t t = 1; t <= iters; ++t) {
+            for (size_t k = 0; k < tr.cid.size(); ++k)
+                acc[tr.cid[k]] += tr.size[k];
+            for (int i = 0; i < PERIODS; ++i) {
+                if (t % period[i] != 0) continue;
+                for (int cid = 0; cid < SYMBOLS; ++cid) {
+                    est[i][cid] = est[i][cid] * (1 - lambda[i]) + (acc[cid] - last[i][cid]) * lambda[i];
+                    last[i][cid] = acc[cid];
+                }
+            }
+        }
+        bench::keep(est[PERIODS - 1][SYMBOLS / 2]);
+    }
+
+    /// The same through DecayingSums.
+    void decaying ( uint64_t iters, int arg ) {
+        trades tr(arg, 31);
+        std::vector<double> acc(SYMBOLS, 0.0);
+        DecayingSums ds(SYMBOLS, PERIODS, lambda);
+        for (int i = 0; i < PERIODS; ++i)
+            for (int cid = 0; cid < SYMBOLS; ++cid)
+                ds.set(i, cid, 1000.0);
+        for (uint64_t t = 1; t <= iters; ++t) {
+            for (size_t k = 0; k < tr.cid.size(); ++k) {
+                acc[tr.cid[k]] += tr.size[k];
+                ds.touch(tr.cid[k]);
+            }
+            for (int i = 0; i < PERIODS; ++i)
+                if (t % period[i] == 0) ds.tick(i, &acc[0]);
+        }
+        bench::keep(ds.value(PERIODS - 1, SYMBOLS / 2));
+    }
+
+    /// The capacity() lookups: all periods of a random symbol.
+    void value ( uint64_t iters, int ) {
+        DecayingSums ds(SYMBOLS, PERIODS, lambda);
+        bench::lcg r(37);
+        double sum = 0;
+        for (uint64_t i = 0; i < iters; ++i) {
+            int cid = r.below(SYMBOLS);
+            for (int p = 0; p < PERIODS; ++p)
+                sum += ds.value(p, cid) + ds.last(p, cid);
+        }
+        bench::keep(sum);
+    }
+
+    bench::registrar r1("capacity.tick.nested", nested, 1);
+    bench::registrar r2("capacity.tick.nested", nested, 10);
+    bench::registrar r3("capacity.tick.nested", nested, 50);
+    bench::registrar r4("capacity.tick", decaying, 1);
+    bench::registrar r5("capacity.tick", decaying, 10);
+    bench::registrar r6("capacity.tick", decaying, 50);
+    bench::registrar r7("capacity.value", value);
+}
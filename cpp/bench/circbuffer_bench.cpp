@@ -0,0 +1,107 @@
+#include "bench.h"
+
+#include "CircBuffer.h"
+
+#include <vector>
+
+namespace {
+
+    /// Price-like samples: a random walk, so stdev and cor aren't degenerate.
+    const std::vector<double> &samples ( ) {
+        static std::vector<double> v;
+        if (v.empty()) {
+            bench::lcg r(3);
+            double x = 50.0;
+            for (int i = 0; i < 8192; ++i) {
+                x += (r.uniform() - 0.5) * 0.02;
+                v.push_back(x);
+            }
+        }
+        return v;
+    }
+
+    struct filled {
+        CircBuffer<double> x, y;
+        filled ( int n ) : x(n), y(n) {
+            const std::vector<double> &s = samples();
+            for (int i = 0; i < n; ++i) {
+                x.add(s[i % s.size()]);
+                y.add(s[(i * 7 + 13) % s.size()]);
+            }
+        }
+    };
+
+    void add ( uint64_t iters, int arg ) {
+        CircBuffer<double> b(arg);
+        const std::vector<double> &s = samples();
+        for (uint64_t i = 0; i < iters; ++i)
+            b.add(s[i & 8191]);
+        double avg;
+        b.getAvg(&avg);
+        bench::keep(avg);
+    }
+
+    /// add() then the O(1) running mean, as the trackers do per sample.
+    void add_avg ( uint64_t iters, int arg ) {
+        CircBuffer<double> b(arg);
+        const std::vector<double> &s = samples();
+        double avg = 0, sum = 0;
+        for (uint64_t i = 0; i < iters; ++i) {
+            b.add(s[i & 8191]);
+            b.getAvg(&avg);
+            sum += avg;
+        }
+        bench::keep(sum);
+    }
+
+    void avg_n ( uint64_t iters, int arg ) {
+        filled f(arg);
+        double avg = 0, sum = 0;
+        for (uint64_t i = 0; i < iters; ++i) {
+            f.x.getAvg(arg, &avg);
+            sum += avg;
+            bench::keep(sum);
+        }
+    }
+
+    void stdev ( uint64_t iters, int arg ) {
+        filled f(arg);
+        double sd = 0, sum = 0;
+        for (uint64_t i = 0; i < iters; ++i) {
+            f.x.getStdev(&sd);
+            sum += sd;
+            bench::keep(sum);
+        }
+    }
+
+    void stdev_n ( uint64_t iters, int arg ) {
+        filled f(arg);
+        double sd = 0, sum = 0;
+        for (uint64_t i = 0; i < iters; ++i) {
+            f.x.getStdev(arg, &sd);
+            sum += sd;
+            bench::keep(sum);
+        }
+    }
+
+    void cor_n ( uint64_t iters, int arg ) {
+        filled f(arg);
+        double c = 0, sum = 0;
+        for (uint64_t i = 0; i < iters; ++i) {
+            CircBuffer<double>::getCor(&f.x, &f.y, arg, &c);
+            sum += c;
+            bench::keep(sum);
+        }
+    }
+
+    bench::registrar r1("circbuffer.add", add, 100);
+    bench::registrar r2("circbuffer.add", add, 1000);
+    bench::registrar r3("circbuffer.add+avg", add_avg, 100);
+    bench::registrar r4("circbuffer.avg.n", avg_n, 100);
+    bench::registrar r5("circbuffer.avg.n", avg_n, 1000);
+    bench::registrar r6("circbuffer.stdev", stdev, 1000);
+    bench::registrar r7("circbuffer.stdev.n", stdev_n, 100);
+    bench::registrar r8("circbuffer.stdev.n", stdev_n, 1000);
+    bench::registrar r9("circbuffer.cor.n", cor_n, 100);
+    bench::registrar r10("circbuffer.cor.n", cor_n, 1000);
+}
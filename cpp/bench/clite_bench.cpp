@@ -0,0 +1,96 @@
+#include "bench.h"
+
+#include <clite/message.h>
+#include <DataUpdates.h>
+
+#include <vector>
+
+using namespace clite::message;
+using clite::util::nanotime;
+
+namespace {
+
+    struct Tick { int cid; double px; };
+    struct Wake { };
+
+    struct Counter : public dispatch<Tick>::listener {
+        long n;
+        double sum;
+        Counter ( ) : n(0), sum(0) { }
+        void update ( const Tick &t ) { ++n; sum += t.px; }
+    };
+
+    struct Coord : public coordinator< dispatch<Wake> > {
+        dispatch<Tick> th;
+        Coord ( ) { add_dispatch(&th); }
+        bool advise_wakeup ( ) { return false; }
+    };
+
+    /// One message through dispatch<T>::send to arg listeners.
+    void fanout ( uint64_t iters, int arg, bool profile ) {
+        Coord c;
+        std::vector<Counter> ls(arg);
+        for (int i = 0; i < arg; ++i) c.th.add_listener(&ls[i]);
+        c.set_profiling(profile);
+        Tick t = { 0, 10.0 };
+        for (uint64_t i = 0; i < iters; ++i) {
+            t.cid = (int) (i & 1023);
+            c.th.send(t);
+        }
+        c.set_profiling(false);
+        bench::keep(ls[0].sum);
+    }
+
+    void send ( uint64_t iters, int arg ) { fanout(iters, arg, false); }
+    void send_profiled ( uint64_t iters, int arg ) { fanout(iters, arg, true); }
+
+    /// Queue behind block, then deliver the lot through the coordinator,
+    /// as DataManager does when a listener sends during an update.
+    void deliver ( uint64_t iters, int arg ) {
+        Coord c;
+        std::vector<Counter> ls(arg);
+        for (int i = 0; i < arg; ++i) c.th.add_listener(&ls[i]);
+        Tick t = { 0, 10.0 };
+        for (uint64_t i = 0; i < iters; i += 64) {
+            dispatch_base::block = true;
+            for (int k = 0; k < 64; ++k) c.th.send(t);
+            dispatch_base::block = false;
+            c.deliver();
+        }
+        bench::keep(ls[0].sum);
+    }
+
+    /// Periodic timers against times a few ms apart, as DataManager
+    /// reschedules after each firing.
+    void next_after ( uint64_t iters, int ) {
+        Timer t(nanotime::from_sec(1), nanotime::from_ms(250));
+        nanotime tv = nanotime::from_sec(1286199000);
+        nanotime acc;
+        bench::lcg r;
+        for (uint64_t i = 0; i < iters; ++i) {
+            tv = tv + nanotime::from_us(r.below(5000));
+            acc = acc + t.nextAfter(tv);
+        }
+        bench::keep(acc);
+    }
+
+    void next_after_oneoff ( uint64_t iters, int ) {
+        Timer t(nanotime::from_sec(1286199000 + 3600));
+        nanotime tv = nanotime::from_sec(1286199000);
+        nanotime acc;
+        for (uint64_t i = 0; i < iters; ++i) {
+            tv = tv + nanotime::from_ms(1);
+            acc = acc + t.nextAfter(tv);
+        }
+        bench::keep(acc);
+    }
+
+    bench::registrar r1("dispatch.send", send, 1);
+    bench::registrar r2("dispatch.send", send, 4);
+    bench::registrar r3("dispatch.send", send, 16);
+    bench::registrar r4("dispatch.send", send, 64);
+    bench::registrar r5("dispatch.send.profiled", send_profiled, 16);
+    bench::registrar r6("dispatch.deliver", deliver, 16);
+    bench::registrar r7("timer.nextAfter", next_after);
+    bench::registrar r8("timer.nextAfter.oneoff", next_after_oneoff);
+}
@@ -0,0 +1,146 @@
+#include "bench.h"
+
+#include "CentralOrderRepo.h"
+
+#include <Common/MktEnums.h>
+#include <Client/lib3/ordermanagement/nasdaq/NasdaqTrader.h>
+
+#include <cl-util/factory.h>
+
+#include <cstdio>
+#include <vector>
+
+using namespace clite::util;
+
+namespace {
+
+    const int SYMBOLS = 100;
+    const int PER_SIDE = 16;
+    const int COMPONENTS = 4;
+
+    /** A DataManager that is never initialized: it has a universe and
+      * hands out Orders it made itself, which is all CentralOrderRepo asks
+      * of it. */
+    class repo_dm : public DataManager {
+        std::vector<Order *> orders_;
+        public:
+        repo_dm ( ) {
+            char sym[16];
+            for (int c = 0; c < SYMBOLS; ++c) {
+                snprintf(sym, sizeof(sym), "S%03d", c);
+                ci_.add(sym);
+            }
+        }
+        virtual Order const *getOrder ( int id ) {
+            return id >= 0 && id < (int) orders_.size()? orders_[id] : 0;
+        }
+        int place ( int cid, Mkt::Side side, int size, double px, int component ) {
+            int id = orders_.size();
+            Order *o = Order::allocate();
+            lib3::NasdaqOrder *no = lib3::NasdaqOrder::allocate();
+            no->init(id, "BENCH", cid, symbol(cid), lib3::LIMIT, side == Mkt::BID? BUY : SELL,
+                     px, size, TIF_DAY, curtv(), o, false);
+            o->init(no, id, Placement::JOIN_QUEUE, component);
+            orders_.push_back(o);
+            return id;
+        }
+    };
+
+    /** SYMBOLS stocks with PER_SIDE open orders a side, spread over
+      * COMPONENTS components, placed through the placements dispatch as
+      * TradeLogic does. */
+    struct filled_repo {
+        repo_dm *dm;
+        CentralOrderRepo *repo;
+        std::vector<int> ids;
+
+        filled_repo ( ) : dm(new repo_dm) {
+            factory<DataManager>::insert(only::one, dm);
+            repo = new CentralOrderRepo();
+            factory<PlacementsHandler>::pointer ph = factory<PlacementsHandler>::get(only::one);
+
+            bench::lcg r(13);
+            for (int c = 0; c < SYMBOLS; ++c) {
+                double mid = 20.0 + r.below(10000) / 100.0;
+                for (int k = 0; k < 2 * PER_SIDE; ++k) {
+                    Mkt::Side side = k & 1? Mkt::ASK : Mkt::BID;
+                    double px = side == Mkt::BID? mid - 0.01 * (k / 2) : mid + 0.01 * (k / 2);
+                    int size = 100 * (1 + r.below(5));
+                    int comp = k % COMPONENTS;
+                    int id = dm->place(c, side, size, px, comp);
+                    OrderPlacementSuggestion ps(c, ECN::ISLD, side, size, px, 0, 0, comp, 0,
+                                                OrderPlacementSuggestion::JOIN_QUEUE, nanotime(),
+                                                mid - 0.01, mid + 0.01, 0.0);
+                    ps.setOrderId(id);
+                    ph->send(ps);
+                    ids.push_back(id);
+                }
+            }
+        }
+    };
+
+    filled_repo &repo ( ) {
+        static filled_repo r;
+        return r;
+    }
+
+    void get_record ( uint64_t iters, int ) {
+        filled_repo &f = repo();
+        bench::lcg r(17);
+        long sum = 0;
+        for (uint64_t i = 0; i < iters; ++i) {
+            int id = f.ids[r.below(f.ids.size())];
+            sum += f.repo->getOrderRecord(id / (2 * PER_SIDE), id) != 0;
+        }
+        bench::keep(sum);
+    }
+
+    void get_record_by_id ( uint64_t iters, int ) {
+        filled_repo &f = repo();
+        bench::lcg r(17);
+        long sum = 0;
+        for (uint64_t i = 0; i < iters; ++i)
+            sum += f.repo->getOrderRecord(f.ids[r.below(f.ids.size())]) != 0;
+        bench::keep(sum);
+    }
+
+    void get_records ( uint64_t iters, int ) {
+        filled_repo &f = repo();
+        bench::lcg r(19);
+        size_t sum = 0;
+        for (uint64_t i = 0; i < iters; ++i) {
+            int cid = r.below(SYMBOLS);
+            sum += f.repo->getOrderRecords(cid, i & 1? Mkt::ASK : Mkt::BID, 0, r.below(COMPONENTS)).size();
+        }
+        bench::keep(sum);
+    }
+
+    void outstanding ( uint64_t iters, int ) {
+        filled_repo &f = repo();
+        bench::lcg r(23);
+        long sum = 0;
+        for (uint64_t i = 0; i < iters; ++i) {
+            int cid = r.below(SYMBOLS);
+            sum += f.repo->totalOutstandingSize(cid, i & 1? Mkt::ASK : Mkt::BID, r.below(COMPONENTS));
+        }
+        bench::keep(sum);
+    }
+
+    void outstanding_aggressive ( uint64_t iters, int ) {
+        filled_repo &f = repo();
+        bench::lcg r(29);
+        long sum = 0;
+        for (uint64_t i = 0; i < iters; ++i) {
+            int cid = r.below(SYMBOLS);
+            const Order *o = f.dm->getOrder(f.ids[cid * 2 * PER_SIDE + r.below(2 * PER_SIDE)]);
+            sum += f.repo->totalOutstandingSizeMoreEqAggresiveThan(cid, o->side(), o->price(), r.below(COMPONENTS));
+        }
+        bench::keep(sum);
+    }
+
+    bench::registrar r1("orderrepo.getOrderRecord", get_record);
+    bench::registrar r2("orderrepo.getOrderRecord.byId", get_record_by_id);
+    bench::registrar r3("orderrepo.getOrderRecords", get_records);
+    bench::registrar r4("orderrepo.totalOutstandingSize", outstanding);
+    bench::registrar r5("orderrepo.totalOutstandingSizeMoreEqAggresiveThan", outstanding_aggressive);
+}
@@ -0,0 +1,98 @@
+#include "bench.h"
+
+#include <guillotine/yaml_message.h>
+#include <guillotine/typed_message.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <cstdio>
+#include <string>
+
+using namespace guillotine;
+
+namespace {
+
+    /// Swallows what the emitter writes, keeping the last document.
+    class null_writer : public yaml::base_writer {
+        public:
+        std::string last;
+        virtual bool write_bytes ( ) { last.swap(buf); buf.clear(); return true; }
+        virtual bool ready ( ) { return true; }
+        virtual bool eof ( ) { return false; }
+        virtual bool error ( ) { return false; }
+    };
+
+    /// Hands the parser the same document every time it reads.
+    class repeat_reader : public yaml::base_reader {
+        std::string doc_;
+        public:
+        repeat_reader ( const std::string &doc ) : doc_(doc) { }
+        virtual bool read_bytes ( ) { buf.append(doc_); return true; }
+        virtual bool ready ( ) { return true; }
+        virtual bool eof ( ) { return false; }
+        virtual bool error ( ) { return false; }
+    };
+
+    /// What the server does with each raw message it receives.  receive()
+    /// copies the functor, so the count lives outside it.
+    struct decoder {
+        long &n;
+        decoder ( long &n ) : n(n) { }
+        void operator() ( yaml::message &m ) {
+            typed::message msg(typed::get_message(m, 0));
+            n += msg.which();
+        }
+    };
+
+    typed::trade make_trade ( int i ) {
+        char sym[16];
+        snprintf(sym, sizeof(sym), "S%03d", i % 500);
+        typed::trade t;
+        t.symbol = sym;
+        t.aggr = 0.25 * (i % 4);
+        t.orderID = 100000 + i;
+        t.qty = (i & 1? -100 : 100) * (1 + i % 10);
+        t.short_mark = typed::trade::unknown;
+        t.clientId = 0;
+        return t;
+    }
+
+    /// A trade, or a batch of arg trades when arg > 0.
+    typed::message make_message ( int arg ) {
+        if (arg <= 0) return typed::message(make_trade(0));
+        typed::trade_batch b;
+        for (int i = 0; i < arg; ++i) b.trades.push_back(make_trade(i));
+        b.clientId = 0;
+        return typed::message(b);
+    }
+
+    void encode ( uint64_t iters, int arg ) {
+        null_writer *w = new null_writer;
+        yaml::emitter ye(w);
+        typed::message m(make_message(arg));
+        size_t bytes = 0;
+        for (uint64_t i = 0; i < iters; ++i) {
+            ye.send(typed::put_message(m));
+            bytes += w->last.size();
+        }
+        bench::keep(bytes);
+    }
+
+    void decode ( uint64_t iters, int arg ) {
+        null_writer *w = new null_writer;
+        yaml::emitter ye(w);
+        ye.send(typed::put_message(make_message(arg)));
+
+        yaml::parser yp(new repeat_reader(w->last));
+        long n = 0;
+        decoder d(n);
+        for (uint64_t i = 0; i < iters; ++i)
+            yp.receive(d);
+        bench::keep(n);
+    }
+
+    bench::registrar r1("yaml.encode.trade", encode);
+    bench::registrar r2("yaml.decode.trade", decode);
+    bench::registrar r3("yaml.encode.trade_batch", encode, 16);
+    bench::registrar r4("yaml.decode.trade_batch", decode, 16);
+}
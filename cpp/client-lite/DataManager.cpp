@@ -54,6 +54,9 @@ using std::vector;
 using std::string;
 
 using namespace clite;
+using clite::util::tick_to_trade;
+using clite::util::perf_counters;
+namespace trace = clite::util::trace;
 
 using trc::compat::util::DateTime;
 
@@ -62,6 +65,8 @@ using holiday2::HolidaySet;
 
 int DataManager::OnEvent ( Event *e ) 
 { 
+    t2t_.begin();
+    if (perf_) perf_->begin(perf_counters::EVENT);
     checkTimes();
     
     ISLDEvent           *islde;
@@ -79,8 +84,9 @@ int DataManager::OnEvent ( Event *e )
         case SIAC_TICK:
             tick = dynamic_cast<TickEvent *>(e);
             if (tick && ci_[tick->Symbol()] != -1) {
-                TapeUpdate tu(this, Ex::charToEx(tick->Exchange()), 
-                        ci_[tick->Symbol()], tick->Size(), curtv(), tick->Px());
+                TapeUpdate tu(Ex::charToEx(tick->Exchange()), 
+                        ci_[tick->Symbol()], tick->Size(), curtime(), tick->Px());
+                t2t_.stamp(tick_to_trade::DECODE);
                 th.send(tu);
             }
 	    break;
@@ -89,11 +95,12 @@ int DataManager::OnEvent ( Event *e )
         case BATS3_HDN:
             bats3 = dynamic_cast<Bats3Event *>(e);
             if (bats3 && ci_[bats3->Symbol()] != -1) {
-                DataUpdate du(this);
+                DataUpdate du;
                 buildImpTick(du, ci_[bats3->Symbol()], bats3->Px(), bats3->ChgSize(), ECN::BATS, bats3->Timestamp());
                 du.side = bats3->Type() == 0? Mkt::BID : Mkt::ASK;
                 du.id = bats3->SeqNum();
                 if (e->msgtype == BATS3_HDN) du.type = Mkt::INVTRADE;
+                t2t_.stamp(tick_to_trade::DECODE);
                 mh.send(du);
                 break;
             }
@@ -104,11 +111,12 @@ int DataManager::OnEvent ( Event *e )
         	// GVNOTE: Looks like this was intentional?! See commit comment for 2009-08-05.
             at = dynamic_cast<ArcaTradeEvent *>(e);
             if (at && ci_[at->Symbol()] != -1) {
-                DataUpdate du(this);
+                DataUpdate du;
                 buildImpTick(du, ci_[at->Symbol()], at->Px(), at->Size(), ECN::ARCA, at->Timestamp());
                 du.type = Mkt::VISTRADE;
                 du.side = Mkt::BID;
                 du.id = 0;
+                t2t_.stamp(tick_to_trade::DECODE);
                 mh.send(du);
                 break;
             }
@@ -126,7 +134,7 @@ int DataManager::OnEvent ( Event *e )
             islde  = dynamic_cast<ISLDEvent *>(e);
             if (islde && ci_[islde->Symbol()] != -1 && islde->Type() < 2  ) {
 
-                DataUpdate du(this);
+                DataUpdate du;
                 du.price = islde->Px();
                 du.size = islde->Size();
                 du.cid = ci_[islde->Symbol()];
@@ -134,9 +142,7 @@ int DataManager::OnEvent ( Event *e )
                 du.id = islde->RefNum();
                 du.ecn = ECN::ISLD;
 
-                du.tv = midnight_;
-                du.tv.sec()  +=  islde->i2qs->i_msecs / 1000;
-                du.tv.usec() += (islde->i2qs->i_msecs % 1000) * 1000;
+                du.tv = nanotime(midnight_) + nanotime::from_ms(islde->i2qs->i_msecs);
                 if (e->msgtype == ISLD_HIDDENEXEC 
                         || e->msgtype ==ITCH3_HIDDENEXEC 
                         || e->msgtype ==ITCH4_HIDDENEXEC 
@@ -145,6 +151,7 @@ int DataManager::OnEvent ( Event *e )
                     du.type = Mkt::INVTRADE;
                 else 
                     du.type = Mkt::VISTRADE;
+                t2t_.stamp(tick_to_trade::DECODE);
                 mh.send(du);
                 break;
             }
@@ -154,7 +161,7 @@ int DataManager::OnEvent ( Event *e )
         case ITCH4F_HIDDENEXEC:
             i4e = dynamic_cast<Itch4Event *>(e);
             if (i4e && ci_[i4e->Symbol()] != -1 && i4e->Type() < 2) {
-                DataUpdate du(this);
+                DataUpdate du;
                 du.price = i4e->Px();
                 du.size = i4e->Size();
                 du.cid = ci_[i4e->Symbol()];
@@ -169,6 +176,7 @@ int DataManager::OnEvent ( Event *e )
                     du.type = Mkt::INVTRADE;
                 else 
                     du.type = Mkt::VISTRADE;
+                t2t_.stamp(tick_to_trade::DECODE);
                 mh.send(du);
                 break;
             }
@@ -179,7 +187,7 @@ int DataManager::OnEvent ( Event *e )
         	// BSX uses Itch4.0, hence we create an Itch4Event
             i4e = dynamic_cast<Itch4Event *>(e);
             if (i4e && ci_[i4e->Symbol()] != -1 && i4e->Type() < 2) {
-                DataUpdate du(this);
+                DataUpdate du;
                 du.price = i4e->Px();
                 du.size = i4e->Size();
                 du.cid = ci_[i4e->Symbol()];
@@ -192,6 +200,7 @@ int DataManager::OnEvent ( Event *e )
                     du.type = Mkt::INVTRADE;
                 else
                     du.type = Mkt::VISTRADE;
+                t2t_.stamp(tick_to_trade::DECODE);
                 mh.send(du);
                 break;
             }
@@ -199,7 +208,7 @@ int DataManager::OnEvent ( Event *e )
         case NYSE_TRADE:
             nte = dynamic_cast<NYSETradeEvent *>(e);
             if (nte && ci_[nte->Symbol()] != -1 ) {
-                DataUpdate du(this);
+                DataUpdate du;
                 du.type = Mkt::VISTRADE;
                 du.price = nte->Px();
                 du.size = nte->Size();
@@ -207,6 +216,7 @@ int DataManager::OnEvent ( Event *e )
                 du.side = Mkt::BID;
                 du.ecn = ECN::NYSE;
                 du.tv = nte->Timestamp();
+                t2t_.stamp(tick_to_trade::DECODE);
                 mh.send(du);
                 break;
             }
@@ -215,6 +225,7 @@ int DataManager::OnEvent ( Event *e )
             ue = dynamic_cast<UserEvent *>(e);
             if (ue) {
                 UserMessage um(ue->Msg1(), ue->Msg2(), ue->Code(), ue->Strategy(), e->livetv);
+                t2t_.stamp(tick_to_trade::DECODE);
                 umh.send(um);
                 break;
             }
@@ -233,7 +244,10 @@ int DataManager::OnEvent ( Event *e )
             break;
     }
 
+    t2t_.stamp(tick_to_trade::DISPATCH);
+    if (perf_) perf_->end(perf_counters::EVENT, e->msgtype);
     deliver();
+    endCycle();
     return 0;
 }
 
@@ -241,15 +255,15 @@ void DataManager::addTimer ( Timer t ) {
     timerset::iterator it = timers.find(t);
     if (it == timers.end()) {
         timers.insert(t);
-        nexttimes.push(TimeUpdate(t, t.nextAfter(curtv())));
+        nexttimes.push(TimeUpdate(t, t.nextAfter(curtime())));
     }
 }
 
 void DataManager::checkTimes() {
     if (nexttimes.empty()) return;
-    TimeVal now = curtv();
+    nanotime now = curtime();
     
-    TimeVal nexttv;
+    nanotime nexttv;
     do {
         TimeUpdate const &next = nexttimes.top();
         nexttv = next.tv();
@@ -265,7 +279,7 @@ void DataManager::checkTimes() {
 
 // GVNOTE: Should remove this function, as it is used in just 2 places, and there also it seems that
 // we partially overwrite what this function does.
-void DataManager::buildImpTick ( DataUpdate &d, int cid, double px, int sz, ECN::ECN ecn, TimeVal tv ) {
+void DataManager::buildImpTick ( DataUpdate &d, int cid, double px, int sz, ECN::ECN ecn, nanotime tv ) {
     int asz = getMarketSize(subBook(ecn), cid, Mkt::ASK, px);
     int bsz = getMarketSize(subBook(ecn), cid, Mkt::BID, px);
     Mkt::Side s;
@@ -292,8 +306,10 @@ void DataManager::buildImpTick ( DataUpdate &d, int cid, double px, int sz, ECN:
 
 void DataManager::onBookChange ( int book_id, lib3::BookOrder *bo, lib3::QuoteReason qr, int delta, bool done )
 {
+    t2t_.begin();
+    if (perf_) perf_->begin(perf_counters::EVENT);
     checkTimes();
-    DataUpdate du(this);
+    DataUpdate du;
     du.cid = bo->cid;
     du.ecn = ECN::mmtoECN[bo->mm];
     if (du.ecn == ECN::UNKN) {
@@ -308,9 +324,13 @@ void DataManager::onBookChange ( int book_id, lib3::BookOrder *bo, lib3::QuoteRe
     du.tv = bo->update_time;
     du.addtv = bo->add_time;
 
+    t2t_.stamp(tick_to_trade::DECODE);
     mh.send(du);
+    t2t_.stamp(tick_to_trade::DISPATCH);
+    if (perf_) perf_->end(perf_counters::EVENT, PERF_BOOK);
 
     deliver();
+    endCycle();
 }
 
 void DataManager::CIChange ( CIndex *which ) {
@@ -354,7 +374,8 @@ Order const *DataManager::getOrder ( int id ) {
 }
 
 Mkt::OrderResult DataManager::placeOrder ( int cid, ECN::ECN ecn, int size, double price,
-        Mkt::Side dir, int timeout, bool invisible, int *seq , long clientOrderID, Mkt::Marking marking, const char* placementAlgo) {
+        Mkt::Side dir, int timeout, bool invisible, int *seq , long clientOrderID, Mkt::Marking marking, Placement::Reason reason, int componentId) {
+    trace::span sp("placeOrder", cid);
 
 	TAEL_PRINTF(dbg.get(), TAEL_INFO, "came in place order. will try to place order for %s on %s for %d",
 			    symbol(cid), ECN::desc(ecn), ((dir == Mkt::BID) ? size: -1*size));
@@ -393,7 +414,7 @@ Mkt::OrderResult DataManager::placeOrder ( int cid, ECN::ECN ecn, int size, doub
     }
 
     MarketMaker mm = ecnToMM[ecn];
-    RejectReasons reason = RejectReasons(-1);
+    RejectReasons rejReason = RejectReasons(-1);
 
     lib3::Order *lo = 0;
     Order *o = Order::allocate();
@@ -490,19 +511,14 @@ Mkt::OrderResult DataManager::placeOrder ( int cid, ECN::ECN ecn, int size, doub
         TAEL_PRINTF(dbg.get(), TAEL_ERROR, "placeOrder: tradesys neither COLO nor SIMTRADE. Not sending to TS.");
         return Mkt::NO_ROUTE;
     }
-    if (!om->trade(lo, &reason)) {
-        return Mkt::reasonToResult(reason);
+    if (!om->trade(lo, &rejReason)) {
+        return Mkt::reasonToResult(rejReason);
     }
+    t2t_.stamp(tick_to_trade::SEND);
 
-    if(placementAlgo) {
-		o->init(lo, clientOrderID, placementAlgo);
-    } else {
-    	o->init(lo, clientOrderID, "UNKNOWN");
-    }
-    TAEL_PRINTF(&reportlog, TAEL_INFO, "%s %s:%d %s %ld TS seqnum: %d", ci_[cid], placementAlgo, ((trade == BUY)? size: -1*size), ECN::desc(ecn), clientOrderID, newseq);
-    o->plreq.init(o, this, Mkt::PLACING, Mkt::GOOD, -1, size, 0, Liq::other, true, 0, price, curtv(), clientOrderID);
-    o->last = &(o->plreq);
-    oh.send(o->plreq);
+    o->init(lo, clientOrderID, reason, componentId);
+    TAEL_PRINTF(&reportlog, TAEL_INFO, "%s %s:%d %s %ld TS seqnum: %d", ci_[cid], Placement::ReasonDesc[reason], ((trade == BUY)? size: -1*size), ECN::desc(ecn), clientOrderID, newseq);
+    oh.send(o->update(Order::PLACE_REQ, Mkt::PLACING, Mkt::GOOD, -1, size, 0, Liq::other, true, 0, price, curtime()));
     if (seq) *seq = newseq;
     return Mkt::GOOD;
 }
@@ -511,6 +527,7 @@ Mkt::OrderResult DataManager::placeOrder ( int cid, ECN::ECN ecn, int size, doub
 // Should perhaps remove this if we are no longer going to use CrossTargetTrader?
 Mkt::OrderResult DataManager::placeBatsOrder ( int cid, int size, double price,
         Mkt::Side dir, BatsRouteMod routing, int *seq, long clientOrderID, Mkt::Marking marking ) {
+    trace::span sp("placeOrder", cid);
     if (listen_only) return Mkt::NO_ROUTE;
     if (!om) return Mkt::NO_REASON;
 
@@ -554,15 +571,14 @@ Mkt::OrderResult DataManager::placeBatsOrder ( int cid, int size, double price,
         return Mkt::NO_ROUTE;
     }
 
-    o->init(lo, clientOrderID, "UNKNOWN");
+    o->init(lo, clientOrderID, Placement::UNKNOWN, -1);
 
     if (!om->trade(lo, &reason)) {
         return Mkt::reasonToResult(reason);
     }
+    t2t_.stamp(tick_to_trade::SEND);
 
-    o->plreq.init(o, this, Mkt::PLACING, Mkt::GOOD, -1, size, 0, Liq::other, true, 0, price, curtv(), clientOrderID);
-    o->last = &(o->plreq);
-    oh.send(o->plreq);
+    oh.send(o->update(Order::PLACE_REQ, Mkt::PLACING, Mkt::GOOD, -1, size, 0, Liq::other, true, 0, price, curtime()));
     if (seq) *seq = newseq;
     return Mkt::GOOD;
 }
@@ -616,6 +632,7 @@ void DataManager::cancelMarket ( int cid, ECN::ECN ecn, Mkt::Side side, int l )
 }
 
 bool DataManager::cancelOrder ( int id ) {
+    trace::span sp("cancelOrder");
     if (listen_only) return false;
     char const *acct = colo_accts[seqnum_ecn(id)].c_str();
     if (acct == 0) {
@@ -634,16 +651,16 @@ bool DataManager::cancelOrder ( int id ) {
     bool didcancel = false;
     if (o->action() != Mkt::CANCELING) {
         didcancel = om->cancel(acct, id);
+        if (didcancel) t2t_.stamp(tick_to_trade::SEND);
         if (o && didcancel) {
-            o->cxreq.init(o, this, Mkt::CANCELING, Mkt::GOOD,
-                    o->lastUpdate().exchangeID(),
-                    o->lastUpdate().sharesOpen(), //updating shares
-                    o->lastUpdate().sharesFilled(), //shares filled
-                    o->lastUpdate().liq(), !lo->is_prom,
-                    o->lastUpdate().sharesCanceled(), //shares canceled
-                    o->confirmed().thisPrice(), curtv(), o->orderID());
-            o->last = &(o->cxreq);
-            oh.send(o->cxreq);
+            OrderUpdate last = o->lastUpdate();
+            oh.send(o->update(Order::CANCEL_REQ, Mkt::CANCELING, Mkt::GOOD,
+                    last.exchangeID(),
+                    last.sharesOpen(), //updating shares
+                    last.sharesFilled(), //shares filled
+                    last.liq(), !lo->is_prom,
+                    last.sharesCanceled(), //shares canceled
+                    o->confirmed().thisPrice(), curtime()));
         }
     }
     return didcancel;
@@ -760,7 +777,7 @@ void DataManager::onFill ( lib3::Order *lo, lib3::FillDetails *fd ) {
     Order *o = (Order *) lo->custom_plugin;
     if (!o) {
         lo->custom_plugin = o = Order::allocate();
-        o->init(lo, -1, "UNKNOWN");
+        o->init(lo, -1, Placement::UNKNOWN, -1);
     }
     // GVNOTE: Should send fd->fill_time instead of curtv(). But should also store curtv()
     // somewhere ... perhaps add a field in OrderUpdate?
@@ -768,53 +785,49 @@ void DataManager::onFill ( lib3::Order *lo, lib3::FillDetails *fd ) {
     // support for this, especially if we are using PO+ orders etc.
     // Create a fills file which has a format similar to the fills file on asetrade1.jc
     o->setRealEcn(fd->real_mm);
-    o->flrsp.init(o, this, Mkt::FILLED, Mkt::GOOD, o->last->exchangeID(), fd->fill_size,
-            o->last->sharesFilled() + fd->fill_size, Liq::fromHyp2(fd->liquidity), !lo->is_prom,
-            o->last->sharesCanceled(),
-            fd->fpx, curtv(), o->orderID());
-    o->last = &(o->flrsp);
-    oh.send(o->flrsp);
+    OrderUpdate last = o->lastUpdate();
+    oh.send(o->update(Order::FILL_RSP, Mkt::FILLED, Mkt::GOOD, last.exchangeID(), fd->fill_size,
+            last.sharesFilled() + fd->fill_size, Liq::fromHyp2(fd->liquidity), !lo->is_prom,
+            last.sharesCanceled(),
+            fd->fpx, curtime()));
 }
 
 void DataManager::onCancel ( lib3::Order *lo, lib3::CancelDetails *cd ) {
     Order *o = (Order *) lo->custom_plugin;
     if (!o) {
         lo->custom_plugin = o = Order::allocate();
-        o->init(lo, -1, "UNKNOWN");
+        o->init(lo, -1, Placement::UNKNOWN, -1);
     }
-    o->cxrsp.init(o, this, Mkt::CANCELED, Mkt::GOOD, o->last->exchangeID(), cd->cancel_size,
-            o->last->sharesFilled(), o->last->liq(), !lo->is_prom,
-            o->last->sharesCanceled() + cd->cancel_size,
-            lo->confirmed_px, curtv(), o->orderID());
-    o->last = &(o->cxrsp);
-    oh.send(o->cxrsp);
+    OrderUpdate last = o->lastUpdate();
+    oh.send(o->update(Order::CANCEL_RSP, Mkt::CANCELED, Mkt::GOOD, last.exchangeID(), cd->cancel_size,
+            last.sharesFilled(), last.liq(), !lo->is_prom,
+            last.sharesCanceled() + cd->cancel_size,
+            lo->confirmed_px, curtime()));
 }
 
 void DataManager::onConfirm ( lib3::Order *lo ) {
     Order *o = (Order *) lo->custom_plugin;
     if (!o) {
         lo->custom_plugin = o = Order::allocate();
-        o->init(lo, -1, "UNKNOWN");
+        o->init(lo, -1, Placement::UNKNOWN, -1);
     }
-    o->plrsp.init(o, this, Mkt::CONFIRMED, Mkt::GOOD, 
+    oh.send(o->update(Order::PLACE_RSP, Mkt::CONFIRMED, Mkt::GOOD, 
             lo->confirm_details->exchange_id, 
             lo->confirm_details->confirmed_size,
             0, Liq::other, !lo->is_prom, 0,
-            lo->confirm_details->confirmed_px, curtv(), o->orderID());
-    o->last = &(o->plrsp);
-    oh.send(o->plrsp);
+            lo->confirm_details->confirmed_px, curtime()));
 }
 
 void DataManager::onReject ( lib3::Order *lo, lib3::RejectDetails *rd ) {
     Order *o = (Order *) lo->custom_plugin;
     if (!o) {
         lo->custom_plugin = o = Order::allocate();
-        o->init(lo, -1, "UNKNOWN");
+        o->init(lo, -1, Placement::UNKNOWN, -1);
     }
-    o->plrsp.init(o, this, Mkt::REJECTED, Mkt::reasonToResult(rd->reason), -1, 
+    OrderUpdate rej = o->update(Order::PLACE_RSP, Mkt::REJECTED, Mkt::reasonToResult(rd->reason), -1, 
             o->size_,
             0, Liq::other, !lo->is_prom, o->size_,
-            o->price_, curtv(), o->orderID());
+            o->price_, curtime());
 	if (!lo->is_prom) {
 		numRejects++;
 		if(numRejects > MAX_ALLOWED_REJECTS) {
@@ -823,23 +836,21 @@ void DataManager::onReject ( lib3::Order *lo, lib3::RejectDetails *rd ) {
 					ECN::desc(o->realecn()), Mkt::OrderResultDesc[Mkt::reasonToResult(rd->reason)]);
 		}
 	}
-    o->last = &(o->plrsp);
-    oh.send(o->plrsp);
+    oh.send(rej);
 }
 
 void DataManager::onCancelReject ( lib3::Order *lo, lib3::CancelRejectDetails *cd ) {
     Order *o = (Order *) lo->custom_plugin;
     if (!o) {
         lo->custom_plugin = o = Order::allocate();
-        o->init(lo, -1, "UNKNOWN");
-    }
-    o->cxrsp.init(o, this, Mkt::CXLREJECTED, o->last->error(), 
-            o->last->exchangeID(), o->canceling().thisShares(),
-            o->last->sharesFilled(), o->last->liq(), !lo->is_prom,
-            o->last->sharesCanceled(),
-            o->confirmed().thisPrice(), curtv(), o->orderID());
-    o->last = &(o->cxrsp);
-    oh.send(o->cxrsp);
+        o->init(lo, -1, Placement::UNKNOWN, -1);
+    }
+    OrderUpdate last = o->lastUpdate();
+    oh.send(o->update(Order::CANCEL_RSP, Mkt::CXLREJECTED, last.error(), 
+            last.exchangeID(), o->canceling().thisShares(),
+            last.sharesFilled(), last.liq(), !lo->is_prom,
+            last.sharesCanceled(),
+            o->confirmed().thisPrice(), curtime()));
 }
 
 void DataManager::onBreak ( lib3::BreakDetails *bd ) {
@@ -939,6 +950,7 @@ DataManager::DataManager ( ) :
     reportlog(*(new tael::LoggerConfiguration((size_t) MAX_BINARY_BUFFER_FILE_SIZE)))
 { 
     construct(); 
+    updateSymbols = this;
 }
 
 DataManager::DataManager ( std::string &confname ) :
@@ -946,6 +958,7 @@ DataManager::DataManager ( std::string &confname ) :
     reportlog(*(new tael::LoggerConfiguration((size_t) MAX_BINARY_BUFFER_FILE_SIZE)))
 { 
     construct(); 
+    updateSymbols = this;
 }
 
 void DataManager::construct ( ) {
@@ -957,6 +970,8 @@ void DataManager::construct ( ) {
     es = 0;
 
     date_ = 0;
+    trace_wake_ = 0;
+    perf_ = 0;
 //    outfd_ = -1;
 
     sims = 0;
@@ -973,6 +988,7 @@ void DataManager::construct ( ) {
     // otherwise Boost libraries complain.
     defOption("debug-level", &dbglvl, "data debugging verbosity ([min]0 to [max]10)", 6);
     defOption("report-log-file", &reportfile_, "info about order placement", "report.log");
+    defOption("latency-log-interval", &latlog_secs_, "seconds between tick-to-trade latency logs (0 = never)", 60);
     defOption("alpha-log-file", &alphalogfile_, "info about alpha", "alpha.log");
     defOption("out-file", &outfile_, "redirect stderr and stdout to here", "std.out");
     defOption("symbol", &symbols_, "symbols to run");
@@ -1008,6 +1024,8 @@ void DataManager::construct ( ) {
     defSwitch("exchange-trades", &useextrd, "Use SIAC and UTDF trade tick data");
     defOption("holiday-file", &holiday_file, "Holiday calendar file (/apps/hyp2/... if unspecified)");
     defSwitch("use-po+", &usepoplus, "Use PO+ ARCA orders for NYSE");
+    defSwitch("perf-counters", &perf_on_, "Sample hardware counters around events and wakeups (perf_event_open)");
+    defOption("perf-sample", &perf_sample_, "Measure 1 in N events/wakeups with perf-counters", 16);
     // GVNOTE: Start using PO+ orders for NYSE once we have some more things in the slippage report
     // i.e. per exec server, per exchange slippage report.
     //defOption("use-po+", &usepoplus, "Use PO+ ARCA orders for NYSE", true);
@@ -1033,6 +1051,8 @@ void DataManager::construct ( ) {
 }
 
 DataManager::~DataManager ( ) {
+    if (updateSymbols == this) updateSymbols = 0;
+    delete perf_;
     //if (outfd_ != -1) close(outfd_);
 	if(outfp) fclose(outfp);
 }
@@ -1186,6 +1206,12 @@ bool DataManager::initialize ( ) {
     numRejects = 0;
     dbg = clite::util::factory<clite::util::debug_stream>::get(std::string("dataman"));
     dbg->setThreshold(tael::Severity(dbglvl));
+    latlog = clite::util::factory<clite::util::debug_stream>::get(std::string("latency"));
+    if (perf_on_ && !perf_) {
+        perf_ = new perf_counters(perf_sample_ > 0? perf_sample_ : 1);
+        perf_->name(PERF_BOOK, "book");
+        perf_->name(PERF_WAKEUP, "wakeup");
+    }
     int reportfd = open((string(getenv("EXEC_LOG_DIR")) + string("/") + reportfile_).c_str(), O_RDWR | O_CREAT | O_APPEND, 0640);
     if (reportfd > -1) {
       reportfld.reset(new tael::FdLogger(reportfd));
@@ -1270,6 +1296,7 @@ bool DataManager::initialize ( ) {
     // GVNOTE: Not sure why we set the curtv_ (current time value)to midnight
     midnight_ = DateTime::getMidnight(date_);
     curtv_ = midnight_;
+    curns_ = curtv_;
 
     ecb = new EventSourceCB(es);
     mbk = new lib3::AggrMarketBook(ci_, mbk_id, es->clock, dbg.get());
@@ -1308,7 +1335,55 @@ bool DataManager::initialize ( ) {
     return true;
 }
 
-WakeUpdate DataManager::wakeup_message ( ) { return WakeUpdate(curtv()); }
+WakeUpdate DataManager::wakeup_message ( ) {
+    t2t_.wakeup();
+    if (perf_) perf_->begin(perf_counters::WAKEUP);
+    if (trace::enabled) {
+        trace::mark(curtime());
+        trace_wake_ = infra_timing::getCycleCount();
+    }
+    return WakeUpdate(curtime());
+}
+
+namespace {
+    struct costlier {
+        bool operator() ( const clite::message::listener_cost &a, const clite::message::listener_cost &b ) const {
+            return a.estimated() > b.estimated();
+        }
+    };
+}
+
+void DataManager::printDispatchProfile ( clite::util::debug_stream *ds, tael::Severity sev, bool reset ) {
+    std::vector<clite::message::listener_cost> costs;
+    profile(costs, reset);
+    std::sort(costs.begin(), costs.end(), costlier());
+    double tpu = t2t_.ticks_per_usec();
+    TAEL_PRINTF(ds, sev, "dispatch profile (%s, 1 in %u calls timed):",
+            clite::message::dispatch_base::profiling? "on" : "off", clite::message::dispatch_base::sample_period);
+    for (size_t i = 0; i < costs.size(); ++i) {
+        const clite::message::listener_cost &c = costs[i];
+        TAEL_PRINTF(ds, sev, "  %-40s %-14s calls=%-9lu mean=%8.3fus total=%10.3fms",
+                c.listener.c_str(), c.message.c_str(), (unsigned long) c.calls,
+                c.sampled? c.ticks / tpu / c.sampled : 0.0, c.estimated() / tpu / 1000.0);
+    }
+}
+
+// Close the tick-to-trade cycle if this event's deliver() sent the wakeup,
+// and log (then reset) the stage histograms every latency-log-interval.
+void DataManager::endCycle ( ) {
+    t2t_.end();
+    if (perf_) perf_->end(perf_counters::WAKEUP, PERF_WAKEUP);
+    if (trace_wake_) {
+        trace::add("wakeup", -1, 0, trace_wake_, infra_timing::getCycleCount());
+        trace_wake_ = 0;
+    }
+    if (latlog_secs_ <= 0 || curns_ < next_latlog_) return;
+    if (!next_latlog_.isZero() && latlog) {
+        t2t_.print(latlog.get(), TAEL_INFO);
+        t2t_.clear();
+    }
+    next_latlog_ = curns_ + nanotime::from_sec(latlog_secs_);
+}
 
 // This is the function in the coordinator, which is called to figure out
 // whether to send a wakeup_message or not.
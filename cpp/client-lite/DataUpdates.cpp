@@ -17,7 +17,10 @@ bool operator!= ( const DataUpdate &a, const DataUpdate &b ) {
     return !(a == b);
 }
 
+const DataManager *updateSymbols = 0;
+
 int TapeUpdate::snprint ( char *s, int n ) const {
+    const DataManager *dm = updateSymbols;
     return dm?
         snprintf(s, n, "Tape %010ld.%06ld: %5s %4s %6d $%8.2f",
                 tv_.sec(), tv_.usec(), dm->symbol(cid_), Ex::desc(ex_), size_, px_)
@@ -28,6 +31,7 @@ int TapeUpdate::snprint ( char *s, int n ) const {
 }
 
 int DataUpdate::snprint ( char *s, int n ) const {
+    const DataManager *dm = updateSymbols;
     return dm?
         snprintf(s, n, "Data %010ld.%06ld: %5s %5s %4s - %3s %+6d %8.2f [%ld]",
                 tv.sec(), tv.usec(), Mkt::DUTypeDesc[type], 
@@ -41,48 +45,42 @@ int DataUpdate::snprint ( char *s, int n ) const {
         ;
 }
 int OrderUpdate::snprint ( char *s, int n ) const {
-    return dm?
+    const DataManager *dm = updateSymbols;
+    nanotime t = tv();
+    // placeholder slots (NO_UPDATE) always printed the cid, not the symbol
+    return dm && ev_.action != Mkt::NO_UPDATE?
         snprintf(s, n, "Order %10ld.%06ld: %5s %4s %4s %4d@%8.2f (%4d/%4d %8.2f) %6s/%7s %4ds %c [%d/E:%ld]",
-                tv_.sec(), tv_.usec(), 
-		 dm->symbol(cid_), ECN::desc(ecn()),
-                Mkt::TradeDesc[dir_], upshs_, uppx_, sharesOpen(), size_, price_, 
-                Mkt::OrderActionDesc[action_], Mkt::OrderResultDesc[error_], 
-                timeout_, inv_?'I':'V', id_, exid_)
+                t.sec(), t.usec(), 
+		 dm->symbol(cid()), ECN::desc(ecn()),
+                Mkt::TradeDesc[dir()], thisShares(), thisPrice(), sharesOpen(), size(), price(), 
+                Mkt::OrderActionDesc[action()], Mkt::OrderResultDesc[error()], 
+                timeout(), invisible()?'I':'V', id(), exchangeID())
         :
         snprintf(s, n, "Order %10ld.%06ld: #%3d# %4s %4s %4d@%8.2f (%4d/%4d %8.2f) %6s/%7s %4ds %c [%d/E:%ld]",
-                tv_.sec(), tv_.usec(), cid_,
+                t.sec(), t.usec(), cid(),
 		 ECN::desc(ecn()),
-                Mkt::TradeDesc[dir_], upshs_, uppx_, sharesOpen(), size_, price_, 
-                Mkt::OrderActionDesc[action_], Mkt::OrderResultDesc[error_], 
-                timeout_, inv_?'I':'V', id_, exid_)
+                Mkt::TradeDesc[dir()], thisShares(), thisPrice(), sharesOpen(), size(), price(), 
+                Mkt::OrderActionDesc[action()], Mkt::OrderResultDesc[error()], 
+                timeout(), invisible()?'I':'V', id(), exchangeID())
         ;
 }
 
-void OrderUpdate::init ( Order const *o, DataManager *dm_, Mkt::OrderAction act, Mkt::OrderResult err,
-        int64_t exid, int upshs, int fillshs, Liq::Liq l, bool mine, int cxlshs, double uppx, TimeVal tv, long orderID ) {
-    dm = dm_;
-    action_ = act;
-    error_ = err;
-    exid_ = exid;
-    upshs_ = upshs;
-    cxlshs_ = cxlshs;
-    fillshs_ = fillshs;
-    uppx_ = uppx;
-    fee_ = fees_ = 0.0;
-    tv_ = tv;
-    liq_ = l;
-    mine_ = mine;
-    orderID_ = orderID;
-
-    ecn_ = o->realecn();
-    dir_ = o->dir();
-    id_ = o->id();
-    cid_ = o->cid();
-    timeout_ = o->timeout();
-    price_ = o->price();
-    size_ = o->size();
-    inv_ = o->invisible();
-    placementAlgo_ = o->placementAlgo;
+OrderUpdate Order::update ( Slot s, Mkt::OrderAction act, Mkt::OrderResult err,
+        int64_t exid, int upshs, int fillshs, Liq::Liq l, bool mine, int cxlshs, double uppx, nanotime tv ) {
+    OrderEvent &e = events_[s];
+    e.ns = tv.count();
+    e.exid = exid;
+    e.uppx = uppx;
+    e.upshs = upshs;
+    e.fillshs = fillshs;
+    e.cxlshs = cxlshs;
+    e.action = act;
+    e.error = err;
+    e.liq = l;
+    e.ecn = realecn_;
+    e.mine = mine;
+    if (act != Mkt::NO_UPDATE) last_ = s;
+    return OrderUpdate(this, e);
 }
 
 bool Order::isCanceling() const {
@@ -97,12 +95,9 @@ bool Order::isCanceling() const {
 
 Order *Order::allocate ( ) { return lib3::Mempool<Order>::getInstance()->allocate(); }
 
-void Order::init ( lib3::Order const *lo, long orderID, const char* placeAlgo ) {
-	if(placeAlgo) {
-		placementAlgo.assign(placeAlgo);
-	} else {
-		placementAlgo.assign("UNKNOWN");
-	}
+void Order::init ( lib3::Order const *lo, long orderID, Placement::Reason reason, int componentId ) {
+    placement_ = reason;
+    component_ = componentId;
 	orderID_ = orderID;
     lo_ = lo;
     id_ = lo->seqnum;
@@ -115,7 +110,6 @@ void Order::init ( lib3::Order const *lo, long orderID, const char* placeAlgo )
     realecn_ = ECN::mmtoECN[lo->mmid];
     dir_ = (Mkt::Trade) lo->dir;
     mine_ = !lo->is_prom;
-    last = &plreq;
     poplus_ = false;
     if (ecn_==ECN::ARCA){
         const lib3::ArcaOrder *ao = dynamic_cast<const lib3::ArcaOrder*>(lo);
@@ -123,11 +117,9 @@ void Order::init ( lib3::Order const *lo, long orderID, const char* placeAlgo )
             poplus_ = (ao->routing == 'O');
       }
     }
-    plreq.init(this, 0, Mkt::NO_UPDATE, Mkt::GOOD, -1, 0, 0, Liq::other, mine_, 0, 0.0, TimeVal(0, 0), orderID);
-    plrsp.init(this, 0, Mkt::NO_UPDATE, Mkt::GOOD, -1, 0, 0, Liq::other, mine_, 0, 0.0, TimeVal(0, 0), orderID);
-    cxreq.init(this, 0, Mkt::NO_UPDATE, Mkt::GOOD, -1, 0, 0, Liq::other, mine_, 0, 0.0, TimeVal(0, 0), orderID);
-    cxrsp.init(this, 0, Mkt::NO_UPDATE, Mkt::GOOD, -1, 0, 0, Liq::other, mine_, 0, 0.0, TimeVal(0, 0), orderID);
-    flrsp.init(this, 0, Mkt::NO_UPDATE, Mkt::GOOD, -1, 0, 0, Liq::other, mine_, 0, 0.0, TimeVal(0, 0), orderID);
+    last_ = PLACE_REQ;
+    for (int i = 0; i < NUM_SLOTS; ++i)
+        update((Slot) i, Mkt::NO_UPDATE, Mkt::GOOD, -1, 0, 0, Liq::other, mine_, 0, 0.0, nanotime());
 }
 
 int Order::snprint ( char *buf, int n ) const {
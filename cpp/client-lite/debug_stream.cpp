@@ -7,6 +7,7 @@ using std::string;
 debug_stream::debug_stream ( string const & name ) : tael::Logger(*(new tael::LoggerConfiguration((size_t) MAX_BINARY_BUFFER_FILE_SIZE))) {
 
     debug_stream_config::config *cfg = debug_stream_config::get_config();
+    deferred_ = cfg->deferred();
     if (!(*cfg)) {
         prefix = name + string(": ");
     }
@@ -35,4 +36,15 @@ void debug_stream::printf(const char *format, ... ) {
 	va_end(ap);
 }
 
-debug_stream::~debug_stream ( ) { }
+void debug_stream::record ( const deferred::site **site, tael::Severity sev, const char *format, ... ) {
+    if (!*site) *site = deferred::register_site(format);
+    va_list ap;
+    va_start(ap, format);
+    deferred::record(this, sev, *site, format, ap);
+    va_end(ap);
+}
+
+debug_stream::~debug_stream ( ) {
+    // lines queued for this stream must reach its destinations before it goes.
+    if (deferred_) deferred::flush();
+}
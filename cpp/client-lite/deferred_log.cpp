@@ -0,0 +1,385 @@
+#include <cl-util/deferred_log.h>
+#include <cl-util/debug_stream.h>
+#include <cl-util/nanotime.h>
+
+#include <c_util/Thread.h>
+using trc::compat::util::Thread;
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <cstdio>
+#include <cstring>
+
+namespace clite { namespace util { namespace deferred {
+
+    namespace {
+
+        inline size_t align8 ( size_t n ) { return (n + 7) & ~(size_t) 7; }
+
+        // largest argument block a single record may carry; bigger calls are
+        // formatted at the call site.
+        const size_t MAX_ARGS = 2048;
+
+        bool parse_conversion ( const char *&p, std::vector<arg_kind> &args ) {
+            // p is just past the '%'
+            while (*p && strchr("-+ #0'", *p)) ++p;
+            if (*p == '*') { args.push_back(INT); ++p; }
+            else while (*p >= '0' && *p <= '9') ++p;
+            if (*p == '.') {
+                ++p;
+                if (*p == '*') { args.push_back(INT); ++p; }
+                else while (*p >= '0' && *p <= '9') ++p;
+            }
+            int longs = 0;
+            bool wide = false;
+            for (;; ++p) {
+                if (*p == 'h') continue;
+                else if (*p == 'l') ++longs;
+                else if (*p == 'q' || *p == 'j') longs = 2;
+                else if (*p == 'z' || *p == 't') longs = 1;
+                else if (*p == 'L') wide = true;
+                else break;
+            }
+            char c = *p;
+            if (!c) return false;
+            ++p;
+            switch (c) {
+                case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+                    args.push_back(longs == 0? INT : longs == 1? LONG : LLONG);
+                    return !wide;
+                case 'c':
+                    args.push_back(INT);
+                    return longs == 0 && !wide;
+                case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+                    args.push_back(DOUBLE);
+                    return !wide;
+                case 's':
+                    args.push_back(STR);
+                    return longs == 0 && !wide;
+                case 'p':
+                    args.push_back(PTR);
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        template <class T>
+        int put ( char *b, size_t n, const char *f, const int *w, size_t nw, T v ) {
+            switch (nw) {
+                case 0:  return snprintf(b, n, f, v);
+                case 1:  return snprintf(b, n, f, w[0], v);
+                default: return snprintf(b, n, f, w[0], w[1], v);
+            }
+        }
+
+        struct rec_hdr {
+            uint32_t len;           // whole record, header included
+            int32_t sev;
+            debug_stream *ds;       // 0 with s == 0: padding up to the end of the ring
+            const site *s;
+            int64_t when;           // time of the call, ns since the epoch
+        };
+
+        /// Byte ring written only by its owning thread and read only by the
+        /// formatter thread.  Records never straddle the end of the buffer.
+        struct ring {
+            std::vector<char> buf;
+            size_t mask;
+            volatile size_t head, tail;
+
+            ring ( size_t sz ) : mask(0), head(0), tail(0) {
+                size_t n = 4096;
+                while (n < sz) n <<= 1;
+                buf.resize(n);
+                mask = n - 1;
+            }
+
+            /// Space for a len byte record, or 0 if the ring is full.
+            char *reserve ( size_t len, size_t &used ) {
+                size_t h = head;
+                size_t pos = h & mask;
+                size_t room = buf.size() - pos;
+                size_t skip = len > room? room : 0;
+                if (buf.size() - (h - tail) < skip + len) return 0;
+                if (skip >= sizeof(rec_hdr)) {
+                    rec_hdr *pad = (rec_hdr *) &buf[pos];
+                    pad->len = skip; pad->ds = 0; pad->s = 0;
+                }
+                used = skip + len;
+                return &buf[(h + skip) & mask];
+            }
+            void commit ( size_t used ) {
+                __sync_synchronize();
+                head = head + used;
+            }
+        };
+
+        pthread_mutex_t mtx = PTHREAD_MUTEX_INITIALIZER;
+        std::vector<ring *> rings;
+        __thread ring *my_ring = 0;
+        volatile unsigned long n_overflows = 0;
+
+        class formatter : public Thread {
+            volatile bool stopping;
+            volatile unsigned long passes;
+            bool started;
+
+            bool drain ( ring *r ) {
+                bool any = false;
+                while (r->tail != r->head) {
+                    __sync_synchronize();
+                    size_t t = r->tail;
+                    size_t pos = t & r->mask;
+                    size_t room = r->buf.size() - pos;
+                    if (room < sizeof(rec_hdr)) {
+                        r->tail = t + room;
+                        continue;
+                    }
+                    const rec_hdr *h = (const rec_hdr *) &r->buf[pos];
+                    if (h->ds != 0) {
+                        std::string line = h->s->format(&r->buf[pos] + sizeof(rec_hdr));
+                        // stamp the line with the time of the call, not of formatting
+                        struct timeval tv;
+                        tv.tv_sec = h->when / 1000000000;
+                        tv.tv_usec = (h->when % 1000000000) / 1000;
+                        TAEL_TPRINTF(h->ds, &tv, tael::Severity(h->sev), "%s", line.c_str());
+                    }
+                    __sync_synchronize();
+                    r->tail = t + h->len;
+                    any = true;
+                }
+                return any;
+            }
+
+            protected:
+            virtual void *run ( ) {
+                while (true) {
+                    bool done = stopping;
+                    std::vector<ring *> rs;
+                    pthread_mutex_lock(&mtx);
+                    rs = rings;
+                    pthread_mutex_unlock(&mtx);
+                    bool any = false;
+                    for (size_t i = 0; i < rs.size(); ++i)
+                        any |= drain(rs[i]);
+                    ++passes;
+                    if (done) break;
+                    if (!any) usleep(1000);
+                }
+                return 0;
+            }
+
+            public:
+            formatter ( ) : stopping(false), passes(0), started(false) { }
+            ~formatter ( ) {
+                if (started) {
+                    stopping = true;
+                    void *vp;
+                    join(vp);
+                }
+            }
+            void ensure_started ( ) {
+                // called with mtx held
+                if (!started) {
+                    started = true;
+                    start();
+                }
+            }
+            void wait_pass ( ) {
+                if (!started || stopping) return;
+                // two full passes guarantee everything queued before the call was seen
+                unsigned long p = passes;
+                while (passes < p + 2) usleep(500);
+            }
+        };
+
+        formatter &the_formatter ( ) {
+            static formatter f;
+            return f;
+        }
+
+        ring *thread_ring ( ) {
+            if (!my_ring) {
+                size_t sz = debug_stream_config::get_config()->ring_size();
+                my_ring = new ring(sz);
+                pthread_mutex_lock(&mtx);
+                rings.push_back(my_ring);
+                the_formatter().ensure_started();
+                pthread_mutex_unlock(&mtx);
+            }
+            return my_ring;
+        }
+
+        const site *preformatted ( ) {
+            static site s("%s");
+            return &s;
+        }
+    }
+
+    site::site ( const char *fmt ) : eager_(false) {
+        const char *p = fmt, *start = fmt;
+        while (*p) {
+            if (*p != '%') { ++p; continue; }
+            if (p[1] == '%') { p += 2; continue; }
+            segment seg;
+            ++p;
+            if (!parse_conversion(p, seg.args)) {
+                eager_ = true;
+                return;
+            }
+            seg.fmt.assign(start, p);
+            segs.push_back(seg);
+            start = p;
+        }
+        if (p != start || segs.empty()) {
+            segment seg;
+            seg.fmt.assign(start, p);
+            segs.push_back(seg);
+        }
+    }
+
+    bool site::encode ( char *buf, size_t n, va_list ap, size_t &used ) const {
+        size_t off = 0;
+        for (std::vector<segment>::const_iterator sg = segs.begin(); sg != segs.end(); ++sg) {
+            for (std::vector<arg_kind>::const_iterator k = sg->args.begin(); k != sg->args.end(); ++k) {
+                if (off + 8 > n) return false;
+                char *slot = buf + off;
+                off += 8;
+                switch (*k) {
+                    case INT:    { int64_t v = va_arg(ap, int); memcpy(slot, &v, 8); break; }
+                    case LONG:   { int64_t v = va_arg(ap, long); memcpy(slot, &v, 8); break; }
+                    case LLONG:  { int64_t v = va_arg(ap, long long); memcpy(slot, &v, 8); break; }
+                    case DOUBLE: { double v = va_arg(ap, double); memcpy(slot, &v, 8); break; }
+                    case PTR:    { void *v = va_arg(ap, void *); memset(slot, 0, 8); memcpy(slot, &v, sizeof(v)); break; }
+                    case STR: {
+                        const char *s = va_arg(ap, const char *);
+                        if (!s) s = "(null)";
+                        uint64_t len = strlen(s);
+                        if (off + align8(len + 1) > n) return false;
+                        memcpy(slot, &len, 8);
+                        memcpy(buf + off, s, len + 1);
+                        off += align8(len + 1);
+                        break;
+                    }
+                }
+            }
+        }
+        used = off;
+        return true;
+    }
+
+    std::string site::format ( const char *args ) const {
+        std::string out;
+        char sbuf[512];
+        for (std::vector<segment>::const_iterator sg = segs.begin(); sg != segs.end(); ++sg) {
+            int w[2];
+            size_t nw = 0;
+            const char *f = sg->fmt.c_str();
+            const char *a = args;
+            int len = 0;
+            // two tries: the stack buffer, then one sized from the first
+            for (int attempt = 0; attempt < 2; ++attempt) {
+                std::vector<char> big;
+                char *b = sbuf;
+                size_t bn = sizeof(sbuf);
+                if (attempt) { big.resize(len + 1); b = &big[0]; bn = big.size(); }
+                a = args; nw = 0;
+                if (sg->args.empty()) len = snprintf(b, bn, f, 0);
+                for (std::vector<arg_kind>::const_iterator k = sg->args.begin(); k != sg->args.end(); ++k) {
+                    bool last = k + 1 == sg->args.end();
+                    int64_t iv; double dv; void *pv = 0;
+                    switch (*k) {
+                        case INT:
+                            memcpy(&iv, a, 8); a += 8;
+                            if (!last) { w[nw++] = (int) iv; break; }
+                            len = put(b, bn, f, w, nw, (int) iv);
+                            break;
+                        case LONG:
+                            memcpy(&iv, a, 8); a += 8;
+                            len = put(b, bn, f, w, nw, (long) iv);
+                            break;
+                        case LLONG:
+                            memcpy(&iv, a, 8); a += 8;
+                            len = put(b, bn, f, w, nw, (long long) iv);
+                            break;
+                        case DOUBLE:
+                            memcpy(&dv, a, 8); a += 8;
+                            len = put(b, bn, f, w, nw, dv);
+                            break;
+                        case PTR:
+                            memcpy(&pv, a, sizeof(pv)); a += 8;
+                            len = put(b, bn, f, w, nw, pv);
+                            break;
+                        case STR: {
+                            uint64_t sl;
+                            memcpy(&sl, a, 8); a += 8;
+                            len = put(b, bn, f, w, nw, a);
+                            a += align8(sl + 1);
+                            break;
+                        }
+                    }
+                }
+                if (len < 0) break;
+                if ((size_t) len < bn) { out.append(b, len); break; }
+            }
+            args = a;
+        }
+        return out;
+    }
+
+    const site *register_site ( const char *fmt ) {
+        return new site(fmt);
+    }
+
+    void record ( debug_stream *ds, int sev, const site *s, const char *fmt, va_list ap ) {
+        int64_t when = nanotime::now().count();
+        char args[MAX_ARGS];
+        size_t n = 0;
+        bool ok = false;
+        if (!s->eager()) {
+            va_list cp;
+            va_copy(cp, ap);
+            ok = s->encode(args, sizeof(args), cp, n);
+            va_end(cp);
+        }
+        if (!ok) {
+            // can't record the arguments: format now and queue the text.
+            char line[MAX_ARGS - 16];
+            vsnprintf(line, sizeof(line), fmt, ap);
+            uint64_t len = strlen(line);
+            memcpy(args, &len, 8);
+            memcpy(args + 8, line, len + 1);
+            n = 8 + align8(len + 1);
+            s = preformatted();
+        }
+
+        ring *r = thread_ring();
+        size_t total = sizeof(rec_hdr) + n, used;
+        char *p;
+        if ((p = r->reserve(total, used)) == 0) {
+            __sync_fetch_and_add(&n_overflows, 1);
+            do sched_yield(); while ((p = r->reserve(total, used)) == 0);
+        }
+        rec_hdr *h = (rec_hdr *) p;
+        h->len = total;
+        h->sev = sev;
+        h->ds = ds;
+        h->s = s;
+        h->when = when;
+        memcpy(p + sizeof(rec_hdr), args, n);
+        r->commit(used);
+    }
+
+    void flush ( ) {
+        the_formatter().wait_pass();
+    }
+
+    unsigned long overflows ( ) {
+        return n_overflows;
+    }
+
+}}}
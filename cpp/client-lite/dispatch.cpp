@@ -1,3 +1,16 @@
 #include <clite/message.h>
 
+#include <cxxabi.h>
+#include <cstdlib>
+
 bool clite::message::dispatch_base::block = false;
+bool clite::message::dispatch_base::profiling = false;
+unsigned clite::message::dispatch_base::sample_period = 8;
+
+std::string clite::message::type_name ( const std::type_info &ti ) {
+    int status = 0;
+    char *dm = abi::__cxa_demangle(ti.name(), 0, 0, &status);
+    std::string name(status == 0 && dm? dm : ti.name());
+    free(dm);
+    return name;
+}
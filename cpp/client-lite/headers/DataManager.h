@@ -32,6 +32,9 @@ using trc::compat::util::TimeVal;
 #include <cl-util/factory.h>
 #include <cl-util/debug_stream.h>
 #include <cl-util/table.h>
+#include <cl-util/latency.h>
+#include <cl-util/trace.h>
+#include <cl-util/perf_counters.h>
 #include <Markets.h>
 #include <DataUpdates.h>
 
@@ -252,8 +255,19 @@ class DataManager :
 
         bool initialized_, running_, enable_trd_;
         TimeVal curtv_;
+        nanotime curns_;
         int date_;
 
+        clite::util::tick_to_trade t2t_;
+        clite::util::factory<clite::util::debug_stream>::pointer latlog;
+        int latlog_secs_;
+        nanotime next_latlog_;
+        uint64_t trace_wake_;
+        clite::util::perf_counters *perf_;
+        bool perf_on_;
+        int perf_sample_;
+        void endCycle ( );
+
         //lib3 infrastructure
         
         //indexed by ECN::ECN
@@ -362,7 +376,7 @@ class DataManager :
 
         bool isShort(int cid, int sz);
 
-        void buildImpTick(DataUpdate &d, int cid, double px, int sz, ECN::ECN ecn, TimeVal tv);
+        void buildImpTick(DataUpdate &d, int cid, double px, int sz, ECN::ECN ecn, nanotime tv);
 
         
         /** An exception for unwinding the HF callbacks. */
@@ -447,11 +461,42 @@ class DataManager :
         inline TimeVal const &curtv ( ) {
             if (running_ && ecb->curtv() > curtv_) {
                 curtv_ = ecb->curtv();
+                curns_ = curtv_;
             }
             return curtv_;
         }
+        /** The current time, as nanoseconds; compare and subtract these
+          * rather than curtv() on the event path. */
+        inline nanotime curtime ( ) {
+            curtv();
+            return curns_;
+        }
 
         
+        /** Tick-to-trade latency, by stage.
+          *
+          * DM stamps decode, dispatch, wakeup and send; components stamp
+          * DECISION when they act on a cycle's data.
+          */
+        clite::util::tick_to_trade &latency ( ) { return t2t_; }
+
+        /** Log each listener's share of dispatch time, most expensive
+          * first, as gathered since the last report while set_profiling()
+          * was on.  Reset clears the counts.
+          */
+        void printDispatchProfile ( clite::util::debug_stream *ds, tael::Severity sev, bool reset );
+
+        /** Hardware counters around events and wakeups, or 0 unless the
+          * perf-counters switch is set.  Kinds are event msgtypes, with
+          * PERF_BOOK for book updates and PERF_WAKEUP for wakeups.
+          */
+        clite::util::perf_counters *perfCounters ( ) { return perf_; }
+        static const int PERF_BOOK = -1;
+        static const int PERF_WAKEUP = -2;
+
+        /** Local midnight of the trading date, as DM time. */
+        nanotime midnight ( ) const { return midnight_; }
+
         /** Is it live mode? */
         inline bool isLive() const {
 	    return live;
@@ -498,7 +543,8 @@ class DataManager :
         } __attribute__ ((__packed__)) ; // be only one byte
 
         virtual Mkt::OrderResult placeOrder ( int cid, ECN::ECN ecn, int size, double price, 
-                Mkt::Side dir, int timeout, bool invisible = false, int *seq = 0, long clientOrderID = -1, Mkt::Marking marking=Mkt::UNKWN, const char* placementAlgo=0 );
+                Mkt::Side dir, int timeout, bool invisible = false, int *seq = 0, long clientOrderID = -1, Mkt::Marking marking=Mkt::UNKWN,
+                Placement::Reason reason = Placement::UNKNOWN, int componentId = -1 );
 
         virtual Mkt::OrderResult placeBatsOrder ( int cid, int size, double price, 
                 Mkt::Side dir, BatsRouteMod routing, int *seq = 0, long clientOrderID = -1, Mkt::Marking marking=Mkt::UNKWN );
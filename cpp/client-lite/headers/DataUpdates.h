@@ -7,6 +7,8 @@
 
 #include <c_util/Time.h>
 using trc::compat::util::TimeVal;
+#include <cl-util/nanotime.h>
+using clite::util::nanotime;
 
 #include <stdint.h>
 
@@ -14,26 +16,31 @@ using trc::compat::util::TimeVal;
 
 class DataManager;
 
+/** The DataManager whose cid -> symbol table the update snprint()s use.  Set
+  * by the DataManager when it is constructed; updates don't carry a pointer.
+  */
+extern const DataManager *updateSymbols;
+
 // GVNOTE: The members of this class like type, ecn, side, etc are directly set in functions
 // like DataManager::buildImpTick, DataManager::onBookChange, etc. Should probably change
 // this and define get / set functions and/or modify the constructor to take more params.
 class DataUpdate {
-    const DataManager *dm;
     public:
-    Mkt::DUType type;
-    ECN::ECN ecn;
-    Mkt::Side side;
-    int cid;
-    int size;
     uint64_t id;
 
     /*
       Times at which events were originated (at exchange), and received by the HF infra, respectively.
     */
-    TimeVal tv;
-    TimeVal addtv;
+    nanotime tv;
+    nanotime addtv;
     double price;
 
+    Mkt::DUType type;
+    ECN::ECN ecn;
+    Mkt::Side side;
+    int cid;
+    int size;
+
     bool isTrade ( ) const  { return type == Mkt::VISTRADE || type == Mkt::INVTRADE; } 
     bool isBook ( ) const  { return !isTrade(); }
     bool isVisibleTrade() const {return type == Mkt::VISTRADE;}
@@ -43,26 +50,23 @@ class DataUpdate {
 
     friend bool operator== (const DataUpdate &du1, const DataUpdate &du2);
     friend bool operator!= (const DataUpdate &du1, const DataUpdate &du2);
-    DataUpdate (const DataManager *dm) :dm(dm) { }
-    DataUpdate () :dm(0) { }
 };
 
 typedef clite::message::dispatch<DataUpdate> MarketHandler;
 
 // Only for SIAC & UTDF trade ticks. Exchange trade ticks are handled using DataUpdate above.
 class TapeUpdate {
-    const DataManager *dm;
     Ex::Ex ex_;
     int cid_;
     int size_;
-    TimeVal tv_;
+    nanotime tv_;
     double px_;
 
     //friend bool operator== ( const TapeUpdate &a, const TapeUpdate &b );
     //friend bool operator!= ( const TapeUpdate &a, const TapeUpdate &b );
     friend class DataManager;
-    TapeUpdate ( DataManager *dm, Ex::Ex ex, int cid, int size, TimeVal tv, double px) 
-        : dm(dm), ex_(ex), cid_(cid), size_(size), tv_(tv), px_(px)
+    TapeUpdate ( Ex::Ex ex, int cid, int size, nanotime tv, double px) 
+        : ex_(ex), cid_(cid), size_(size), tv_(tv), px_(px)
     { }
 
     public:
@@ -70,51 +74,48 @@ class TapeUpdate {
     inline int cid() const { return cid_; }
     inline int size() const { return size_; }
     inline double price() const { return px_; }
-    inline TimeVal tv() const { return tv_; }
+    inline nanotime tv() const { return tv_; }
     int snprint ( char *s, int n ) const;
 };
 typedef clite::message::dispatch<TapeUpdate> TapeHandler;
 
 class Order;
+
+/** What changes from one order event to the next; everything fixed when the
+  * order is placed lives on the Order itself.
+  */
+struct OrderEvent {
+    int64_t ns;                 // event time, nanoseconds since the epoch
+    int64_t exid;
+    double uppx;
+    int32_t upshs, fillshs, cxlshs;
+    uint8_t action, error, liq, ecn, mine;
+};
+
 /** OrderUpdates are all the information we expose about an order.
   *
   * Update is kind of a misnomer, because they contain all the info that the
-  * DataManager by default tracks and exposes to the user.  It probably keeps
-  * the OrderUpdates in a set internally, and just hands out references thereto.
+  * DataManager by default tracks and exposes to the user.  An update is one
+  * OrderEvent plus a pointer to its Order (Orders are pooled and never freed),
+  * so it is trivially copyable and fits in a cache line.
   */
 class OrderUpdate { 
 
-	// GVNOTE: Add orderID to an OrderUpdate message
-	long orderID_;
-
-    DataManager *dm;
-    Mkt::OrderAction action_;
-    Mkt::OrderResult error_;
+    const Order *o_;
+    OrderEvent ev_;
 
-    int size_, id_, cid_, timeout_;
-    double price_;
-    bool inv_, mine_;
-    ECN::ECN ecn_;
-    Mkt::Trade dir_;
-
-    int upshs_, cxlshs_, fillshs_;
-    int64_t exid_;
-    // GVNOTE: Looks like fee_ and fees_ are never set.
-    double uppx_, fee_, fees_;
-    TimeVal tv_;
-    Liq::Liq liq_;
     public:
 
-    std::string placementAlgo_;
-    OrderUpdate () : dm(0), action_(Mkt::NO_UPDATE) { }
+    OrderUpdate () : o_(0) { ev_.action = Mkt::NO_UPDATE; }
+    OrderUpdate ( const Order *o, const OrderEvent &ev ) : o_(o), ev_(ev) { }
 
     int snprint ( char *buf, int n ) const; 
 
     /* Updating information: not stored by the "immutable" order */
 
-    inline Mkt::OrderAction action ( ) const { return action_; }
+    inline Mkt::OrderAction action ( ) const { return (Mkt::OrderAction) ev_.action; }
     inline Mkt::OrderState  state  ( ) const { 
-        switch (action_) {
+        switch (action()) {
             case Mkt::PLACING:
             case Mkt::NO_UPDATE:
                 return Mkt::NEW;
@@ -131,45 +132,51 @@ class OrderUpdate {
         // GVNOTE: Adding this to get rid of compiler warning. Should never reach here.
         return Mkt::DONE;
     }
-    inline Mkt::OrderResult error  ( ) const { return error_; }
+    inline Mkt::OrderResult error  ( ) const { return (Mkt::OrderResult) ev_.error; }
 
-    inline int sharesCanceled ( ) const { return cxlshs_; }
-    inline int sharesFilled   ( ) const { return fillshs_; }
-    inline int sharesOpen     ( ) const { return size_ - (fillshs_ + cxlshs_); }
+    inline int sharesCanceled ( ) const { return ev_.cxlshs; }
+    inline int sharesFilled   ( ) const { return ev_.fillshs; }
+    inline int sharesOpen     ( ) const { return size() - (ev_.fillshs + ev_.cxlshs); }
 
-    inline int thisShares     ( ) const { return upshs_; }
-    inline double thisPrice   ( ) const { return uppx_; }
+    inline int thisShares     ( ) const { return ev_.upshs; }
+    inline double thisPrice   ( ) const { return ev_.uppx; }
 
-    inline double totalFees   ( ) const { return fees_; }
-    inline double thisFee     ( ) const { return action_ == Mkt::FILLED? fee_ : 0.0; } 
+    // Fees were never filled in; kept so fee accounting still compiles.
+    inline double totalFees   ( ) const { return 0.0; }
+    inline double thisFee     ( ) const { return 0.0; } 
 
-    inline TimeVal tv ( ) const { return tv_; }
+    inline nanotime tv ( ) const { return nanotime::from_ns(ev_.ns); }
 
     /* Order-derived information */
 
-    inline long orderID ( ) const { return orderID_; }
-    inline int size     ( ) const { return size_; }
-    inline int id       ( ) const { return id_; }
-    inline int64_t exchangeID ( ) const { return exid_; }
-    inline double price ( ) const { return price_; }
-    inline int cid      ( ) const { return cid_; }
-    inline ECN::ECN ecn ( ) const { return ecn_; }
-    inline Mkt::Trade dir ( ) const { return dir_; }
-    inline Mkt::Side side ( ) const { return dir_==Mkt::BUY ? Mkt::BID : Mkt::ASK; }
-    inline bool invisible ( ) const { return inv_; }
-    inline int timeout ( ) const { return timeout_; }
-    inline Liq::Liq liq ( ) const { return liq_; }
-    inline bool mine ( ) const { return mine_; }
-
-    inline operator bool ( ) const { return action_ != Mkt::NO_UPDATE; }
-    void init ( Order const *o, DataManager *dm, Mkt::OrderAction act, Mkt::OrderResult err,
-            int64_t exid, int upshs, int fillshs, Liq::Liq l, bool mine, int cxlshs, double uppx, 
-            TimeVal tv, long orderID );
+    inline const Order &order ( ) const { return *o_; }
+    inline long orderID ( ) const;
+    inline int size     ( ) const;
+    inline int id       ( ) const;
+    inline int64_t exchangeID ( ) const { return ev_.exid; }
+    inline double price ( ) const;
+    inline int cid      ( ) const;
+    inline ECN::ECN ecn ( ) const { return (ECN::ECN) ev_.ecn; }
+    inline Mkt::Trade dir ( ) const;
+    inline Mkt::Side side ( ) const { return dir()==Mkt::BUY ? Mkt::BID : Mkt::ASK; }
+    inline bool invisible ( ) const;
+    inline int timeout ( ) const;
+    inline Liq::Liq liq ( ) const { return (Liq::Liq) ev_.liq; }
+    inline bool mine ( ) const { return ev_.mine; }
+    inline Placement::Reason placementReason ( ) const;
+    inline int placementComponent ( ) const;
+
+    inline operator bool ( ) const { return ev_.action != Mkt::NO_UPDATE; }
 };
 
 class Order : public lib3::CustomPlugin<Order> {
     friend class DataManager;
 
+    public:
+    /// The kinds of event an order keeps the latest of.
+    enum Slot { PLACE_REQ, PLACE_RSP, CANCEL_REQ, CANCEL_RSP, FILL_RSP, NUM_SLOTS };
+
+    private:
     lib3::Order const *lo_;
     int size_, id_, cid_, timeout_;
     double price_;
@@ -179,28 +186,34 @@ class Order : public lib3::CustomPlugin<Order> {
     Mkt::Trade dir_;
     bool poplus_;
     long orderID_;
-    OrderUpdate plreq, plrsp, cxreq, cxrsp, flrsp;
-    OrderUpdate *last;
+    Placement::Reason placement_;
+    int component_;
+    OrderEvent events_[NUM_SLOTS];
+    Slot last_;
+
+    /// Record an event in slot s and make it the last update.
+    OrderUpdate update ( Slot s, Mkt::OrderAction act, Mkt::OrderResult err,
+            int64_t exid, int upshs, int fillshs, Liq::Liq l, bool mine, int cxlshs, double uppx,
+            nanotime tv );
 
     public:
 
-    std::string placementAlgo;
-    inline Mkt::OrderAction action ( ) const { return last->action(); }
-    inline Mkt::OrderState  state  ( ) const { return last->state(); }
-    inline Mkt::OrderResult error  ( ) const { return last->error(); }
+    inline Mkt::OrderAction action ( ) const { return lastUpdate().action(); }
+    inline Mkt::OrderState  state  ( ) const { return lastUpdate().state(); }
+    inline Mkt::OrderResult error  ( ) const { return lastUpdate().error(); }
 
-    inline OrderUpdate const &placing   ( ) const { return plreq; }
-    inline OrderUpdate const &confirmed ( ) const { return plrsp; }
-    inline OrderUpdate const &canceling ( ) const { return cxreq; }
-    inline OrderUpdate const &canceled  ( ) const { return cxrsp; }
-    inline OrderUpdate const &filled    ( ) const { return flrsp; }
+    inline OrderUpdate placing   ( ) const { return OrderUpdate(this, events_[PLACE_REQ]); }
+    inline OrderUpdate confirmed ( ) const { return OrderUpdate(this, events_[PLACE_RSP]); }
+    inline OrderUpdate canceling ( ) const { return OrderUpdate(this, events_[CANCEL_REQ]); }
+    inline OrderUpdate canceled  ( ) const { return OrderUpdate(this, events_[CANCEL_RSP]); }
+    inline OrderUpdate filled    ( ) const { return OrderUpdate(this, events_[FILL_RSP]); }
 
-    inline OrderUpdate const &lastUpdate( ) const { return *last; }
+    inline OrderUpdate lastUpdate( ) const { return OrderUpdate(this, events_[last_]); }
 
     inline int size           ( ) const { return size_; }
-    inline int sharesOpen     ( ) const { return last->sharesOpen(); }
-    inline int sharesFilled   ( ) const { return last->sharesFilled(); }
-    inline int sharesCanceled ( ) const { return last->sharesCanceled(); }
+    inline int sharesOpen     ( ) const { return size_ - (events_[last_].fillshs + events_[last_].cxlshs); }
+    inline int sharesFilled   ( ) const { return events_[last_].fillshs; }
+    inline int sharesCanceled ( ) const { return events_[last_].cxlshs; }
     inline int id             ( ) const { return id_; }
     inline double price       ( ) const { return price_; }
     inline int cid            ( ) const { return cid_; }
@@ -212,16 +225,29 @@ class Order : public lib3::CustomPlugin<Order> {
     inline bool mine          ( ) const { return mine_; }
     inline int timeout        ( ) const { return timeout_; }
     inline long orderID       ( ) const { return orderID_; }
+    inline Placement::Reason placementReason ( ) const { return placement_; }
+    inline int placementComponent ( ) const { return component_; }
     inline void setRealEcn (MarketMaker realmm) { realecn_ = ECN::mmtoECN[realmm]; }
 
     bool isCanceling() const; /// is there an "outstanding cancel-request"?
          
     Order ( ) { };
-    void init ( lib3::Order const *lo, long orderID, const char* placeAlgo );
+    void init ( lib3::Order const *lo, long orderID, Placement::Reason reason, int componentId );
     int snprint ( char *buf, int n ) const;
     static Order *allocate ();
 };
 
+inline long OrderUpdate::orderID ( ) const { return o_->orderID(); }
+inline int OrderUpdate::size ( ) const { return o_->size(); }
+inline int OrderUpdate::id ( ) const { return o_->id(); }
+inline double OrderUpdate::price ( ) const { return o_->price(); }
+inline int OrderUpdate::cid ( ) const { return o_->cid(); }
+inline Mkt::Trade OrderUpdate::dir ( ) const { return o_->dir(); }
+inline bool OrderUpdate::invisible ( ) const { return o_->invisible(); }
+inline int OrderUpdate::timeout ( ) const { return o_->timeout(); }
+inline Placement::Reason OrderUpdate::placementReason ( ) const { return o_->placementReason(); }
+inline int OrderUpdate::placementComponent ( ) const { return o_->placementComponent(); }
+
 typedef clite::message::dispatch<OrderUpdate> OrderHandler;
 
 /** Admin updates, including state of data feeds and markets, and Tower alerts.
@@ -257,7 +283,7 @@ class UserMessage {
     public:
     UserMessage ( const char *m1, const char *m2, int c, int s, TimeVal const &tv ) {
         strncpy(msg1_, m1, 32);
-        strncpy(msg1_, m1, 32);
+        strncpy(msg2_, m2, 32);
         msg1_[31] = 0;
         msg2_[31] = 0;
         code_ = c;
@@ -276,34 +302,28 @@ typedef clite::message::dispatch<UserMessage> UserMessageHandler;
 
 class Timer {
     // period and phase
-    // if period == (0,0), this is a one-off firing at phase
-    TimeVal period_, phase_;
-    static inline uint64_t usof( const TimeVal t ) { return t.sec() * 1000000 + t.usec(); }
-    static inline TimeVal  tvof( const uint64_t t ) { return TimeVal(t / 1000000, t %1000000); }
+    // if period == 0, this is a one-off firing at phase
+    nanotime period_, phase_;
     
     public:
         
-        Timer ( const TimeVal &period_, const TimeVal &phase ) : period_(period_), phase_(phase) { }
-        Timer ( const TimeVal &oneoff ) : period_(), phase_(oneoff) { }
+        Timer ( const nanotime &period_, const nanotime &phase ) : period_(period_), phase_(phase) { }
+        Timer ( const nanotime &oneoff ) : period_(), phase_(oneoff) { }
         Timer ( const Timer &t ) : period_(t.period_), phase_(t.phase_) { }
         Timer & operator = ( const Timer &t ) { 
             period_ = t.period_; phase_ = t.phase_;
             return *this;
         }
-        inline bool isOneoff ( ) const { return period_ == TimeVal(); }
-        inline TimeVal period ( ) const { return period_; }
-        inline TimeVal phase  ( ) const { return isOneoff()?  TimeVal() : phase_; }
-        inline TimeVal oneoff ( ) const { return !isOneoff()? TimeVal() : phase_; }
-        inline TimeVal nextAfter ( const TimeVal & tv ) const {
+        inline bool isOneoff ( ) const { return period_.isZero(); }
+        inline nanotime period ( ) const { return period_; }
+        inline nanotime phase  ( ) const { return isOneoff()?  nanotime() : phase_; }
+        inline nanotime oneoff ( ) const { return !isOneoff()? nanotime() : phase_; }
+        inline nanotime nextAfter ( const nanotime & tv ) const {
             if (isOneoff()) {
-                return tv > phase_? TimeVal() : phase_;
+                return tv > phase_? nanotime() : phase_;
             } else {
-                uint64_t tv_u = usof(tv);
-                uint64_t ph_u = usof(phase_);
-                uint64_t pd_u = usof(period_);
-                uint64_t x = tv_u - (tv_u % pd_u) + ph_u;
-
-                return tvof(x > tv_u? x : x + pd_u);
+                nanotime x = tv - (tv % period_) + phase_;
+                return x > tv? x : x + period_;
             }
         }
         inline bool operator == ( const Timer &r ) const
@@ -316,11 +336,11 @@ class Timer {
 
 class TimeUpdate {
     Timer   timer_;
-    TimeVal tv_;
+    nanotime tv_;
     public:
-    TimeUpdate ( Timer t, TimeVal tv ) : timer_(t), tv_(tv) { }
+    TimeUpdate ( Timer t, nanotime tv ) : timer_(t), tv_(tv) { }
     inline Timer const & timer ( ) const { return timer_; }
-    inline TimeVal const & tv ( ) const { return tv_; }
+    inline nanotime const & tv ( ) const { return tv_; }
     // priority queue less-than is flipped so that soonest is on top.
     bool operator < ( const TimeUpdate &r ) const { return tv_ > r.tv_; }
     int snprint ( char *s, int n ) const;
@@ -330,11 +350,10 @@ typedef clite::message::dispatch<TimeUpdate> TimeHandler;
 
 class WakeUpdate {
     public:
-    TimeVal tv;
+    nanotime tv;
     WakeUpdate ( ) { }
-    WakeUpdate ( const TimeVal &tv ) : tv(tv) { }
+    WakeUpdate ( const nanotime &tv ) : tv(tv) { }
 };
-
 typedef clite::message::dispatch<WakeUpdate> WakeupHandler;
 
 /** Base class for listening to updates.
@@ -194,6 +194,20 @@ namespace ECN {
     Ex::Ex EcnToEx(ECN e);
 };
 
+/** Why an order was placed: the kind of order placement component that
+  * suggested it (ntradesys OrderPlacementSuggestion::PlacementReason).  Carried
+  * on every Order and OrderUpdate; turned into text only when logged or sent.
+  */
+namespace Placement {
+    enum Reason {
+        JOIN_QUEUE, FOLLOW_LEADER, FOLLOW_INVTRD, CROSS, TAKE_INVISIBLE, FOLLOW_LEADER_SOB, UNKNOWN, MKT_ON_CLOSE };
+    const char *const ReasonDesc[] = {
+        "JOIN_QUEUE", "FLW_LEADER", "STEP_UP_L1", "CROSS     ", "TAKE_INVSB",
+        "FLW_SOB   ", "UNKNOWN   ", "MKTONCLOSE" };
+    /// one-letter code per reason, as sent in guillotine fill messages
+    const char StratCode[] = "JLTXISUM";
+}
+
 namespace Liq {
     enum Liq { add, remove, other, UNKN };
     const char * desc ( Liq l );
@@ -4,6 +4,7 @@
 #include <tael/Log.h>
 #include <tael/FdLogger.h>
 #include <cl-util/Configurable.h>
+#include <cl-util/deferred_log.h>
 
 #define MAX_BINARY_BUFFER_FILE_SIZE (1 << 26)
 using namespace trc;
@@ -21,11 +22,17 @@ namespace clite { namespace util {
                     config ( ) : Configurable("debug-stream") {
                         defOption("path", &path_, "path to write debug streams", getenv("EXEC_LOG_DIR"));
                         defOption("ext", &ext_, "extension for debug files", ".log");
+                        defOption("deferred", &deferred_, "record DS_PRINTF arguments and format them on a background thread", false);
+                        defOption("ring-size", &ring_size_, "bytes of deferred log records buffered per thread", 1 << 20);
                     }
                     std::string path_, ext_;
+                    bool deferred_;
+                    int ring_size_;
                 public:
                     const std::string &path() const { return path_; }
                     const std::string &ext() const { return ext_; }
+                    bool deferred() const { return deferred_; }
+                    size_t ring_size() const { return ring_size_; }
                     operator bool() const {
                         return !path_.empty();
                     }
@@ -46,9 +53,16 @@ namespace clite { namespace util {
         private:
             std::string name;
             std::string prefix;
+            bool deferred_;
 
         public:
             debug_stream ( std::string const & name );
+
+            bool enabled ( tael::Severity sev ) { return configuration().threshold() >= sev; }
+            bool is_deferred ( ) const { return deferred_; }
+            /// Backend of DS_PRINTF for deferred streams; *site caches the
+            /// parsed format of the call site.
+            void record ( const deferred::site **site, tael::Severity sev, const char *format, ... );
             // GVNOTE: This is a hack. Adding the printf function to keep the code consistent
             // with the interface provided by the OLD logger. Should remove this in the future
             // and probably switch to calling TAEL_* directly everywhere in the code.
@@ -56,4 +70,24 @@ namespace clite { namespace util {
             virtual ~debug_stream ( ) ;
     };
 }}
+
+/** TAEL_PRINTF for debug_streams.  A disabled severity costs one compare and
+  * evaluates none of the arguments.  With debug-stream.deferred set, the
+  * call only copies its arguments to a per-thread ring and the line is
+  * formatted on a background thread; the text written is the same either
+  * way, but arguments must stay valid only for the duration of the call
+  * (strings are copied, not referenced).
+  */
+#define DS_PRINTF(ds, sev, ...) do { \
+        clite::util::debug_stream *ds_ = (ds); \
+        if (ds_->enabled(sev)) { \
+            if (ds_->is_deferred()) { \
+                static const clite::util::deferred::site *site_ = 0; \
+                ds_->record(&site_, sev, __VA_ARGS__); \
+            } else { \
+                TAEL_PRINTF(ds_, sev, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
 #endif
@@ -0,0 +1,67 @@
+#ifndef __CL_UTIL_DEFERRED_LOG__
+#define __CL_UTIL_DEFERRED_LOG__
+
+#include <cstdarg>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace clite { namespace util {
+
+    class debug_stream;
+
+    /** Deferred formatting for debug_stream.
+      *
+      * A log call site is parsed once into a site (the format string cut into
+      * one-conversion segments).  Each call then only copies the raw
+      * arguments -- integers, doubles, pointers and the bytes of %s strings
+      * -- into a ring owned by the calling thread.  A single background
+      * thread drains every thread's ring, runs the same printf conversions
+      * over the recorded arguments and hands the finished line to the
+      * stream's tael destinations, so the text is exactly what TAEL_PRINTF
+      * would have produced at the call site.  The time of the call is
+      * recorded with the arguments and the line is stamped with it, not
+      * with the time it was formatted.
+      *
+      * Formats using conversions that can't be recorded faithfully (%n,
+      * long double, wide strings), and calls whose arguments don't fit a
+      * record, are formatted on the spot instead.
+      */
+    namespace deferred {
+
+        enum arg_kind { INT, LONG, LLONG, DOUBLE, STR, PTR };
+
+        struct segment {
+            std::string fmt;                // literal text and at most one conversion
+            std::vector<arg_kind> args;     // '*' width/precision ints, then the value
+        };
+
+        class site {
+            std::vector<segment> segs;
+            bool eager_;
+            public:
+            explicit site ( const char *fmt );
+            /// true if calls must be formatted immediately
+            bool eager ( ) const { return eager_; }
+
+            /// Copy the arguments for this format into buf, setting used to
+            /// the bytes written (a multiple of 8); false if they don't fit.
+            bool encode ( char *buf, size_t n, va_list ap, size_t &used ) const;
+            /// Format arguments previously written by encode().
+            std::string format ( const char *args ) const;
+        };
+
+        /// Parse fmt into a site; sites live for the life of the process.
+        const site *register_site ( const char *fmt );
+
+        /// Queue one call on the calling thread's ring.
+        void record ( debug_stream *ds, int sev, const site *s, const char *fmt, va_list ap );
+
+        /// Block until everything queued so far has been written out.
+        void flush ( );
+
+        /// Times a producer found its ring full and had to wait.
+        unsigned long overflows ( );
+    }
+}}
+#endif
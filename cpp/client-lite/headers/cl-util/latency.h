@@ -0,0 +1,136 @@
+#ifndef __CL_UTIL_LATENCY__
+#define __CL_UTIL_LATENCY__
+
+#include <tael/Log.h>
+#include <cl-util/CycleCount.h>
+
+#include <stdint.h>
+
+namespace clite { namespace util {
+
+    class debug_stream;
+
+    /** Log-linear histogram of non-negative integer samples, after
+      * HdrHistogram: values below 16 get a bucket each, and every power of
+      * two above that is split into 16 equal buckets, so a value is always
+      * reported within 1/16 of itself.  The buckets are a fixed array;
+      * record() is a shift, a bit scan and an increment.
+      */
+    class log_histogram {
+        public:
+        static const int SUB_BITS = 4;
+        static const int SUB = 1 << SUB_BITS;
+        static const int BUCKETS = (64 - SUB_BITS + 1) * SUB;
+
+        log_histogram ( ) { clear(); }
+
+        static inline int bucket ( uint64_t v ) {
+            if (v < (uint64_t) SUB) return (int) v;
+            int m = 63 - __builtin_clzll(v);
+            return (m - SUB_BITS) * SUB + (int) (v >> (m - SUB_BITS));
+        }
+        /// Smallest value falling in bucket i, and the bucket's width.
+        static uint64_t lowest ( int i );
+        static uint64_t width ( int i );
+
+        inline void record ( uint64_t v ) {
+            ++counts_[bucket(v)];
+            ++n_;
+            sum_ += v;
+            if (v < min_) min_ = v;
+            if (v > max_) max_ = v;
+        }
+
+        uint64_t count ( ) const { return n_; }
+        uint64_t min ( ) const { return n_? min_ : 0; }
+        uint64_t max ( ) const { return max_; }
+        double mean ( ) const { return n_? (double) sum_ / n_ : 0.0; }
+        /// Value at or below which fraction q (0..1) of the samples fall, as
+        /// the middle of its bucket (clamped to the exact min and max).
+        double quantile ( double q ) const;
+        uint64_t operator[] ( int i ) const { return counts_[i]; }
+
+        void clear ( );
+
+        private:
+        uint64_t counts_[BUCKETS];
+        uint64_t n_, sum_, min_, max_;
+    };
+
+    /** Rate of the TSC, measured against CLOCK_MONOTONIC from the moment
+      * of construction (or reset()).  Asking for it within 10ms of that
+      * waits out the difference.
+      */
+    class tsc_calibration {
+        uint64_t tsc0_;
+        int64_t mono0_;
+        public:
+        tsc_calibration ( ) { reset(); }
+        void reset ( );
+        double ticks_per_usec ( ) const;
+    };
+
+    /** Tick-to-trade latency, broken down by stage.
+      *
+      * A cycle starts at the first market event handled after the last
+      * wakeup, and ends once the wakeup that event leads to has been
+      * delivered.  Each stage stamp records the TSC cycles elapsed since
+      * the start of the current cycle in that stage's histogram, so SEND is
+      * tick-to-trade proper and the others show where the time went:
+      *
+      *   DECODE    the update has been built and is about to be dispatched
+      *   DISPATCH  every listener has seen it
+      *   WAKEUP    the wakeup is about to go out
+      *   DECISION  a component has decided to place or cancel
+      *   SEND      the order or cancel has been handed to the order manager
+      *
+      * Stamps outside a cycle (orders sent from a timer, say) are ignored.
+      * Cycles are converted to microseconds only when printing, against a
+      * calibration of the TSC with the monotonic clock.
+      */
+    class tick_to_trade {
+        public:
+        enum stage { DECODE, DISPATCH, WAKEUP, DECISION, SEND, STAGES };
+        static const char *stage_name ( stage s );
+
+        tick_to_trade ( );
+
+        inline void begin ( ) {
+            if (start_ == 0) start_ = infra_timing::getCycleCount();
+        }
+        inline void stamp ( stage s ) {
+            if (start_ != 0) hist_[s].record(infra_timing::getCycleCount() - start_);
+        }
+        inline void wakeup ( ) {
+            stamp(WAKEUP);
+            woke_ = true;
+        }
+        inline void end ( ) {
+            if (woke_) {
+                start_ = 0;
+                woke_ = false;
+                ++cycles_;
+            }
+        }
+
+        const log_histogram &histogram ( stage s ) const { return hist_[s]; }
+        uint64_t cycles ( ) const { return cycles_; }
+
+        /// TSC ticks per microsecond, measured since construction.
+        double ticks_per_usec ( ) const { return clock_.ticks_per_usec(); }
+
+        /// One line per stage: count, mean, p50/p90/p99/p99.9 and max in us.
+        void print ( debug_stream *ds, tael::Severity sev );
+        void clear ( );
+
+        private:
+        log_histogram hist_[STAGES];
+        uint64_t start_;
+        bool woke_;
+        uint64_t cycles_;
+        tsc_calibration clock_;
+    };
+
+}}
+
+#endif // __CL_UTIL_LATENCY__
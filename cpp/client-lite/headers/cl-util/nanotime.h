@@ -0,0 +1,73 @@
+#ifndef __CL_UTIL_NANOTIME__
+#define __CL_UTIL_NANOTIME__
+
+#include <c_util/Time.h>
+
+#include <stdint.h>
+#include <time.h>
+
+namespace clite { namespace util {
+
+    /** A point in time (or a span) as one signed 64-bit count of nanoseconds
+      * since the epoch.
+      *
+      * Comparison, addition and subtraction are single integer operations --
+      * no sec/usec carries -- so this is what the event path carries around.
+      * lib3 and c_util still speak TimeVal; a TimeVal converts implicitly,
+      * and to_timeval() goes the other way, so adapters stay at those
+      * boundaries.  sec()/usec() match the TimeVal accessors for printing.
+      */
+    class nanotime {
+        int64_t ns_;
+        public:
+        nanotime ( ) : ns_(0) { }
+        nanotime ( const trc::compat::util::TimeVal &tv )
+            : ns_((int64_t) tv.sec() * 1000000000 + (int64_t) tv.usec() * 1000) { }
+
+        static inline nanotime from_ns  ( int64_t n ) { nanotime t; t.ns_ = n; return t; }
+        static inline nanotime from_us  ( int64_t n ) { return from_ns(n * 1000); }
+        static inline nanotime from_ms  ( int64_t n ) { return from_ns(n * 1000000); }
+        static inline nanotime from_sec ( int64_t n ) { return from_ns(n * 1000000000); }
+        /// Wall-clock time, at the clock's full resolution.
+        static inline nanotime now ( ) {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            return from_ns((int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec);
+        }
+
+        inline int64_t count ( ) const { return ns_; }
+        inline bool isZero   ( ) const { return ns_ == 0; }
+
+        /// Whole seconds, and the micro/nanoseconds into that second.
+        inline long sec  ( ) const { return (long) (ns_ / 1000000000); }
+        inline long usec ( ) const { return (long) ((ns_ % 1000000000) / 1000); }
+        inline long nsec ( ) const { return (long) (ns_ % 1000000000); }
+
+        inline double seconds ( ) const { return ns_ * 1e-9; }
+        inline double millis  ( ) const { return ns_ * 1e-6; }
+        inline double micros  ( ) const { return ns_ * 1e-3; }
+
+        /// Truncates to the microsecond.
+        inline trc::compat::util::TimeVal to_timeval ( ) const
+        { return trc::compat::util::TimeVal(sec(), usec()); }
+
+        inline nanotime & operator += ( nanotime r ) { ns_ += r.ns_; return *this; }
+        inline nanotime & operator -= ( nanotime r ) { ns_ -= r.ns_; return *this; }
+        inline nanotime operator * ( int64_t k ) const { return from_ns(ns_ * k); }
+        inline nanotime operator / ( int64_t k ) const { return from_ns(ns_ / k); }
+        inline nanotime operator % ( nanotime r ) const { return from_ns(ns_ % r.ns_); }
+
+        // free so that a TimeVal converts on either side
+        friend inline nanotime operator + ( nanotime l, nanotime r ) { return from_ns(l.ns_ + r.ns_); }
+        friend inline nanotime operator - ( nanotime l, nanotime r ) { return from_ns(l.ns_ - r.ns_); }
+        friend inline bool operator == ( nanotime l, nanotime r ) { return l.ns_ == r.ns_; }
+        friend inline bool operator != ( nanotime l, nanotime r ) { return l.ns_ != r.ns_; }
+        friend inline bool operator <  ( nanotime l, nanotime r ) { return l.ns_ <  r.ns_; }
+        friend inline bool operator <= ( nanotime l, nanotime r ) { return l.ns_ <= r.ns_; }
+        friend inline bool operator >  ( nanotime l, nanotime r ) { return l.ns_ >  r.ns_; }
+        friend inline bool operator >= ( nanotime l, nanotime r ) { return l.ns_ >= r.ns_; }
+    };
+
+} }
+
+#endif // __CL_UTIL_NANOTIME__
@@ -0,0 +1,91 @@
+#ifndef __CL_UTIL_PERF_COUNTERS__
+#define __CL_UTIL_PERF_COUNTERS__
+
+#include <tael/Log.h>
+
+#include <stdint.h>
+#include <map>
+#include <string>
+
+namespace clite { namespace util {
+
+    class debug_stream;
+
+    /** Hardware performance counters around sections of the event loop.
+      *
+      * Opens one perf_event_open group on the calling thread -- cycles,
+      * instructions, L1D read misses, LLC misses and branch misses, user
+      * space only -- the first time a measurement begins, so it counts
+      * whichever thread runs the loop.  Counters the kernel or CPU won't
+      * give us are left out; if none can be opened at all (no PMU in a VM,
+      * perf_event_paranoid, seccomp) available() is false, error() says
+      * why, and begin()/end() do nothing.
+      *
+      * Reading the group is a syscall, so only one section in every
+      * sample_period is measured.  Totals are kept per kind (an int the
+      * caller chooses: DataManager uses the event msgtype, and negative
+      * kinds for book updates and wakeups) and per slot, so a wakeup can
+      * be measured while an event measurement is open.
+      */
+    class perf_counters {
+        public:
+        enum counter { CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES, COUNTERS };
+        enum slot { EVENT, WAKEUP, SLOTS };
+        static const char *counter_name ( counter c );
+
+        struct totals {
+            uint64_t n;
+            uint64_t v[COUNTERS];
+            totals ( ) : n(0) { for (int i = 0; i < COUNTERS; ++i) v[i] = 0; }
+        };
+
+        explicit perf_counters ( unsigned sample_period = 16 );
+        ~perf_counters ( );
+
+        /// Known once the first measurement has begun.
+        bool available ( ) const { return nopen_ > 0; }
+        bool has ( counter c ) const { return index_[c] >= 0; }
+        const std::string &error ( ) const { return error_; }
+
+        inline void begin ( slot s ) {
+            armed_[s] = false;
+            if (++seen_[s] % period_ != 0) return;
+            if (!tried_) open();
+            armed_[s] = nopen_ > 0 && read(start_[s]);
+        }
+        inline void end ( slot s, int kind ) {
+            if (armed_[s]) finish(s, kind);
+        }
+
+        /// Label for a kind in print(); unnamed kinds print as "msgtype N".
+        void name ( int kind, const std::string &label ) { names_[kind] = label; }
+        const std::map<int, totals> &results ( ) const { return totals_; }
+
+        /// Per kind: sections measured, then mean of each counter, IPC.
+        void print ( debug_stream *ds, tael::Severity sev ) const;
+        void clear ( ) { totals_.clear(); }
+
+        private:
+        bool read ( uint64_t *v );
+        void open ( );
+        void finish ( slot s, int kind );
+
+        int fd_;
+        int nopen_;
+        bool tried_;
+        int index_[COUNTERS];       // position in the group read, or -1
+        unsigned period_;
+        unsigned long seen_[SLOTS];
+        bool armed_[SLOTS];
+        uint64_t start_[SLOTS][COUNTERS];
+        std::string error_;
+        std::map<int, totals> totals_;
+        std::map<int, std::string> names_;
+        int fds_[COUNTERS];
+
+        perf_counters ( const perf_counters & );
+    };
+
+}}
+
+#endif // __CL_UTIL_PERF_COUNTERS__
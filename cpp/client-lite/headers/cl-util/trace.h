@@ -0,0 +1,84 @@
+#ifndef __CL_UTIL_TRACE__
+#define __CL_UTIL_TRACE__
+
+#include <cl-util/CycleCount.h>
+#include <cl-util/nanotime.h>
+#include <tael/Log.h>
+
+#include <stdint.h>
+#include <string>
+#include <typeinfo>
+
+namespace clite { namespace util {
+
+    /** Span tracing of the trading thread, for Chrome / Perfetto.
+      *
+      * A span is a name, an optional cid and type (the component, say),
+      * and the TSC at its start and end.  Spans go into a fixed ring that
+      * overwrites its oldest entries, so the last N are always available
+      * and recording never allocates.  Alongside them the ring holds clock
+      * marks -- a TSC reading paired with DataManager time, one per wakeup
+      * -- so that write_json() can place each span in market time: the
+      * mark gives where the wakeup started, the TSC how long things
+      * really took.  In simulation that means a burst at 09:30:00 exports
+      * at 09:30:00, spread over the wall time it cost.
+      *
+      * The ring has a single writer (the trading thread), and is only read
+      * from that thread too; write_json_async() copies it there and leaves
+      * the formatting to a background thread.  While tracing is off a span
+      * costs one test.
+      */
+    namespace trace {
+
+        struct record {
+            uint64_t t0, t1;            ///< TSC; for a clock mark, t1 is the market time in ns
+            const char *name;           ///< 0 for a clock mark
+            const std::type_info *who;
+            int32_t cid;
+        };
+
+        extern bool enabled;
+
+        /// Allocate a ring of (at least) capacity records and start recording.
+        void start ( size_t capacity );
+        void stop ( );
+        size_t size ( );
+
+        void mark ( nanotime market );
+        void add ( const char *name, int cid, const std::type_info *who, uint64_t t0, uint64_t t1 );
+
+        /** Write the spans that started in [from, to) market time as Chrome
+          * trace-event JSON, timestamps in us since origin.  Returns the
+          * number of spans written, or -1 if the file can't be opened.
+          */
+        int write_json ( const std::string &path, nanotime origin, nanotime from, nanotime to );
+
+        /** As write_json, but only the copy of the ring is made on the calling
+          * thread; the file is written by a background thread, which logs the
+          * number of spans written to log (if given) when done.  Returns false,
+          * writing nothing, while an earlier dump is still being written.
+          */
+        bool write_json_async ( const std::string &path, nanotime origin, nanotime from, nanotime to,
+                                tael::Logger *log = 0 );
+        /// Wait for the last write_json_async() to finish.
+        void wait_json ( );
+
+        /// Records the enclosing scope as a span, if tracing was on when it began.
+        class span {
+            const char *name_;
+            const std::type_info *who_;
+            int cid_;
+            uint64_t t0_;
+            span ( const span & );
+            public:
+            span ( const char *name, int cid = -1, const std::type_info *who = 0 )
+                : name_(name), who_(who), cid_(cid), t0_(enabled? infra_timing::getCycleCount() : 0) { }
+            ~span ( ) {
+                if (t0_) add(name_, cid_, who_, t0_, infra_timing::getCycleCount());
+            }
+        };
+    }
+
+}}
+
+#endif // __CL_UTIL_TRACE__
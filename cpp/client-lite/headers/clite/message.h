@@ -3,14 +3,39 @@
 
 #include <list>
 #include <deque>
+#include <vector>
+#include <string>
+#include <typeinfo>
 #include <algorithm>
+#include <stdint.h>
+
+#include <cl-util/CycleCount.h>
 
 namespace clite { namespace message {
 
+/** Cost of one listener on one dispatch, as gathered in profiling mode.
+  * calls counts every update() made while profiling; ticks is the TSC
+  * total over the sampled calls only.
+  */
+struct listener_cost {
+    std::string listener, message;
+    uint64_t calls, sampled, ticks;
+    /// ticks scaled up from the sample to all calls
+    double estimated ( ) const { return sampled? (double) ticks * calls / sampled : 0.0; }
+};
+
+/// Demangled name of a type, for reports.
+std::string type_name ( const std::type_info &ti );
+
 class dispatch_base {
 
     public:
     static bool block;
+    /** Profiling mode: when set, every dispatch counts calls per listener
+      * and times each listener's update() with the TSC on one message in
+      * every sample_period.  Off, dispatch pays one test per message. */
+    static bool profiling;
+    static unsigned sample_period;
 
     protected:
     class listener_base {
@@ -24,6 +49,8 @@ class dispatch_base {
     virtual void add_listener_front ( listener_base *lb ) = 0;
     virtual void remove_listener ( listener_base *lb ) = 0;
     virtual void deliver ( ) = 0;
+    /// Append this dispatch's per-listener costs, and reset them.
+    virtual void profile ( std::vector<listener_cost> &, bool reset ) { }
 
     virtual ~dispatch_base ( ) { }
 };
@@ -40,15 +67,24 @@ class dispatch : public dispatch_base {
     typedef T message;
 
     private:
+    struct slot {
+        listener *l;
+        uint64_t calls, sampled, ticks;
+        slot ( listener *l ) : l(l), calls(0), sampled(0), ticks(0) { }
+        bool operator == ( const listener *o ) const { return l == o; }
+    };
     typedef std::deque<T> tdeque;
-    typedef std::list<listener *> llist;
+    typedef std::list<slot> llist;
 
     tdeque pending;
     llist ls;
+    uint64_t messages;
     dispatch ( const dispatch<T> &other ) { } //not cool
 
+    void update_all ( const T &t );
+
     public:
-    dispatch ( ) { }
+    dispatch ( ) : messages(0) { }
     ~dispatch ( ) { }
     void add_listener ( dispatch_base::listener_base *lb, dispatch_base::listener_base *lb_after );
     void add_listener_back ( dispatch_base::listener_base *lb ) {
@@ -58,6 +94,9 @@ class dispatch : public dispatch_base {
     void remove_listener ( dispatch_base::listener_base *lb );
     void deliver ( );
     void send ( const T &t);
+    template <typename It>
+    void send ( It begin, It end );
+    void profile ( std::vector<listener_cost> &out, bool reset );
 };
 
 // GVNOTE: Do we really want to have a list of dispatchers, with each listener added to each
@@ -143,6 +182,18 @@ class coordinator: public virtual dispatch_base {
             }
         }
     }
+    /** Turn dispatch profiling on (timing one message in every
+      * sample_period) or off; see dispatch_base::profiling. */
+    void set_profiling ( bool on, unsigned sample_period = 8 ) {
+        dispatch_base::sample_period = sample_period? sample_period : 1;
+        dispatch_base::profiling = on;
+    }
+    /// Per-listener costs of every dispatch, wakeups included.
+    void profile ( std::vector<listener_cost> &out, bool reset ) {
+        for (dblist::iterator i = dbs.begin(); i != dbs.end(); ++i)
+            (*i)->profile(out, reset);
+        wh.profile(out, reset);
+    }
     virtual ~coordinator ( ) { }
 };
 
@@ -166,19 +217,19 @@ void dispatch<T>::add_listener ( dispatch_base::listener_base *lb,
     if(after) {
         typename llist::iterator al = std::find(ls.begin(), ls.end(), after);
         if (al != ls.end()) {
-            ls.insert(al++, l);
+            ls.insert(al++, slot(l));
             return;
         }
     }
 
-    ls.push_back(l);
+    ls.push_back(slot(l));
     }
 
 template <typename T>
 void dispatch<T>::add_listener_front ( dispatch_base::listener_base *lb ) {
     listener *l = dynamic_cast<listener *>(lb);
     if (l) {
-        ls.push_front(l);
+        ls.push_front(slot(l));
     }
 }
 
@@ -194,14 +245,50 @@ void dispatch<T>::remove_listener ( dispatch_base::listener_base *lb ) {
     }
 }
 
+template <typename T>
+void dispatch<T>::update_all ( const T &t ) {
+    if (!profiling) {
+        for (typename llist::iterator l = ls.begin(); l != ls.end(); ++l)
+            l->l->update(t);
+        return;
+    }
+    bool timed = ++messages % sample_period == 0;
+    for (typename llist::iterator l = ls.begin(); l != ls.end(); ++l) {
+        ++l->calls;
+        if (timed) {
+            uint64_t t0 = infra_timing::getCycleCount();
+            l->l->update(t);
+            l->ticks += infra_timing::getCycleCount() - t0;
+            ++l->sampled;
+        } else {
+            l->l->update(t);
+        }
+    }
+}
+
 template <typename T>
 void dispatch<T>::deliver ( ) {
     for (typename tdeque::iterator u = pending.begin(); u != pending.end(); ++u)
-        for (typename llist::iterator l = ls.begin(); l != ls.end(); ++l)
-            (*l)->update(*u);
+        update_all(*u);
     pending.clear();
 }
 
+template <typename T>
+void dispatch<T>::profile ( std::vector<listener_cost> &out, bool reset ) {
+    for (typename llist::iterator l = ls.begin(); l != ls.end(); ++l) {
+        if (l->calls == 0) continue;
+        listener_cost c;
+        c.listener = type_name(typeid(*l->l));
+        c.message = type_name(typeid(T));
+        c.calls = l->calls;
+        c.sampled = l->sampled;
+        c.ticks = l->ticks;
+        out.push_back(c);
+        if (reset) l->calls = l->sampled = l->ticks = 0;
+    }
+    if (reset) messages = 0;
+}
+
 template <typename T>
 void dispatch<T>::send ( const T &t) {
     if (block || !pending.empty()) {
@@ -210,8 +297,22 @@ void dispatch<T>::send ( const T &t) {
         // GVNOTE: This implementation does not seem thread safe. Either switch to using
         // mutex, or re-think whether we need to make this thread safe or not.
         block = true;
-        for (typename llist::iterator l = ls.begin(); l != ls.end(); ++l)
-            (*l)->update(t);
+        update_all(t);
+        block = false;
+    }
+}
+
+// Sends a run of messages as a unit: either all are delivered now, each to
+// every listener in order, or all are queued for the next deliver().
+template <typename T>
+template <typename It>
+void dispatch<T>::send ( It begin, It end ) {
+    if (block || !pending.empty()) {
+        pending.insert(pending.end(), begin, end);
+    } else {
+        block = true;
+        for (It t = begin; t != end; ++t)
+            update_all(*t);
         block = false;
     }
 }
@@ -0,0 +1,97 @@
+#include <cl-util/latency.h>
+#include <cl-util/debug_stream.h>
+
+#include <time.h>
+#include <cstring>
+
+namespace clite { namespace util {
+
+    namespace {
+        int64_t mono_ns ( ) {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+        }
+
+        // shortest interval the TSC is calibrated over
+        const int64_t MIN_CALIBRATION_NS = 10 * 1000000;
+    }
+
+    uint64_t log_histogram::lowest ( int i ) {
+        if (i < SUB) return i;
+        int m = i / SUB + SUB_BITS - 1;
+        return (uint64_t) (i % SUB + SUB) << (m - SUB_BITS);
+    }
+
+    uint64_t log_histogram::width ( int i ) {
+        if (i < SUB) return 1;
+        int m = i / SUB + SUB_BITS - 1;
+        return (uint64_t) 1 << (m - SUB_BITS);
+    }
+
+    double log_histogram::quantile ( double q ) const {
+        if (n_ == 0) return 0.0;
+        if (q <= 0.0) return min_;
+        if (q >= 1.0) return max_;
+        uint64_t rank = (uint64_t) (q * n_);
+        if (rank >= n_) rank = n_ - 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; ++i) {
+            seen += counts_[i];
+            if (seen > rank) {
+                double v = lowest(i) + (width(i) - 1) / 2.0;
+                if (v < min_) v = min_;
+                if (v > max_) v = max_;
+                return v;
+            }
+        }
+        return max_;
+    }
+
+    void log_histogram::clear ( ) {
+        memset(counts_, 0, sizeof(counts_));
+        n_ = sum_ = max_ = 0;
+        min_ = ~(uint64_t) 0;
+    }
+
+    const char *tick_to_trade::stage_name ( stage s ) {
+        static const char *names[STAGES] = { "decode", "dispatch", "wakeup", "decision", "send" };
+        return s < STAGES? names[s] : "?";
+    }
+
+    void tsc_calibration::reset ( ) {
+        tsc0_ = infra_timing::getCycleCount();
+        mono0_ = mono_ns();
+    }
+
+    double tsc_calibration::ticks_per_usec ( ) const {
+        int64_t ns = mono_ns() - mono0_;
+        while (ns < MIN_CALIBRATION_NS) ns = mono_ns() - mono0_;
+        uint64_t ticks = infra_timing::getCycleCount() - tsc0_;
+        return ticks * 1000.0 / ns;
+    }
+
+    tick_to_trade::tick_to_trade ( )
+        : start_(0), woke_(false), cycles_(0)
+    { }
+
+    void tick_to_trade::print ( debug_stream *ds, tael::Severity sev ) {
+        double tpu = ticks_per_usec();
+        if (tpu <= 0.0) tpu = 1.0;
+        TAEL_PRINTF(ds, sev, "tick-to-trade over %lu cycles (%.1f ticks/us), us since first tick:",
+                (unsigned long) cycles_, tpu);
+        for (int s = 0; s < STAGES; ++s) {
+            const log_histogram &h = hist_[s];
+            TAEL_PRINTF(ds, sev, "  %-8s n=%-9lu mean=%8.2f p50=%8.2f p90=%8.2f p99=%8.2f p99.9=%8.2f max=%9.2f",
+                    stage_name(stage(s)), (unsigned long) h.count(), h.mean() / tpu,
+                    h.quantile(0.5) / tpu, h.quantile(0.9) / tpu, h.quantile(0.99) / tpu,
+                    h.quantile(0.999) / tpu, h.max() / tpu);
+        }
+    }
+
+    void tick_to_trade::clear ( ) {
+        for (int s = 0; s < STAGES; ++s) hist_[s].clear();
+        cycles_ = 0;
+    }
+
+}}
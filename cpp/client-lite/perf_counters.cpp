@@ -0,0 +1,122 @@
+#include <cl-util/perf_counters.h>
+#include <cl-util/debug_stream.h>
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cstring>
+
+namespace clite { namespace util {
+
+    namespace {
+        struct event_spec { uint32_t type; uint64_t config; };
+
+        const event_spec specs[perf_counters::COUNTERS] = {
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+            { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+                                  | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                  | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        };
+
+        int open_event ( const event_spec &e, int group ) {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = e.type;
+            attr.config = e.config;
+            attr.read_format = PERF_FORMAT_GROUP;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            return (int) syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+        }
+    }
+
+    const char *perf_counters::counter_name ( counter c ) {
+        static const char *names[COUNTERS] = { "cycles", "instr", "l1d-miss", "llc-miss", "br-miss" };
+        return c < COUNTERS? names[c] : "?";
+    }
+
+    perf_counters::perf_counters ( unsigned sample_period )
+        : fd_(-1), nopen_(0), tried_(false), period_(sample_period? sample_period : 1)
+    {
+        for (int i = 0; i < COUNTERS; ++i) { index_[i] = -1; fds_[i] = -1; }
+        for (int s = 0; s < SLOTS; ++s) { seen_[s] = 0; armed_[s] = false; }
+    }
+
+    perf_counters::~perf_counters ( ) {
+        for (int i = 0; i < COUNTERS; ++i)
+            if (fds_[i] >= 0) close(fds_[i]);
+    }
+
+    void perf_counters::open ( ) {
+        tried_ = true;
+        for (int i = 0; i < COUNTERS; ++i) {
+            int fd = open_event(specs[i], fd_);
+            if (fd < 0) {
+                if (error_.empty())
+                    error_ = std::string(counter_name(counter(i))) + ": " + strerror(errno);
+                continue;
+            }
+            if (fd_ < 0) fd_ = fd;
+            fds_[i] = fd;
+            index_[i] = nopen_++;
+        }
+    }
+
+    bool perf_counters::read ( uint64_t *v ) {
+        uint64_t buf[1 + COUNTERS];
+        ssize_t want = sizeof(uint64_t) * (1 + nopen_);
+        if (::read(fd_, buf, want) != want || buf[0] != (uint64_t) nopen_) return false;
+        for (int i = 0; i < COUNTERS; ++i)
+            v[i] = index_[i] >= 0? buf[1 + index_[i]] : 0;
+        return true;
+    }
+
+    void perf_counters::finish ( slot s, int kind ) {
+        armed_[s] = false;
+        uint64_t now[COUNTERS];
+        if (!read(now)) return;
+        totals &t = totals_[kind];
+        ++t.n;
+        for (int i = 0; i < COUNTERS; ++i)
+            t.v[i] += now[i] - start_[s][i];
+    }
+
+    void perf_counters::print ( debug_stream *ds, tael::Severity sev ) const {
+        if (!available()) {
+            if (tried_) TAEL_PRINTF(ds, sev, "perf counters unavailable (%s)", error_.c_str());
+            return;
+        }
+        char hdr[256];
+        int off = snprintf(hdr, sizeof(hdr), "%-14s %9s", "kind", "n");
+        for (int i = 0; i < COUNTERS; ++i)
+            off += snprintf(hdr + off, sizeof(hdr) - off, " %10s", counter_name(counter(i)));
+        snprintf(hdr + off, sizeof(hdr) - off, " %6s", "ipc");
+        TAEL_PRINTF(ds, sev, "%s   [means per section, 1 in %u sampled]", hdr, period_);
+
+        for (std::map<int, totals>::const_iterator k = totals_.begin(); k != totals_.end(); ++k) {
+            const totals &t = k->second;
+            if (t.n == 0) continue;
+            char label[32];
+            std::map<int, std::string>::const_iterator nm = names_.find(k->first);
+            if (nm != names_.end()) snprintf(label, sizeof(label), "%s", nm->second.c_str());
+            else snprintf(label, sizeof(label), "msgtype %d", k->first);
+            char line[256];
+            off = snprintf(line, sizeof(line), "%-14s %9lu", label, (unsigned long) t.n);
+            for (int i = 0; i < COUNTERS; ++i) {
+                if (has(counter(i)))
+                    off += snprintf(line + off, sizeof(line) - off, " %10.1f", (double) t.v[i] / t.n);
+                else
+                    off += snprintf(line + off, sizeof(line) - off, " %10s", "-");
+            }
+            if (has(CYCLES) && has(INSTRUCTIONS) && t.v[CYCLES])
+                snprintf(line + off, sizeof(line) - off, " %6.2f", (double) t.v[INSTRUCTIONS] / t.v[CYCLES]);
+            TAEL_PRINTF(ds, sev, "%s", line);
+        }
+    }
+
+}}
@@ -0,0 +1,47 @@
+#include <cstdio>
+#include <cstdarg>
+#include <cl-util/deferred_log.h>
+
+using namespace clite::util;
+
+// print what printf makes of a call next to what the deferred path makes of it
+void comp ( const char *fmt, ... ) {
+    char want[4096];
+    va_list ap, cp;
+    va_start(ap, fmt);
+    va_copy(cp, ap);
+    vsnprintf(want, sizeof(want), fmt, cp);
+    va_end(cp);
+
+    deferred::site s(fmt);
+    char args[2048];
+    size_t n;
+    printf(" -- \"%s\" -- \n", fmt);
+    printf(" printf   \"%.80s\"\n", want);
+    if (s.eager()) {
+        printf(" deferred (formatted at the call site)\n");
+    } else if (!s.encode(args, sizeof(args), ap, n)) {
+        printf(" deferred (arguments too big, formatted at the call site)\n");
+    } else {
+        std::string got = s.format(args);
+        printf(" deferred \"%.80s\" (%lu bytes of arguments)\n", got.c_str(), (unsigned long) n);
+        printf(" same is %s \n", got == want? "true" : "false");
+    }
+    printf("\n");
+    va_end(ap);
+}
+
+int main () {
+    comp("no conversions at all");
+    comp("100%% literal");
+    comp("%-5s TL::placeOrder: %s %4d shs on %s at %7.3f Reason = %s "
+         "compId = %2d cbbo=(%.2f,%.2f) sizes=(%d,%d) id=%d pri=%.6f impact=%.8f",
+         "IBM", "BID", 100, "ISLD", 130.125, "JOIN_QUEUE", 3, 130.12, 130.13, 500, 700, 42, 0.000123, 1.5e-7);
+    comp("%ld %lld %lu %zu %c %p %%", -5L, 1LL << 40, 7UL, (size_t) 9, 'x', (void *) 0x1234);
+    comp("[%*d] [%-*.*f] [%.*s]", 6, 42, 10, 3, 3.14159, 3, "abcdef");
+    comp("%s|%s", (const char *) 0, "");
+    comp("%e %g %G %a", 1e100, 0.0001, 1e-20, 1.0);
+    comp("%.*6$f %s", 1.0, "positional is eager");
+    comp("%s", std::string(3000, 'x').c_str());
+    comp("trailing %d then text", 5);
+}
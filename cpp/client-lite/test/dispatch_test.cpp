@@ -0,0 +1,74 @@
+#include <cstdio>
+#include <vector>
+#include <clite/message.h>
+
+using namespace clite::message;
+
+struct Tick { int n; };
+struct Wake { };
+
+bool verbose = true;
+
+struct Fast : public dispatch<Tick>::listener {
+    void update ( const Tick &t ) { if (verbose) printf(" Fast got tick %d\n", t.n); }
+};
+struct Slow : public dispatch<Tick>::listener, public dispatch<Wake>::listener {
+    volatile int sink;
+    void update ( const Tick &t ) {
+        if (verbose) printf(" Slow got tick %d\n", t.n);
+        for (int i = 0; i < 20000; ++i) sink += i;
+    }
+    void update ( const Wake & ) { }
+};
+
+struct Coord : public coordinator< dispatch<Wake> > {
+    dispatch<Tick> th;
+    Coord ( ) { add_dispatch(&th); }
+    bool advise_wakeup ( ) { return true; }
+};
+
+void show ( const char *what, const std::vector<listener_cost> &costs ) {
+    printf(" -- %s: %lu entries --\n", what, (unsigned long) costs.size());
+    for (size_t i = 0; i < costs.size(); ++i) {
+        const listener_cost &c = costs[i];
+        printf(" %-6s %-6s calls %4llu sampled %4llu ticks %10llu estimated %12.0f\n",
+                c.listener.c_str(), c.message.c_str(), (unsigned long long) c.calls,
+                (unsigned long long) c.sampled, (unsigned long long) c.ticks, c.estimated());
+    }
+    printf("\n");
+}
+
+int main () {
+    Coord c;
+    Fast f;
+    Slow s;
+    c.add_listener(&s);
+    c.add_listener(&f);
+    Tick t = { 0 };
+    std::vector<listener_cost> costs;
+
+    printf(" -- Slow added first --\n");
+    c.th.send(t);
+    printf("\n");
+
+    c.profile(costs, false);
+    show("profiling off", costs);
+
+    // every call counted, 1 in 4 timed
+    verbose = false;
+    c.set_profiling(true, 4);
+    for (int i = 0; i < 100; ++i) { c.th.send(t); c.deliver(); }
+    c.profile(costs, true);
+    show("100 ticks and wakeups, 1 in 4 timed", costs);
+
+    costs.clear();
+    c.profile(costs, false);
+    show("after reset", costs);
+
+    c.set_profiling(false);
+    c.remove_listener(&s);
+    verbose = true;
+    printf(" -- Slow removed --\n");
+    t.n = 1;
+    c.th.send(t);
+}
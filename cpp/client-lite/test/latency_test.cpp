@@ -0,0 +1,60 @@
+#include <cstdio>
+#include <cl-util/latency.h>
+
+using namespace clite::util;
+
+void bucket ( uint64_t v ) {
+    int b = log_histogram::bucket(v);
+    printf(" %20llu => bucket %4d [%llu, +%llu)\n", (unsigned long long) v, b,
+            (unsigned long long) log_histogram::lowest(b), (unsigned long long) log_histogram::width(b));
+}
+
+void show ( const char *what, const log_histogram &h ) {
+    printf(" %-10s n %8lu  min %8llu  p50 %10.1f  p99 %10.1f  max %8llu  mean %10.1f\n", what,
+            (unsigned long) h.count(), (unsigned long long) h.min(), h.quantile(0.5), h.quantile(0.99),
+            (unsigned long long) h.max(), h.mean());
+}
+
+int main () {
+    printf(" -- buckets (16 per power of two) --\n");
+    bucket(0);
+    bucket(15);
+    bucket(16);
+    bucket(31);
+    bucket(32);
+    bucket(33);
+    bucket(1000);
+    bucket(1000000);
+    bucket(~(uint64_t) 0);
+    printf(" BUCKETS %d\n\n", log_histogram::BUCKETS);
+
+    printf(" -- 1..10000 --\n");
+    log_histogram h;
+    show("empty", h);
+    for (uint64_t v = 1; v <= 10000; ++v) h.record(v);
+    show("recorded", h);
+    h.clear();
+    show("cleared", h);
+    printf("\n");
+
+    printf(" -- tick to trade --\n");
+    tick_to_trade t;
+    t.stamp(tick_to_trade::SEND);               // outside a cycle: ignored
+    t.begin();
+    t.stamp(tick_to_trade::DECODE);
+    t.stamp(tick_to_trade::DISPATCH);
+    t.end();
+    t.stamp(tick_to_trade::SEND);               // cycle stays open until a wakeup
+    printf(" before wakeup: cycles %lu  send n %lu\n", (unsigned long) t.cycles(),
+            (unsigned long) t.histogram(tick_to_trade::SEND).count());
+    t.wakeup();
+    t.end();
+    t.stamp(tick_to_trade::SEND);
+    printf(" after wakeup:  cycles %lu  send n %lu\n", (unsigned long) t.cycles(),
+            (unsigned long) t.histogram(tick_to_trade::SEND).count());
+    show("decode", t.histogram(tick_to_trade::DECODE));
+    show("dispatch", t.histogram(tick_to_trade::DISPATCH));
+    show("wakeup", t.histogram(tick_to_trade::WAKEUP));
+    show("send", t.histogram(tick_to_trade::SEND));
+    printf(" ticks/us %f\n", t.ticks_per_usec());
+}
@@ -0,0 +1,52 @@
+#include <cstdio>
+#include <cl-util/nanotime.h>
+
+using namespace clite::util;
+using trc::compat::util::TimeVal;
+
+void show ( const char *what, nanotime t ) {
+    printf(" %-24s %ld.%09ld  (%ld.%06ld as TimeVal)\n", what, t.sec(), t.nsec(),
+            (long) t.to_timeval().sec(), (long) t.to_timeval().usec());
+}
+
+int main () {
+    TimeVal tv(1286202600, 123456);
+    nanotime t(tv);
+    printf(" -- conversions --\n");
+    printf(" TimeVal %ld.%06ld => %lld ns\n", (long) tv.sec(), (long) tv.usec(), (long long) t.count());
+    show("t", t);
+    show("t + 999ns", t + nanotime::from_ns(999));
+    show("from_us(1500)", nanotime::from_us(1500));
+    show("from_ms(1500)", nanotime::from_ms(1500));
+    show("from_sec(2)", nanotime::from_sec(2));
+    printf("\n");
+
+    printf(" -- carries --\n");
+    show("10.999999 + 2us", nanotime(TimeVal(10, 999999)) + nanotime::from_us(2));
+    show("11.000000 - 1us", nanotime(TimeVal(11, 0)) - nanotime::from_us(1));
+    printf("\n");
+
+    printf(" -- arithmetic --\n");
+    nanotime s = nanotime::from_sec(7);
+    s += nanotime::from_ms(5);
+    s -= nanotime::from_sec(1);
+    show("7s + 5ms - 1s", s);
+    show("  % 1s", s % nanotime::from_sec(1));
+    show("  / 5", s / 5);
+    show("  * 2", s * 2);
+    nanotime half = nanotime(TimeVal(5, 500000)) - nanotime(TimeVal(5, 0));
+    printf(" 5.5 - 5.0 is %f s, %f ms, %f us\n", half.seconds(), half.millis(), half.micros());
+    printf("\n");
+
+    printf(" -- comparisons (TimeVal on either side) --\n");
+    nanotime u = t + nanotime::from_ns(999);
+    printf(" tv <  t+999ns is %s \n", tv < u? "true" : "false");
+    printf(" t+999ns > tv  is %s \n", u > tv? "true" : "false");
+    printf(" tv == t       is %s \n", tv == t? "true" : "false");
+    printf(" t <= tv       is %s \n", t <= tv? "true" : "false");
+    printf(" t != tv       is %s \n", t != tv? "true" : "false");
+    printf(" nanotime() isZero is %s \n", nanotime().isZero()? "true" : "false");
+    printf("\n");
+
+    show("now", nanotime::now());
+}
@@ -0,0 +1,52 @@
+#include <cstdio>
+#include <map>
+#include <cl-util/perf_counters.h>
+
+using namespace clite::util;
+
+volatile double sink;
+
+void work ( ) {
+    double x = 0;
+    for (int i = 0; i < 100000; ++i) x += i * 0.5;
+    sink = x;
+}
+
+void show ( perf_counters &pc ) {
+    const std::map<int, perf_counters::totals> &r = pc.results();
+    printf(" %lu kinds\n", (unsigned long) r.size());
+    for (std::map<int, perf_counters::totals>::const_iterator i = r.begin(); i != r.end(); ++i) {
+        printf(" kind %d: %llu sampled\n", i->first, (unsigned long long) i->second.n);
+        for (int c = 0; c < perf_counters::COUNTERS; ++c) {
+            if (!pc.has(perf_counters::counter(c))) continue;
+            printf("   %-14s %14llu  (%.0f per section)\n", perf_counters::counter_name(perf_counters::counter(c)),
+                    (unsigned long long) i->second.v[c],
+                    i->second.n? (double) i->second.v[c] / i->second.n : 0.0);
+        }
+    }
+    printf("\n");
+}
+
+int main () {
+    perf_counters pc(4);
+    printf(" -- before the first sample --\n");
+    printf(" available is %s \n", pc.available()? "true" : "false");
+    show(pc);
+
+    // 40 sections of kind 7, 1 in 4 sampled
+    for (int i = 0; i < 40; ++i) {
+        pc.begin(perf_counters::EVENT);
+        work();
+        pc.end(perf_counters::EVENT, 7);
+    }
+    printf(" -- 40 sections, 1 in 4 sampled --\n");
+    printf(" available is %s \n", pc.available()? "true" : "false");
+    if (!pc.available()) printf(" error: %s\n", pc.error().c_str());
+    show(pc);
+
+    // an unmatched end() never records
+    pc.clear();
+    pc.end(perf_counters::WAKEUP, 1);
+    printf(" -- cleared, then end() without begin() --\n");
+    show(pc);
+}
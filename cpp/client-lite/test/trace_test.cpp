@@ -0,0 +1,81 @@
+#include <cstdio>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <cl-util/trace.h>
+
+using namespace clite::util;
+
+static std::string slurp ( const std::string &path ) {
+    std::ifstream in(path.c_str());
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+static int occurrences ( const std::string &s, const std::string &what ) {
+    int n = 0;
+    for (size_t p = s.find(what); p != std::string::npos; p = s.find(what, p + 1)) ++n;
+    return n;
+}
+
+// what a dump of a window made of the ring
+void show ( const char *what, const std::string &path ) {
+    std::string js = slurp(path);
+    printf(" -- %s -- \n", what);
+    printf(" %d complete events \n", occurrences(js, "\"ph\":\"X\""));
+    printf(" %d typed JoinQueue, %d with cid 1 \n",
+           occurrences(js, "\"type\":\"JoinQueue\""), occurrences(js, "\"cid\":1"));
+    printf(" starts at 09:30:00 is %s \n", js.find("\"ts\":34200000") != std::string::npos? "true" : "false");
+    printf(" JSON envelope is %s \n",
+           js.find("{\"displayTimeUnit\"") == 0 && js.find("]}") != std::string::npos? "true" : "false");
+    printf("\n");
+}
+
+struct Component { virtual ~Component ( ) { } };
+struct JoinQueue : public Component { };
+
+int main () {
+    std::string path = std::string("/tmp/trace_test.") + (char) ('a' + getpid() % 26) + ".json";
+    nanotime mid = nanotime::from_sec(1286164800);
+    nanotime open = mid + nanotime::from_sec(9 * 3600 + 30 * 60);
+
+    { trace::span s("before start"); }
+    printf(" recorded before start: %lu \n", (unsigned long) trace::size());
+
+    // 1 span before any mark, then 3 wakeups of a mark, a wakeup span and 2 cids x 2 spans
+    trace::start(100);
+    { trace::span s("no mark yet"); }
+    for (int w = 0; w < 3; ++w) {
+        trace::mark(open + nanotime::from_sec(w));
+        trace::span outer("wakeup");
+        for (int cid = 0; cid < 2; ++cid) {
+            trace::span s("TradeLogic", cid);
+            JoinQueue jq;
+            Component &c = jq;
+            trace::span inner("suggestOrderPlacements", cid, &typeid(c));
+        }
+    }
+    printf(" recorded: %lu (of 19) \n\n", (unsigned long) trace::size());
+
+    printf(" spans written: %d (of 15) \n", trace::write_json(path, mid, open, open + nanotime::from_sec(10)));
+    show("all 3 wakeups", path);
+    printf(" spans written: %d (of 5) \n", trace::write_json(path, mid, open + nanotime::from_sec(1), open + nanotime::from_sec(2)));
+    show("the 2nd wakeup", path);
+
+    printf(" background dump started is %s \n",
+           trace::write_json_async(path, mid, open, open + nanotime::from_sec(10))? "true" : "false");
+    trace::wait_json();
+    show("all 3 wakeups, written in the background", path);
+
+    trace::stop();
+    { trace::span s("after stop"); }
+    printf(" recorded after stop: %lu \n", (unsigned long) trace::size());
+
+    trace::start(100);
+    for (int i = 0; i < 5000; ++i) { trace::span s("wrap"); }
+    printf(" recorded after 5000 more: %lu (ring of 1024) \n", (unsigned long) trace::size());
+
+    unlink(path.c_str());
+}
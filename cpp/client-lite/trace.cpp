@@ -0,0 +1,194 @@
+#include <cl-util/trace.h>
+#include <cl-util/latency.h>
+#include <clite/message.h>
+
+#include <c_util/Thread.h>
+using trc::compat::util::Thread;
+
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdio>
+
+namespace clite { namespace util { namespace trace {
+
+    bool enabled = false;
+
+    namespace {
+        std::vector<record> ring;
+        size_t mask = 0;
+        uint64_t head = 0;      // records ever written
+        tsc_calibration tsc;
+
+        inline void push ( const record &r ) {
+            ring[head & mask] = r;
+            ++head;
+        }
+
+        struct by_tsc {
+            bool operator() ( const record &a, const record &b ) const { return a.t0 < b.t0; }
+        };
+
+        void escape ( FILE *f, const std::string &s ) {
+            for (size_t i = 0; i < s.size(); ++i) {
+                if (s[i] == '"' || s[i] == '\\') fputc('\\', f);
+                fputc(s[i], f);
+            }
+        }
+
+        // the ring's records, oldest first
+        void snapshot ( std::vector<record> &out ) {
+            uint64_t first = head > ring.size()? head - ring.size() : 0;
+            out.clear();
+            out.reserve(head - first);
+            for (uint64_t i = first; i < head; ++i)
+                out.push_back(ring[i & mask]);
+        }
+
+        int write_records ( const std::vector<record> &recs, const std::string &path,
+                            nanotime origin, nanotime from, nanotime to ) {
+            FILE *f = fopen(path.c_str(), "w");
+            if (!f) return -1;
+
+            std::vector<record> marks, spans;
+            for (size_t i = 0; i < recs.size(); ++i) {
+                const record &r = recs[i];
+                (r.name? spans : marks).push_back(r);
+            }
+            std::sort(marks.begin(), marks.end(), by_tsc());
+
+            double tpu = tsc.ticks_per_usec();
+            std::map<const std::type_info *, std::string> names;
+            int n = 0;
+            fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+            for (size_t i = 0; i < spans.size(); ++i) {
+                const record &s = spans[i];
+                // place the span after the latest wakeup that started before it
+                std::vector<record>::const_iterator m = std::upper_bound(marks.begin(), marks.end(), s, by_tsc());
+                if (m == marks.begin()) continue;
+                --m;
+                double off = (s.t0 - m->t0) / tpu;
+                nanotime at = nanotime::from_ns((int64_t) m->t1) + nanotime::from_ns((int64_t) (off * 1000));
+                if (at < from || at >= to) continue;
+
+                double ts = (nanotime::from_ns((int64_t) m->t1) - origin).micros() + off;
+                fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f",
+                        n? ",\n" : "", s.name, ts, (s.t1 - s.t0) / tpu);
+                if (s.cid >= 0 || s.who) {
+                    fprintf(f, ",\"args\":{");
+                    if (s.cid >= 0) fprintf(f, "\"cid\":%d", s.cid);
+                    if (s.who) {
+                        std::map<const std::type_info *, std::string>::iterator w = names.find(s.who);
+                        if (w == names.end())
+                            w = names.insert(std::make_pair(s.who, clite::message::type_name(*s.who))).first;
+                        fprintf(f, "%s\"type\":\"", s.cid >= 0? "," : "");
+                        escape(f, w->second);
+                        fputc('"', f);
+                    }
+                    fputc('}', f);
+                }
+                fputc('}', f);
+                ++n;
+            }
+            fprintf(f, "\n]}\n");
+            fclose(f);
+            return n;
+        }
+
+        class writer : public Thread {
+            std::string path;
+            nanotime origin, from, to;
+            tael::Logger *log;
+            volatile bool done;
+
+            protected:
+            virtual void *run ( ) {
+                int n = write_records(recs, path, origin, from, to);
+                if (log) TAEL_PRINTF(log, TAEL_INFO, "trace: %d spans written to %s", n, path.c_str());
+                done = true;
+                return 0;
+            }
+
+            public:
+            std::vector<record> recs;
+            writer ( const std::string &path, nanotime origin, nanotime from, nanotime to, tael::Logger *log )
+                : path(path), origin(origin), from(from), to(to), log(log), done(false) { }
+            bool finished ( ) const { return done; }
+        };
+
+        writer *pending = 0;
+
+        void reap ( ) {
+            if (!pending) return;
+            void *vp;
+            pending->join(vp);
+            delete pending;
+            pending = 0;
+        }
+
+        // don't let the process exit under a dump still being written
+        struct reaper { ~reaper ( ) { reap(); } } reap_at_exit;
+    }
+
+    void start ( size_t capacity ) {
+        size_t n = 1024;
+        while (n < capacity) n <<= 1;
+        if (ring.size() != n) {
+            ring.assign(n, record());
+            mask = n - 1;
+            head = 0;
+        }
+        enabled = true;
+    }
+
+    void stop ( ) {
+        enabled = false;
+    }
+
+    size_t size ( ) {
+        return head < ring.size()? head : ring.size();
+    }
+
+    void mark ( nanotime market ) {
+        if (!enabled) return;
+        record r;
+        r.t0 = infra_timing::getCycleCount();
+        r.t1 = market.count();
+        r.name = 0;
+        r.who = 0;
+        r.cid = -1;
+        push(r);
+    }
+
+    void add ( const char *name, int cid, const std::type_info *who, uint64_t t0, uint64_t t1 ) {
+        if (ring.empty()) return;
+        record r;
+        r.t0 = t0;
+        r.t1 = t1;
+        r.name = name;
+        r.who = who;
+        r.cid = cid;
+        push(r);
+    }
+
+    int write_json ( const std::string &path, nanotime origin, nanotime from, nanotime to ) {
+        std::vector<record> recs;
+        snapshot(recs);
+        return write_records(recs, path, origin, from, to);
+    }
+
+    bool write_json_async ( const std::string &path, nanotime origin, nanotime from, nanotime to,
+                            tael::Logger *log ) {
+        if (pending && !pending->finished()) return false;
+        reap();
+        pending = new writer(path, origin, from, to, log);
+        snapshot(pending->recs);
+        pending->start();
+        return true;
+    }
+
+    void wait_json ( ) {
+        reap();
+    }
+
+}}}
@@ -5,6 +5,7 @@
 #include "yaml_message.h"
 #include <list>
 #include <string>
+#include <vector>
 
 namespace guillotine {
     namespace typed {
@@ -29,6 +30,14 @@ namespace guillotine {
             int clientId;
         };
 
+        // Several trades in one message.  On the wire the fields of trade
+        // are parallel lists (symbol: [A, B], qty: [100, -200], ...), with
+        // orderID and short-mark optional as for trade.
+        struct trade_batch {
+            std::vector<trade> trades;
+            int clientId;
+        };
+
         // Whenever we receive a list of trades, ack them with the number of
         // trades received by us
         struct trade_ack {
@@ -93,6 +102,9 @@ namespace guillotine {
             bool halt;
             double bid, ask;
             size_t bidsz, asksz;
+            // orderID of the trade this info answers, -1 for none.  Optional
+            // on the wire, and only sent when set.
+            long orderID;
             int clientId;
         };
 
@@ -123,10 +135,10 @@ namespace guillotine {
             virtual ~parse_error ( ) throw ( ) { }
         };
 
-        typedef boost::variant<connect, trade, stop, halt, resume, status> request;
-        typedef boost::variant<server, fill, info, error> response;
-        typedef boost::variant<connect, trade, stop, halt, resume, status,
-                server, fill, info, error> message;
+        typedef boost::variant<connect, trade, stop, halt, resume, status, trade_batch> request;
+        typedef boost::variant<server, fill, info, error, trade_ack> response;
+        typedef boost::variant<connect, trade, stop, halt, resume, status, trade_batch,
+                server, fill, info, error, trade_ack> message;
 
         //NSARKAS ammended so that a client id is embeded in the resulting message. Other option would be to stop treating messages as immutable later on.
         message get_message ( const yaml::message &raw, int clientId );
@@ -93,6 +93,7 @@ namespace guillotine {
 
         bool take_docs ( const char *c, int n);
         void clear_docs ( );
+        size_t pending ( ) const { return buf.size(); }
 
         virtual bool write_bytes ( ) = 0;
         virtual bool ready ( ) = 0;
@@ -118,9 +119,13 @@ namespace guillotine {
         ~file_writer ( ) { }
     };
 
+    // Works with blocking and non-blocking sockets.  On a non-blocking
+    // socket, write_bytes writes as much as the kernel will take and leaves
+    // the rest in buf; call it again when the socket is writable.
     class socket_writer : public base_writer {
         
         Socket *s;
+        bool is_error;
 
         public:
         virtual bool write_bytes ( );
@@ -128,7 +133,7 @@ namespace guillotine {
         virtual bool eof ( );
         virtual bool error ( );
 
-        socket_writer ( Socket *s ) : s(s) { }
+        socket_writer ( Socket *s ) : s(s), is_error(false) { }
         ~socket_writer ( ) { }
 
     };
@@ -55,7 +55,7 @@ namespace guillotine {
                 }
             }
             try {
-                if ( (s = boost::any_cast<T>(&(m[field].value()))) ) {
+                if ( (s = boost::any_cast<string>(&(m[field].value()))) ) {
                     dest.push_back(boost::lexical_cast<T>(*s));
                 } else if ( (ss = boost::any_cast<list<yaml::node> >(&(m[field].value()))) ) {
                     for (list<yaml::node>::const_iterator i = ss->begin(); i != ss->end(); ++i)
@@ -105,6 +105,49 @@ namespace guillotine {
                 return message(t);
             }
 
+            if (raw.name() == "trade-batch") {
+                trade_batch b;
+                list<string> syms;
+                list<double> aggrs;
+                list<int> qtys, marks;
+                list<long> oids;
+                fillf(syms, raw, "symbol");
+                fillf(aggrs, raw, "aggr");
+                fillf(qtys, raw, "qty");
+                bool haveOids = fillf(oids, raw, "orderID", true);
+                bool haveMarks = fillf(marks, raw, "short-mark", true);
+                if (aggrs.size() != syms.size() || qtys.size() != syms.size() ||
+                        (haveOids && oids.size() != syms.size()) ||
+                        (haveMarks && marks.size() != syms.size())) {
+                    pe.msg.reason = error::bad_field;
+                    pe.msg.field_name = "symbol";
+                    pe.msg.info = "field lists of different lengths in message trade-batch";
+                    throw pe;
+                }
+                b.trades.resize(syms.size());
+                list<string>::const_iterator si = syms.begin();
+                list<double>::const_iterator ai = aggrs.begin();
+                list<int>::const_iterator qi = qtys.begin(), mi = marks.begin();
+                list<long>::const_iterator oi = oids.begin();
+                for (std::vector<trade>::iterator t = b.trades.begin(); t != b.trades.end(); ++t) {
+                    t->symbol = *si++;
+                    t->aggr = *ai++;
+                    t->qty = *qi++;
+                    t->orderID = haveOids ? *oi++ : -1;
+                    t->short_mark = haveMarks ? *mi++ : trade::unknown;
+                    t->clientId = clientId;
+                }
+                b.clientId = clientId;
+                return message(b);
+            }
+
+            if (raw.name() == "trade-ack") {
+                trade_ack a;
+                fillf(a.numTrades, raw, "numTrades");
+                a.clientId = clientId;
+                return message(a);
+            }
+
             if (raw.name() == "stop") {
                 stop s;
                 s.all = !fillf(s.symbols, raw, "symbol", true);
@@ -212,6 +255,9 @@ namespace guillotine {
                 if (!fillf(s.ask, raw, "ask", true)) s.ask = 0.0;
                 if (!fillf(s.bidsz, raw, "bid-size", true)) s.bidsz = 0;
                 if (!fillf(s.asksz, raw, "ask-size", true)) s.asksz = 0;
+                long orderID = -1;
+                fillf(orderID, raw, "orderID", true);
+                s.orderID = orderID;
                 s.clientId = clientId;
 
                 return message(s);
@@ -297,6 +343,7 @@ namespace guillotine {
                 fillf(m, "account", s.account);
                 fillf(m, "name", s.name);
                 fillf(m, "password", s.password);
+                fillf(m, "listenToBcast", s.listenToBcast);
                 return m;
             }
             yaml::message operator() ( const trade &s ) const {
@@ -308,6 +355,31 @@ namespace guillotine {
                 fillf(m, "short-mark", s.short_mark);
                 return m;
             }
+            yaml::message operator() ( const trade_batch &s ) const {
+                yaml::message m("trade-batch");
+                list<string> syms;
+                list<double> aggrs;
+                list<int> qtys, marks;
+                list<long> oids;
+                for (std::vector<trade>::const_iterator t = s.trades.begin(); t != s.trades.end(); ++t) {
+                    syms.push_back(t->symbol);
+                    aggrs.push_back(t->aggr);
+                    qtys.push_back(t->qty);
+                    oids.push_back(t->orderID);
+                    marks.push_back(t->short_mark);
+                }
+                fillf(m, "symbol", syms);
+                fillf(m, "aggr", aggrs);
+                fillf(m, "qty", qtys);
+                fillf(m, "orderID", oids);
+                fillf(m, "short-mark", marks);
+                return m;
+            }
+            yaml::message operator() ( const trade_ack &s ) const {
+                yaml::message m("trade-ack");
+                fillf(m, "numTrades", s.numTrades);
+                return m;
+            }
             yaml::message operator() ( const halt &s ) const {
                 yaml::message m("halt");
                 if (!s.all) {
@@ -378,6 +450,8 @@ namespace guillotine {
                 fillf(m, "ask-size", s.asksz);
                 fillf(m, "bid", s.bid);
                 fillf(m, "ask", s.ask);
+                if (s.orderID >= 0)
+                    fillf(m, "orderID", s.orderID);
                 return m;
             }
 
@@ -447,6 +521,19 @@ namespace guillotine {
                 return ss.str();
             }
 
+            std::string operator() ( const trade_batch &s ) const {
+                ss << "Batch    " << s.trades.size() << " trades [";
+                for (std::vector<trade>::const_iterator t = s.trades.begin(); t != s.trades.end(); ++t) {
+                    ss << " " << t->symbol << ":" << t->qty << "@" << t->aggr;
+                }
+                ss << " ].";
+                return ss.str();
+            }
+            std::string operator() ( const trade_ack &s ) const {
+                ss << "TradeAck " << s.numTrades << " trades accepted.";
+                return ss.str();
+            }
+
             std::string operator() ( const stop &s ) const {
                 ss << "Stop     ";
                 if (s.all) ss << "(all symbols).";
@@ -514,6 +601,8 @@ namespace guillotine {
                    << ", halt: " << s.halt
                    << " [" << s.bidsz << "x" << s.bid << " | " 
                    << s.ask << "x" << s.asksz << "]";
+                if (s.orderID >= 0)
+                    ss << " (orderID = " << s.orderID << ")";
                 return ss.str();
             }
             std::string operator() ( const error &s ) const {
@@ -539,6 +628,14 @@ namespace guillotine {
             request operator() ( const halt &s ) const { return request(s); }
             request operator() ( const resume &s ) const { return request(s); }
             request operator() ( const status &s ) const { return request(s); }
+            request operator() ( const trade_batch &s ) const { return request(s); }
+            request operator() ( const trade_ack &s ) const {
+                parse_error pe;
+                pe.msg.reason = error::bad_message;
+                pe.msg.message_name = "trade-ack";
+                pe.msg.info = std::string("message type 'trade-ack' not expected here.");
+                throw pe;
+            }
             request operator() ( const server &s ) const {
                 parse_error pe;
                 pe.msg.reason = error::bad_message;
@@ -573,6 +670,14 @@ namespace guillotine {
             response operator() ( const fill &s ) const { return response(s); }
             response operator() ( const info &s ) const { return response(s); }
             response operator() ( const error &s ) const { return response(s); }
+            response operator() ( const trade_ack &s ) const { return response(s); }
+            response operator() ( const trade_batch &s ) const {
+                parse_error pe;
+                pe.msg.reason = error::bad_message;
+                pe.msg.message_name = "trade-batch";
+                pe.msg.info = std::string("message type 'trade-batch' not expected here.");
+                throw pe;
+            }
             response operator() ( const connect &s ) const {
                 parse_error pe;
                 pe.msg.reason = error::bad_message;
@@ -629,6 +734,7 @@ namespace guillotine {
         	std::pair<bool, int> operator() ( const fill &s ) const { return std::make_pair(targetClientId == s.clientId || targetListenToBcast, s.clientId); }
         	std::pair<bool, int> operator() ( const info &s ) const { return std::make_pair(targetClientId == s.clientId, s.clientId); }
         	std::pair<bool, int> operator() ( const error &s ) const { return std::make_pair(targetClientId == s.clientId, s.clientId); }
+        	std::pair<bool, int> operator() ( const trade_ack &s ) const { return std::make_pair(targetClientId == s.clientId, s.clientId); }
         };
 
         request get_request  ( const message &m ) { return boost::apply_visitor(to_req(), m); }
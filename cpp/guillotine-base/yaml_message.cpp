@@ -2,6 +2,7 @@
 #include <Util/Socket.h>
 
 #include <cstring>
+#include <cerrno>
 #include <cstdlib>
 
 #include <boost/lexical_cast.hpp>
@@ -113,18 +114,28 @@ namespace yaml {
     }
 
     bool socket_writer::write_bytes ( ) {
+        if (is_error) return false;
         const char *b = buf.c_str();
         int rem = buf.length();
         if (rem == 0) return true;
 
-        int nwrit = 0;
-        nwrit = s->write(b, rem);
-        if (nwrit > 0) {
-            rem -= nwrit;
-            buf.erase(0, nwrit);
-        } else {
-            perror("write");
+        int done = 0;
+        while (rem > 0) {
+            int nwrit = s->write(b + done, rem);
+            if (nwrit > 0) {
+                rem -= nwrit;
+                done += nwrit;
+            } else if (nwrit < 0 && errno == EINTR) {
+                continue;
+            } else {
+                if (nwrit < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                    perror("write");
+                    is_error = true;
+                }
+                break;
+            }
         }
+        buf.erase(0, done);
         return rem == 0;
     }
     bool socket_writer::ready( ) {
@@ -134,7 +145,7 @@ namespace yaml {
         return false;
     }
     bool socket_writer::error ( ) {
-        return false;
+        return is_error;
     }
 
 
@@ -56,16 +56,12 @@ void msg_handler::operator() ( const typed::trade &req ) {
 			getMarket(c->dm->masterBook(), cid, Mkt::ASK, 0, &ask, 0);
 
 			int oldtarget = c->trd->getTargetPosition(cid);
-			TAEL_PRINTF(&c->costlog, TAEL_INFO, "REQ %s currPos: %d qty: %d at aggr %.3f (%.2f,%.2f) [orderID: %ld]",
-				sym.c_str(), c->dm->position(cid), req.qty, req.aggr, bid, ask, req.orderID);
+			JournalRecord r(c->record(JournalRecord::REQ, cid));
+			r.pos = c->dm->position(cid);
+			r.qty = req.qty; r.aggr = req.aggr; r.bid = bid; r.ask = ask; r.orderID = req.orderID;
+			c->record_cost(r);
 
-			equal_cid eq(cid);
-			c->actions.erase(
-					std::remove_if(c->actions.begin(), c->actions.end(),
-						boost::apply_visitor(eq)),
-					c->actions.end());
-
-			c->actions.push_back(do_trade(cid, req.qty, req.aggr,
+			c->actions.push(do_trade(cid, req.qty, req.aggr,
 						req.aggr * 1000000000 +
 						std::abs(req.qty) * (bid + ask),
 						req.orderID, req.short_mark, req.clientId));
@@ -73,6 +69,37 @@ void msg_handler::operator() ( const typed::trade &req ) {
 	}
 }
 
+// Batches skip the action queue: the whole batch enters the engine on this
+// wakeup, superseding anything still queued for its symbols.
+void msg_handler::operator() ( const typed::trade_batch &req ) {
+	std::vector<TradeTarget> batch;
+	batch.reserve(req.trades.size());
+	for (std::vector<typed::trade>::const_iterator t = req.trades.begin(); t != req.trades.end(); ++t) {
+		int cid = to_cid(t->symbol, req.clientId);
+		if (cid == -1) continue;
+		if (c->stops[cid]) {
+			c->send_halterror(t->symbol, req.clientId);
+			continue;
+		}
+		double bid = 0.0, ask = 0.0;
+		getMarket(c->dm->masterBook(), cid, Mkt::BID, 0, &bid, 0);
+		getMarket(c->dm->masterBook(), cid, Mkt::ASK, 0, &ask, 0);
+		int pos = c->dm->position(cid);
+		JournalRecord r(c->record(JournalRecord::REQ, cid));
+		r.pos = pos;
+		r.qty = t->qty; r.aggr = t->aggr; r.bid = bid; r.ask = ask; r.orderID = t->orderID;
+		c->record_cost(r);
+
+		c->actions.cancel(cid);
+		batch.push_back(TradeTarget(cid, pos + t->qty, t->aggr * 0.0001, t->orderID, (Mkt::Marking)t->short_mark));
+	}
+
+	typed::trade_ack ack;
+	ack.numTrades = batch.empty()? 0 : c->trd->tradeToBatch(batch, req.clientId);
+	ack.clientId = req.clientId;
+	c->my_rsps.push_back(typed::response(ack));
+}
+
 void msg_handler::operator() ( const typed::resume &req ) {
     if (req.all) {
         int numLocates = 0;
@@ -170,20 +197,46 @@ void msg_handler::setup_stop ( int cid, int clientId ) {
     double bid = 0.0, ask = 0.0;
     getMarket(c->dm->masterBook(), cid, Mkt::BID, 0, &bid, 0);
     getMarket(c->dm->masterBook(), cid, Mkt::ASK, 0, &ask, 0);
-    TAEL_PRINTF(&c->costlog, TAEL_INFO, "REQ %s pos: %d (qtyLeft: %d) (%.2f,%.2f) #stop",
-            c->dm->symbol(cid), pos, oldtarget - pos, bid, ask);
-
-    equal_cid eq(cid);
-    // note: "remove_if" is unintuitive.
-    c->actions.erase(
-            std::remove_if(c->actions.begin(), c->actions.end(),
-                boost::apply_visitor(eq)),
-            c->actions.end());
+    JournalRecord r(c->record(JournalRecord::STOP, cid));
+    r.pos = pos; r.qty = oldtarget - pos; r.bid = bid; r.ask = ask;
+    c->record_cost(r);
 
-    c->actions.push_back(do_stop(cid, 
+    c->actions.push(do_stop(cid, 
                 std::abs(pos - oldtarget) * (bid + ask), clientId));
 }
 
+void action_scheduler::reset ( int ncids ) {
+    heap.clear();
+    latest.clear(); latest.resize(ncids, 0);
+    live = 0;
+}
+
+void action_scheduler::push ( const do_action &a ) {
+    int cid = boost::apply_visitor(action_cid(), a);
+    if (latest[cid] == 0) ++live;
+    latest[cid] = ++seq;
+    heap.push_back(entry(a, seq));
+    std::push_heap(heap.begin(), heap.end(), entry_lt());
+    if (heap.size() > 2 * live + 64) compact();
+}
+
+void action_scheduler::cancel ( int cid ) {
+    if (latest[cid] != 0) {
+        latest[cid] = 0;
+        --live;
+    }
+}
+
+void action_scheduler::compact ( ) {
+    std::vector<entry> h;
+    h.reserve(live);
+    for (std::vector<entry>::const_iterator it = heap.begin(); it != heap.end(); ++it) {
+        if (is_live(*it)) h.push_back(*it);
+    }
+    heap.swap(h);
+    std::make_heap(heap.begin(), heap.end(), entry_lt());
+}
+
 void apply_action::operator() ( const do_stop &s ) {
     c->trd->stop(s.cid, s.clientId);
 }
@@ -192,9 +245,10 @@ void apply_action::operator() ( const do_trade &s ) {
   c->trd->trade(s.cid, s.qty, s.aggr * 0.0001, s.orderID, s.clientId, (Mkt::Marking)s.short_mark);
 }
 
-void hfcontext::send_info ( int cid, int qty, double prio, int clientId ) {
+void hfcontext::send_info ( int cid, int qty, double prio, int clientId, long orderID ) {
     typed::info i;
     i.clientId = clientId;
+    i.orderID = orderID;
     int short_mark = trd->getShortMarking(cid);
     i.symbol = dm->symbol(cid);
 
@@ -240,12 +294,56 @@ void hfcontext::send_halterror ( const std::string &sym, int clientId ) {
     my_rsps.push_back(typed::response(e));
 }
 
+JournalRecord hfcontext::record ( JournalRecord::Type t, int cid ) {
+    return JournalRecord(t, dm->curtime().count() / 1000, _date, dm->symbol(cid));
+}
+
+bool hfcontext::journaling ( ) {
+    if (journal.enabled()) return true;
+    if (journal.failed() && !journalFailReported) {
+        TAEL_PRINTF(&log, TAEL_ERROR, "Journal write failed: %s; %lu records lost so far, writing text logs from here on",
+                strerror(journal.error()), journal.lostCount());
+        journalFailReported = true;
+    }
+    return false;
+}
+
+void hfcontext::record_cost ( const JournalRecord &r ) {
+    if (journaling()) {
+        journal.append(r);
+    } else {
+        char buf[256];
+        r.snprint(buf, sizeof(buf));
+        TAEL_PRINTF(&costlog, TAEL_INFO, "%s", buf);
+    }
+}
+
+void hfcontext::record_fill ( const JournalRecord &r ) {
+    if (journaling()) {
+        journal.append(r);
+    } else {
+        r.printFill(fillsOutStream);
+        record_cost(r);
+    }
+}
+
+void hfcontext::record_order ( const OrderUpdate &ou ) {
+    if (journaling()) {
+        journal.append(JournalRecord::order(ou, _date, dm->symbol(ou.cid())));
+    } else {
+        char buf[256];
+        ou.snprint(buf, 255);
+        TAEL_PRINTF(&log, TAEL_INFO, "%s", buf);
+    }
+}
+
 void hflistener::update ( const WakeUpdate &w ) {
 
     if (!c->my_rsps.empty()) 
         c->rspx.try_swap(c->my_rsps);
 
     if (c->reqx.try_swap(c->my_reqs)) {
+        clite::util::trace::span sp("guillotine requests");
         msg_handler handler(c);
         std::for_each(c->my_reqs.begin(), c->my_reqs.end(), boost::apply_visitor(handler));
     } else {
@@ -253,15 +351,11 @@ void hflistener::update ( const WakeUpdate &w ) {
     }
     if (!c->my_reqs.empty()) {
         c->my_reqs.clear();
-        action_gt gt; // gt == greater than
-        std::sort(c->actions.begin(), c->actions.end(), boost::apply_visitor(gt));
     }
-    if (!c->actions.empty() && c->dm->curtv() - c->last_act > TimeVal(0, c->act_rate *1000)) {
+    if (!c->actions.empty()) {
+        clite::util::trace::span sp("guillotine actions");
         apply_action a(c);
-        
-        boost::apply_visitor(a, c->actions.front());
-        c->actions.pop_front();
-        c->last_act = c->dm->curtv();
+        c->actions.release(c->dm->curtime(), c->act_rate, c->act_burst, a);
     }
     if (!c->has_reset_) {
         TAEL_PRINTF(&c->log, TAEL_INFO, "HF: resetting all targets to positions.");
@@ -269,17 +363,13 @@ void hflistener::update ( const WakeUpdate &w ) {
             c->trd->stop(i);
 
         c->has_reset_ = true;
-        c->last_act = c->dm->curtv();
     }
 }
 
 void hflistener::update ( const OrderUpdate &ou ) {
-    char buf[256];
-    ou.snprint(buf, 255);
     //char *liqstr;
     char liqchar;
-    std::string strat("U");
-    TAEL_PRINTF(&c->log, TAEL_INFO, "%s", buf);
+    c->record_order(ou);
     if (ou.action() == Mkt::FILLED && ou.mine()) {
         int cid = ou.cid();
         double bid = 0.0, ask = 0.0;
@@ -293,14 +383,7 @@ void hflistener::update ( const OrderUpdate &ou ) {
             default: f.liquidity = typed::fill::other; liqchar = 'O'; /*liqstr = "other";*/ break;
         }
 
-        if (ou.placementAlgo_.compare("JOIN_QUEUE") == 0) strat = "J";
-        if (ou.placementAlgo_.compare("FLW_LEADER") == 0) strat = "L";
-        if (ou.placementAlgo_.compare("STEP_UP_L1") == 0) strat = "T";
-        if (ou.placementAlgo_.compare("CROSS     ") == 0) strat = "X";
-        if (ou.placementAlgo_.compare("TAKE_INVSB") == 0) strat = "I";
-        if (ou.placementAlgo_.compare("FLW_SOB   ") == 0) strat = "S";
-        if (ou.placementAlgo_.compare("MKTONCLOSE") == 0) strat = "M";
-        f.strat = strat;
+        f.strat = std::string(1, Placement::StratCode[ou.placementReason()]);
         f.orderID = ou.orderID();
         f.symbol = c->dm->symbol(cid);
         f.exchange = ECN::desc(ou.ecn());
@@ -317,13 +400,13 @@ void hflistener::update ( const OrderUpdate &ou ) {
         getMarket(c->dm->masterBook(), cid, Mkt::BID, 0, &bid, 0);
         getMarket(c->dm->masterBook(), cid, Mkt::ASK, 0, &ask, 0);
         c->fillCounter++;
-        long curr_time = ((long) f.time_sec)*1000 + (f.time_usec/1000);
-        c->fillsOutStream << "F|" << c->_date << "|" << f.symbol << "|" << curr_time
-        		<< "|" << f.fill_size << "|" << f.fill_price << "|" << ECN::desc(ou.ecn())
-                << "|" << liqchar << "|" << f.orderID << "|" << (ou.placementAlgo_).c_str() << std::endl;
-        TAEL_PRINTF(&c->costlog, TAEL_INFO, "FILL %s %s %d@%.2f (%.2f,%.2f) %c (orderID: %ld, seqnum: %d) Algo: %s",
-                c->dm->symbol(cid), ECN::desc(ou.ecn()),
-                f.fill_size, f.fill_price, bid, ask, liqchar, f.orderID, ou.id(), (ou.placementAlgo_).c_str());
+        JournalRecord r(c->record(JournalRecord::FILL, cid));
+        strncpy(r.ecn, ECN::desc(ou.ecn()), sizeof(r.ecn) - 1);
+        strncpy(r.algo, Placement::ReasonDesc[ou.placementReason()], sizeof(r.algo) - 1);
+        r.liq = liqchar;
+        r.qty = f.fill_size; r.price = f.fill_price; r.bid = bid; r.ask = ask;
+        r.orderID = f.orderID; r.seqnum = ou.id();
+        c->record_fill(r);
     }
     else if (ou.action() == Mkt::FILLED && c->float_fills && !ou.mine()) {
         int cid = ou.cid();
@@ -337,9 +420,10 @@ void hflistener::update ( const OrderUpdate &ou ) {
         Mkt::Marking mark = c->trd->getShortMarking(cid);
         //NSARKAS maybe we would like to provide a meaningful orderid and clientid at this point?
         c->trd->tradeTo(cid, oldtarget + delta, aggr, (long) -2, ClientInfo::NO_CLIENT_ID, mark);
-        TAEL_PRINTF(&c->costlog, TAEL_INFO, "REQ %s %d %d %d %.3f %.2f %.2f # implicit update due to %d fill",
-                c->dm->symbol(cid), oldtarget, oldtarget + delta, c->dm->position(cid),
-                aggr, bid, ask, delta);
+        JournalRecord r(c->record(JournalRecord::IMPLICIT, cid));
+        r.target = oldtarget; r.qty = delta; r.pos = c->dm->position(cid);
+        r.aggr = aggr; r.bid = bid; r.ask = ask;
+        c->record_cost(r);
     }
 }
 
@@ -390,7 +474,7 @@ void hflistener::update ( const TimeUpdate &tu ) {
 }
 
 void hflistener::update ( const TradeRequest & trq ) {
-    c->send_info(trq._cid, trq._targetPos - c->dm->position(trq._cid), trq._priority, trq._clientId);
+    c->send_info(trq._cid, trq._targetPos - c->dm->position(trq._cid), trq._priority, trq._clientId, trq._orderID);
 }
 
 void hflistener::update ( const UserMessage &um ) {
@@ -405,7 +489,7 @@ void hflistener::update ( const UserMessage &um ) {
 
     if (um.code() == c->ratecode) {
         int rate = atoi(um.msg1());
-        if (rate < 0 || rate > 1000) {
+        if (rate < -1 || rate > 1000) {
             TAEL_PRINTF(&c->log, TAEL_INFO, "HF Rate Code ignored: %d out of bounds", rate);
         } else {
             TAEL_PRINTF(&c->log, TAEL_INFO, "HF Rate Code set: %d", rate);
@@ -475,6 +559,11 @@ void hflistener::update ( const UserMessage &um ) {
 	string prefix("");
 	tc->printTCSummaryInfo(TAEL_INFO, prefix);
       }
+      factory<StreamingTCTracker>::pointer stc = factory<StreamingTCTracker>::find(only::one);
+      if (stc) {
+	string prefix("");
+	stc->printTCSummaryInfo(TAEL_INFO, prefix);
+      }
     }
     if (um.code() == c->inviscode) {
       factory<TakeInvisibleComponent>::pointer invc = factory<TakeInvisibleComponent>::find(only::one);
@@ -609,6 +698,60 @@ void hflistener::update ( const UserMessage &um ) {
       }
     }
 
+    // user-message dump tick-to-trade latency histograms.
+    if (um.code() == c->latencycode) {
+      factory<clite::util::debug_stream>::pointer latlog = factory<clite::util::debug_stream>::get(std::string("latency"));
+      c->dm->latency().print(latlog.get(), TAEL_INFO);
+      if (!strcmp(um.msg1(), "reset")) c->dm->latency().clear();
+      TAEL_PRINTF(&c->log, TAEL_INFO, "HF Latency Code received: dumped to latency log%s",
+                    strcmp(um.msg1(), "reset")? "" : " and reset");
+    }
+
+    // user-message switch per-listener dispatch profiling on/off, or dump it.
+    if (um.code() == c->profilecode) {
+      factory<clite::util::debug_stream>::pointer plog = factory<clite::util::debug_stream>::get(std::string("latency"));
+      if (!strcmp(um.msg1(), "on")) {
+        int every = atoi(um.msg2());
+        c->dm->set_profiling(true, every > 0? every : 8);
+        TAEL_PRINTF(&c->log, TAEL_INFO, "HF Profile Code received: dispatch profiling on, 1 in %d timed",
+                      every > 0? every : 8);
+      } else {
+        bool off = !strcmp(um.msg1(), "off");
+        if (off) c->dm->set_profiling(false);
+        c->dm->printDispatchProfile(plog.get(), TAEL_INFO, true);
+        TAEL_PRINTF(&c->log, TAEL_INFO, "HF Profile Code received: dumped to latency log%s",
+                      off? ", profiling off" : "");
+      }
+    }
+
+    // user-message start/stop span tracing, or write a window of it as Chrome trace JSON.
+    if (um.code() == c->tracecode) {
+      if (!strcmp(um.msg1(), "on")) {
+        clite::util::trace::start(c->traceRing);
+        TAEL_PRINTF(&c->log, TAEL_INFO, "HF Trace Code received: tracing on, %d spans kept", c->traceRing);
+      } else if (!strcmp(um.msg1(), "off")) {
+        clite::util::trace::stop();
+        TAEL_PRINTF(&c->log, TAEL_INFO, "HF Trace Code received: tracing off");
+      } else if (!strcmp(um.msg1(), "dump")) {
+        // window as HHMMSS-HHMMSS of DM time; everything in the ring if absent
+        int a = 0, b = 240000;
+        sscanf(um.msg2(), "%d-%d", &a, &b);
+        nanotime mid = c->dm->midnight();
+        nanotime from = mid + nanotime::from_sec(a / 10000 * 3600 + a / 100 % 100 * 60 + a % 100);
+        nanotime to = mid + nanotime::from_sec(b / 10000 * 3600 + b / 100 % 100 * 60 + b % 100);
+        char name[64];
+        snprintf(name, sizeof(name), "/trace-%06d-%06d.json", a, b);
+        string path = string(getenv("EXEC_LOG_DIR")) + name;
+        // formatted & written on a background thread, which logs the span count
+        if (clite::util::trace::write_json_async(path, mid, from, to, &c->log))
+          TAEL_PRINTF(&c->log, TAEL_INFO, "HF Trace Code received: writing %s", path.c_str());
+        else
+          TAEL_PRINTF(&c->log, TAEL_WARN, "HF Trace Code received: previous dump still being written, %s skipped", path.c_str());
+      } else {
+        TAEL_PRINTF(&c->log, TAEL_WARN, "HF Trace Code received: unknown subcommand '%s' (on, off or dump)", um.msg1());
+      }
+    }
+
 }
 
 }}
@@ -5,6 +5,8 @@
 #include <iostream>
 #include <fstream>
 #include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
 
 #include <DataManager.h>
 #include <Configurable.h>
@@ -15,8 +17,10 @@
 
 #include <guillotine/typed_message.h>
 #include "mxdeque.h"
+#include "Journal.h"
 
 #include <ExecutionEngine.h>
+#include <HFUtils.h>
 
 #include <HFCodes.h>
 
@@ -66,11 +70,85 @@ namespace guillotine { namespace server {
         bool operator() ( const do_trade &, const do_stop & ) const { return false; }
     };
 
-    struct equal_cid : public boost::static_visitor<bool> {
-        int cid;
-        equal_cid ( int c ) : cid(c) { }
+    struct action_cid : public boost::static_visitor<int> {
         template <typename T>
-        bool operator() ( const T &t ) const { return t.cid == cid; }
+        int operator() ( const T &t ) const { return t.cid; }
+    };
+
+    // Queue of pending external actions, released highest priority first
+    // (see action_gt; equal priorities go first-in first-out).
+    // At most one action is live per cid: pushing an action supersedes
+    // whatever was queued for that cid.  Superseded entries stay in the
+    // heap and are skipped when they surface.
+    // Release is rate limited by a token bucket refilled at one token per
+    // rate ms and holding at most burst tokens.  Rate 0 releases one action
+    // per wakeup, as before the bucket; a negative rate releases everything.
+    class action_scheduler {
+        struct entry {
+            do_action act;
+            unsigned seq;
+            entry ( const do_action &a, unsigned s ) : act(a), seq(s) { }
+        };
+        // heap order: true if l should come out after r
+        struct entry_lt {
+            bool operator() ( const entry &l, const entry &r ) const {
+                action_gt gt;
+                if (boost::apply_visitor(gt, r.act, l.act)) return true;
+                if (boost::apply_visitor(gt, l.act, r.act)) return false;
+                return l.seq > r.seq;
+            }
+        };
+
+        std::vector<entry> heap;
+        std::vector<unsigned> latest; // seq of the live entry per cid, 0 if none
+        unsigned seq;
+        size_t live;
+        double tokens;
+        bool started;
+        nanotime last_refill;
+
+        bool is_live ( const entry &e ) const {
+            return latest[boost::apply_visitor(action_cid(), e.act)] == e.seq;
+        }
+        void compact ( );
+
+        public:
+        action_scheduler ( ) : seq(0), live(0), tokens(0), started(false) { }
+
+        void reset ( int ncids );
+        void push ( const do_action &a );
+        void cancel ( int cid );
+        size_t size ( ) const { return live; }
+        bool empty ( ) const { return live == 0; }
+
+        // Refill the bucket up to now and hand as many actions to f as it
+        // allows.  Returns the number released.
+        template <typename F>
+        int release ( nanotime now, int rate, int burst, F &f ) {
+            if (!started) { last_refill = now; started = true; }
+            if (rate > 0) {
+                tokens += HFUtils::milliSecondsBetween(last_refill, now) / rate;
+                if (tokens > burst) tokens = burst;
+            } else if (rate == 0) {
+                tokens = 1.0;
+            }
+            last_refill = now;
+
+            int n = 0;
+            while (live > 0 && (rate < 0 || tokens >= 1.0)) {
+                std::pop_heap(heap.begin(), heap.end(), entry_lt());
+                entry e = heap.back();
+                heap.pop_back();
+                if (!is_live(e)) continue;
+                latest[boost::apply_visitor(action_cid(), e.act)] = 0;
+                --live;
+                boost::apply_visitor(f, e.act);
+                tokens -= 1.0;
+                ++n;
+            }
+            if (tokens < 0) tokens = 0;
+            return n;
+        }
     };
 
     struct apply_action : public boost::static_visitor<> {
@@ -92,6 +170,7 @@ namespace guillotine { namespace server {
 
         void operator() ( const typed::connect &req );
         void operator() ( const typed::trade &req );
+        void operator() ( const typed::trade_batch &req );
         void operator() ( const typed::stop &req );
         void operator() ( const typed::halt &req );
         void operator() ( const typed::resume &req );
@@ -114,6 +193,9 @@ struct hfcontext : public Configurable {
     int ignoretickdowncode;
     int requestsyncscode;
     int orderprobcode;
+    int latencycode;
+    int profilecode;
+    int tracecode;
     mxdeque<typed::request> &reqx;
     mxdeque<typed::response> &rspx;
     clite::util::factory<DataManager>::pointer dm;
@@ -123,7 +205,8 @@ struct hfcontext : public Configurable {
     reqdeque my_reqs;
     rspdeque my_rsps;
 
-    std::deque<do_action> actions;
+    action_scheduler actions;
+    int act_burst;
 
     std::vector<bool> stops;
     std::vector<double> fillCash;
@@ -144,9 +227,16 @@ struct hfcontext : public Configurable {
     std::ofstream reportOutStream;
     tael::Logger log;
 
+    Journal journal;
+    std::string journalFile;
+    int journalRing;
+    int journalFsync; // in ms
+    bool journalFailReported;
+    int traceRing;
+    bool traceOnStart;
+
     boost::shared_ptr<tael::LoggerDestination> ld;
 
-    TimeVal last_act;
     Timer sync_timer;
     Timer sync_minor_timer;
 
@@ -160,13 +250,25 @@ struct hfcontext : public Configurable {
     ExecutionEngine *trd;
 
     void send_info ( int cid, int clientId );
-    void send_info ( int cid, int qty, double prio, int clientId );
+    void send_info ( int cid, int qty, double prio, int clientId, long orderID = -1 );
 
     void send_symerror ( const std::string &sym, int clientId );
     void send_halterror ( const std::string &sym, int clientId );
 
+    /// Cost-log, fills-file and order-update output.  With a journal-file
+    /// these only queue a binary record for the journal thread (render it
+    /// with gt-journal); otherwise the text is written here as before.
+    /// journaling() is false once the journal has failed; the first caller
+    /// to see that reports it.
+    bool journaling ( );
+    JournalRecord record ( JournalRecord::Type t, int cid );
+    void record_cost ( const JournalRecord &r );
+    void record_fill ( const JournalRecord &r );
+    void record_order ( const OrderUpdate &ou );
+
     public:
     void reset ( ) { 
+        actions.reset(dm->cidsize());
         stops.clear(); stops.resize(dm->cidsize(), false);
         fillCash.clear(); fillCash.resize(dm->cidsize(), 0);
         fillShs.clear(); fillShs.resize(dm->cidsize(), 0);
@@ -182,6 +284,7 @@ struct hfcontext : public Configurable {
         log(*(new tael::LoggerConfiguration((size_t) MAX_BINARY_BUFFER_FILE_SIZE))),
         sync_timer(TimeVal(300,0), TimeVal(0,0)),
         sync_minor_timer(TimeVal(0,0), TimeVal(0,0)),
+        journalFailReported(false),
         has_reset_(false),
         fillCounter(0),
         sync_cid_counter(0)/*,
@@ -191,7 +294,8 @@ struct hfcontext : public Configurable {
         defOption("base-strat-code", &stratcode, "Strategy code base (for all gt servers)", defoption::BaseCode);
         defOption("offset-strat", &stratoff, "Offset code for this gt server");
         // GVNOTE: Changed default act-rate to 5 ms from 0 ms for stability reasons.
-        defOption("action-rate", &act_rate, "time to wait in ms between sending actions (0 = instant)", 0);
+        defOption("action-rate", &act_rate, "time to wait in ms between sending actions (0 = one per wakeup, -1 = all queued at once)", 0);
+        defOption("action-burst", &act_burst, "max actions sent back to back after an idle period (token bucket depth)", 1);
         defSwitch("start-halted",&start_halted,"Start the server in a halted mode");
         defOption("request-syncs", &request_syncs, "Send locate/position sync requests", true);
         defOption("stop-code", &stopcode, "Stop code #", defoption::StopCode);
@@ -211,11 +315,19 @@ struct hfcontext : public Configurable {
         defOption("ignoretick-code", &ignoretickdowncode, "Ignore Tick code", defoption::IgnoreTickCode);
         defOption("request-syncs-code", &requestsyncscode, "Request locates/positions syncs code", defoption::SyncUpdateCode);
         defOption("order-place-prob",&orderprobcode,"Order placement probability code",defoption::OrderProbCode);
+        defOption("latency-code", &latencycode, "Tick-to-trade latency dump code (msg1 \"reset\" also clears)", defoption::LatencyCode);
+        defOption("profile-code", &profilecode, "Dispatch profiling code (msg1 on [msg2 = 1 in N timed], off, dump)", defoption::ProfileCode);
+        defOption("trace-code", &tracecode, "Span tracing code (msg1 on, off, dump [msg2 = HHMMSS-HHMMSS])", defoption::TraceCode);
+        defOption("trace-ring-size", &traceRing, "Trace span records kept for trace-code dumps", 1 << 18);
+        defSwitch("trace", &traceOnStart, "Record trace spans from startup");
         defOption("cost-log-file", &coststr, "Cost log filename");
         defOption("float-fills", &float_fills, "Float target over external fills (generate implicit requests)");
         defOption("name", &namestr, "Name that server should use with client", "Guillotine Server");
         defOption("fills-log-file", &fillsFile, "Name of the fills file", "fills.txt");
         defOption("report-log-file", &reportFile, "Name of the fills file", "report.txt");
+        defOption("journal-file", &journalFile, "Binary fills/cost/order journal, written off the trading thread (replaces the text logs)");
+        defOption("journal-ring-size", &journalRing, "Records buffered between trading and journal threads", 65536);
+        defOption("journal-fsync-interval", &journalFsync, "Max ms between journal fdatasyncs", 1000);
         //defOption("ignore",&ignore_symbols,"Symbols to ignore for trading");
     }
 
@@ -248,7 +360,18 @@ struct hfcontext : public Configurable {
         string fillsFilePath = string(getenv("EXEC_LOG_DIR")) + string("/") + fillsFile;
         bool fillsFileExists = (stat(fillsFilePath.c_str(), &buffer) == 0);
         fillsOutStream.open (fillsFilePath.c_str(), ios::out | ios::app | ios::binary);
-        if(!fillsFileExists) fillsOutStream << "type|date|ticker|ts_received|shares|price|exchange|liquidity|orderID|algo" << std::endl;
+        if(!fillsFileExists) fillsOutStream << JournalRecord::FILLS_HEADER << std::endl;
+
+        if (configured("journal-file")) {
+            string journalPath = string(getenv("EXEC_LOG_DIR")) + string("/") + journalFile;
+            if (!journal.open(journalPath, journalRing, journalFsync)) {
+                TAEL_PRINTF(&log, TAEL_ERROR, "Can't open journal %s: %s", journalPath.c_str(), strerror(errno));
+                return false;
+            }
+            TAEL_PRINTF(&log, TAEL_INFO, "Journaling fills, cost and order updates to %s", journalPath.c_str());
+        }
+
+        if (traceOnStart) clite::util::trace::start(traceRing);
 
 /*
         bool reportFileExists = (stat(reportFile.c_str(), &buffer) == 0);
@@ -259,6 +382,15 @@ struct hfcontext : public Configurable {
     }
 
     ~hfcontext () {
+        if (journal.enabled() || journal.failed()) {
+            journal.close();
+            if (journal.overflowCount())
+                TAEL_PRINTF(&log, TAEL_WARN, "Journal ring filled %lu times; consider a larger journal-ring-size",
+                        journal.overflowCount());
+            if (journal.failed())
+                TAEL_PRINTF(&log, TAEL_ERROR, "Journal write failed: %s; %lu records not journaled (see the text logs)",
+                        strerror(journal.error()), journal.lostCount());
+        }
     	fillsOutStream.close();
     }
 
@@ -66,6 +66,19 @@ namespace guillotine {
             //return ci.status_;
         }
 
+        void ClientInfo::req_handler::operator() ( const typed::trade_batch &req ) {
+            if (ci.status_ != open) {
+                typed::error e;
+                e.reason = typed::error::bad_message;
+                e.message_name = "trade-batch";
+                e.info = "Trade message sent without connect or after error.";
+                ci.sendm(typed::response(e));
+                ci.status_ = error;
+                return;
+            }
+            reqs.push_back(typed::request(req));
+        }
+
         void ClientInfo::req_handler::operator() ( const typed::stop &req ) {
             if (ci.status_ != open) {
                 typed::error e;
@@ -131,6 +144,69 @@ namespace guillotine {
         return status_;
     }
 
+    ClientInfo::status ClientInfo::send ( rspdeque &rsps, bool trimIrrelevantRsps, int *numOfRelRsps, int *relRspsSent, std::vector<bool>& sentToSomeClient) {
+    	std::deque<typed::response> relRsps;
+    	*numOfRelRsps = 0;
+    	*relRspsSent = 0;
+    	bool over = wtr->pending() >= max_pending;
+    	if (over && policy == disconnect) {
+    	    TAEL_PRINTF(&log, TAEL_ERROR, "Outbound buffer at %zu bytes (limit %zu), disconnecting slow client.",
+    	            wtr->pending(), max_pending);
+    	    status_ = error;
+    	    return status_;
+    	}
+    	int i = 0;
+        for (rspdeque::const_iterator r = rsps.begin(); r != rsps.end(); ++r, i++) {
+        	std::pair<bool, int> relevant = typed::isRelevant(this->client_id, this->listenToBcast, *r);
+        	if (trimIrrelevantRsps && !relevant.first) {
+        		if (log.configuration().threshold() >= TAEL_INFO) {
+        			std::string temp = typed::show(*r);
+        			TAEL_PRINTF(&log, TAEL_INFO, " Pruned response %s. It was directed to clientId %d and not %d", temp.c_str(), relevant.second, this->client_id);
+        		}
+        		continue;
+        	}
+        	sentToSomeClient[i] = true;
+        	(*numOfRelRsps)++;
+        	const typed::info *inf = boost::get<typed::info>(&*r);
+        	if (inf != 0 && (over || conflated.count(inf->symbol))) {
+        	    // keep ordering per symbol: once one info is held back, later
+        	    // ones for that symbol replace it rather than overtake it.
+        	    conflated[inf->symbol] = *inf;
+        	    continue;
+        	}
+        	relRsps.push_back(*r);
+        	if (log.configuration().threshold() >= TAEL_INFO) {
+        	    std::string temp = typed::show(*r);
+        	    TAEL_PRINTF(&log, TAEL_INFO, " -> %s", temp.c_str());
+        	}
+        }
+
+        if (!relRsps.empty()) {
+            ye.send(it_yaml(relRsps.begin()), it_yaml(relRsps.end()));
+            *relRspsSent = relRsps.size();
+        }
+        if (!conflated.empty()) {
+            TAEL_PRINTF(&log, TAEL_INFO, " Holding %zu conflated info responses, %zu bytes pending.",
+                    conflated.size(), wtr->pending());
+        }
+        return update_status();
+    }
+
+    ClientInfo::status ClientInfo::flush ( ) {
+        wtr->write_bytes();
+        if (!conflated.empty() && wtr->pending() < max_pending) {
+            std::deque<typed::response> infos;
+            for (std::map<std::string, typed::info>::const_iterator it = conflated.begin();
+                    it != conflated.end(); ++it) {
+                infos.push_back(typed::response(it->second));
+            }
+            conflated.clear();
+            TAEL_PRINTF(&log, TAEL_INFO, " -> %zu conflated info responses.", infos.size());
+            ye.send(it_yaml(infos.begin()), it_yaml(infos.end()));
+        }
+        return update_status();
+    }
+
 ServerThread::ServerThread ( mxdeque<typed::request> &reqx, mxdeque<typed::response> &rspx) :
     Configurable("server"), reqx(reqx), rspx(rspx),/* ld(&tael::FdLogger::stdoutLogger()),*/ log(*(new tael::LoggerConfiguration((size_t) MAX_BINARY_BUFFER_FILE_SIZE)))
 {
@@ -140,6 +216,8 @@ ServerThread::ServerThread ( mxdeque<typed::request> &reqx, mxdeque<typed::respo
     defOption("account", &account, "account name");
     defOption("password", &password, "password for account.");
     defOption("client-ip", &client_str, "Acceptable client IP addresses (any if unspecified)");
+    defOption("client-buffer-size", &max_pending, "outbound bytes queued per client before slow-client-policy applies", (size_t) (1 << 20));
+    defOption("slow-client-policy", &policystr, "what to do with clients over client-buffer-size: conflate (info responses) or disconnect", string("conflate"));
     
     SelectFactory::selectImp(SelectFactory::SelectEpoll);
     srv = new TCPServerSocket();
@@ -175,6 +253,14 @@ void *ServerThread::run ( ) {
     }
     log.addDestination(ld.get());
 
+    if (policystr == "disconnect") {
+        policy = ClientInfo::disconnect;
+    } else {
+        if (policystr != "conflate")
+            TAEL_PRINTF(&log, TAEL_ERROR, "Unknown slow-client-policy %s, using conflate.", policystr.c_str());
+        policy = ClientInfo::conflate;
+    }
+
     sel->add(srv, (SelectMode) (SelectRead | SelectWrite | SelectError));
     sel->settimeout(seltimeout);
 
@@ -226,9 +312,9 @@ void *ServerThread::run ( ) {
                                     filename.c_str(), addr, port);
                         }
                         boost::shared_ptr<tael::FdLogger> fld ( new tael::FdLogger(fd) );
-                        boost::shared_ptr<ClientInfo> ci ( new ClientInfo(ns, fld, account, password ) );
+                        boost::shared_ptr<ClientInfo> ci ( new ClientInfo(ns, fld, account, password, max_pending, policy ) );
                         clients.insert(make_pair(ns, ci));
-                        //ns->setNonBlock();
+                        ns->setNonBlock();
                         sel->add(ns, (SelectMode)(SelectRead | SelectError));
                         TAEL_PRINTF(&log, TAEL_INFO, "Accepted connection from %s:%u", addr, port);
                     }
@@ -247,7 +333,6 @@ void *ServerThread::run ( ) {
                         ClientInfo::status status = cit->second->receive(my_reqs);
                         switch (status) {
                             case ClientInfo::blocked:
-                                cit->second->wtr->write_bytes();
                             case ClientInfo::preopen:
                             case ClientInfo::open:
                                 n2 = my_reqs.size();
@@ -255,24 +340,25 @@ void *ServerThread::run ( ) {
                                     TAEL_PRINTF(&log, TAEL_INFO, "Client %s sends %d requests (%d prev in queue)",
                                             cit->second->name().c_str(), n2 - n, n);
                                 }
+                                // receive may have queued error responses
+                                watch(s, *cit->second);
                                 break;
                             case ClientInfo::error:
                                 TAEL_PRINTF(&log, TAEL_ERROR, "Client %s is confused, closing.", cit->second->name().c_str());
-                                sel->remove(s);
-                                s->close();
-                                clients.erase(cit);
-                                delete s;
+                                drop(cit);
                                 break;
                             case ClientInfo::closed:
                                 TAEL_PRINTF(&log, TAEL_INFO, "Client %s is leaving, closing.", cit->second->name().c_str());
-                                sel->remove(s);
-                                s->close();
-                                clients.erase(cit);
-                                delete s;
+                                drop(cit);
                                 break;
                         }
                     } else if (mode == SelectWrite && s_err == 0) {
-                        cit->second->wtr->write_bytes();
+                        if (cit->second->flush() == ClientInfo::error) {
+                            TAEL_PRINTF(&log, TAEL_ERROR, "Client %s write failed, closing.", cit->second->name().c_str());
+                            drop(cit);
+                        } else {
+                            watch(s, *cit->second);
+                        }
                     } else {
                         char *my_errbuf = strerror_r(s_err, errbuf, errbufLen);
                         if (my_errbuf == 0) 
@@ -281,10 +367,7 @@ void *ServerThread::run ( ) {
                         else
                             TAEL_PRINTF(&log, TAEL_ERROR, "Client %s error: %s",
                                     cit->second->name().c_str(), my_errbuf);
-                        sel->remove(s);
-                        s->close();
-                        clients.erase(cit);
-                        delete s;
+                        drop(cit);
                     }
                 } else {
                     TAEL_PRINTF(&log, TAEL_ERROR, "Select returned surprise socket FD #%d", s->getFD());
@@ -316,14 +399,21 @@ void ServerThread::handleInteract() {
         int total;
         int sent;
         std::vector<bool> sentToSomeClient(my_rsps.size(), false);
+        std::vector<cmap::iterator> failed;
         for (cmap::iterator cit = clients.begin(); cit != clients.end(); ++cit) {
             if (cit->second->account() == account && cit->second->status_ == ClientInfo::open) {
-                if (cit->second->send(my_rsps, true, &total, &sent, sentToSomeClient) != ClientInfo::error)
-                    TAEL_PRINTF(&log, TAEL_INFO, "Sent %d responses to client %s.", sent, cit->second->name().c_str());
-                else
-                    TAEL_PRINTF(&log, TAEL_ERROR, "Failed to send all %d responses to client %s. Only %d sent.", total, cit->second->name().c_str(), sent);
+                if (cit->second->send(my_rsps, true, &total, &sent, sentToSomeClient) != ClientInfo::error) {
+                    TAEL_PRINTF(&log, TAEL_INFO, "Sent %d responses to client %s (%d conflated).", sent, cit->second->name().c_str(), total - sent);
+                    watch(cit->first, *cit->second);
+                } else {
+                    TAEL_PRINTF(&log, TAEL_ERROR, "Failed to send all %d responses to client %s, closing.", total, cit->second->name().c_str());
+                    failed.push_back(cit);
+                }
             }
         }
+        for (std::vector<cmap::iterator>::iterator fit = failed.begin(); fit != failed.end(); ++fit) {
+            drop(*fit);
+        }
         for (unsigned int i = 0; i < my_rsps.size(); i++) {
         	if(sentToSomeClient[i] == false) {
         		TAEL_PRINTF(&log, TAEL_CRITICAL, "Failed to send some response to any client. Possible error or disconnection.");
@@ -333,6 +423,25 @@ void ServerThread::handleInteract() {
     }
 }
 
+// Only ask for SelectWrite while there is something queued, otherwise epoll
+// would wake us up continuously for every idle client.
+void ServerThread::watch ( Socket *s, ClientInfo &ci ) {
+    bool want = ci.wants_write();
+    if (want == ci.write_watched) return;
+    sel->remove(s);
+    sel->add(s, want? (SelectMode)(SelectRead | SelectWrite | SelectError)
+                    : (SelectMode)(SelectRead | SelectError));
+    ci.write_watched = want;
+}
+
+void ServerThread::drop ( cmap::iterator cit ) {
+    Socket *s = cit->first;
+    sel->remove(s);
+    s->close();
+    clients.erase(cit);
+    delete s;
+}
+
 void ServerThread::closeout ( ) {
     /*
     for (cmap::iterator cit = clients.begin(); cit != clients.end(); ++cit) {
@@ -19,6 +19,7 @@ using trc::compat::util::Thread;
 #include <boost/variant.hpp>
 #include <boost/shared_array.hpp>
 #include <functional>
+#include <map>
 
 using namespace trc;
 
@@ -55,12 +56,26 @@ struct ClientInfo {
         closed
     } status_;
 
+    // What to do with a client whose outbound buffer has grown past
+    // max_pending bytes because it isn't reading fast enough.
+    //   conflate   -- hold back info responses, keeping only the latest one
+    //                 per symbol, and send them once the buffer drains.
+    //                 Everything else is still queued, up to
+    //                 HARD_LIMIT_FACTOR * max_pending, past which we give up.
+    //   disconnect -- drop the client.
+    enum overflow_policy {
+        conflate,
+        disconnect
+    };
+    static const size_t HARD_LIMIT_FACTOR = 4;
+
     struct req_handler : public boost::static_visitor<> {
         ClientInfo &ci;
         reqdeque &reqs;
         req_handler(ClientInfo &ci, reqdeque &reqs ) : ci(ci), reqs(reqs) { }
         void operator() ( const typed::connect &req );
         void operator() ( const typed::trade &req );
+        void operator() ( const typed::trade_batch &req );
         void operator() ( const typed::stop &req );
         void operator() ( const typed::halt &req );
         void operator() ( const typed::resume &req );
@@ -94,14 +109,21 @@ struct ClientInfo {
     status sendm ( const typed::response &m ) {
     	std::string temp = typed::show(m);
         TAEL_PRINTF(&log, TAEL_INFO, " -> %s", temp.c_str());
-        if (ye.send(typed::put_message(m)) == 1)
-            status_ = open;
-        else if (wtr->error())
+        ye.send(typed::put_message(m));
+        return update_status();
+    }
+
+    status update_status ( ) {
+        if (wtr->error())
             status_ = error;
-        else 
-            status_ = blocked;
+        else if (wtr->pending() > HARD_LIMIT_FACTOR * max_pending) {
+            TAEL_PRINTF(&log, TAEL_ERROR, "Outbound buffer at %zu bytes (limit %zu), giving up on client.",
+                    wtr->pending(), HARD_LIMIT_FACTOR * max_pending);
+            status_ = error;
+        }
         return status_;
     }
+
     Socket *s;
 
     bool listenToBcast;
@@ -115,6 +137,11 @@ struct ClientInfo {
     yaml::parser yp;
     yaml::emitter ye;
 
+    size_t max_pending;
+    overflow_policy policy;
+    std::map<std::string, typed::info> conflated;
+    bool write_watched;
+
     boost::shared_ptr<tael::LoggerDestination> ld;
     tael::Logger log;
 
@@ -123,11 +150,13 @@ struct ClientInfo {
     const std::string &name() const { return client_name; }
     const int &id() const { return client_id; }
     const std::string &account() const { return account_; }
+    bool wants_write() const { return wtr->pending() > 0 || !conflated.empty(); }
     ClientInfo ( Socket *s, boost::shared_ptr<tael::LoggerDestination> ld,
-            const std::string &acct, const std::string &pass ) : status_(preopen),
+            const std::string &acct, const std::string &pass,
+            size_t max_pending, overflow_policy policy ) : status_(preopen),
         s(s), account_(acct), password_(pass),
         rdr(new yaml::socket_reader(s)), wtr(new yaml::socket_writer(s)),
-        yp(rdr), ye(wtr),
+        yp(rdr), ye(wtr), max_pending(max_pending), policy(policy), write_watched(false),
         ld(ld), log(*(new tael::LoggerConfiguration((size_t) MAX_BINARY_BUFFER_FILE_SIZE)))
     { 
     	client_id = getNextClientInfoId();
@@ -138,35 +167,8 @@ struct ClientInfo {
     typedef boost::transform_iterator<rsp_to_yaml, std::deque<typed::response>::iterator> it_yaml;
 
     status receive ( reqdeque &reqs );
-    status send    ( rspdeque &rsps, bool trimIrrelevantRsps, int *numOfRelRsps, int *relRspsSent, std::vector<bool>& sentToSomeClient) {
-    	std::deque<typed::response> relRsps;
-    	*numOfRelRsps = 0;
-    	int i = 0;
-        for (rspdeque::const_iterator r = rsps.begin(); r != rsps.end(); ++r, i++) {
-        	std::pair<bool, int> relevant = typed::isRelevant(this->client_id, this->listenToBcast, *r);
-        	if (trimIrrelevantRsps && !relevant.first) {
-        		std::string temp = typed::show(*r);
-        		TAEL_PRINTF(&log, TAEL_INFO, " Pruned response %s. It was directed to clientId %d and not %d", temp.c_str(), relevant.second, this->client_id);
-        		continue;
-        	}
-        	relRsps.push_back(*r);
-        	sentToSomeClient[i] = true;
-        	std::string temp = typed::show(*r);
-            TAEL_PRINTF(&log, TAEL_INFO, " -> %s", temp.c_str());
-            (*numOfRelRsps)++;
-        }
-
-        *relRspsSent = ye.send(it_yaml(relRsps.begin()), it_yaml(relRsps.end()));
-        if (*relRspsSent != *numOfRelRsps) {
-            if (wtr->error())
-                status_ = error;
-            else 
-                status_ = blocked;
-        } else {
-            status_ = open;
-        }
-        return status_;
-    }
+    status flush   ( );
+    status send    ( rspdeque &rsps, bool trimIrrelevantRsps, int *numOfRelRsps, int *relRspsSent, std::vector<bool>& sentToSomeClient);
 
     ~ClientInfo ( ) 
     {
@@ -193,6 +195,9 @@ class ServerThread : public Thread, public Configurable {
     std::string sdebugfile, tdebugfile;
     std::string account;
     std::string password;
+    size_t max_pending;
+    std::string policystr;
+    ClientInfo::overflow_policy policy;
 
     typedef std::map<Socket *, boost::shared_ptr<ClientInfo> > cmap;
     cmap clients;
@@ -214,6 +219,8 @@ class ServerThread : public Thread, public Configurable {
         virtual void *onKill ();
         void closeout ();
         void handleInteract ();
+        void watch ( Socket *s, ClientInfo &ci );
+        void drop ( cmap::iterator cit );
     bool allow_ip(const struct sockaddr_in *sin);
 
     public: 
@@ -22,6 +22,9 @@ namespace guillotine { namespace server {
         static const int IgnoreTickCode = 1500;
         static const int SyncUpdateCode = 1600;
         static const int OrderProbCode = 1700;
+        static const int LatencyCode = 1800;
+        static const int ProfileCode = 1900;
+        static const int TraceCode = 2000;
     }
 }
 }
@@ -0,0 +1,197 @@
+#include "Journal.h"
+
+#include <DataUpdates.h>
+#include <Markets.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace guillotine { namespace server {
+
+// records are written raw; keep the layout from drifting silently.
+typedef char journal_record_is_128_bytes[sizeof(JournalRecord) == 128 ? 1 : -1];
+
+const char *JournalRecord::JOURNAL_MAGIC = "GTJRNL";
+const char *JournalRecord::FILLS_HEADER = "type|date|ticker|ts_received|shares|price|exchange|liquidity|orderID|algo";
+
+namespace {
+    void copystr ( char *dst, const char *src, size_t n ) {
+        strncpy(dst, src, n - 1);
+        dst[n - 1] = '\0';
+    }
+
+    int64_t now_us ( ) {
+        struct timeval tv;
+        gettimeofday(&tv, 0);
+        return tv.tv_sec * (int64_t) 1000000 + tv.tv_usec;
+    }
+}
+
+JournalRecord::JournalRecord ( Type t, int64_t usec, int date, const char *sym ) {
+    memset(this, 0, sizeof(*this));
+    type = t;
+    this->usec = usec;
+    this->date = date;
+    copystr(symbol, sym, sizeof(symbol));
+}
+
+JournalRecord JournalRecord::header ( ) {
+    JournalRecord r(HEADER, now_us(), 0, JOURNAL_MAGIC);
+    r.seqnum = VERSION;
+    return r;
+}
+
+JournalRecord JournalRecord::order ( const OrderUpdate &ou, int date, const char *sym ) {
+    JournalRecord r(ORDER, ou.tv().count() / 1000, date, sym);
+    copystr(r.ecn, ECN::desc(ou.ecn()), sizeof(r.ecn));
+    r.dir = ou.dir();
+    r.action = ou.action();
+    r.error = ou.error();
+    r.inv = ou.invisible();
+    r.qty = ou.thisShares();
+    r.price = ou.thisPrice();
+    r.pos = ou.sharesOpen();
+    r.size = ou.size();
+    r.limit = ou.price();
+    r.timeout = ou.timeout();
+    r.seqnum = ou.id();
+    r.orderID = ou.exchangeID();
+    return r;
+}
+
+int JournalRecord::snprint ( char *buf, int n ) const {
+    switch (type) {
+        case FILL:
+            return snprintf(buf, n, "FILL %s %s %d@%.2f (%.2f,%.2f) %c (orderID: %ld, seqnum: %d) Algo: %s",
+                    symbol, ecn, qty, price, bid, ask, liq, (long) orderID, seqnum, algo);
+        case REQ:
+            return snprintf(buf, n, "REQ %s currPos: %d qty: %d at aggr %.3f (%.2f,%.2f) [orderID: %ld]",
+                    symbol, pos, qty, aggr, bid, ask, (long) orderID);
+        case STOP:
+            return snprintf(buf, n, "REQ %s pos: %d (qtyLeft: %d) (%.2f,%.2f) #stop",
+                    symbol, pos, qty, bid, ask);
+        case IMPLICIT:
+            return snprintf(buf, n, "REQ %s %d %d %d %.3f %.2f %.2f # implicit update due to %d fill",
+                    symbol, target, target + qty, pos, aggr, bid, ask, qty);
+        case ORDER:
+            return snprintf(buf, n, "Order %10ld.%06ld: %5s %4s %4s %4d@%8.2f (%4d/%4d %8.2f) %6s/%7s %4ds %c [%d/E:%ld]",
+                    (long) (usec / 1000000), (long) (usec % 1000000), symbol, ecn,
+                    Mkt::TradeDesc[dir], qty, price, pos, size, limit,
+                    Mkt::OrderActionDesc[action], Mkt::OrderResultDesc[error],
+                    timeout, inv? 'I':'V', seqnum, (long) orderID);
+        case HEADER:
+            return snprintf(buf, n, "%s v%d", symbol, seqnum);
+    }
+    return snprintf(buf, n, "?? record type %d", type);
+}
+
+std::ostream &JournalRecord::printFill ( std::ostream &os ) const {
+    return os << "F|" << date << "|" << symbol << "|" << (long) (usec / 1000)
+              << "|" << qty << "|" << price << "|" << ecn
+              << "|" << liq << "|" << (long) orderID << "|" << algo << std::endl;
+}
+
+void JournalRing::init ( size_t capacity ) {
+    size_t sz = 1;
+    while (sz < capacity) sz <<= 1;
+    buf.resize(sz, JournalRecord::header());
+    mask = sz - 1;
+    head = tail = 0;
+}
+
+bool Journal::open ( const std::string &path_, size_t ringsz, int fsync_ms_ ) {
+    path = path_;
+    fsync_ms = fsync_ms_;
+    ring.init(ringsz);
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) return false;
+    // a crash mid-write can leave part of a record; appending after it would
+    // misalign everything that follows.
+    struct stat st;
+    if (fstat(fd, &st) < 0) { ::close(fd); fd = -1; return false; }
+    size = st.st_size - st.st_size % (off_t) sizeof(JournalRecord);
+    if (size != st.st_size && ftruncate(fd, size) < 0) { ::close(fd); fd = -1; return false; }
+    stopping = false;
+    failed_ = false;
+    errno_ = 0;
+    lost = 0;
+    append(JournalRecord::header());
+    start();
+    return true;
+}
+
+void Journal::close ( ) {
+    if (fd < 0) return;
+    stopping = true;
+    void *vp;
+    join(vp);
+    ::close(fd);
+    fd = -1;
+}
+
+void Journal::append ( const JournalRecord &r ) {
+    if (ring.push(r)) return;
+    ++overflows;
+    while (!ring.push(r)) sched_yield();
+}
+
+bool Journal::write_run ( const JournalRecord *p, size_t n ) {
+    const char *b = (const char *) p;
+    size_t left = n * sizeof(JournalRecord);
+    while (left > 0) {
+        ssize_t w = ::write(fd, b, left);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            errno_ = errno;
+            // drop whatever part of the run made it out; should even that
+            // fail, the next open() cuts the partial record off.
+            if (ftruncate(fd, size) < 0) { }
+            return false;
+        }
+        b += w;
+        left -= w;
+    }
+    size += n * sizeof(JournalRecord);
+    return true;
+}
+
+void *Journal::run ( ) {
+    int64_t last_sync = now_us();
+    bool dirty = false;
+    while (true) {
+        bool done = stopping;
+        const JournalRecord *p;
+        size_t n;
+        // drain everything queued so far; the ring wraps at most once per pass.
+        while ((n = ring.peek(p)) > 0) {
+            if (!failed_ && !write_run(p, n)) {
+                __sync_synchronize();
+                failed_ = true;
+            }
+            if (failed_) {
+                // keep draining so append() never wedges the trading thread.
+                lost = lost + n;
+            } else {
+                dirty = true;
+            }
+            ring.consume(n);
+        }
+        int64_t t = now_us();
+        if (dirty && (done || t - last_sync >= fsync_ms * (int64_t) 1000)) {
+            fdatasync(fd);
+            last_sync = t;
+            dirty = false;
+        }
+        if (done) break;
+        usleep(1000);
+    }
+    return 0;
+}
+
+}}
@@ -0,0 +1,160 @@
+#ifndef __GUILLOTINE_JOURNAL_H__
+#define __GUILLOTINE_JOURNAL_H__
+
+#include <c_util/Thread.h>
+using trc::compat::util::Thread;
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <string>
+#include <vector>
+#include <ostream>
+
+class OrderUpdate;
+
+namespace guillotine { namespace server {
+
+/** Fixed-size binary record of the fills / cost / order journal.
+  *
+  * One layout serves every record type; which fields mean what:
+  *   FILL      symbol ecn algo liq qty(signed fill size) price bid ask orderID seqnum
+  *   REQ       symbol pos qty aggr bid ask orderID
+  *   STOP      symbol pos qty(qty left) bid ask
+  *   IMPLICIT  symbol target(old target) qty(delta) pos aggr bid ask
+  *   ORDER     an OrderUpdate: symbol ecn dir action error inv qty(this shares)
+  *             price(this price) pos(shares open) size limit timeout seqnum
+  *             orderID(exchange id)
+  * usec is the DataManager time of the event (the OrderUpdate's own time for
+  * ORDER records).  The file starts with a HEADER record whose symbol is
+  * JOURNAL_MAGIC and seqnum the layout version.
+  */
+struct JournalRecord {
+    enum Type { HEADER = 0, FILL, REQ, STOP, IMPLICIT, ORDER };
+
+    uint8_t type;
+    char    liq;
+    uint8_t action, error;
+    uint8_t dir, inv;
+    uint16_t pad0;
+    int64_t usec;
+    int64_t orderID;
+    double  price, limit, aggr, bid, ask;
+    int32_t date;
+    int32_t qty, pos, target, seqnum;
+    int32_t size, timeout;
+    char    symbol[12];
+    char    ecn[8];
+    char    algo[12];
+    char    pad1[4];
+
+    static const char *JOURNAL_MAGIC;
+    static const int VERSION = 1;
+
+    JournalRecord ( Type t, int64_t usec, int date, const char *sym );
+
+    static JournalRecord header ( );
+    static JournalRecord order ( const OrderUpdate &ou, int date, const char *sym );
+
+    /// Text of the cost-log (FILL, REQ, STOP, IMPLICIT) or server-log (ORDER)
+    /// line for this record, without the logger's time/level prefix.
+    int snprint ( char *buf, int n ) const;
+    /// Line of the pipe-delimited fills file (FILL records only).
+    std::ostream &printFill ( std::ostream &os ) const;
+    static const char *FILLS_HEADER;
+};
+
+/** Single-producer single-consumer ring of records.
+  *
+  * The producer (trading thread) only writes head, the consumer (journal
+  * writer) only writes tail; the barriers order the slot contents against the
+  * index updates.  Capacity is rounded up to a power of two.
+  */
+class JournalRing {
+    std::vector<JournalRecord> buf;
+    size_t mask;
+    volatile size_t head;
+    char pad[64];
+    volatile size_t tail;
+
+    public:
+    JournalRing ( ) : mask(0), head(0), tail(0) { }
+    void init ( size_t capacity );
+
+    bool push ( const JournalRecord &r ) {
+        size_t h = head;
+        if (h - tail > mask) return false;
+        buf[h & mask] = r;
+        __sync_synchronize();
+        head = h + 1;
+        return true;
+    }
+
+    /// Longest contiguous run of records ready to be consumed.
+    size_t peek ( const JournalRecord *&p ) {
+        size_t t = tail;
+        size_t n = head - t;
+        __sync_synchronize();
+        size_t off = t & mask;
+        if (n > buf.size() - off) n = buf.size() - off;
+        p = &buf[off];
+        return n;
+    }
+    void consume ( size_t n ) {
+        __sync_synchronize();
+        tail = tail + n;
+    }
+    bool empty ( ) const { return head == tail; }
+};
+
+/** Binary journal written off the trading thread.
+  *
+  * append() copies a record into the ring and returns.  A writer thread
+  * drains whatever is in the ring with one write() per contiguous run (so a
+  * burst of fills costs one syscall, not one per fill) and fdatasync()s at
+  * most every fsync-interval ms while there is unsynced data.  Records are
+  * never dropped for space: if the ring is full append() spins until the
+  * writer makes room, and counts how often that happened.
+  *
+  * The file only ever holds whole records.  A short write is retried for the
+  * rest of the run; a write error cuts the file back to the last whole
+  * record and stops journaling: failed() turns on, enabled() off, and the
+  * writer keeps draining the ring, counting what it could not write in
+  * lostCount().  Callers fall back to their text output.
+  */
+class Journal : public Thread {
+    JournalRing ring;
+    int fd;
+    int fsync_ms;
+    volatile bool stopping;
+    unsigned long overflows;
+    volatile bool failed_;
+    volatile int errno_;
+    volatile unsigned long lost;
+    off_t size;     // bytes of whole records in the file
+    std::string path;
+
+    bool write_run ( const JournalRecord *p, size_t n );
+
+    protected:
+    virtual void *run ( );
+
+    public:
+    Journal ( ) : fd(-1), fsync_ms(1000), stopping(false), overflows(0),
+                  failed_(false), errno_(0), lost(0), size(0) { }
+    virtual ~Journal ( ) { close(); }
+
+    bool open ( const std::string &path, size_t ringsz, int fsync_ms );
+    void close ( );
+    bool enabled ( ) const { return fd >= 0 && !failed_; }
+    unsigned long overflowCount ( ) const { return overflows; }
+    /// A write failed; error() is its errno, lostCount() the records not written.
+    bool failed ( ) const { return failed_; }
+    int error ( ) const { return errno_; }
+    unsigned long lostCount ( ) const { return lost; }
+
+    void append ( const JournalRecord &r );
+};
+
+}}
+
+#endif
@@ -0,0 +1,89 @@
+// Renders a gt-server binary journal (hf.journal-file) as the text files the
+// server writes when it is not journaling, so existing tools keep working:
+//
+//     gt-journal fills  FILE   fills file: header line plus one F|... line per fill
+//     gt-journal cost   FILE   cost log: REQ / FILL lines, analyze_costs.py format
+//     gt-journal orders FILE   order-update lines, as in the server log
+//     gt-journal all    FILE   every record, cost and order lines interleaved
+//
+// The time prefix on cost/order lines is the record's event time (data
+// manager time), where the live text log has the logger's wall-clock time.
+
+#include "Journal.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+using namespace guillotine::server;
+using namespace std;
+
+static void print_line ( const JournalRecord &r ) {
+    char buf[256];
+    time_t sec = (time_t) (r.usec / 1000000);
+    struct tm tm;
+    localtime_r(&sec, &tm);
+    strftime(buf, sizeof(buf), "%Y/%m/%d %H:%M:%S", &tm);
+    cout << buf;
+    snprintf(buf, sizeof(buf), ".%06ld INFO ", (long) (r.usec % 1000000));
+    cout << buf;
+    r.snprint(buf, sizeof(buf));
+    cout << buf << '\n';
+}
+
+int main ( int argc, char **argv ) {
+
+    if (argc != 3 || (strcmp(argv[1], "fills") && strcmp(argv[1], "cost")
+                && strcmp(argv[1], "orders") && strcmp(argv[1], "all"))) {
+        cerr << "usage: " << argv[0] << " fills|cost|orders|all JOURNAL" << endl;
+        return 1;
+    }
+    string mode(argv[1]);
+
+    FILE *f = fopen(argv[2], "rb");
+    if (!f) {
+        cerr << "Can't open " << argv[2] << ": " << strerror(errno) << endl;
+        return 1;
+    }
+
+    if (mode == "fills") cout << JournalRecord::FILLS_HEADER << '\n';
+
+    JournalRecord r(JournalRecord::HEADER, 0, 0, "");
+    long n = 0;
+    bool seen_header = false;
+    while (fread(&r, sizeof(r), 1, f) == 1) {
+        ++n;
+        switch (r.type) {
+            case JournalRecord::HEADER:
+                // a file appended to by several server runs has one per run.
+                if (strcmp(r.symbol, JournalRecord::JOURNAL_MAGIC) || r.seqnum != JournalRecord::VERSION) {
+                    cerr << argv[2] << ": record " << n << ": bad journal header" << endl;
+                    return 1;
+                }
+                seen_header = true;
+                break;
+            case JournalRecord::FILL:
+                if (mode == "fills") r.printFill(cout);
+                else if (mode != "orders") print_line(r);
+                break;
+            case JournalRecord::ORDER:
+                if (mode == "orders" || mode == "all") print_line(r);
+                break;
+            default:
+                if (mode == "cost" || mode == "all") print_line(r);
+                break;
+        }
+        if (!seen_header) {
+            cerr << argv[2] << ": not a gt-server journal" << endl;
+            return 1;
+        }
+    }
+    if (ferror(f)) {
+        cerr << argv[2] << ": read error after " << n << " records" << endl;
+        return 1;
+    }
+    fclose(f);
+    return 0;
+}
@@ -0,0 +1,277 @@
+// Load generator and end-to-end latency benchmark for the guillotine TCP
+// protocol.
+//
+// Opens N client connections to a gt-server and sends trade / stop / status
+// messages at configured per-connection rates, then reports latency
+// percentiles for
+//   ack        trade sent -> the info carrying its orderID (the server
+//              answers a trade with an info once the trading thread has
+//              picked the request up)
+//   first-fill trade sent -> first fill carrying its orderID
+// Stop and status messages add load but aren't timed: their infos carry no
+// orderID to match them by.  Trades whose info was conflated away by a
+// backed-up server are counted as unacked.
+//
+// Intended to be pointed at a server running on historical data with the
+// simulated trader, so no outside services are needed, e.g.
+//     gt-server -C gt.cfg --live-data=0 --start-date=20100104 \
+//               --trade-type=sim --sim-trade-file=sim.cfg
+//     gt-loadgen --port=... --account=... --password=... \
+//               --connections=8 --trade-rate=50 --duration=60
+//
+// Results are printed as a whitespace separated table (one row per metric,
+// latencies in microseconds) to stdout and, optionally, to --results-file so
+// runs can be compared across commits.
+
+#include <guillotine/yaml_message.h>
+#include <guillotine/typed_message.h>
+
+#include <Configurable.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/lexical_cast.hpp>
+#include <Util/Socket.h>
+#include <Util/SelectFactory.h>
+
+#include <sys/time.h>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <vector>
+#include <map>
+
+using namespace guillotine;
+using namespace std;
+
+namespace {
+
+    int64_t now_us ( ) {
+        struct timeval tv;
+        gettimeofday(&tv, 0);
+        return tv.tv_sec * (int64_t) 1000000 + tv.tv_usec;
+    }
+
+    struct latencies {
+        std::string name;
+        std::vector<int64_t> us;
+        latencies ( const std::string &n ) : name(n) { }
+
+        int64_t pct ( double p ) {
+            if (us.empty()) return 0;
+            size_t ix = std::min(us.size() - 1, (size_t) (p * us.size()));
+            return us[ix];
+        }
+        void print ( std::ostream &os ) {
+            std::sort(us.begin(), us.end());
+            os << name << " " << us.size() << " " << pct(0.5) << " " << pct(0.9) << " "
+               << pct(0.99) << " " << pct(0.999) << " " << (us.empty()? 0 : us.back()) << std::endl;
+        }
+    };
+
+    // shared across connections: fills are broadcast, so any connection may
+    // see the first fill for an order.
+    struct results {
+        latencies ack, fill;
+        std::map<long, int64_t> pending_acks, open_orders;
+        long sent, received, errors;
+        results ( ) : ack("ack"), fill("first-fill"), sent(0), received(0), errors(0) { }
+    };
+
+    struct connection {
+        TCPSocket *s;
+        boost::shared_ptr<yaml::socket_reader> rdr;
+        boost::shared_ptr<yaml::socket_writer> wtr;
+        yaml::parser yp;
+        yaml::emitter ye;
+        bool connected;
+        int64_t next_trade, next_stop, next_status;
+        results &res;
+
+        connection ( TCPSocket *s, results &res ) : s(s),
+            rdr(new yaml::socket_reader(s)), wtr(new yaml::socket_writer(s)),
+            yp(rdr), ye(wtr), connected(false),
+            next_trade(0), next_stop(0), next_status(0), res(res) { }
+
+        bool send ( const typed::message &m ) {
+            ++res.sent;
+            return ye.send(typed::put_message(m)) == 1 || !wtr->error();
+        }
+
+        void operator() ( yaml::message &m ) {
+            int64_t t = now_us();
+            ++res.received;
+            try {
+                typed::message msg(typed::get_message(m, 0));
+                if (typed::server *sv = boost::get<typed::server>(&msg)) {
+                    connected = true;
+                    if (symbols.empty())
+                        symbols.assign(sv->symbols.begin(), sv->symbols.end());
+                } else if (typed::info *inf = boost::get<typed::info>(&msg)) {
+                    std::map<long, int64_t>::iterator it = res.pending_acks.find(inf->orderID);
+                    if (it != res.pending_acks.end()) {
+                        res.ack.us.push_back(t - it->second);
+                        res.pending_acks.erase(it);
+                    }
+                } else if (typed::fill *f = boost::get<typed::fill>(&msg)) {
+                    std::map<long, int64_t>::iterator it = res.open_orders.find(f->orderID);
+                    if (it != res.open_orders.end()) {
+                        res.fill.us.push_back(t - it->second);
+                        res.open_orders.erase(it);
+                    }
+                } else if (boost::get<typed::error>(&msg)) {
+                    ++res.errors;
+                }
+            } catch (typed::parse_error &pe) {
+                ++res.errors;
+            }
+        }
+
+        std::vector<std::string> symbols;
+    };
+}
+
+int main ( int argc, char **argv ) {
+
+    CmdLineFileConfig cfg(argc, argv, "config,C");
+    bool help;
+    string host, account, password, resfile;
+    int port, nconn, qty, duration;
+    double trade_rate, stop_rate, status_rate, aggr;
+    vector<string> syms;
+
+    cfg.defOption("help,h", &help, "print this help message");
+    cfg.defOption("host", &host, "gt-server host", string("localhost"));
+    cfg.defOption("port", &port, "gt-server port");
+    cfg.defOption("account", &account, "account name");
+    cfg.defOption("password", &password, "password for account");
+    cfg.defOption("connections", &nconn, "number of client connections", 1);
+    cfg.defOption("trade-rate", &trade_rate, "trade messages per second per connection", 10.0);
+    cfg.defOption("stop-rate", &stop_rate, "stop messages per second per connection", 0.0);
+    cfg.defOption("status-rate", &status_rate, "status messages per second per connection", 0.0);
+    cfg.defOption("qty", &qty, "max |qty| of each trade (sign alternates)", 100);
+    cfg.defOption("aggr", &aggr, "aggressiveness of each trade", 5.0);
+    cfg.defOption("symbol", &syms, "symbols to trade (default: all the server offers)");
+    cfg.defOption("duration", &duration, "seconds to send for", 30);
+    cfg.defOption("results-file", &resfile, "append results table here");
+
+    if (!cfg.configure()) { cerr << cfg << endl; return 1; }
+    if (help) { cerr << cfg << endl; return 1; }
+
+    results res;
+    vector<boost::shared_ptr<connection> > conns;
+    map<Socket *, connection *> bysock;
+    SelectFactory::selectImp(SelectFactory::SelectEpoll);
+    Select *sel = SelectFactory::getInstance();
+    sel->settimeout(1);
+
+    for (int i = 0; i < nconn; ++i) {
+        TCPSocket *s = new TCPSocket();
+        if (!s->Connect(host.c_str(), port)) {
+            cerr << "Connection " << i << " to " << host << ":" << port << " failed." << endl;
+            return 1;
+        }
+        boost::shared_ptr<connection> c(new connection(s, res));
+        c->symbols = syms;
+        typed::connect cm;
+        cm.account = account;
+        cm.password = password;
+        cm.name = "loadgen-" + boost::lexical_cast<string>(i);
+        cm.clientId = 0;
+        cm.listenToBcast = 1;
+        c->send(typed::message(cm));
+        conns.push_back(c);
+        bysock[s] = c.get();
+        sel->add(s, (SelectMode)(SelectRead | SelectError));
+    }
+
+    int64_t start = now_us();
+    int64_t stop_at = start + duration * (int64_t) 1000000;
+    int64_t drain_until = stop_at + 2000000;
+    int64_t trade_iv = trade_rate > 0 ? (int64_t) (1e6 / trade_rate) : 0;
+    int64_t stop_iv = stop_rate > 0 ? (int64_t) (1e6 / stop_rate) : 0;
+    int64_t status_iv = status_rate > 0 ? (int64_t) (1e6 / status_rate) : 0;
+    long orderID = 1;
+    size_t symix = 0;
+
+    while (now_us() < drain_until && !conns.empty()) {
+        int64_t t = now_us();
+        for (size_t i = 0; i < conns.size() && t < stop_at; ++i) {
+            connection &c = *conns[i];
+            if (!c.connected || c.symbols.empty()) continue;
+            const string *si = &c.symbols[symix++ % c.symbols.size()];
+
+            if (trade_iv && t >= c.next_trade) {
+                typed::trade tr;
+                tr.symbol = *si;
+                tr.aggr = aggr;
+                tr.orderID = orderID++;
+                tr.qty = (tr.orderID % 2 ? 1 : -1) * (1 + rand() % qty);
+                tr.short_mark = typed::trade::unknown;
+                tr.clientId = 0;
+                res.pending_acks[tr.orderID] = t;
+                res.open_orders[tr.orderID] = t;
+                c.send(typed::message(tr));
+                c.next_trade = t + trade_iv;
+            }
+            if (stop_iv && t >= c.next_stop) {
+                typed::stop st;
+                st.all = false;
+                st.symbols.push_back(*si);
+                st.clientId = 0;
+                c.send(typed::message(st));
+                c.next_stop = t + stop_iv;
+            }
+            if (status_iv && t >= c.next_status) {
+                typed::status st;
+                st.all = false;
+                st.symbols.push_back(*si);
+                st.clientId = 0;
+                c.send(typed::message(st));
+                c.next_status = t + status_iv;
+            }
+        }
+
+        Socket *s;
+        SelectMode mode;
+        while ((s = sel->next(&mode)) != 0) {
+            map<Socket *, connection *>::iterator it = bysock.find(s);
+            if (it == bysock.end()) continue;
+            if (mode != SelectRead || it->second->rdr->eof()) {
+                cerr << "Server dropped a connection." << endl;
+                sel->remove(s);
+                for (size_t i = 0; i < conns.size(); ++i)
+                    if (conns[i].get() == it->second) {
+                        conns.erase(conns.begin() + i);
+                        break;
+                    }
+                bysock.erase(it);
+                s->close();
+                delete s;
+                continue;
+            }
+            it->second->yp.receive(*it->second);
+        }
+    }
+
+    double secs = (now_us() - start) / 1e6;
+    cerr << "sent " << res.sent << " messages, received " << res.received
+         << " responses (" << res.errors << " errors, " << res.pending_acks.size()
+         << " trades unacked) in " << secs << "s" << endl;
+
+    cout << "# metric count p50 p90 p99 p999 max (us)" << endl;
+    res.ack.print(cout);
+    res.fill.print(cout);
+    if (!resfile.empty()) {
+        ofstream out(resfile.c_str(), ios::out | ios::app);
+        res.ack.print(out);
+        res.fill.print(out);
+    }
+
+    for (size_t i = 0; i < conns.size(); ++i) {
+        conns[i]->s->close();
+        delete conns[i]->s;
+    }
+    delete sel;
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Load-test client that deliberately reads slowly, to exercise the server's
+// per-client outbound buffering and slow-client-policy.
+//
+// It connects, asks for status on all symbols every request-interval, and
+// drains its socket only read-chunk bytes at a time with read-delay between
+// reads.  A small SO_RCVBUF makes the server's queue back up quickly.
+//
+// usage: gt-slowclient host port account password
+//            [request-interval-ms=100] [read-delay-ms=50] [read-chunk=512] [rcvbuf=4096]
+
+#include <guillotine/yaml_message.h>
+#include <guillotine/typed_message.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/lexical_cast.hpp>
+#include <Util/Socket.h>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <cstring>
+#include <iostream>
+
+using namespace guillotine;
+using namespace std;
+
+static double now_ms ( ) {
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+int main ( int argc, char **argv ) {
+
+    if (argc < 5) {
+        cerr << "usage: " << argv[0] << " host port account password"
+             << " [request-interval-ms] [read-delay-ms] [read-chunk] [rcvbuf]" << endl;
+        return 1;
+    }
+    int reqInterval = argc > 5 ? boost::lexical_cast<int>(argv[5]) : 100;
+    int readDelay   = argc > 6 ? boost::lexical_cast<int>(argv[6]) : 50;
+    int readChunk   = argc > 7 ? boost::lexical_cast<int>(argv[7]) : 512;
+    int rcvbuf      = argc > 8 ? boost::lexical_cast<int>(argv[8]) : 4096;
+
+    TCPSocket s;
+    setsockopt(s.getFD(), SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    if (!s.Connect(argv[1], boost::lexical_cast<int>(argv[2]))) {
+        cerr << "Can't connect to " << argv[1] << ":" << argv[2] << endl;
+        return 1;
+    }
+
+    yaml::emitter yemit(new yaml::socket_writer(&s));
+
+    typed::connect c;
+    c.account = argv[3];
+    c.password = argv[4];
+    c.name = "slow-client";
+    c.listenToBcast = 0;
+    c.clientId = 0;
+    yemit.send(typed::put_message(typed::message(c)));
+
+    typed::status st;
+    st.all = true;
+    st.clientId = 0;
+
+    char *buf = new char[readChunk];
+    long bytes = 0, docs = 0, reqs = 0;
+    double start = now_ms(), lastReq = 0, lastReport = start;
+
+    while (true) {
+        double t = now_ms();
+        if (t - lastReq >= reqInterval) {
+            if (yemit.send(typed::put_message(typed::message(st))) != 1) {
+                cerr << "Request write failed, server gone?" << endl;
+                break;
+            }
+            ++reqs;
+            lastReq = t;
+        }
+
+        int rd = s.read(buf, readChunk);
+        if (rd <= 0) {
+            cerr << "Server closed connection after " << (t - start) / 1000.0 << "s" << endl;
+            break;
+        }
+        bytes += rd;
+        for (int i = 0; i + 3 < rd; ++i) {
+            if (buf[i] == '\n' && strncmp(buf + i + 1, "---", 3) == 0) ++docs;
+        }
+
+        if (t - lastReport >= 1000) {
+            cout << (int) ((t - start) / 1000) << "s: " << reqs << " requests, "
+                 << docs << " documents, " << bytes << " bytes read ("
+                 << bytes / ((t - start) / 1000.0) << " B/s)" << endl;
+            lastReport = t;
+        }
+        usleep(readDelay * 1000);
+    }
+
+    cout << "total: " << reqs << " requests, " << docs << " documents, " << bytes << " bytes" << endl;
+    delete [] buf;
+    return 0;
+}
@@ -12,7 +12,7 @@ using trc::compat::util::Histogram;
 using trc::compat::util::UniformBucketizer;
 using trc::compat::util::CountingBucket;
 
-#include "CycleCount.h"
+#include <cl-util/CycleCount.h>
 
 #include <string>
 #include <iostream>
@@ -77,11 +77,15 @@ int main ( int argc, char **argv ) {
 
     vector<string> tradeon;
     string slogfile;
+    string tcrecordfile;
+    bool tctextlog;
     int order_rate,order_size;
     double order_price;
     
     cfg.defOption("help,h", &help, "print this help message");
     cfg.defOption("server.server-log-file", &slogfile, "server access / error log file");
+    cfg.defOption("server.tc-record-file", &tcrecordfile, "binary file of completed trade requests, for TC analysis (none if empty)", string(""));
+    cfg.defOption("server.tc-text-log", &tctextlog, "also log every trade request, placement and fill as text (TROPFTrackerImmediate)", true);
     cfg.defOption("trade-on", &tradeon, "ECNs to trade on");
     cfg.defOption("maxorderrate", &order_rate, "Maximum per symbol order rate", 75);
     cfg.defOption("maxordersize", &order_size, "Maximum per symbol order size", 10000);
@@ -132,11 +136,21 @@ int main ( int argc, char **argv ) {
     //   reconciliation.
     //factory<PNLTracker>::pointer pnlTracker(factory<PNLTracker>::get(only::one));
 
-    // ALERT ALERT - may want to remove for production use.
-    // Create a TC tracker, which can be used to dump detailed info on
-    //   trade requests, order-placements, and fills, in a format that organizes
-    //   inof so that it makes it easy to spot screwy behavior.
-    factory<TROPFTrackerImmediate>::pointer tcTracker(factory<TROPFTrackerImmediate>::get(only::one));
+    // Create a TC tracker, which keeps slippage & fill-time aggregates on
+    //   trade requests, and appends each completed request to the TC record
+    //   file, in EXEC_LOG_DIR.
+    string tcpath;
+    if (!tcrecordfile.empty()) {
+        tcpath = string(getenv("EXEC_LOG_DIR")) + string("/") + tcrecordfile;
+    }
+    factory<StreamingTCTracker>::pointer tcTracker(new StreamingTCTracker(tcpath));
+    factory<StreamingTCTracker>::insert(only::one, tcTracker);
+    // Per-event text log of trade requests, order-placements, and fills, in a
+    //   format that makes it easy to spot screwy behavior.
+    factory<TROPFTrackerImmediate>::pointer tcTextLog;
+    if (tctextlog) {
+        tcTextLog = factory<TROPFTrackerImmediate>::get(only::one);
+    }
     factory<ForwardTracker>::pointer fwdTracker(factory<ForwardTracker>::get(only::one));
     factory<PullTracker>::pointer pullTracker(factory<PullTracker>::get(only::one));
     factory<Chunk>::pointer chunk(factory<Chunk>::get(only::one));
@@ -25,22 +25,14 @@ CapacityTracker::CapacityTracker():
   _hvt (factory<HistVolumeTracker>::get(only::one)),
   _accVol(_dm->cidsize(),0),
   _ourAccVol(_dm->cidsize(),0),
+  _vol(_dm->cidsize(),MAXPERIODS,_lambda),
+  _ourVol(_dm->cidsize(),MAXPERIODS,_lambda),
   _mktOpen(false),
   _minCap(100),
   _lastTick(0),
   _participationRate(INIT_CAPACITY)
 {  
-  _lastV.resize( MAXPERIODS );
-  _estimate.resize( MAXPERIODS );
-  _lastOurv.resize( MAXPERIODS );
-  _avgOurV.resize( MAXPERIODS );
   _laststate.resize( _dm->cidsize(), 0 );
-  for (int i=0;i<MAXPERIODS;i++){
-    _lastV[i].resize( _dm->cidsize(), 0 );
-    _estimate[i].resize( _dm->cidsize(), 0.0 );
-    _lastOurv[i].resize( _dm->cidsize(), 0 );
-    _avgOurV[i].resize( _dm->cidsize(), 0.0 );
-  }
   
   _dm->add_listener(this);
 
@@ -48,8 +40,8 @@ CapacityTracker::CapacityTracker():
   for (int cid=0;cid<_dm->cidsize();cid++){
     double v = _hvt->getAvgDailyVol(cid)/(60*60*6.5); // the avergae volume per second during trading hours (=cross section), historically
     for (int i=0;i<MAXPERIODS;i++){
-      _estimate[i][cid] = v*_periods[i];
-      TAEL_TPRINTF(_logPrinter.get(), &t.tv, TAEL_ERROR, "INIT %s estimate[%d]=%f",_dm->symbol(cid),_periods[i],_estimate[i][cid]);
+      _vol.set(i,cid,v*_periods[i]);
+      TAEL_TPRINTF(_logPrinter.get(), &t.tv, TAEL_ERROR, "INIT %s estimate[%d]=%f",_dm->symbol(cid),_periods[i],_vol.value(i,cid));
     }
   }
 }
@@ -60,14 +52,17 @@ void CapacityTracker::update(const TimeUpdate &t) {
 }
 
 void CapacityTracker::update ( const DataUpdate &du ) {
-  if (du.isTrade()) 
+  if (du.isTrade()) {
     _accVol[du.cid] += du.size;
+    _vol.touch(du.cid);
+  }
 }
 
 void CapacityTracker::update( const OrderUpdate& ou ) { 
    if (ou.action() != Mkt::FILLED)
      return;
    _ourAccVol[ou.cid()] += ou.thisShares();
+   _ourVol.touch(ou.cid());
 }
 
 void CapacityTracker::update(const WakeUpdate &wu) {
@@ -77,17 +72,13 @@ void CapacityTracker::update(const WakeUpdate &wu) {
   int t = _dm->curtv().sec();
   if (t==_lastTick)
     return;
-  TimeVal tmv = _dm->curtv();
 
+  // Symbols that didn't trade since a period's last tick only decay, which
+  // DecayingSums does for all of them at once.
   for (int i=0;i<MAXPERIODS;i++){
     if (t%_periods[i]==0){
-      for (int cid=0;cid<_dm->cidsize();cid++){
-	_estimate[i][cid] = _estimate[i][cid]*(1-_lambda[i]) + (_accVol[cid]-_lastV[i][cid])*_lambda[i];
-	_avgOurV[i][cid] = _avgOurV[i][cid]*(1-_lambda[i]) + (_ourAccVol[cid]-_lastOurv[i][cid])*_lambda[i];
-	_lastV[i][cid] = _accVol[cid];
-	_lastOurv[i][cid]=_ourAccVol[cid];
-	//TAEL_PRINTF(_logPrinter, TAEL_ERROR, &tmv,"%d %s estimate[%d]=%f",t,_dm->symbol(cid),_periods[i],_estimate[i][cid]);
-      }
+      _vol.tick(i,&_accVol[0]);
+      _ourVol.tick(i,&_ourAccVol[0]);
     }
   }
   _lastTick=t;
@@ -103,11 +94,11 @@ bool CapacityTracker::capacity(int cid){
   if  (_participationRate>75)
     return true;
 
-  if ( (_participationRate<75) && (_avgOurV[MAXPERIODS-1][cid]>_participationRate*_estimate[MAXPERIODS-1][cid]/100.0)){
+  if ( (_participationRate<75) && (_ourVol.value(MAXPERIODS-1,cid)>_participationRate*_vol.value(MAXPERIODS-1,cid)/100.0)){
     // We've exceeded our participation rate ! Stop
     TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "%5s: CapTracker: Disallowing as OurVol=%f "
-    		"avgVol=%f participation rate=%f",_dm->symbol(cid),_avgOurV[MAXPERIODS-1][cid],
-    		_estimate[MAXPERIODS-1][cid]/100.0,_participationRate);
+    		"avgVol=%f participation rate=%f",_dm->symbol(cid),_ourVol.value(MAXPERIODS-1,cid),
+    		_vol.value(MAXPERIODS-1,cid)/100.0,_participationRate);
     ret = false;
   }
   else{
@@ -116,25 +107,25 @@ bool CapacityTracker::capacity(int cid){
 		printCount++;
 	}
     for (int i=0;i<MAXPERIODS;i++){
-      double rate = std::max(_fraction[i]*_estimate[i][cid]+100,_periods[i]*100.0); // HEURISTIC: Assume a min rate of 100/sec (?)
-      double periodcap = std::max(rate-(_ourAccVol[cid]-_lastOurv[i][cid]),0.0);
+      double rate = std::max(_fraction[i]*_vol.value(i,cid)+100,_periods[i]*100.0); // HEURISTIC: Assume a min rate of 100/sec (?)
+      double periodcap = std::max(rate-(_ourAccVol[cid]-_ourVol.last(i,cid)),0.0);
       if (periodcap<_minCap){
 	ret = false;
 	cap = periodcap;
 	limperiod = _periods[i];
-	limrate = _fraction[i]*_estimate[i][cid] ;
-	limvol = _ourAccVol[cid]-_lastOurv[i][cid];
+	limrate = _fraction[i]*_vol.value(i,cid) ;
+	limvol = (int) (_ourAccVol[cid]-_ourVol.last(i,cid));
       }
     }
   }
   if (!ret){
     if (_laststate[cid]>0){
-      TAEL_PRINTF(_logPrinter.get(), TAEL_ERROR, "%5s: CapTracker: Disallowing as OurVol=%f avgVol=%f cap=%f rate[%d]=%f < %d = vol[%d]",_dm->symbol(cid),_avgOurV[MAXPERIODS-1][cid],_estimate[MAXPERIODS-1][cid]/100.0,cap,limperiod,limrate,limvol,limperiod);
+      TAEL_PRINTF(_logPrinter.get(), TAEL_ERROR, "%5s: CapTracker: Disallowing as OurVol=%f avgVol=%f cap=%f rate[%d]=%f < %d = vol[%d]",_dm->symbol(cid),_ourVol.value(MAXPERIODS-1,cid),_vol.value(MAXPERIODS-1,cid)/100.0,cap,limperiod,limrate,limvol,limperiod);
     }
   }
   else
     if (_laststate[cid]==0)
-      TAEL_PRINTF(_logPrinter.get(), TAEL_ERROR, "%5s: CapTracker: Allowing as OurVol=%f avgVol=%f cap=%f rate[%d]=%f < %d = vol[%d]",_dm->symbol(cid),_avgOurV[MAXPERIODS-1][cid],_estimate[MAXPERIODS-1][cid]/100.0,cap,limperiod,limrate,limvol,limperiod);
+      TAEL_PRINTF(_logPrinter.get(), TAEL_ERROR, "%5s: CapTracker: Allowing as OurVol=%f avgVol=%f cap=%f rate[%d]=%f < %d = vol[%d]",_dm->symbol(cid),_ourVol.value(MAXPERIODS-1,cid),_vol.value(MAXPERIODS-1,cid)/100.0,cap,limperiod,limrate,limvol,limperiod);
   
   _laststate[cid]=ret?1:0;
   return ret;
@@ -4,6 +4,7 @@
 #include "DataManager.h"
 #include "DataUpdates.h"
 #include "HistVolumeTracker.h"
+#include "DecayingSums.h"
 #include <vector>
 #include <cl-util/factory.h>
 #include <cl-util/debug_stream.h>
@@ -28,12 +29,10 @@ class CapacityTracker :
   static const double _lambda[MAXPERIODS];   // Discount factor (use 2/(N+1) to rounghly keep last N observations)
   static const double _fraction[MAXPERIODS]; // Participation rate
 
-  vector<double>          _accVol;    // Running accumulated volume of each symbol since the program started
-  vector<vector<double> > _lastV;     // Volume traded per symbol as of last reset per period
-  vector<vector<double> > _estimate;  // Estimate of the average volume per symbol/period (based mostly on live recent volume data)
-  vector<vector<double> > _avgOurV;
-  vector<int>             _ourAccVol; // Running accumulated volume of OUR trades
-  vector<vector<int> >    _lastOurv;  // Volume filled per symbol as of last reset per period
+  vector<double> _accVol;    // Running accumulated volume of each symbol since the program started
+  vector<double> _ourAccVol; // Running accumulated volume of OUR trades
+  DecayingSums   _vol;       // Estimate of the average volume per period/symbol (based mostly on live recent volume data)
+  DecayingSums   _ourVol;    // Same, for our fills
   vector<int> _laststate;
   bool _mktOpen;
   int  _minCap;
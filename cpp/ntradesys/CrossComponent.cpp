@@ -27,7 +27,7 @@ CrossComponent::CrossComponent( int waitMilliSec, AlphaSignal *fvSignal )
     _fvSignal(fvSignal),
     _enabled(true)
 {
-  _lastOPTime.resize( _dm->cidsize(), 0 );
+  _lastOPTime.resize( _dm->cidsize(), nanotime() );
 
   initializeVectorOfSortEcns();
 }
@@ -56,7 +56,7 @@ void CrossComponent::suggestOrderPlacements( int cid, Mkt::Side side, int tradeL
     return;
 
   // Have issued crossing order for stock too recently. Don't try to trade it in current wakeup context.
-  if( HFUtils::milliSecondsBetween(_lastOPTime[cid], _dm->curtv()) < _waitMilliSec ) 
+  if( HFUtils::milliSecondsBetween(_lastOPTime[cid], _dm->curtime()) < _waitMilliSec ) 
     return;
 
   // Check if 1/2 spread + common TC are > priority. 
@@ -167,7 +167,7 @@ void CrossComponent::suggestOrderPlacements( int cid, Mkt::Side side, int tradeL
     if( orderSizes[i] == 0 ) continue;
     OrderPlacementSuggestion suggestion( cid, ECN::ECN(i), side, orderSizes[i], crossPrice, IOC_TIMEOUT, 
 					 tradeLogicId, _componentId, csn, OrderPlacementSuggestion::CROSS,
-					 _dm->curtv(), ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK),
+					 _dm->curtime(), ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK),
 					 priority);
     suggestions.push_back( suggestion );
   }
@@ -191,7 +191,7 @@ void CrossComponent::suggestOrderPlacements( int cid, Mkt::Side side, int tradeL
     TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "%-5s Cross: Signal Info: MID%.3f  CPX%.2f  ALP%.6f  FV%.4f  CMNTC%.6f  PRI%.6f",
 			 _dm->symbol(cid), mid, crossPrice, alpha, fv, commonTC, priority );
     
-    _lastOPTime[ cid ] = _dm->curtv();
+    _lastOPTime[ cid ] = _dm->curtime();
   }
 
   return;
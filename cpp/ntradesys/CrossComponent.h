@@ -36,7 +36,7 @@ class CrossComponent : public TradeLogicComponent {
 
   int             _waitMilliSec;                       // Number of milliseconds to wait between placing crossing orders (per stock).
   double _priorityScale;
-  vector<TimeVal> _lastOPTime;                         // Last time an order was placed by this component, per stock.
+  vector<nanotime> _lastOPTime;                        // Last time an order was placed by this component, per stock.
 
   AlphaSignal *_fvSignal;                              // Unconditional return/alpha signal.  Null for no-signal.
 
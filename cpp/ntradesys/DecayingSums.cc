@@ -0,0 +1,107 @@
+#include "DecayingSums.h"
+
+#include <emmintrin.h>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+/// Below this the per-period factor is folded into the stored estimates,
+///   well before est/scale could overflow.
+const double MIN_SCALE = 1e-100;
+/// Above this fraction of the universe pending, a tick is a full pass.
+const int DENSE_FRACTION = 8;
+
+DecayingSums::DecayingSums( int n, int np, const double* lambda ) :
+  _n(n),
+  _np(np),
+  _stride((n + 7) & ~7),
+  _words((n + 63) / 64),
+  _block(0)
+{
+  if( np < 1 || np > MAX_PERIODS )
+    throw std::invalid_argument( "DecayingSums: too many periods" );
+  size_t rowBytes = _stride * sizeof(double);
+  size_t bytes = 2 * np * rowBytes + (np + 1) * _words * sizeof(uint64_t);
+  if( posix_memalign( &_block, 64, bytes ) != 0 )
+    throw std::bad_alloc();
+  memset( _block, 0, bytes );
+  _est = (double*) _block;
+  _last = _est + np * _stride;
+  _touched = (uint64_t*) (_last + np * _stride);
+  _pending = _touched + _words;
+  for( int p = 0; p < np; p++ ) {
+    _lambda[p] = lambda[p];
+    _scale[p] = 1.0;
+  }
+}
+
+DecayingSums::~DecayingSums() {
+  free( _block );
+}
+
+// SSE2 is all x86-64 guarantees, so that's what the kernels are written
+// for: two symbols a step, then the odd one out.
+void DecayingSums::fold( double* est, double* last, const double* acc, int n, double w ) {
+  __m128d vw = _mm_set1_pd( w );
+  int k = 0;
+  for( ; k + 2 <= n; k += 2 ) {
+    __m128d a = _mm_loadu_pd( acc + k );
+    __m128d d = _mm_sub_pd( a, _mm_loadu_pd( last + k ) );
+    _mm_storeu_pd( est + k, _mm_add_pd( _mm_loadu_pd( est + k ), _mm_mul_pd( d, vw ) ) );
+    _mm_storeu_pd( last + k, a );
+  }
+  for( ; k < n; k++ ) {
+    est[k] += (acc[k] - last[k]) * w;
+    last[k] = acc[k];
+  }
+}
+
+void DecayingSums::rescale( double* est, int n, double s ) {
+  __m128d vs = _mm_set1_pd( s );
+  int k = 0;
+  for( ; k + 2 <= n; k += 2 )
+    _mm_storeu_pd( est + k, _mm_mul_pd( _mm_loadu_pd( est + k ), vs ) );
+  for( ; k < n; k++ )
+    est[k] *= s;
+}
+
+void DecayingSums::tick( int p, const double* acc ) {
+  double* est = _est + p * _stride;
+  double* last = _last + p * _stride;
+  uint64_t* pending = _pending + p * _words;
+
+  // hand the touches since the last tick to every period
+  for( int q = 0; q < _np; q++ ) {
+    uint64_t* row = _pending + q * _words;
+    for( int k = 0; k < _words; k++ )
+      row[k] |= _touched[k];
+  }
+  memset( _touched, 0, _words * sizeof(uint64_t) );
+
+  // decay everybody at once
+  double scale = _scale[p] * (1 - _lambda[p]);
+  if( scale < MIN_SCALE ) {
+    rescale( est, _n, scale );
+    scale = 1.0;
+  }
+  _scale[p] = scale;
+
+  // then fold in what moved, weighted up by the factor the estimates are stored under
+  double w = _lambda[p] / scale;
+  int touched = 0;
+  for( int k = 0; k < _words; k++ )
+    touched += __builtin_popcountll( pending[k] );
+  if( touched * DENSE_FRACTION > _n ) {
+    fold( est, last, acc, _n, w );
+  } else {
+    for( int k = 0; k < _words; k++ ) {
+      for( uint64_t bits = pending[k]; bits; bits &= bits - 1 ) {
+        int cid = k * 64 + __builtin_ctzll( bits );
+        est[cid] += (acc[cid] - last[cid]) * w;
+        last[cid] = acc[cid];
+      }
+    }
+  }
+  memset( pending, 0, _words * sizeof(uint64_t) );
+}
@@ -0,0 +1,64 @@
+#ifndef _DECAYINGSUMS_H_
+#define _DECAYINGSUMS_H_
+
+#include <stdint.h>
+
+/// Exponentially decaying per-period sums of an accumulating per-symbol
+///   quantity (e.g. the volume traded), for a few sampling periods over
+///   all the symbols of the universe.
+///
+/// At each tick of period p, every symbol's estimate becomes
+///     est = est*(1-lambda[p]) + (acc - last)*lambda[p];  last = acc
+///   where acc is the symbol's running total.  The decay is shared by all
+///   symbols, so it is kept as one factor per period: the estimates are
+///   stored divided by it, and a tick only touches the symbols whose
+///   total moved since the period's last tick (see touch()).  When many
+///   did, or when the factor would underflow, the tick is one streaming
+///   pass over the period's row instead.
+///
+/// Storage is period-major: row p holds the estimates (and last totals)
+///   of all symbols for period p, contiguously, in one 64-byte aligned
+///   block.
+class DecayingSums {
+ public:
+  static const int MAX_PERIODS = 8;
+
+  /// n symbols, np periods (at most MAX_PERIODS) with discount factors lambda[0..np).
+  DecayingSums( int n, int np, const double* lambda );
+  ~DecayingSums();
+
+  /// cid's running total has changed: it's to be folded in at the next
+  ///   tick of each period.
+  void touch( int cid ) { _touched[cid >> 6] |= 1ULL << (cid & 63); }
+
+  /// A tick of period p; acc[cid] is the running total of each symbol.
+  void tick( int p, const double* acc );
+
+  /// Current estimate for period p of symbol cid.  O(1).
+  double value( int p, int cid ) const { return _est[p * _stride + cid] * _scale[p]; }
+  /// cid's running total as of the last tick of period p.
+  double last( int p, int cid ) const { return _last[p * _stride + cid]; }
+  /// Start symbol cid's estimate for period p at v.
+  void set( int p, int cid, double v ) { _est[p * _stride + cid] = v / _scale[p]; }
+
+  /// The streaming kernels a tick is made of, over n contiguous symbols:
+  ///   est += (acc - last)*w, last = acc ...
+  static void fold( double* est, double* last, const double* acc, int n, double w );
+  ///   ... and est *= s.
+  static void rescale( double* est, int n, double s );
+
+ protected:
+  int       _n;
+  int       _np;
+  int       _stride;         /// row length, rounded up to a cache line of doubles
+  int       _words;          /// row length of _pending
+  void*     _block;
+  double*   _est;            /// [period][cid], divided by _scale[period]
+  double*   _last;           /// [period][cid]
+  uint64_t* _touched;        /// [cid/64]: bit per symbol touched since the last tick of any period
+  uint64_t* _pending;        /// [period][cid/64]: same, since the period's last tick
+  double    _lambda[MAX_PERIODS];
+  double    _scale[MAX_PERIODS];  /// product of (1-lambda) over the period's ticks since last rescaled
+};
+
+#endif
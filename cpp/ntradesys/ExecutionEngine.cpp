@@ -44,7 +44,7 @@ bool ExecutionEngine::trade(int cid, int size, double priority, long orderID, in
 /// broadcast a request-update through the trade-request-queue
 bool ExecutionEngine::tradeTo( int cid, int target, double priority, long orderID, int clientId, Mkt::Marking marking ) {
   if( _cidToTradeLogic[cid] == NULL ) {
-    TAEL_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s WARNING: on ExecutionEngine::tradeTo, but this symbol is associated with no TradeLogic. ",
+    DS_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s WARNING: on ExecutionEngine::tradeTo, but this symbol is associated with no TradeLogic. ",
 			 _dm->symbol(cid) );
     return false;
   }
@@ -52,20 +52,55 @@ bool ExecutionEngine::tradeTo( int cid, int target, double priority, long orderI
   SingleStockState *ss = _stocksState->getState(cid);
   int previousTarget = ss->getTargetPosition();
   int currentPosition = ss->getCurrentPosition();
-  TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "%-5s ExecutionEngine::tradeTo: currPos = %4d, target changed %4d ==> %4d, "
+  DS_PRINTF(_logPrinter.get(), TAEL_INFO, "%-5s ExecutionEngine::tradeTo: currPos = %4d, target changed %4d ==> %4d, "
 		       "priority= %7.4f bps, cbbo=(%.2f,%.2f) mktStt=%s marking=%s",
 		       _dm->symbol(cid), _dm->position(cid), previousTarget, target, priority*10000, 
 		       ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK), ss->getMktStatusDesc(), Mkt::MarkingDesc[marking] );
 
   // populate the trade-request into the Trade-Requests-Queue
   TradeRequest tr( cid, previousTarget, currentPosition, target, priority, 
-		   ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK), _dm->curtv(), orderID, clientId, marking );
+		   ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK), _dm->curtime(), orderID, clientId, marking );
   ss->onTradeRequest( tr );
   _tradeRequestHandler->send( tr );
 
   return true;
 }
 
+int ExecutionEngine::tradeToBatch( const vector<TradeTarget> &batch, int clientId ) {
+  // validation pass: keep the last entry per associated cid
+  vector<int> lastIx( batch.size(), -1 );
+  _batchSeen.resize( _dm->cidsize(), -1 );
+  for( int i = 0; i < (int)batch.size(); i++ ) {
+    int cid = batch[i].cid;
+    if( cid < 0 || cid >= _dm->cidsize() || _cidToTradeLogic[cid] == NULL ) {
+      DS_PRINTF(_logPrinter.get(), TAEL_WARN, "ExecutionEngine::tradeToBatch: dropping entry %d, cid %d unknown or associated with no TradeLogic",
+		  i, cid );
+      continue;
+    }
+    if( _batchSeen[cid] != -1 ) lastIx[ _batchSeen[cid] ] = -1;
+    _batchSeen[cid] = i;
+    lastIx[i] = i;
+  }
+
+  vector<TradeRequest> trs;
+  trs.reserve( batch.size() );
+  for( int i = 0; i < (int)batch.size(); i++ ) {
+    if( lastIx[i] == -1 ) continue;
+    const TradeTarget &tt = batch[i];
+    _batchSeen[tt.cid] = -1;
+    SingleStockState *ss = _stocksState->getState(tt.cid);
+    TradeRequest tr( tt.cid, ss->getTargetPosition(), ss->getCurrentPosition(), tt.target, tt.priority,
+		     ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK), _dm->curtime(), tt.orderID, clientId, tt.marking );
+    ss->onTradeRequest( tr );
+    trs.push_back( tr );
+  }
+
+  DS_PRINTF(_logPrinter.get(), TAEL_INFO, "ExecutionEngine::tradeToBatch: %d of %d requests accepted from client %d",
+	      (int)trs.size(), (int)batch.size(), clientId );
+  _tradeRequestHandler->send( trs.begin(), trs.end() );
+  return trs.size();
+}
+
 /**
  *  Request to stop trading. Handle like a trade request to trade to current position with the current priority.
  */
@@ -78,7 +113,7 @@ bool ExecutionEngine::stop( int cid, int clientId ) {
   int    target = _dm->position( cid );
   double priority = ss->getPriority();
   
-  TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "%-5s ExecutionEngine::stop: currPos = %6d, target changed %6d ==> %6d, "
+  DS_PRINTF(_logPrinter.get(), TAEL_INFO, "%-5s ExecutionEngine::stop: currPos = %6d, target changed %6d ==> %6d, "
 		       "priority= %5.2f bps, cbbo=(%.2f,%.2f) mktStt=%s",
 		       _dm->symbol(cid), _dm->position(cid), previousTarget, target, priority*10000, 
 		       ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK), ss->getMktStatusDesc() );
@@ -88,7 +123,7 @@ bool ExecutionEngine::stop( int cid, int clientId ) {
 
   //NSARKAS note that orderId = -1
   TradeRequest tr( cid, previousTarget, target, target, priority, 
-		   ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK), _dm->curtv(), -1, clientId, Mkt::UNKWN );
+		   ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK), _dm->curtime(), -1, clientId, Mkt::UNKWN );
   ss->onTradeRequest( tr );
   _tradeRequestHandler->send( tr );
 
@@ -25,6 +25,18 @@ class TradeStatus {
     : tState(tradingState), currentPosition(currPos), targetPosition(targetPos), shsTraded(shsTraded_), priority(priority_) {}
 };
 
+/// One entry of a batch trade request (see ExecutionEngine::tradeToBatch).
+struct TradeTarget {
+  int cid;
+  int target;
+  double priority;
+  long orderID;
+  Mkt::Marking marking;
+
+  TradeTarget( int cid_, int target_, double priority_, long orderID_, Mkt::Marking marking_ )
+    : cid(cid_), target(target_), priority(priority_), orderID(orderID_), marking(marking_) {}
+};
+
 class ExecutionEngine {
 
   factory<DataManager>::pointer          _dm;
@@ -35,6 +47,7 @@ class ExecutionEngine {
   /// Maps stocks <-> TradeLogics. Every stock is associated with a particular TradeLogic, or with no TradeLogic
   vector<TradeLogic*>                    _cidToTradeLogic;
   TradeLogic*                            _singleTradeLogic; /// used only, possibly, when a single TL is common to all stocks
+  vector<int>                            _batchSeen;        /// scratch for tradeToBatch: batch index per cid, -1 if none
 
   // stuff that normally belongs to the constructor (here because there're two constructors)
   void init();  
@@ -49,6 +62,11 @@ public:
   //NSARKAS, marking no longer has a default value. I found it error prone when trying to add additional parameters
   virtual bool trade( int cid, int size, double priority, long orderID, int clientId, Mkt::Marking marking);
   virtual bool tradeTo( int cid, int target, double priority, long orderID, int clientId, Mkt::Marking marking);
+  /// Like tradeTo for many stocks at once.  The batch is validated in one pass (unknown or
+  /// unassociated stocks are dropped, a repeated cid keeps its last entry) and the resulting
+  /// trade requests are dispatched together, so all are handled before the next wakeup.
+  /// Returns the number of requests accepted.
+  virtual int tradeToBatch( const vector<TradeTarget> &batch, int clientId );
   virtual bool stop( int cid, int clientId );
 
   virtual bool stop(int clientId); // call stop on all stocks
@@ -32,7 +32,7 @@ Exec::Exec(const OrderUpdate &ou, double bid, double ask) :
   _dir(ou.dir()), 
   _side(ou.side()),
   _ecn(ou.ecn()), 
-  _fillTV(ou.tv()),
+  _fillTV(ou.tv().to_timeval()),
   _orderID(ou.id()), 
   _tc(-1 * ou.thisFee()), 
   _cbid(bid), 
@@ -80,7 +80,7 @@ void FollowLeaderComponent::suggestOrderPlacements( int cid, Mkt::Side side, int
 	if (chunkSizes[i] <= 0) continue;
 	OrderPlacementSuggestion ops( cid, e, side, chunkSizes[i], loPrice, DEFAULT_TIMEOUT,
 				      tradeLogicId, _componentId, csqn, OrderPlacementSuggestion::FOLLOW_LEADER,
-				      _dm->curtv(), ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK),
+				      _dm->curtime(), ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK),
 				      priority);
 	suggestions.push_back(ops);
       }
@@ -270,7 +270,7 @@ void FollowLeaderComponent::suggestOrderCancels( int cid, unsigned int bidCapaci
       SingleStockState *ss =_stocksState -> getState( cid );
       OrderCancelSuggestion cancelSugg( orderId, _componentId, OrderCancelSuggestion::NO_CAPACITY, 
 					ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK),
-					_dm->curtv() );
+					_dm->curtime() );
       cancelSuggestions.push_back( cancelSugg );
       totalOutstandingSize -= order->sharesOpen();
     }
@@ -321,8 +321,8 @@ bool FollowLeaderComponentKH::decideToCancel(  int cid, const Order* order, unsi
   } else { 
     // Market is invalid. But pulling on every locked/crossed book leads to too-frequent order cancels.  
     // So, as comproise, we cancel only if the book stays invalid for more than, say, 1 second
-    TimeVal lastUpdateTV = ss->getLastChangeInMktStatus();
-    if (HFUtils::milliSecondsBetween(lastUpdateTV, _dm->curtv()) > HFUtils::INVALD_MKT_CANCEL_MS) {
+    nanotime lastUpdateTV = ss->getLastChangeInMktStatus();
+    if (HFUtils::milliSecondsBetween(lastUpdateTV, _dm->curtime()) > HFUtils::INVALD_MKT_CANCEL_MS) {
       cancelReason = OrderCancelSuggestion::NO_VALID_MARKET;
       return true;
     }
@@ -9,7 +9,7 @@ FollowLeaderJoinQueueBackup::FollowLeaderJoinQueueBackup()
     _jq(),
     _ignoreTickDown ( false )
 {
-  _lastFtlEventTime.resize( _dm->cidsize(), 0 );
+  _lastFtlEventTime.resize( _dm->cidsize(), nanotime() );
   _dm->add_listener( this );
 }
 
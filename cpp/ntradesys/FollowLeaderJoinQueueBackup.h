@@ -39,14 +39,14 @@ class FollowLeaderJoinQueueBackup : public TradeLogicComponent, public TradeRequ
   FollowLeaderSOB      _ftl;
   JoinQueueComponent            _jq;
 
-  vector<TimeVal> _lastFtlEventTime;   /// Per stock: Last time FTL suggested-placement/cxl/ we-got-new-trade-request etc.
+  vector<nanotime> _lastFtlEventTime;  /// Per stock: Last time FTL suggested-placement/cxl/ we-got-new-trade-request etc.
                                        /// (idealy should include FTL-fills as well)
   bool _ignoreTickDown;
   
   const static int JQ_WAIT_TIME_MS = 150 * 1000;  // 2.5 minutes
 
-  void markFtlEvent( int cid ) { _lastFtlEventTime[cid] = _dm->curtv(); }
-  double milliSecondsSinceLastFtlEvent(int cid) const { return HFUtils::milliSecondsBetween(_lastFtlEventTime[cid], _dm->curtv()); }
+  void markFtlEvent( int cid ) { _lastFtlEventTime[cid] = _dm->curtime(); }
+  double milliSecondsSinceLastFtlEvent(int cid) const { return HFUtils::milliSecondsBetween(_lastFtlEventTime[cid], _dm->curtime()); }
 
   bool tickDown ( int cid, Mkt::Side s); // Did the price tick down from the last wakeup?
   virtual void update( const TradeRequest& tr );
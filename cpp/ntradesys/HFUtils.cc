@@ -132,13 +132,6 @@ bool HFUtils::tsFuzzyEQ(const TimeVal &tv1, const TimeVal &tv2) {
   return ret;
 }
 
-// tv1 - tv2, in milliseconds.
-double HFUtils::milliSecondsBetween(const TimeVal &tv1, const TimeVal &tv2) {
-  long secsDiff = (tv2.sec() - tv1.sec());
-  long microSecsDiff = (tv2.usec() - tv1.usec());
-  return (secsDiff * 1000) + (microSecsDiff / 1000.0);
-}
-
 bool HFUtils::getTradeableMarket(DataManager*dm, int cid, Mkt::Side side, int level,
 				 size_t minSize, double *price, size_t *size) {
   return getTradableMarket(dm->masterBook(), cid, side, level, minSize, price, size);
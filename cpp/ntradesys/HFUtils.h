@@ -59,8 +59,8 @@ class HFUtils {
   static bool tsFuzzyLE(const TimeVal &tv1, const TimeVal &tv2);
   // is tv1 = tv2, to within epsilon.
   static bool tsFuzzyEQ(const TimeVal &tv1, const TimeVal &tv2);
-  // tv2 - tv1, in milliseconds.
-  static double milliSecondsBetween(const TimeVal &tv1, const TimeVal &tv2);
+  // tv2 - tv1, in milliseconds.  TimeVals convert.
+  static double milliSecondsBetween(nanotime tv1, nanotime tv2) { return (tv2 - tv1).millis(); }
 
   /*
     Simplified book query functions.
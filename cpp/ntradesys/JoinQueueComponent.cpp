@@ -75,12 +75,12 @@ void JoinQueueComponent::suggestOrderPlacements( int cid, Mkt::Side side, int tr
   // To avoid place/pull loops
   /*
   if( _lastPlacedOrders[cid].price == cbboPrice && 
-      HFUtils::milliSecondsBetween(_lastPlacedOrders[cid].time,_dm->curtv()) < MIN_REPLACED_INTERVAL )
+      HFUtils::milliSecondsBetween(_lastPlacedOrders[cid].time,_dm->curtime()) < MIN_REPLACED_INTERVAL )
     return;
   */
   // Do not place at more than 10 orders per second, if the price ticks up, then FLW should pick it up
   
-  if( HFUtils::milliSecondsBetween(_lastPlacedOrders[cid].time,_dm->curtv()) < MIN_REPLACED_INTERVAL )
+  if( HFUtils::milliSecondsBetween(_lastPlacedOrders[cid].time,_dm->curtime()) < MIN_REPLACED_INTERVAL )
     return;
   
   // Try to place at CBBO unless that would result in too many shares outstanding that are reasonably likely to
@@ -139,7 +139,7 @@ void JoinQueueComponent::suggestOrderPlacements( int cid, Mkt::Side side, int tr
     if (chunkSizes[i] <= 0) continue;
     OrderPlacementSuggestion ops( cid, loRoute, side, chunkSizes[i], cbboPrice, DEFAULT_TIMEOUT, 
 				  tradeLogicId, _componentId, csqn, OrderPlacementSuggestion::JOIN_QUEUE,
-				  _dm->curtv(), ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK),
+				  _dm->curtime(), ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK),
 				  priority);
     char buf[1024];
     ops.snprint(buf, 1024);
@@ -148,7 +148,7 @@ void JoinQueueComponent::suggestOrderPlacements( int cid, Mkt::Side side, int tr
     suggestions.push_back(ops);
   }
   if (chunkSizes.size() > 0) {
-    _lastPlacedOrders[cid].update( cbboPrice, _dm->curtv() );
+    _lastPlacedOrders[cid].update( cbboPrice, _dm->curtime() );
   }
   return;
 }
@@ -201,8 +201,8 @@ bool JoinQueueComponent::decideToCancel( int cid, const Order* order, unsigned i
   } else { 
     // Market is invalid. But pulling on every locked/crossed book leads to too-frequent order cancels.  
     // So, as comproise, we cancel only if the book stays invalid for more than, say, 1 second
-    TimeVal lastUpdateTV = ss->getLastChangeInMktStatus();
-    if (HFUtils::milliSecondsBetween(lastUpdateTV, _dm->curtv()) > HFUtils::INVALD_MKT_CANCEL_MS) {
+    nanotime lastUpdateTV = ss->getLastChangeInMktStatus();
+    if (HFUtils::milliSecondsBetween(lastUpdateTV, _dm->curtime()) > HFUtils::INVALD_MKT_CANCEL_MS) {
       cancelReason = OrderCancelSuggestion::NO_VALID_MARKET;
       return true;
     }
@@ -273,7 +273,7 @@ void JoinQueueComponent::suggestOrderCancels( int cid, unsigned int bidCapacity,
       SingleStockState *ss =_stocksState -> getState( cid );
       OrderCancelSuggestion cancelSugg( orderId, _componentId, OrderCancelSuggestion::NO_CAPACITY, 
 					ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK),
-					_dm->curtv() );
+					_dm->curtime() );
       cancelSuggestions.push_back( cancelSugg );
       totalOutstandingSize -= order->sharesOpen();
     }
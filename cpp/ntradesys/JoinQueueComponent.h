@@ -15,10 +15,10 @@ using namespace clite::util;
 /// some details regarding the last placed order of a particular symbol, to avoid loops of place/pull
 struct LastPlacedOrder {
   double  price;
-  TimeVal time;
+  nanotime time;
 
-  LastPlacedOrder() : price(-1), time(TimeVal(0)) {}
-  inline void update( double price_, TimeVal time_ ) { price = price_; time = time_; }
+  LastPlacedOrder() : price(-1), time() {}
+  inline void update( double price_, nanotime time_ ) { price = price_; time = time_; }
 };
 
 class JoinQueueComponent : public TradeLogicComponent {
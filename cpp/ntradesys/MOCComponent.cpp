@@ -79,7 +79,7 @@ void MOCComponent::suggestOrderPlacements( int cid, Mkt::Side side, int tradeLog
 
       OrderPlacementSuggestion ops(cid, ecn, side, sharesLeft, price, DEFAULT_TIMEOUT,
     		 			    tradeLogicId, _componentId, allocateSeqNum(), OrderPlacementSuggestion::MKT_ON_CLOSE,
-    		 			    _dm->curtv(), ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK), priority);
+    		 			    _dm->curtime(), ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK), priority);
       suggestions.push_back(ops);
     } else {
     	std::cout << "ERROR: could not find the exchange for symbol " << _dm->symbol(cid) << std::endl;
@@ -10,7 +10,7 @@ OpenTracker::OpenTracker()
     _marketIsOpen(false),
     _nyseOpenTV(0),
     _amexOpenTV(0),
-    _marketOpenTV(0)
+    _marketOpenTV()
 {
   _dm = factory<DataManager>::find(only::one);
   if( !_dm )
@@ -18,8 +18,8 @@ OpenTracker::OpenTracker()
   _nyse.assign( _dm->cidsize(), false );  
   _amex.assign( _dm->cidsize(), false );
 
-  _nyseOpenTV.assign(_dm->cidsize(), 0 );
-  _amexOpenTV.assign(_dm->cidsize(), 0 );
+  _nyseOpenTV.assign(_dm->cidsize(), nanotime() );
+  _amexOpenTV.assign(_dm->cidsize(), nanotime() );
 
   _dm -> add_listener( this );
 }
@@ -66,7 +66,7 @@ bool OpenTracker::hasOpened( int cid, ECN::ECN ecn ) const {
   }
 }
 
-bool OpenTracker::openTV(int cid, ECN::ECN ecn, TimeVal &fv) const {
+bool OpenTracker::openTV(int cid, ECN::ECN ecn, nanotime &fv) const {
   bool ret = hasOpened(cid, ecn);
   if (!ret) {
     return false;
@@ -26,9 +26,9 @@ class OpenTracker : public MarketHandler::listener, public TimeHandler::listener
   vector<bool>                      _amex;
   bool                              _marketIsOpen;
 
-  vector<TimeVal>                   _nyseOpenTV;
-  vector<TimeVal>                   _amexOpenTV;
-  TimeVal                           _marketOpenTV;
+  vector<nanotime>                  _nyseOpenTV;
+  vector<nanotime>                  _amexOpenTV;
+  nanotime                          _marketOpenTV;
 
 public:
   OpenTracker();
@@ -40,8 +40,8 @@ public:
   bool hasOpenedOnPrimaryExchange( int cid ) const { return hasOpened( cid, _exchangeT->getExchange(cid) ); }
 
   // As hasOpened, but also fills in stock-specific open-time estimate.
-  bool openTV(int cid, ECN::ECN ecn, TimeVal &fv) const;
-  bool openTV(int cid, TimeVal &fv) const { return openTV( cid, _exchangeT->getExchange(cid), fv); }
+  bool openTV(int cid, ECN::ECN ecn, nanotime &fv) const;
+  bool openTV(int cid, nanotime &fv) const { return openTV( cid, _exchangeT->getExchange(cid), fv); }
 };
 
 #endif
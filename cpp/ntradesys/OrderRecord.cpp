@@ -23,8 +23,8 @@ OrderRecord::OrderRecord( const Order* order, const OrderPlacementSuggestion& pl
     _placingTV( order->placing().tv() ),
     _priority(placementMsg._priority),
     _marketImpact(placementMsg._marketImpact),
-    _placeDuTV( TimeVal(0) ),
-    _confirmationTV( TimeVal(0) ),
+    _placeDuTV( ),
+    _confirmationTV( ),
     _refnum( UNKNOWN_REF_NUM ),
     _refGuessed( false ),
     _initialShsPos( UNKNOWN_Q_POS_IN_SHS ),
@@ -38,7 +38,7 @@ OrderRecord::OrderRecord( const Order* order, const OrderPlacementSuggestion& pl
 
 
 int OrderRecord::snprint(char *buf, int n) const {
-  DateTime dt(_placingTV); 
+  DateTime dt(_placingTV.to_timeval()); 
    // Print aggregate info about order.
   return snprintf(buf, n, "OP %02d:%02d:%02d:%06d  CID%i  SIDE%s  SIZE%i  PX%f  ECN%s  RSN%s  ORDID%i  TLID%i  CMPID%i  CMPSN%i  PRI%.6f  MI%.6f",
 		  dt.hh(), dt.mm(), dt.ss(), dt.usec(), 
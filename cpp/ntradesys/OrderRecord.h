@@ -57,7 +57,7 @@ class OrderRecord {
   double    _mid;
   double    _vol;
   ECN::ECN  _ecn;
-  TimeVal   _placingTV; // The time we sent the placement-order
+  nanotime  _placingTV; // The time we sent the placement-order
 
   //////////////
   // Used for TC analysis
@@ -68,8 +68,8 @@ class OrderRecord {
   /////////////////
   // Q-position info
   /////////////////
-  TimeVal   _placeDuTV;        // Add tv (time we got the placement-data-update that matches this order)
-  TimeVal   _confirmationTV; // the tv of the confirmation-order-update
+  nanotime  _placeDuTV;       // Add tv (time we got the placement-data-update that matches this order)
+  nanotime  _confirmationTV; // the tv of the confirmation-order-update
 
   uint64_t  _refnum;     // The reference number from the exchange (either the value we got from the exchange or a guessed value)
   bool      _refGuessed; // Did we have to guess ref-num or simply got it back from the exchange
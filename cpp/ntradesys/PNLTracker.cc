@@ -98,7 +98,7 @@ void PNLTracker::update(const TimeUpdate &au) {
     _mktCloseTV = au.tv();
   }
   if (_seenMktClose == true && _printedOnClose == false) {
-    double diff = HFUtils::milliSecondsBetween(_mktCloseTV, _dm->curtv());
+    double diff = HFUtils::milliSecondsBetween(_mktCloseTV, _dm->curtime());
     if (diff >= PRINT_ON_CLOSE_DELAY_MILLISECONDS) {
       _printedOnClose = true;
       string prefix("");
@@ -36,7 +36,7 @@ class PNLTracker : OrderHandler::listener, TimeHandler::listener {
 
   bool _printOnClose;                       // Automatically print TC summary info on/after mkt close.
   bool _seenMktClose;                       // Have we seen a markety close message?
-  TimeVal _mktCloseTV;                      // What was the Time of that message.
+  nanotime _mktCloseTV;                     // What was the Time of that message.
   bool _printedOnClose;                     // Have we already dump state following the last mkt close message?  
 
   // How long after mkt close to delay printing.
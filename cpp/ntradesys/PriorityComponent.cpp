@@ -18,6 +18,9 @@
 
 #include "PriorityComponent.h"
 #include <cl-util/float_cmp.h>
+#include <cl-util/trace.h>
+
+namespace trace = clite::util::trace;
 
 /*****************************************************************
   PriorityComponent
@@ -122,8 +125,11 @@ void PriorityComponent::suggestOrderPlacements( int cid, Mkt::Side side, int tra
     // first, reduce the current outstanding size placed by this component from "new" capacity
     sharesUsedCross = _centralOrderRepo->totalOutstandingSize( cid, side, _cross.componentId(), tradeLogicId );
     priorityCross = componentPriority(cid, side, tradeLogicId, numShares, priority, OrderPlacementSuggestion::CROSS); 
-    _cross.suggestOrderPlacements( cid, side, tradeLogicId, capacityCross - sharesUsedCross, 
+    {
+      trace::span sp("suggestOrderPlacements", cid, &typeid(_cross));
+      _cross.suggestOrderPlacements( cid, side, tradeLogicId, capacityCross - sharesUsedCross, 
 				   priorityCross, subComponentSuggestions );
+    }
     //TAEL_PRINTF(&_reportlog, TAEL_INFO, "%s cross:%d", _dm->symbol(cid), capacityCross - sharesUsedCross);
     sharesUsedCross += ordersSize( subComponentSuggestions );
     suggestions.insert(suggestions.end(),subComponentSuggestions.begin(), subComponentSuggestions.end());
@@ -139,8 +145,11 @@ void PriorityComponent::suggestOrderPlacements( int cid, Mkt::Side side, int tra
     // first, reduce the current outstanding size placed by this component from "new" capacity
     sharesUsedTakeInvis = _centralOrderRepo->totalOutstandingSize( cid, side, _takeInvis.componentId(), tradeLogicId );
     priorityTakeInvis = componentPriority(cid, side, tradeLogicId, numShares, priority, OrderPlacementSuggestion::TAKE_INVISIBLE);
-    _takeInvis.suggestOrderPlacements( cid, side, tradeLogicId, capacityTakeInvis - sharesUsedTakeInvis, 
+    {
+      trace::span sp("suggestOrderPlacements", cid, &typeid(_takeInvis));
+      _takeInvis.suggestOrderPlacements( cid, side, tradeLogicId, capacityTakeInvis - sharesUsedTakeInvis, 
 				       priorityTakeInvis, subComponentSuggestions );
+    }
     //TAEL_PRINTF(&_reportlog, TAEL_INFO, "%s takeInvis:%d", _dm->symbol(cid), capacityTakeInvis - sharesUsedTakeInvis);
     sharesUsedTakeInvis += ordersSize( subComponentSuggestions );
     suggestions.insert(suggestions.end(),subComponentSuggestions.begin(), subComponentSuggestions.end());
@@ -154,8 +163,11 @@ void PriorityComponent::suggestOrderPlacements( int cid, Mkt::Side side, int tra
   if( capacityIOT > 0 ) {
     sharesUsedIOT = _centralOrderRepo->totalOutstandingSize( cid, side, _iot.componentId(), tradeLogicId );
     priorityIOT = componentPriority(cid, side, tradeLogicId, numShares, priority, OrderPlacementSuggestion::FOLLOW_INVTRD);
-    _iot.suggestOrderPlacements( cid, side, tradeLogicId, capacityIOT - sharesUsedIOT, 
+    {
+      trace::span sp("suggestOrderPlacements", cid, &typeid(_iot));
+      _iot.suggestOrderPlacements( cid, side, tradeLogicId, capacityIOT - sharesUsedIOT, 
 				 priorityIOT, subComponentSuggestions );
+    }
     //TAEL_PRINTF(&_reportlog, TAEL_INFO, "%s iot:%d", _dm->symbol(cid), capacityIOT - sharesUsedIOT);
     sharesUsedIOT += ordersSize( subComponentSuggestions );
     suggestions.insert( suggestions.end(), subComponentSuggestions.begin(), subComponentSuggestions.end() );
@@ -173,8 +185,11 @@ void PriorityComponent::suggestOrderPlacements( int cid, Mkt::Side side, int tra
     // Thus, we do not subtract here the size of open FTL-orders from the capacity (but only from the capacity of JQ)
     sharesUsedFTL = 0;
     priorityFTL = componentPriority(cid, side, tradeLogicId, numShares, priority, OrderPlacementSuggestion::FOLLOW_LEADER);
-    _ftl.suggestOrderPlacements(cid, side, tradeLogicId, capacityFTL - sharesUsedFTL, 
+    {
+      trace::span sp("suggestOrderPlacements", cid, &typeid(_ftl));
+      _ftl.suggestOrderPlacements(cid, side, tradeLogicId, capacityFTL - sharesUsedFTL, 
 				priorityFTL, subComponentSuggestions);
+    }
     //TAEL_PRINTF(&_reportlog, TAEL_INFO, "%s ftl:%d", _dm->symbol(cid), capacityFTL - sharesUsedFTL);
     sharesUsedFTL = ordersSize( subComponentSuggestions );
     suggestions.insert( suggestions.end(), subComponentSuggestions.begin(), subComponentSuggestions.end() );
@@ -190,7 +205,10 @@ void PriorityComponent::suggestOrderPlacements( int cid, Mkt::Side side, int tra
     // Note: JQ takes care itself for not risking getting over-fills too frequently. That's partly why 
     // we don't bother subtracting from numShares the current open orders
     priorityJQ = componentPriority(cid, side, tradeLogicId, numShares, priority, OrderPlacementSuggestion::JOIN_QUEUE);
-    _jqt.suggestOrderPlacements( cid, side, tradeLogicId, capacityJQ, priorityJQ, subComponentSuggestions );
+    {
+      trace::span sp("suggestOrderPlacements", cid, &typeid(_jqt));
+      _jqt.suggestOrderPlacements( cid, side, tradeLogicId, capacityJQ, priorityJQ, subComponentSuggestions );
+    }
     //TAEL_PRINTF(&_reportlog, TAEL_INFO, "%s jq:%d", _dm->symbol(cid), capacityJQ);
     suggestions.insert( suggestions.end(), subComponentSuggestions.begin(), subComponentSuggestions.end() );
     subComponentSuggestions.clear();
@@ -208,32 +226,47 @@ void PriorityComponent::suggestOrderCancels( int cid, unsigned int bidCapacity,
   vector<OrderCancelSuggestion> subComponentSuggestions;
 
   // Ask CROSS to cancel its own undesired orders.
-  _cross.suggestOrderCancels( cid, _lastCapacityCross[cid][Mkt::BID], _lastCapacityCross[cid][Mkt::ASK], 
+  {
+    trace::span sp("suggestOrderCancels", cid, &typeid(_cross));
+    _cross.suggestOrderCancels( cid, _lastCapacityCross[cid][Mkt::BID], _lastCapacityCross[cid][Mkt::ASK], 
 			      priority / TakeLiquidityPriorityScale, tradeLogicId, subComponentSuggestions );
+  }
   cancelSuggestions.insert( cancelSuggestions.end(), subComponentSuggestions.begin(), subComponentSuggestions.end() );
   subComponentSuggestions.clear();
 
   // Ask TakeInvisible to cancel its own undesired orders.
-  _takeInvis.suggestOrderCancels( cid, _lastCapacityTakeInvis[cid][Mkt::BID], _lastCapacityTakeInvis[cid][Mkt::ASK], 
+  {
+    trace::span sp("suggestOrderCancels", cid, &typeid(_takeInvis));
+    _takeInvis.suggestOrderCancels( cid, _lastCapacityTakeInvis[cid][Mkt::BID], _lastCapacityTakeInvis[cid][Mkt::ASK], 
 				  priority / TakeLiquidityPriorityScale, tradeLogicId, subComponentSuggestions );
+  }
   cancelSuggestions.insert( cancelSuggestions.end(), subComponentSuggestions.begin(), subComponentSuggestions.end() );
   subComponentSuggestions.clear();
 
   // Ask IOT to cancel its own undesired orders.
-  _iot.suggestOrderCancels( cid, _lastCapacityIOT[cid][Mkt::BID], _lastCapacityIOT[cid][Mkt::ASK], priority, tradeLogicId, 
+  {
+    trace::span sp("suggestOrderCancels", cid, &typeid(_iot));
+    _iot.suggestOrderCancels( cid, _lastCapacityIOT[cid][Mkt::BID], _lastCapacityIOT[cid][Mkt::ASK], priority, tradeLogicId, 
 			    subComponentSuggestions );
+  }
   cancelSuggestions.insert( cancelSuggestions.end(), subComponentSuggestions.begin(), subComponentSuggestions.end() );
   subComponentSuggestions.clear();
 
   // Ask FTL to cancel its own undesired orders.
-  _ftl.suggestOrderCancels( cid, _lastCapacityFTL[cid][Mkt::BID], _lastCapacityFTL[cid][Mkt::ASK], priority, tradeLogicId, 
+  {
+    trace::span sp("suggestOrderCancels", cid, &typeid(_ftl));
+    _ftl.suggestOrderCancels( cid, _lastCapacityFTL[cid][Mkt::BID], _lastCapacityFTL[cid][Mkt::ASK], priority, tradeLogicId, 
 			    subComponentSuggestions );
+  }
   cancelSuggestions.insert( cancelSuggestions.end(), subComponentSuggestions.begin(), subComponentSuggestions.end() );
   subComponentSuggestions.clear();
 
   // Ask JQ to cancel its own undesired orders.
-  _jqt.suggestOrderCancels( cid, _lastCapacityJQ[cid][Mkt::BID], _lastCapacityJQ[cid][Mkt::ASK], priority, tradeLogicId, 
+  {
+    trace::span sp("suggestOrderCancels", cid, &typeid(_jqt));
+    _jqt.suggestOrderCancels( cid, _lastCapacityJQ[cid][Mkt::BID], _lastCapacityJQ[cid][Mkt::ASK], priority, tradeLogicId, 
 			    subComponentSuggestions );
+  }
   cancelSuggestions.insert( cancelSuggestions.end(), subComponentSuggestions.begin(), subComponentSuggestions.end() );
   subComponentSuggestions.clear();
 
@@ -17,6 +17,7 @@ using namespace clite::util;
 
 #include "DataManager.h"
 #include "Markets.h"
+#include "RollingStats.h"
 #include "c_util/Time.h"
 using trc::compat::util::TimeVal;
 
@@ -24,28 +25,24 @@ using trc::compat::util::TimeVal;
  *  A simple trailing QSize tracking widget. 
  *  Tracks the EMA of the gloabal queue size, as well as the global queue size in each of the ECNs we listen to.
  */
-class QSzTracker : public TimeHandler::listener, public WakeupHandler::listener {
+class QSzTracker : public RollingStats::sampler {
  protected:
-  factory<DataManager>::pointer _dm;    // Exists externally.
+  factory<DataManager>::pointer  _dm;    // Exists externally.
+  factory<RollingStats>::pointer _rs;
 
-  vector<double>   _qSz;                   // Moving/decaying qsize (or simply sum of samples as long as not warmed)
-  vector<double>   _ecnQSz[ECN::ECN_size]; // Moving/decaying qsize on each ("turned-on") ECN
+  int              _qSzId;                 // Moving/decaying qsize series (RollingStats)
+  int              _ecnQSzId[ECN::ECN_size]; // Same on each ("turned-on") ECN; -1 if not tracked
   vector<ECN::ECN> _turnedOnEcns;          // Which Ecns are listened to by DM
 
   double         _lambda;
   int            _msec; // msec between samples
-  TimeVal        _lastUpdateTV;
-  bool           _mktOpen;       // Is market open or closed?
-  bool           _warmed;   // True once enough samples are recorded
-  int            _ct;       // count the first samples until there are enough to declare this is "warmed"
 
-  void sampleAllStocks();
+  void init( int length, bool ecns );
 
  public:
   QSzTracker();
   QSzTracker( int msec, int length );
-  virtual void update( const TimeUpdate& t );
-  virtual void update( const WakeUpdate& wu );
+  virtual void sample( RollingStats& rs );
   bool qSz( int cid, double &qSz ) const;
   bool ecnQSz( int cid, ECN::ECN ecn, double &ecnQSz ) const;  
 };
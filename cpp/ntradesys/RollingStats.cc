@@ -0,0 +1,243 @@
+#include "RollingStats.h"
+
+#include <emmintrin.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+  // The per-tick kernels, one pass over n symbols.  SSE2 (all x86-64
+  // guarantees): two symbols a step, then the odd one out.  A sample is
+  // present where it isn't NaN.
+
+  /// ema = present? ema*(1-lambda) + x*lambda : ema, or while warming up
+  ///   ema += present? x : 0.  cnt counts the samples.
+  void ema_kernel( double* ema, double* cnt, const double* in, int n,
+                   double lambda, bool warming ) {
+    __m128d one = _mm_set1_pd( 1.0 );
+    __m128d l = _mm_set1_pd( warming ? 1.0 : lambda );
+    __m128d keep = _mm_set1_pd( warming ? 1.0 : 1 - lambda );
+    int k = 0;
+    for( ; k + 2 <= n; k += 2 ) {
+      __m128d x = _mm_loadu_pd( in + k );
+      __m128d m = _mm_cmpord_pd( x, x );
+      __m128d e = _mm_loadu_pd( ema + k );
+      __m128d upd = _mm_add_pd( _mm_mul_pd( e, keep ), _mm_mul_pd( _mm_and_pd( m, x ), l ) );
+      _mm_storeu_pd( ema + k, _mm_or_pd( _mm_and_pd( m, upd ), _mm_andnot_pd( m, e ) ) );
+      _mm_storeu_pd( cnt + k, _mm_add_pd( _mm_loadu_pd( cnt + k ), _mm_and_pd( m, one ) ) );
+    }
+    for( ; k < n; k++ ) {
+      double x = in[k];
+      if( x != x ) continue;
+      ema[k] = warming ? ema[k] + x : ema[k] * (1 - lambda) + x * lambda;
+      cnt[k] += 1;
+    }
+  }
+
+  /// Push this tick's samples into ring row (v, ok), taking the row's old
+  ///   samples out of the window's sums.
+  void window_kernel( double* sum, double* sumsq, double* cnt, double* v, double* ok,
+                      const double* in, int n ) {
+    __m128d one = _mm_set1_pd( 1.0 );
+    int k = 0;
+    for( ; k + 2 <= n; k += 2 ) {
+      __m128d x = _mm_loadu_pd( in + k );
+      __m128d m = _mm_cmpord_pd( x, x );
+      __m128d x0 = _mm_and_pd( m, x );
+      __m128d o = _mm_loadu_pd( v + k );
+      __m128d p = _mm_and_pd( m, one );
+      _mm_storeu_pd( sum + k, _mm_add_pd( _mm_loadu_pd( sum + k ), _mm_sub_pd( x0, o ) ) );
+      if( sumsq )
+        _mm_storeu_pd( sumsq + k, _mm_add_pd( _mm_loadu_pd( sumsq + k ),
+                                              _mm_sub_pd( _mm_mul_pd( x0, x0 ), _mm_mul_pd( o, o ) ) ) );
+      _mm_storeu_pd( cnt + k, _mm_add_pd( _mm_loadu_pd( cnt + k ), _mm_sub_pd( p, _mm_loadu_pd( ok + k ) ) ) );
+      _mm_storeu_pd( v + k, x0 );
+      _mm_storeu_pd( ok + k, p );
+    }
+    for( ; k < n; k++ ) {
+      double x = in[k];
+      bool present = x == x;
+      double x0 = present ? x : 0.0;
+      sum[k] += x0 - v[k];
+      if( sumsq ) sumsq[k] += x0 * x0 - v[k] * v[k];
+      cnt[k] += (present ? 1.0 : 0.0) - ok[k];
+      v[k] = x0;
+      ok[k] = present ? 1.0 : 0.0;
+    }
+  }
+}
+
+RollingStats::series::series( int n ) :
+  src(0), r(EMA), msec(0), timer(nanotime()), lambda(0), warmup(0), window(0), q(0),
+  head(0), ticks(0),
+  in(n, numeric_limits<double>::quiet_NaN()), cnt(n, 0.0)
+{}
+
+RollingStats::RollingStats() :
+  _mktOpen(false)
+{
+  _dm = factory<DataManager>::find(only::one);
+  if( !_dm )
+    throw std::runtime_error( "Failed to get DataManager from factory (in RollingStats::RollingStats)" );
+  _dm->add_listener(this);
+}
+
+RollingStats::~RollingStats() {
+  for( size_t i = 0; i < _series.size(); i++ )
+    delete _series[i];
+}
+
+int RollingStats::add( const string& name, sampler* src, int msec, reducer r,
+                       double param, int warmup, double q ) {
+  int n = _dm->cidsize();
+  series* s = new series( n );
+  s->name = name;
+  s->src = src;
+  s->r = r;
+  s->msec = msec;
+  if( r == EMA ) {
+    s->lambda = param;
+    s->warmup = warmup;
+    s->ema.assign( n, 0.0 );
+  } else {
+    s->window = std::max( 1, (int) param );
+    s->q = q;
+    s->sum.assign( n, 0.0 );
+    if( r == STDEV ) s->sumsq.assign( n, 0.0 );
+    s->ring.assign( (size_t) s->window * n, 0.0 );
+    s->ok.assign( (size_t) s->window * n, 0.0 );
+  }
+  if( msec > 0 ) {
+    s->timer = Timer( nanotime::from_ms(msec), nanotime() );
+    _dm->addTimer( s->timer );
+  }
+  _series.push_back( s );
+  return _series.size() - 1;
+}
+
+int RollingStats::find( const string& name ) const {
+  for( size_t i = 0; i < _series.size(); i++ )
+    if( _series[i]->name == name ) return i;
+  return -1;
+}
+
+void RollingStats::clear() {
+  for( size_t i = 0; i < _series.size(); i++ ) {
+    series& s = *_series[i];
+    if( s.r == EMA ) continue;
+    std::fill( s.sum.begin(), s.sum.end(), 0.0 );
+    std::fill( s.sumsq.begin(), s.sumsq.end(), 0.0 );
+    std::fill( s.cnt.begin(), s.cnt.end(), 0.0 );
+    std::fill( s.ring.begin(), s.ring.end(), 0.0 );
+    std::fill( s.ok.begin(), s.ok.end(), 0.0 );
+    s.head = 0;
+    s.ticks = 0;
+  }
+}
+
+void RollingStats::update( const TimeUpdate& t ) {
+  if( t.timer() == _dm->marketOpen() ) {
+    _mktOpen = true;
+    clear();
+  }
+  if( t.timer() == _dm->marketClose() ) _mktOpen = false;
+  if( !_mktOpen ) return;
+
+  // every sampler with a series due samples once; then every due series is reduced
+  _due.clear();
+  _ticking.clear();
+  for( size_t i = 0; i < _series.size(); i++ ) {
+    series* s = _series[i];
+    if( s->msec > 0 && t.timer() != s->timer ) continue;
+    std::fill( s->in.begin(), s->in.end(), numeric_limits<double>::quiet_NaN() );
+    _ticking.push_back( s );
+    if( std::find( _due.begin(), _due.end(), s->src ) == _due.end() )
+      _due.push_back( s->src );
+  }
+  for( size_t i = 0; i < _due.size(); i++ )
+    _due[i]->sample( *this );
+  for( size_t i = 0; i < _ticking.size(); i++ )
+    tick( *_ticking[i] );
+}
+
+void RollingStats::tick( series& s ) {
+  int n = s.in.size();
+  if( s.r == EMA ) {
+    bool warming = s.ticks <= s.warmup;
+    ema_kernel( &s.ema[0], &s.cnt[0], &s.in[0], n, s.lambda, warming );
+    s.ticks++;
+    // the warm-up sums become the starting averages
+    if( s.ticks == s.warmup + 1 )
+      for( int cid = 0; cid < n; cid++ )
+        s.ema[cid] /= s.ticks;
+    return;
+  }
+  size_t row = (size_t) s.head * n;
+  window_kernel( &s.sum[0], s.sumsq.empty() ? 0 : &s.sumsq[0], &s.cnt[0],
+                 &s.ring[row], &s.ok[row], &s.in[0], n );
+  s.ticks++;
+  if( ++s.head == s.window ) {
+    s.head = 0;
+    resum( s );
+  }
+}
+
+void RollingStats::resum( series& s ) {
+  int n = s.in.size();
+  std::fill( s.sum.begin(), s.sum.end(), 0.0 );
+  std::fill( s.sumsq.begin(), s.sumsq.end(), 0.0 );
+  for( int w = 0; w < s.window; w++ ) {
+    const double* v = &s.ring[(size_t) w * n];
+    for( int cid = 0; cid < n; cid++ )
+      s.sum[cid] += v[cid];
+    if( !s.sumsq.empty() )
+      for( int cid = 0; cid < n; cid++ )
+        s.sumsq[cid] += v[cid] * v[cid];
+  }
+}
+
+int RollingStats::count( int id, int cid ) const {
+  return (int) _series[id]->cnt[cid];
+}
+
+bool RollingStats::value( int id, int cid, double& v ) const {
+  const series& s = *_series[id];
+  double c = s.cnt[cid];
+  switch( s.r ) {
+  case EMA:
+    if( s.ticks <= s.warmup ) return false;
+    v = s.ema[cid];
+    return true;
+  case MEAN:
+    if( c <= 0 ) return false;
+    v = s.sum[cid] / c;
+    return true;
+  case SUM:
+    if( c <= 0 ) return false;
+    v = s.sum[cid];
+    return true;
+  case STDEV: {
+    if( c <= 0 ) return false;
+    double m = s.sum[cid] / c;
+    v = sqrt( std::max( s.sumsq[cid] / c - m * m, 0.0 ) );
+    return true;
+  }
+  case QUANTILE: {
+    if( c <= 0 ) return false;
+    int n = s.in.size();
+    std::vector<double> xs;
+    xs.reserve( (size_t) c );
+    for( int w = 0; w < s.window; w++ )
+      if( s.ok[(size_t) w * n + cid] > 0 ) xs.push_back( s.ring[(size_t) w * n + cid] );
+    size_t k = std::min( xs.size() - 1, (size_t) (s.q * (xs.size() - 1) + 0.5) );
+    std::nth_element( xs.begin(), xs.begin() + k, xs.end() );
+    v = xs[k];
+    return true;
+  }
+  }
+  return false;
+}
@@ -0,0 +1,130 @@
+#ifndef _ROLLINGSTATS_H_
+#define _ROLLINGSTATS_H_
+
+#include <string>
+#include <vector>
+
+#include <cl-util/factory.h>
+using namespace clite::util;
+
+#include "DataManager.h"
+
+/// Timer-driven rolling statistics over all the symbols of the universe,
+///   shared by the tracker family (QSzTracker, SpdTracker, SpreadTracker,
+///   VolatilityTracker, ImbTracker, IntervalVolumeTracker).
+///
+/// A tracker registers named per-symbol series, each with a sampling period
+///   and a reducer, and implements sampler to fill in the series' current
+///   samples.  On each timer tick the engine asks the samplers whose series
+///   are due for a sample of all symbols, then reduces every due series in
+///   one pass over its columns.  The tracker reads results with value().
+///
+/// Series are only sampled while the market is open.  Windowed series are
+///   emptied at the open.
+///
+/// Storage is columnar: a series' input, running sums and EMA are arrays
+///   over the symbols, and its window is a ring of such arrays, one per
+///   tick.  A symbol with no sample on a tick (input left as NaN) gets no
+///   update from it; for windowed series it is a hole in that symbol's window,
+///   which is therefore the last <window> ticks rather than the last <window>
+///   samples.
+///
+/// Behaviour changes for the converted trackers, which each ran their own
+///   buffers before:
+///   - windows are the last N ticks, not the last N samples, so a symbol with
+///     holes reaches a minimum-points threshold later and drops old samples
+///     sooner;
+///   - sampling only happens while the market is open, and windows restart at
+///     the open (SpreadTracker sampled around the clock and never restarted;
+///     ImbTracker emptied at the close);
+///   - SpreadTracker only takes a sample when lastNormalSpread succeeds; it used
+///     to push whatever the failed call left behind;
+///   - ticks fall on multiples of the period, not on offsets from the open or
+///     from the last wakeup that sampled.
+///
+/// Not on the engine: CapacityTracker's DecayingSums decay per event, lazily
+///   per symbol, and TimeBucketSeries takes any number of samples per period;
+///   neither is one sample per symbol per tick.
+class RollingStats : public TimeHandler::listener {
+ public:
+  enum reducer {
+    EMA,       /// exponential moving average with discount factor lambda,
+               ///   started from the mean of the first <warmup>+1 ticks' samples
+    MEAN,      /// mean over the trailing window
+    STDEV,     /// stdev (population) over the trailing window
+    SUM,       /// sum over the trailing window
+    QUANTILE   /// q-quantile over the trailing window; a selection per query
+  };
+
+  /// Fills in the samples of one or more series: input(id)[cid] for each
+  ///   symbol with a sample, leaving the others NaN.
+  class sampler {
+   public:
+    virtual ~sampler() {}
+    virtual void sample( RollingStats& rs ) = 0;
+  };
+
+  RollingStats();
+  virtual ~RollingStats();
+
+  /// Register a series sampled every msec milliseconds (0: on every timer
+  ///   update) by src.  For EMA, param is lambda and the average of the
+  ///   first warmup+1 ticks starts it; otherwise param is the window length in
+  ///   ticks and, for QUANTILE, q the quantile.  Returns the series id.
+  int add( const std::string& name, sampler* src, int msec, reducer r,
+           double param, int warmup = 0, double q = 0.5 );
+  /// Series id by name, or -1.
+  int find( const std::string& name ) const;
+
+  /// The row for src to write the current tick's samples of series id into.
+  double* input( int id ) { return &_series[id]->in[0]; }
+
+  /// The series' current value for cid; false if it has none yet (no
+  ///   sample in the window, or EMA still warming up).
+  bool value( int id, int cid, double& v ) const;
+  /// Number of samples in cid's window (or taken, for EMA).
+  int count( int id, int cid ) const;
+  /// True once an EMA series is past its warm-up.
+  bool warmed( int id ) const { return _series[id]->ticks > _series[id]->warmup; }
+
+  /// Empty all windowed series.
+  void clear();
+
+  virtual void update( const TimeUpdate& t );
+
+ protected:
+  struct series {
+    std::string name;
+    sampler*    src;
+    reducer     r;
+    int         msec;
+    Timer       timer;
+    double      lambda;       /// EMA
+    int         warmup;       /// EMA
+    int         window;       /// windowed reducers: ring length in ticks
+    double      q;            /// QUANTILE
+    int         head;         /// next ring row to write
+    int         ticks;        /// ticks since registered (EMA) or cleared (windowed)
+    std::vector<double> in;   /// [cid] this tick's samples, NaN for none
+    std::vector<double> ema;  /// [cid] EMA, or the sum of samples while warming up
+    std::vector<double> sum;  /// [cid] over the window
+    std::vector<double> sumsq;/// [cid] over the window (STDEV)
+    std::vector<double> cnt;  /// [cid] samples in the window, or taken (EMA)
+    std::vector<double> ring; /// [row][cid], 0 for no sample
+    std::vector<double> ok;   /// [row][cid], 1 where there was a sample
+
+    series( int n );
+  };
+
+  factory<DataManager>::pointer _dm;
+  std::vector<series*> _series;
+  std::vector<sampler*> _due;     /// this tick's samplers
+  std::vector<series*>  _ticking; /// this tick's series
+  bool _mktOpen;
+
+  void tick( series& s );
+  /// Recompute s's running sums from its ring, to keep them from drifting.
+  void resum( series& s );
+};
+
+#endif
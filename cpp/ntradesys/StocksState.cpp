@@ -4,6 +4,7 @@ using trc::compat::util::TimeVal;
 #include "StocksState.h"
 
 #include <cl-util/float_cmp.h>
+#include <cl-util/trace.h>
 
 const char *const SingleStockState::MktStatusDesc[] =  
   { "Normal ", "Locked ", "Crossed", "NoData ", "Unknown" };
@@ -23,10 +24,10 @@ SingleStockState::SingleStockState( int cid )
     _cid( cid ),
     _bookTop(),
     _mktStatus(NODATA),
-    _lastChangeInMktStatus(0),
+    _lastChangeInMktStatus(),
     _exclusiveBookTop(),
     _exclusiveMktStatus(NODATA),
-    _lastExclusiveMktUpdate(0),
+    _lastExclusiveMktUpdate(),
     _lastWakeupBookTop(),
     _lastWakeupNormalTop(),
     _lastWakeupMktStatus(NODATA),
@@ -36,7 +37,7 @@ SingleStockState::SingleStockState( int cid )
     _minimalPxVariation(0.01),
     _priority(0.0),
     _marking(Mkt::UNKWN),
-    _shsBought(0), _shsSold(0), _nBuys(0), _nSells(0), _lastFillTime(0),
+    _shsBought(0), _shsSold(0), _nBuys(0), _nSells(0), _lastFillTime(),
     _totalFees(0.0), _totalFeesBuy(0.0), _totalFeesSell(0.0)
 {
   _dm = factory<DataManager>::find(only::one);
@@ -109,7 +110,7 @@ void SingleStockState::updateMktStatus( MktStatus currMktStatus ) {
 			 bestPrice(Mkt::BID), bestPrice(Mkt::ASK) );
 
   _mktStatus = currMktStatus;
-  _lastChangeInMktStatus = _dm->curtv();
+  _lastChangeInMktStatus = _dm->curtime();
   return;
 }
 
@@ -223,8 +224,8 @@ bool SingleStockState::strictlyInsideLastNormalCBBO( double px ) const {
 
 // Update the "exclusive" top-market
 void SingleStockState::updateExclusiveMkt() {
-  if( _dm->curtv() == _lastExclusiveMktUpdate ) return; // THIS ASSUMES THAT _dm->curtv DOES NOT UPDATE WITHOUT NEW EXTERNAL UPDATES
-  _lastExclusiveMktUpdate = _dm->curtv();
+  if( _dm->curtime() == _lastExclusiveMktUpdate ) return; // THIS ASSUMES THAT _dm->curtime DOES NOT UPDATE WITHOUT NEW EXTERNAL UPDATES
+  _lastExclusiveMktUpdate = _dm->curtime();
 
   // Bid
   int    level = 0;
@@ -282,6 +283,7 @@ void StocksState::update( const OrderUpdate& ou ) {
 }
 
 void StocksState::update( const WakeUpdate& wu ) { 
+  clite::util::trace::span sp( "StocksState refresh" );
   // refresh all stock-states
   for( int cid=0; cid<_dm->cidsize(); cid++ ) 
     _states[cid]->onWakeup( _nDuSinceLastWakeup[cid]>0 );
@@ -78,7 +78,7 @@ class SingleStockState {
   inline bool haveNormalMarket() const { return _mktStatus==NORMAL; }
   inline MktStatus getMktStatus() const { return _mktStatus; }
   inline const char* getMktStatusDesc() const { return MktStatusDesc[_mktStatus]; }
-  TimeVal     getLastChangeInMktStatus() const { return _lastChangeInMktStatus; }
+  nanotime    getLastChangeInMktStatus() const { return _lastChangeInMktStatus; }
   // These versions do not do careful error checking
   inline double spread() const { return (_bookTop._askPx - _bookTop._bidPx); }
   inline double mid() const { return (_bookTop._askPx + _bookTop._bidPx)/2; }
@@ -132,14 +132,14 @@ class SingleStockState {
   // current mkt info
   BookTop   _bookTop;
   MktStatus _mktStatus;
-  TimeVal   _lastChangeInMktStatus;
+  nanotime  _lastChangeInMktStatus;
 
   // Top level excluding our orders. Updated only on request.
   //(Though in a very loose and shaky definition: we subtract all our orders from placing till they reach a DONE status. 
   // So sizes of levels can actually come out negative! )
   BookTop   _exclusiveBookTop;
   MktStatus _exclusiveMktStatus;
-  TimeVal   _lastExclusiveMktUpdate;
+  nanotime  _lastExclusiveMktUpdate;
   void      updateExclusiveMkt();
 
   // last wakeup mkt-info
@@ -171,7 +171,7 @@ class SingleStockState {
   int _shsSold;
   int _nBuys;  // # fills (partial fills are counted independantly)
   int _nSells; // # fills (partial fills are counted independantly)
-  TimeVal _lastFillTime;
+  nanotime _lastFillTime;
 
   /// These are cumulative fees, according to the numbers we get from the server
   double _totalFees;     // positive is bad for you
@@ -1,8 +1,6 @@
 #include "Suggestions.h"
 
-const char * OrderPlacementSuggestion::PlacementReasonDesc[] = 
-    { "JOIN_QUEUE", "FLW_LEADER", "STEP_UP_L1", "CROSS     ", "TAKE_INVSB", 
-      "FLW_SOB   ", "UNKNOWN   ", "MKTONCLOSE" };
+const char * const *OrderPlacementSuggestion::PlacementReasonDesc = Placement::ReasonDesc;
 const char * OrderCancelSuggestion::CancelReasonDesc[] = 
     { "NO_VALID_MKT", "NOT_AT_CBBO ", "Q_POS_UNFVR ", "LEADER_PULL ", "LSS_AG_CBBO ", 
       "NO_FOLLOWRS ", "INSIDE_SPRD ", "ST_SGL_ERR  ", "WRONG_SIDE  ", "NO_CAPCITY  ", 
@@ -15,7 +13,7 @@ const char * OrderCancelSuggestion::CancelReasonDesc[] =
 OrderPlacementSuggestion::OrderPlacementSuggestion( int cid, ECN::ECN ecn, Mkt::Side side, int size, double price, int timeout, 
 						    int tradeLogicId, int componentId, int componentSeqNum,
 						    OrderPlacementSuggestion::PlacementReason reason,
-						    const TimeVal &tv, double cbbid, double cbask, 
+						    const nanotime &tv, double cbbid, double cbask, 
 						    double priority) 
   :  _cid(cid),
      _ecn(ecn),
@@ -41,7 +39,7 @@ OrderPlacementSuggestion::OrderPlacementSuggestion( int cid, ECN::ECN ecn, Mkt::
   OrderCancelSuggestion code
 ******************************************************************************/
 OrderCancelSuggestion::OrderCancelSuggestion( int orderId, int componentId, OrderCancelSuggestion::CancelReason reason,
-					      double cbid, double cask, const TimeVal &tv ) 
+					      double cbid, double cask, const nanotime &tv ) 
   : _orderId( orderId ),
     _componentId( componentId ),
     _reason( reason ), 
@@ -5,6 +5,8 @@
 #include "c_util/Time.h"
 using trc::compat::util::TimeVal;
 using trc::compat::util::DateTime;
+#include <cl-util/nanotime.h>
+using clite::util::nanotime;
 
 /**
  * Used by trade logic components to suggest order placements to trade logics.
@@ -13,14 +15,18 @@ using trc::compat::util::DateTime;
 class OrderPlacementSuggestion {
 
  public:
+  /// Same values as Placement::Reason, which is what orders carry.
   enum PlacementReason {
-    JOIN_QUEUE, FOLLOW_LEADER, FOLLOW_INVTRD, CROSS, TAKE_INVISIBLE, FOLLOW_LEADER_SOB, UNKNOWN, MKT_ON_CLOSE};
+    JOIN_QUEUE = Placement::JOIN_QUEUE, FOLLOW_LEADER = Placement::FOLLOW_LEADER,
+    FOLLOW_INVTRD = Placement::FOLLOW_INVTRD, CROSS = Placement::CROSS,
+    TAKE_INVISIBLE = Placement::TAKE_INVISIBLE, FOLLOW_LEADER_SOB = Placement::FOLLOW_LEADER_SOB,
+    UNKNOWN = Placement::UNKNOWN, MKT_ON_CLOSE = Placement::MKT_ON_CLOSE};
 
-  const static char * PlacementReasonDesc[];
+  const static char * const *PlacementReasonDesc;
 
   OrderPlacementSuggestion( int cid, ECN::ECN ecn, Mkt::Side side, int size, double price, int timeout, 
 			    int tradeLogicId, int componentId, int componentSeqNum, PlacementReason reason,
-			    const TimeVal &tv, double cbbix, double cbask, double priority);
+			    const nanotime &tv, double cbbix, double cbask, double priority);
   virtual ~OrderPlacementSuggestion() {};
 
   void setOrderId( int orderId ) { _orderId = orderId; }
@@ -45,13 +51,13 @@ class OrderPlacementSuggestion {
   PlacementReason  _reason; /// Type (enumeration) of the order placement component that suggested placing order,
   double _cbbid;        /// Composite best bid & ask at time of placement, ignoring odd-lots.
   double _cbask;
-  TimeVal _tv;          /// Wall/sim time when order-placement suggestion is generated.
+  nanotime _tv;         /// Wall/sim time when order-placement suggestion is generated.
 
   double _priority;     /// leaf-node priority.  Aka priority passed to leaf OPC that actually suggested order.
   double _marketImpact; /// Estimated market-impact=, at time of placement.  Populated for liquidity-taking orders only.
 
   int snprint(char *s, int n) const {
-    DateTime dt(_tv);
+    DateTime dt(_tv.to_timeval());
     int i = snprintf(s, n, "OPS CID%i  ECN%s  SIDE%s  SIZE%i  PX%.2f  TOUT%i  TLID%i  CMPID%i  CSQN%i  RSN%s  %02d:%02d:%02d:%06d  CBID%.2f  CASK%.2f  ORDID%i  PRI%.6f  MKTIMP%.6f",
 		     _cid, ECN::desc(_ecn), Mkt::SideDesc[_side], _size,
 		     _price, _timeout, _tradeLogicId, _componentId, _componentSeqNum,
@@ -80,10 +86,10 @@ public:
   static char const *CancelReasonDesc[];
 
   OrderCancelSuggestion( int orderId, int componentId, OrderCancelSuggestion::CancelReason reason,
-			double cbid, double cask, const TimeVal &tv );
+			double cbid, double cask, const nanotime &tv );
 
   int snprint(char *s, int n) const {
-    DateTime dt(_tv);
+    DateTime dt(_tv.to_timeval());
     // Print aggregate info about cancel suggestion
     return snprintf(s, n, "CXLR %02d:%02d:%02d:%06d  CMPID%i  RSN%s  BPX%.2f  APX%.2f  ORDID%i",
 		    dt.hh(), dt.mm(), dt.ss(), dt.usec(), _componentId, 
@@ -97,7 +103,7 @@ public:
 
   double   _cbid;                // Composite bid @ time of cancel.  Round lots only????
   double   _cask;                // Composite ask @ time of cancel.  Round lots onlky???? 
-  TimeVal  _tv;                  // Wall/sim time when cancel suggestion is initiated. 
+  nanotime _tv;                  // Wall/sim time when cancel suggestion is initiated. 
 };
 
 #endif // __SUGGESTIONS_H__
@@ -20,6 +20,11 @@
 // cpputil includes
 #include "RUtils.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
 using trc::compat::util::DateTime;
 const string RELEVANT_LOG_FILE = "tctracking";
 const trc::tael::Severity TROPFTrackerImmediate::plevel = TAEL_WARN;
@@ -133,10 +138,8 @@ double TradeRequestRecord::totalFillMinutes() {
   if (!_fills.lastFillTime(lastFillTime)) {
     return 0.0;
   }
-  TimeVal diff = lastFillTime - _tr._recvTime;
-  long numSeconds = diff.sec();
-  long numUSeconds = diff.usec();
-  double ret = (numSeconds / 60.0) + (numUSeconds / (60000000.0));
+  nanotime diff = lastFillTime - _tr._recvTime;
+  double ret = diff.seconds() / 60.0;
   return ret;
 }
 
@@ -195,7 +198,7 @@ void TradeRequestRecord::printTCSummaryInfo(DataManager *dm,
 					    tael::Severity plevel,
 					    string& prefix, const char* symbol) {
   int numf = numFills();
-  DateTime dt(_tr._recvTime);
+  DateTime dt(_tr._recvTime.to_timeval());
   // Print aggregate info about TradeRequestRecord
   TAEL_PRINTF(tdebug, plevel, "%-5s %s TradeRequestRecord::printTCSummaryInfo", symbol, prefix.c_str());
   TAEL_PRINTF(tdebug, plevel, "%-5s %s   Aggregate", symbol, prefix.c_str());
@@ -280,7 +283,7 @@ int TradeRequestRecord::snprint_ord(char *buf, int n,
 int TradeRequestRecord::snprint_base(char *buf, int n) {
   int totShsFilled = totalSharesFilled();
   int totShsWanted = _tr._targetPos - _tr._initPos;
-  DateTime dt(_tr._recvTime);
+  DateTime dt(_tr._recvTime.to_timeval());
   double initialBid = -1, initialAsk = -1;
   initialPx(Mkt::BID, &initialBid);
   initialPx(Mkt::ASK, &initialAsk);
@@ -451,7 +454,7 @@ void TROPFTracker::update(const TimeUpdate &au) {
     _mktCloseTV = au.tv();
   }
   if (_seenMktClose == true && _printedOnClose == false) {
-    double diff = HFUtils::milliSecondsBetween(_mktCloseTV, _dm->curtv());
+    double diff = HFUtils::milliSecondsBetween(_mktCloseTV, _dm->curtime());
     if (diff >= PRINT_ON_CLOSE_DELAY_MILLISECONDS) {
       _printedOnClose = true;
       string prefix("");
@@ -564,3 +567,230 @@ void TROPFTrackerImmediate::update(const TradeRequest &tr) {
   TAEL_PRINTF(_ddebug.get(), plevel, "%-5s %s %s", symbol, _prefix.c_str(), buf);
 }
 
+
+
+/***********************************************************
+  TCRecord code
+***********************************************************/
+double TCRecord::wAvgSlippage() const {
+  if (absShsFilled <= 0 || cbid <= 0 || cask <= 0) {
+    return 0.0;
+  }
+  double initialMid = (cbid + cask)/2.0;
+  double wafp = wAvgFillPx();
+  if (targetPos >= initPos) {
+    return (initialMid - wafp);
+  }
+  return (wafp - initialMid);
+}
+
+double TCRecord::totalFillMinutes() const {
+  if (numFills <= 0) {
+    return 0.0;
+  }
+  return (lastFillNs - recvNs) / 60e9;
+}
+
+
+/***********************************************************
+  StreamingTCTracker code
+***********************************************************/
+StreamingTCTracker::StreamingTCTracker(const string &recordFile) :
+  _recordFile(recordFile),
+  _fd(-1),
+  _numRequests(0),
+  _numFilledRequests(0),
+  _numOrphanFills(0),
+  _totShsFilled(0.0),
+  _totNotional(0.0),
+  _totSlippage(0.0),
+  _totFillMinutes(0.0),
+  _seenMktClose(false),
+  _mktCloseTV(),
+  _completedOnClose(false)
+{
+  _dm = factory<DataManager>::find(only::one);
+  if( !_dm )
+    throw std::runtime_error( "Failed to get DataManager from factory (in StreamingTCTracker::StreamingTCTracker)" );
+  _ddebug = factory<debug_stream>::get( RELEVANT_LOG_FILE );
+
+  if (!_recordFile.empty()) {
+    _fd = open(_recordFile.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0640);
+    if (_fd == -1)
+      throw std::runtime_error( "Unable to open TC record file " + _recordFile + " (in StreamingTCTracker::StreamingTCTracker)" );
+  }
+  _live.assign(_dm->cidsize(), -1);
+  _outBuf.reserve(WRITE_BATCH);
+
+  _dm->add_listener(this);
+}
+
+StreamingTCTracker::~StreamingTCTracker() {
+  flushRecords();
+  if (_fd != -1) {
+    close(_fd);
+  }
+}
+
+void StreamingTCTracker::complete(int cid, TCRecord::Completion how) {
+  int slot = _live[cid];
+  if (slot < 0) {
+    return;
+  }
+  TCRecord &r = _pool[slot];
+  r.completion = how;
+
+  _numRequests++;
+  if (r.numFills > 0) {
+    _numFilledRequests++;
+    _totShsFilled += r.absShsFilled;
+    _totNotional += r.notional;
+    _totSlippage += r.wAvgSlippage() * r.absShsFilled;
+    _totFillMinutes += r.totalFillMinutes();
+  }
+  if (_fd != -1) {
+    _outBuf.push_back(r);
+    if ((int)_outBuf.size() >= WRITE_BATCH) {
+      flushRecords();
+    }
+  }
+
+  _live[cid] = -1;
+  _free.push_back(slot);
+}
+
+void StreamingTCTracker::completeAll(TCRecord::Completion how) {
+  for (unsigned int cid = 0; cid < _live.size(); cid++) {
+    complete(cid, how);
+  }
+  flushRecords();
+}
+
+void StreamingTCTracker::flushRecords() {
+  if (_fd == -1 || _outBuf.empty()) {
+    _outBuf.clear();
+    return;
+  }
+  const char *p = (const char *)&_outBuf[0];
+  size_t left = _outBuf.size() * sizeof(TCRecord);
+  while (left > 0) {
+    ssize_t n = write(_fd, p, left);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      TAEL_PRINTF(_ddebug.get(), TAEL_ERROR, "StreamingTCTracker: write to %s failed (%s), no more records will be written",
+		  _recordFile.c_str(), strerror(errno));
+      close(_fd);
+      _fd = -1;
+      break;
+    }
+    p += n;
+    left -= n;
+  }
+  _outBuf.clear();
+}
+
+/*
+  Fills go to the stock's live request.
+*/
+void StreamingTCTracker::update(const OrderUpdate &ou) {
+  if (ou.action() !=  Mkt::FILLED) {
+    return;
+  }
+  int slot = _live[ou.cid()];
+  if (slot < 0) {
+    _numOrphanFills++;
+    return;
+  }
+  TCRecord &r = _pool[slot];
+  int64_t t = ou.tv().count();
+  int size = ou.thisShares();
+  double px = ou.thisPrice();
+  if (r.numFills == 0) {
+    r.firstFillNs = t;
+  }
+  r.lastFillNs = t;
+  r.numFills++;
+  r.shsFilled += (ou.side() == Mkt::BID ? size : -size);
+  r.absShsFilled += size;
+  r.sumFillPx += px;
+  r.notional += size * px;
+}
+
+void StreamingTCTracker::update(const OrderCancelSuggestion &ocs) {
+  const Order *ord = _dm->getOrder(ocs._orderId);
+  if (ord == NULL) {
+    return;
+  }
+  int slot = _live[ord->cid()];
+  if (slot >= 0) {
+    _pool[slot].numCancels++;
+  }
+}
+
+void StreamingTCTracker::update(const OrderPlacementSuggestion &ops) {
+  int slot = _live[ops._cid];
+  if (slot >= 0) {
+    _pool[slot].numPlaces++;
+  }
+}
+
+/*
+  New request:  completes the live one, if any, and takes its place.
+*/
+void StreamingTCTracker::update(const TradeRequest &tr) {
+  complete(tr._cid, TCRecord::REPLACED);
+  int slot;
+  if (!_free.empty()) {
+    slot = _free.back();
+    _free.pop_back();
+  } else {
+    slot = _pool.size();
+    _pool.push_back(TCRecord());
+  }
+  TCRecord &r = _pool[slot];
+  memset(&r, 0, sizeof(r));
+  r.orderID = tr._orderID;
+  r.recvNs = tr._recvTime.count();
+  r.priority = tr._priority;
+  r.cbid = tr._cbid;
+  r.cask = tr._cask;
+  r.cid = tr._cid;
+  r.clientId = tr._clientId;
+  r.initPos = tr._initPos;
+  r.targetPos = tr._targetPos;
+  _live[tr._cid] = slot;
+}
+
+void StreamingTCTracker::update(const TimeUpdate &au) {
+  if (au.timer() == _dm->marketOpen()) {
+    _seenMktClose = false;
+    _completedOnClose = false;
+    _numRequests = _numFilledRequests = _numOrphanFills = 0;
+    _totShsFilled = _totNotional = _totSlippage = _totFillMinutes = 0.0;
+  }
+  if (au.timer() == _dm->marketClose()) {
+    _seenMktClose = true;
+    _completedOnClose = false;    
+    _mktCloseTV = au.tv();
+  }
+  if (_seenMktClose == true && _completedOnClose == false) {
+    double diff = HFUtils::milliSecondsBetween(_mktCloseTV, _dm->curtime());
+    if (diff >= PRINT_ON_CLOSE_DELAY_MILLISECONDS) {
+      _completedOnClose = true;
+      completeAll(TCRecord::CLOSE);
+      string prefix("");
+      printTCSummaryInfo(TAEL_WARN, prefix);
+    }
+  }
+}
+
+void StreamingTCTracker::printTCSummaryInfo(tael::Severity plevel, string& prefix) {
+  double avgSlip = (_totShsFilled > 0 ? _totSlippage/_totShsFilled : 0.0);
+  double fracSlip = (_totNotional > 0 ? _totSlippage/_totNotional : 0.0);
+  double avgMins = (_numFilledRequests > 0 ? _totFillMinutes/_numFilledRequests : 0.0);
+  TAEL_PRINTF(_ddebug.get(), plevel, "%s StreamingTCTracker  REQS %ld  FILLED %ld  LIVE %d  ORPHAN-FILLS %ld  SHS %.0f  NOT %.2f  TC-SLIP TOT%.2f  PERSHS%.4f  FRAC%.6f  TC-TIME AVGMINS%.4f",
+	      prefix.c_str(), _numRequests, _numFilledRequests, numLiveRequests(), _numOrphanFills,
+	      _totShsFilled, _totNotional, _totSlippage, avgSlip, fracSlip, avgMins);
+}
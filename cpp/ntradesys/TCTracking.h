@@ -16,6 +16,7 @@ using std::vector;
 using std::list;
 #include <string>
 using std::string;
+#include <stdint.h>
 
 // Hyp2/Hyp3 includes.
 #include "c_util/Time.h"
@@ -219,7 +220,8 @@ class TradeRequestRecordSet {
   - TROPFTracker should only be used for debugging, or inside toy applications that
     do not generate huge order activity.
   - TROPFTTracker should not be used in production execution engine code, especially 
-    production code that handles large customer traffic volumes.
+    production code that handles large customer traffic volumes.  Use StreamingTCTracker
+    there.
 */
 class TROPFTracker : 
   public PlacementsHandler::listener, 
@@ -237,7 +239,7 @@ class TROPFTracker :
 
   bool _printOnClose;                       // Automatically print TC summary info on/after mkt close.
   bool _seenMktClose;                       // Have we seen a markety close message?
-  TimeVal _mktCloseTV;                      // What was the Time of that message.
+  nanotime _mktCloseTV;                     // What was the Time of that message.
   bool _printedOnClose;                     // Have we already dump state following the last mkt close message?
   
   // How long after mkt close to delay printing.
@@ -314,4 +316,118 @@ class TROPFTrackerImmediate :
 };
 
 
+/*
+  Fixed-size record of 1 completed TradeRequest, as kept by StreamingTCTracker.
+  This is also the StreamingTCTracker file format:  records appended back to back,
+    native byte order, no padding (see python/bin/tc_records.py).
+*/
+struct TCRecord {
+  enum Completion { REPLACED = 0,   // A new TradeRequest came in for the stock.
+		    CLOSE = 1 };    // Still open after the close.
+
+  int64_t orderID;          // TradeRequest _orderID.
+  int64_t recvNs;           // TradeRequest _recvTime.
+  int64_t firstFillNs;      // Time of 1st & last fills, 0 for none.
+  int64_t lastFillNs;
+  double priority;          // TradeRequest _priority.
+  double cbid;              // Composite bid & ask @ time of request.
+  double cask;
+  double sumFillPx;         // Sum of fill prices.
+  double notional;          // Sum of fill size * fill price.
+  int32_t cid;
+  int32_t clientId;
+  int32_t initPos;
+  int32_t targetPos;
+  int32_t numPlaces;        // Order placements, cancel attempts & fills while live.
+  int32_t numCancels;
+  int32_t numFills;
+  int32_t shsFilled;        // Net, + for bought.
+  int32_t absShsFilled;     // Gross.
+  int32_t completion;       // Completion.
+
+  // As per the TradeRequestRecord versions.  0 for no fills.
+  double sAvgFillPx() const {return numFills > 0 ? sumFillPx/numFills : 0.0;}
+  double wAvgFillPx() const {return absShsFilled > 0 ? notional/absShsFilled : 0.0;}
+  // Per share, vs initial mid.  Positive # = good = made $ on trading.
+  //   0 without a valid composite bid & ask @ time of request.
+  double wAvgSlippage() const;
+  // Minutes from request to last fill.
+  double totalFillMinutes() const;
+};
+
+/*
+  Production version of TROPFTracker.  Keeps only the live TradeRequest per stock,
+    as a fixed-size TCRecord from a pool, and accumulates its placement/cancel/fill
+    counts, fill prices and fill times as they happen.
+  - A request is complete when the next TradeRequest for the stock comes in, or
+    PRINT_ON_CLOSE_DELAY_MILLISECONDS after the close (to catch late fills).  Completed
+    requests are folded into day-level slippage & fill-time aggregates, and appended 
+    to the record file, if any, then their record goes back to the pool.
+  - Memory is thus bounded by the number of stocks with a live request, not by
+    the day's activity.
+  - Fills are assigned to the live request on their stock, as per TROPFTracker.
+    Fills with no live request are counted, but otherwise dropped.
+  - File writes are batched, WRITE_BATCH records at a time, and flushed at completion
+    of the close.
+*/
+class StreamingTCTracker : 
+  public PlacementsHandler::listener, 
+  public CancelsHandler::listener, 
+  public OrderHandler::listener,
+  public TradeRequestsHandler::listener,
+  public TimeHandler::listener
+{
+ protected:
+  factory<DataManager>::pointer _dm;        // Exists externally.
+  factory<debug_stream>::pointer _ddebug;
+
+  vector<TCRecord> _pool;                   // Records, live or free.
+  vector<int> _free;                        // Free _pool slots.
+  vector<int> _live;                        // Per stock: _pool slot of live request, or -1.
+
+  string _recordFile;                       // Completed requests file.  "" for none.
+  int _fd;                                  //   -1 if not open.
+  vector<TCRecord> _outBuf;                 // Completed records not yet written.
+
+  // Aggregates over completed requests, since the open.
+  long _numRequests;
+  long _numFilledRequests;                  // Those with at least 1 fill.
+  long _numOrphanFills;                     // Fills with no live request.
+  double _totShsFilled;                     // Gross.
+  double _totNotional;
+  double _totSlippage;                      // $, positive # = good.
+  double _totFillMinutes;                   // Over filled requests.
+
+  bool _seenMktClose;
+  nanotime _mktCloseTV;
+  bool _completedOnClose;
+
+  const static int PRINT_ON_CLOSE_DELAY_MILLISECONDS = 10 * 60 * 1000;
+  const static int WRITE_BATCH = 64;
+
+  // Finish stock cid's live request, if any.
+  void complete(int cid, TCRecord::Completion how);
+  void completeAll(TCRecord::Completion how);
+  // Write out _outBuf.
+  void flushRecords();
+ public:
+  // recordFile:  file to append completed requests to.  "" for none.
+  StreamingTCTracker(const string &recordFile = "");
+  virtual ~StreamingTCTracker();
+
+  int numLiveRequests() const {return _pool.size() - _free.size();}
+
+  /*
+    HF dispatcher/event functions.
+  */
+  virtual void update(const OrderUpdate &ou); 
+  virtual void update(const OrderCancelSuggestion &ocs );
+  virtual void update(const OrderPlacementSuggestion &ops); 
+  virtual void update(const TradeRequest &trd);
+  virtual void update(const TimeUpdate &au);
+
+  // Print day-level aggregates.
+  void printTCSummaryInfo(tael::Severity plevel, string& prefix);  
+};
+
 #endif  // __TCTRACKING_H__
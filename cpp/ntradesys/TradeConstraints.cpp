@@ -1,29 +1,21 @@
 #include "TradeConstraints.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
 using trc::compat::util::DateTime;
 
-const TimeVal HALT_TIME_FOLLOWING_UNSOLICITED_CANCEL = TimeVal( 10, 0 ); // 10 seconds
+const nanotime HALT_TIME_FOLLOWING_UNSOLICITED_CANCEL = nanotime::from_sec( 10 ); // 10 seconds
 const int  MIN_CACACPITY_TO_TRADE=0;
 const int IOC_TIMEOUT = 0;
 const static int MAX_PER_TICKER_ORDER_RATE = 75;    // 75 orders per second (default)
 
-PerSymbolConstraints::PerSymbolConstraints( int cid )
-  : _cid( cid ),
-    _dm( factory<DataManager>::get(only::one) ),
-    _logPrinter( factory<debug_stream>::get(std::string("trader")) ),
-    _unsolicitedCxlsLog( factory<debug_stream>::get(std::string("unsolicited-cancels")) ),
-    _centralOrderRepo( factory<CentralOrderRepo>::get(only::one) ),
-    _canBeTradedForSure( false ),
-    _timeToResumeTrading( TimeVal(0) ),
-    _openTracker( factory<OpenTracker>::get(only::one) ),
-    _capTracker( factory<CapacityTracker>::get(only::one)),
-    _ecnsAllowed(),
-    _opWindow(),
-    _orderRate(MAX_PER_TICKER_ORDER_RATE)
-{}
+static inline size_t roundToLine( size_t n ) { return (n + 63) & ~(size_t) 63; }
 
 /*
-  Check whether placing an order in _cid would violate per-stock 
+  Check whether placing an order in cid would violate per-stock 
     order placement rate limits.
   Note:
   - These limits are currently implemented on the execution engine
@@ -31,103 +23,125 @@ PerSymbolConstraints::PerSymbolConstraints( int cid )
     these as per stoxk x virtual-account, but does not reliably communicate
     ecn x session x virtual account mappings to execution, so we choose
     to implenent this per stock to be conservative.
+  - The ring keeps the times of the last _ringSize (>= _orderRate)
+    placements, so the limit is hit iff the _orderRate-th most recent
+    placement was less than a second ago.
 */
-bool PerSymbolConstraints::checkOPRateLimit() {
-  /*  current wall/sim time */
-  TimeVal curtv = _dm->curtv();
-
-  /*  wall/sim time as of 1 second ago.  */
-  TimeVal diff(1, 0);
-  curtv -= diff;
- 
-  /*  remove time-stamps of any order placed > 1 second ago.  */
-  _opWindow.advance(curtv);
+bool TradeConstraints::checkOPRateLimit( int cid ) {
+  const symbol_state &s = _state[cid];
+  if( _orderRate > 0 && (int) s.filled < _orderRate ) return true;
 
-  /*  see how many orders have been placed in last second.  */
-  int sz = _opWindow.size();
-  if (sz >= _orderRate) {
-    // too many orders - would violate rate limit.
-    TAEL_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s WARNING: disallowing order placement that would exceed per-stock order rate limit.",
-			 _dm->symbol(_cid) );
-    return false;
-  } 
+  if( _orderRate > 0 ) {
+    int slot = (int) s.next - _orderRate;
+    if( slot < 0 ) slot += _ringSize;
+    /*  wall/sim time as of 1 second ago.  */
+    nanotime cutoff = _dm->curtime() - nanotime::from_sec(1);
+    if( _opTimes[(size_t) cid * _ringSize + slot] < cutoff.count() ) return true;
+  }
 
-  // not going to violate rate limit.
-  return true;
+  // too many orders - would violate rate limit.
+  TAEL_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s WARNING: disallowing order placement that would exceed per-stock order rate limit.",
+		       _dm->symbol(cid) );
+  return false;
 }
 
-void PerSymbolConstraints::onPlace() {
-  /*  Place current wall/sim time into sliding window.  */
-  TimeVal curtv = _dm->curtv();
-  _opWindow.push(curtv);
+void TradeConstraints::onPlace( int cid ) {
+  /*  Place current wall/sim time into the symbol's ring.  */
+  symbol_state &s = _state[cid];
+  _opTimes[(size_t) cid * _ringSize + s.next] = _dm->curtime().count();
+  if( ++s.next == (uint32_t) _ringSize ) s.next = 0;
+  if( s.filled < (uint32_t) _ringSize ) ++s.filled;
 }
 
-bool PerSymbolConstraints::canPlace() {
+bool TradeConstraints::canPlace( int cid ) {
   // check % of volume constraints.
-  if (!_capTracker->capacity(_cid)) return false;
+  if (!_capTracker->capacity(cid)) return false;
   // check per-ticker risk-mgmt imposed order placement rate limit constraints.
-  if (!checkOPRateLimit()) return false;
+  if (!checkOPRateLimit(cid)) return false;
   
   // check whether stock is trading in normal market session, and
   //   also whether execution system user has temporarily ask for a
   //   halt in trading it.
-  if( _canBeTradedForSure ) return true;
+  symbol_state &s = _state[cid];
+  if( s.open ) return true;
   
-  // _canBeTradedForSure is false ==> check if market is open and if there are recent rejections
-  if( !_openTracker->hasOpenedOnPrimaryExchange(_cid) ) return false; // market is not open for this symbol
-  if( _timeToResumeTrading > _dm->curtv() ) return false;             // it's not time to resume yet
-  if (_dm->stops[_cid]) return false; // trading is halted right now for this symbol
+  // open is false ==> check if market is open and if there are recent rejections
+  if( !_openTracker->hasOpenedOnPrimaryExchange(cid) ) return false; // market is not open for this symbol
+  if( s.resume > _dm->curtime().count() ) return false;               // it's not time to resume yet
+  if (_dm->stops[cid]) return false; // trading is halted right now for this symbol
   
   // ok, we can start/resume trading
-  _canBeTradedForSure = true;
+  s.open = 1;
   return true;
 }
 
-bool PerSymbolConstraints::canPlace( ECN::ECN ecn, double price ) {
-  if( !canPlace(ecn) ) return false;
+bool TradeConstraints::canPlace( int cid, ECN::ECN ecn, double price ) {
+  if( !canPlace(cid, ecn) ) return false;
 
-  if( _specificEcnPxConstraints[ecn].empty() ) return true; // I added this line mostly for efficiency: this is the common scenario by far
+  symbol_state &s = _state[cid];
+  if( !s.holds[ecn] ) return true; // the common scenario by far: no line of _holds touched
   
-  price_to_time::iterator it = _specificEcnPxConstraints[ecn].find( price );
+  price_holds &h = _holds[cid * ECN::ECN_size + ecn];
+  int px = cmp<3>::idx( price );
   // GVNOTE: Not sure if the following is the right behavior (for both buy/sell). Check on it.
-  if( it == _specificEcnPxConstraints[ecn].end() ) 
-    return true;
-  
-  // Are we passed the time-to-resume?
-  if( it->second <= _dm->curtv() ) {
-    _specificEcnPxConstraints[ecn].erase( it );
-    return true;
+  for( int i = 0, j = px & (PRICE_HOLDS - 1); i < PRICE_HOLDS; ++i, j = (j + 1) & (PRICE_HOLDS - 1) ) {
+    if( !h.until[j] || h.px[j] != px ) continue;
+    // Are we passed the time-to-resume?
+    if( h.until[j] <= _dm->curtime().count() ) {
+      h.until[j] = 0;
+      --s.holds[ecn];
+      return true;
+    }
+    return false;
   }
-  return false;
+  return true;
+}
+
+/// Hold trading at price on ecn until the given time.  Takes the slot already
+/// holding this price, else an empty or expired one, else the one expiring soonest.
+void TradeConstraints::holdPrice( int cid, ECN::ECN ecn, double price, nanotime until ) {
+  symbol_state &s = _state[cid];
+  price_holds &h = _holds[cid * ECN::ECN_size + ecn];
+  int px = cmp<3>::idx( price );
+  int64_t now = _dm->curtime().count();
+  int slot = -1, soonest = 0;
+  for( int i = 0, j = px & (PRICE_HOLDS - 1); i < PRICE_HOLDS; ++i, j = (j + 1) & (PRICE_HOLDS - 1) ) {
+    if( h.until[j] && h.px[j] == px ) { slot = j; break; }
+    if( slot < 0 && h.until[j] <= now ) slot = j;
+    if( h.until[j] < h.until[soonest] ) soonest = j;
+  }
+  if( slot < 0 ) slot = soonest;
+  if( !h.until[slot] ) ++s.holds[ecn];
+  h.until[slot] = until.count();
+  h.px[slot] = px;
 }
 
 /// assuming this is a rejection for this cid. 
 /// setting "time-to-resume-trading" according to the type of rejection
-void PerSymbolConstraints::onReject( const OrderUpdate& ou ) {
-  TimeVal haltTime = getHaltTimeFollowingRejection( ou.error() );
-  _timeToResumeTrading = _dm->curtv() + haltTime;
-  _canBeTradedForSure = false;
+void TradeConstraints::onReject( const OrderUpdate& ou ) {
+  int cid = ou.cid();
+  nanotime resume = _dm->curtime() + getHaltTimeFollowingRejection( cid, ou.error() );
+  _state[cid].resume = resume.count();
+  _state[cid].open = 0;
   TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "%-5s Due to rejection, halting trading until %s",
-		       _dm->symbol(_cid), DateTime(_timeToResumeTrading).gettimestring() );
+		       _dm->symbol(cid), DateTime(resume.to_timeval()).gettimestring() );
 }
 
-void PerSymbolConstraints::onCxlRej( const OrderUpdate& ou ) {
-  orders_id_set::const_iterator it = _cancelingOrdersSet.find( ou.id() );
-  if( it != _cancelingOrdersSet.end() ) _cancelingOrdersSet.erase( it );
-  else TAEL_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s WARNING: got a cxl-reject for order ID %d but this order is not in the "
+void TradeConstraints::onCxlRej( const OrderUpdate& ou ) {
+  if( !_cancelingOrders.erase( ou.id() ) )
+    TAEL_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s WARNING: got a cxl-reject for order ID %d but this order is not in the "
 			    "canceling-set", _dm->symbol(ou.cid()), ou.id() );
 }
 
-void PerSymbolConstraints::onFullCxled( const OrderUpdate& ou ) {
+void TradeConstraints::onFullCxled( const OrderUpdate& ou ) {
   if (ou.timeout() == IOC_TIMEOUT )
     return;
-  orders_id_set::const_iterator it = _cancelingOrdersSet.find( ou.id() );
-  if( it != _cancelingOrdersSet.end() ) _cancelingOrdersSet.erase( it );
   // if order is not canceling: This is an unsolicited cancel
-  else onUnsolicitedCxl( ou );
+  if( !_cancelingOrders.erase( ou.id() ) )
+    onUnsolicitedCxl( ou );
 }
 
-void PerSymbolConstraints::onUnsolicitedCxl( const OrderUpdate& ou ) {
+void TradeConstraints::onUnsolicitedCxl( const OrderUpdate& ou ) {
   int bidSzAtLevel = getMarketSize(_dm->subBook(ou.ecn()), ou.cid(), Mkt::BID, ou.price());
   int askSzAtLevel = getMarketSize(_dm->subBook(ou.ecn()), ou.cid(), Mkt::ASK, ou.price());
   // Don't halt trading if there is a plausible reason for the cancel:
@@ -147,10 +161,10 @@ void PerSymbolConstraints::onUnsolicitedCxl( const OrderUpdate& ou ) {
       return;
   }
 
-  TimeVal resumeTime = _dm->curtv() + HALT_TIME_FOLLOWING_UNSOLICITED_CANCEL;
-  _specificEcnPxConstraints[ ou.ecn()][ ou.price() ] = resumeTime;
+  nanotime resumeTime = _dm->curtime() + HALT_TIME_FOLLOWING_UNSOLICITED_CANCEL;
+  holdPrice( ou.cid(), ou.ecn(), ou.price(), resumeTime );
   TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "%-5s Due to unsolicited cancel, halting trading at price %.2f on %s until %s",
-		       _dm->symbol(_cid), ou.price(), ECN::desc(ou.ecn()), DateTime(resumeTime).gettimestring() );
+		       _dm->symbol(ou.cid()), ou.price(), ECN::desc(ou.ecn()), DateTime(resumeTime.to_timeval()).gettimestring() );
 
   TAEL_PRINTF(_unsolicitedCxlsLog.get(), TAEL_WARN, "%-5s Unsolicited cxl on %s (%s,%d@%.2f). "
 			       "The sizes (bid,ask) we see in this level on that ECN: (%d,%d)",
@@ -159,7 +173,7 @@ void PerSymbolConstraints::onUnsolicitedCxl( const OrderUpdate& ou ) {
   return;
 }
 
-TimeVal PerSymbolConstraints::getHaltTimeFollowingRejection( Mkt::OrderResult error ) const {
+nanotime TradeConstraints::getHaltTimeFollowingRejection( int cid, Mkt::OrderResult error ) const {
   switch( error ) {
   case Mkt::UNSHORTABLE:
   case Mkt::GO_SHORT:
@@ -168,53 +182,101 @@ TimeVal PerSymbolConstraints::getHaltTimeFollowingRejection( Mkt::OrderResult er
   case Mkt::NO_REASON:
 //  case Mkt::MARGIN_SERVER:
   case Mkt::POSITION_SERVER:
-    return TimeVal(10,0); // GVNOTE: reduced this from 60 sec to 10 sec
+    return nanotime::from_sec(10); // GVNOTE: reduced this from 60 sec to 10 sec
   case Mkt::POSITION:
   case Mkt::SIZE:
   case Mkt::BUYING_POWER:
   case Mkt::RATE:
   case Mkt::NUM_ORDERS:
-    return TimeVal(10,0); // 10 seconds
+    return nanotime::from_sec(10); // 10 seconds
   case Mkt::GOOD:
     {
-      TAEL_PRINTF(_logPrinter.get(), TAEL_ERROR, "%-5s ERROR: Shouldn't have got a rejection with error==Mkt::GOOD", _dm->symbol(_cid) );
-      return TimeVal( 10,0 );
+      TAEL_PRINTF(_logPrinter.get(), TAEL_ERROR, "%-5s ERROR: Shouldn't have got a rejection with error==Mkt::GOOD", _dm->symbol(cid) );
+      return nanotime::from_sec(10);
     }
     // should have covered them all, but to be on the safe side
   default:
     {
-      TAEL_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s WARNING: Unfamiliar error upon rejection", _dm->symbol(_cid) );
-      return TimeVal( 10,0 );
+      TAEL_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s WARNING: Unfamiliar error upon rejection", _dm->symbol(cid) );
+      return nanotime::from_sec(10);
     }
   }
 }
 
 TradeConstraints::TradeConstraints()
-  : _dm( factory<DataManager>::get(only::one) ),
-    _logPrinter( factory<debug_stream>::get(std::string("trader")) ) 
+  : _block( 0 ),
+    _ncids( 0 ),
+    _ringSize( 0 ),
+    _state( 0 ),
+    _opTimes( 0 ),
+    _holds( 0 ),
+    _orderRate( MAX_PER_TICKER_ORDER_RATE ),
+    _dm( factory<DataManager>::get(only::one) ),
+    _logPrinter( factory<debug_stream>::get(std::string("trader")) ),
+    _unsolicitedCxlsLog( factory<debug_stream>::get(std::string("unsolicited-cancels")) ),
+    _centralOrderRepo( factory<CentralOrderRepo>::get(only::one) ),
+    _openTracker( factory<OpenTracker>::get(only::one) ),
+    _capTracker( factory<CapacityTracker>::get(only::one) )
 {
-  _perSymbolConstraints.resize( _dm->cidsize() );
-  for( int cid=0; cid<_dm->cidsize(); cid++ )
-    _perSymbolConstraints[cid] = new PerSymbolConstraints( cid );
+  _ncids = _dm->cidsize();
+  allocate( _orderRate );
 
   _dm -> add_listener_front( this );
 }
 
 TradeConstraints::~TradeConstraints() {
-  for( int cid=0; cid<_dm->cidsize(); cid++ )
-    delete _perSymbolConstraints[cid];
+  free( _block );
+}
+
+void TradeConstraints::allocate( int ringSize ) {
+  size_t stateBytes = roundToLine( _ncids * sizeof(symbol_state) );
+  size_t ringBytes  = roundToLine( (size_t) _ncids * ringSize * sizeof(int64_t) );
+  size_t holdBytes  = (size_t) _ncids * ECN::ECN_size * sizeof(price_holds);
+  void *p = 0;
+  if( posix_memalign( &p, 64, stateBytes + ringBytes + holdBytes ) != 0 )
+    throw std::bad_alloc();
+  memset( p, 0, stateBytes + ringBytes + holdBytes );
+
+  char *block = (char *) p;
+  symbol_state *state = (symbol_state *) block;
+  int64_t *opTimes = (int64_t *) (block + stateBytes);
+  price_holds *holds = (price_holds *) (block + stateBytes + ringBytes);
+
+  if( _block ) {
+    memcpy( state, _state, _ncids * sizeof(symbol_state) );
+    memcpy( holds, _holds, holdBytes );
+    // keep the most recent placements, oldest first
+    for( int cid = 0; cid < _ncids; cid++ ) {
+      symbol_state &s = state[cid];
+      int keep = std::min( (int) s.filled, ringSize );
+      for( int k = 0; k < keep; k++ ) {
+        int from = ((int) s.next - keep + k + _ringSize) % _ringSize;
+        opTimes[(size_t) cid * ringSize + k] = _opTimes[(size_t) cid * _ringSize + from];
+      }
+      s.filled = keep;
+      s.next = keep % ringSize;
+    }
+    free( _block );
+  }
+
+  _block = block;
+  _ringSize = ringSize;
+  _state = state;
+  _opTimes = opTimes;
+  _holds = holds;
 }
   
 void TradeConstraints::set( ECN::ECN ecn, bool allowedToTrade ) {
+  uint16_t bit = 1 << ecn;
   if( ecn != ECN::NYSE ) {
-    for( int cid=0; cid<_dm->cidsize(); cid++ )
-      _perSymbolConstraints[cid] -> set( ecn, allowedToTrade );
+    for( int cid=0; cid<_ncids; cid++ )
+      _state[cid].ecns = allowedToTrade ? (_state[cid].ecns | bit) : (_state[cid].ecns & ~bit);
     TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "TradeConstraints: %s %s", (allowedToTrade ? "enabled" : "disabled"), ECN::desc(ecn) );
   } else { // for NYSE: enable only tape-A tickers
     factory<ExchangeTracker>::pointer exchangeT = factory<ExchangeTracker>::get(only::one);
-    for( int cid=0; cid<_dm->cidsize(); cid++ ) 
+    for( int cid=0; cid<_ncids; cid++ ) 
       if( exchangeT->getTape( cid ) == Mkt::TAPE_A )
-	_perSymbolConstraints[cid] -> set( ecn, allowedToTrade );
+	_state[cid].ecns = allowedToTrade ? (_state[cid].ecns | bit) : (_state[cid].ecns & ~bit);
     TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "TradeConstraints: %s %s for tape A symbols",
 			 (allowedToTrade ? "enabled" : "disabled"), ECN::desc(ecn) );
   }
@@ -222,25 +284,26 @@ void TradeConstraints::set( ECN::ECN ecn, bool allowedToTrade ) {
 
 void TradeConstraints::setOrderRate( int orderRate ){
   TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "TradeConstraints:: setting order rate to %d",orderRate );
-   for( int cid=0; cid<_dm->cidsize(); cid++ )
-     _perSymbolConstraints[cid] -> setOrderRate( orderRate );
+  _orderRate = orderRate;
+  if( orderRate > _ringSize )
+    allocate( orderRate );
 }
 
 void TradeConstraints::update( const OrderUpdate& ou ) {
   switch( ou.action() ) {
   case Mkt::CANCELING:
     if( ou.thisShares() == ou.sharesOpen() ) // order considered as canceling only if this is a full-cancel, not a "reduce-size"
-      _perSymbolConstraints[ou.cid()] -> onFullCxling( ou );
+      _cancelingOrders.insert( ou.id() );
     break;
   case Mkt::CXLREJECTED:
-    _perSymbolConstraints[ou.cid()] -> onCxlRej( ou );
+    onCxlRej( ou );
     break;
   case Mkt::CANCELED:
     if( ou.sharesOpen() == 0 ) // only care about full-cancelations
-      _perSymbolConstraints[ou.cid()] -> onFullCxled( ou );
+      onFullCxled( ou );
     break;
   case Mkt::REJECTED:
-    _perSymbolConstraints[ou.cid()] -> onReject( ou );
+    onReject( ou );
     break;
   default:
     break;
@@ -249,13 +312,8 @@ void TradeConstraints::update( const OrderUpdate& ou ) {
 
 void TradeConstraints::update( const TimeUpdate &t ) {
     if (t.timer() == _dm->marketClose()) {
-        for( int cid=0; cid<_dm->cidsize(); cid++ )
-            _perSymbolConstraints[cid] -> set( false );
+        for( int cid=0; cid<_ncids; cid++ )
+            _state[cid].open = 0;
         TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "TradeConstraints:: MARKET IS CLOSED, should not trade anymore" );
     }
 }
-
-
-void TradeConstraints::onPlace( int cid ) {
-  _perSymbolConstraints[cid]->onPlace();
-}
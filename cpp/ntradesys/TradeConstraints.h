@@ -8,7 +8,8 @@
 #ifndef _TRADE_CONSTRAINTS_H_
 #define _TRADE_CONSTRAINTS_H_
 
-#include <bitset>
+#include <ext/hash_set>
+#include <stdint.h>
 using namespace std;
 
 #include <cl-util/factory.h>
@@ -21,47 +22,18 @@ using namespace clite::util;
 #include "OpenTracker.h"
 #include "CentralOrderRepo.h"
 
-#include "SlidingWindow.h"
-
-/// Constraints over a single cid
-class PerSymbolConstraints {
-private:
-  const int                          _cid;
-  factory<DataManager>::pointer      _dm;
-  factory<debug_stream>::pointer     _logPrinter;
-  factory<debug_stream>::pointer     _unsolicitedCxlsLog;
-  factory<CentralOrderRepo>::pointer _centralOrderRepo;
+/* Can we trade a particular cid [on a particular ECN [in a particular price]]
+ * Based on: 
+ * - market opened?
+ * - Any recent rejections?
+ * - User allows trading on a particular ECN?
+ * - Recent unsolicited cancels in a particular ECN and price?
+ */
+class TradeConstraints : public OrderHandler::listener, public TimeHandler::listener {
+public:  
+  TradeConstraints();
+  virtual ~TradeConstraints();
 
-  /// General constraints for the symbol
-  bool                          _canBeTradedForSure; /// if true - can be traded. If false - should check (market opened? Recent REJECTs?)
-  TimeVal                       _timeToResumeTrading; // Set following rejections (though should also check marketOpen before resuming)
-  factory<OpenTracker>::pointer _openTracker;
-  factory<CapacityTracker>::pointer _capTracker;
-  /// ECN constraints for the symbol
-  bitset<ECN::ECN_size> _ecnsAllowed; /// Keeps track of which ECNs engine is allowed to trade on. 
-
-  /// ECN*price constraints for the symbol
-  typedef clite::util::cmp<3>::hash_map<TimeVal>::type price_to_time;
-  typedef __gnu_cxx::hash_set<int>                     orders_id_set;
-
-  orders_id_set _cancelingOrdersSet; // A set of all orders of this symbol in a canceling state (fully canceling only)
-  price_to_time _specificEcnPxConstraints[ECN::ECN_size]; /// one hash-map of (price ==> time to resume) for every ECN
-
-  /// Rate limiting of per-ticker order placements.
-  /// Note: Tower infra applies per ticker x virtual-account rate limits.  The mapping between
-  ///   accounts, virtual accounts, and ECNs can be many - many.  So, to be safe, we
-  ///   apply per ticker order placement rate limits, rather than per ticker x ecn
-  ///   order placement rate limits.
-  SlidingWindow<TimeVal> _opWindow;
-  int _orderRate;
-  TimeVal getHaltTimeFollowingRejection( Mkt::OrderResult error ) const;
-
-  /// Check whether placing order (for stock _cid) would violate risk-mgmt imposed/asked-for
-  ///   limits on order placement rate.
-  bool checkOPRateLimit();
-public:
-  PerSymbolConstraints( int cid );
-  
   // Note:  3 versions of canPlace cleaned up 20101001.  Same name + incremental parameter
   //   list suggest that different versions should implement progressively more restrictive
   //   checks - e.g. canPlace(ecn) should check everything that canPlace() does, and also
@@ -76,39 +48,10 @@ public:
   //   canPlace(ecn):  as canPlace(), plus checks trading on specific ecn allowed.
   //   canPlace(ecn, price): as canPlace(ecn), plus checks for recent unsolicited cancels at
   //     specified {ecn,price}.
-  bool canPlace();                                                /// Checks whether market opened for the symbol, for recent rejections, 
+  bool canPlace( int cid );                                       /// Checks whether market opened for the symbol, for recent rejections, 
                                                                   ///   and for OPR rate limits.
-  bool canPlace( ECN::ECN ecn ) {return canPlace() && _ecnsAllowed[ecn];} /// check for set of ECNs on which we can trade (set by user)
-  bool canPlace( ECN::ECN ecn, double price );                    /// check for the set of ECNs as well as for recent unsolicited cancels
-
-  void set( bool tradingAllowed ) { _canBeTradedForSure = tradingAllowed; }
-  void set( ECN::ECN ecn, bool allowed ) { _ecnsAllowed.set( ecn, allowed ); }
-  void setOrderRate ( int OrderRate ) { _orderRate = OrderRate; }
-  // Tell constraint-system that have just placed an order.
-  void onPlace();
-
-  void onReject( const OrderUpdate& ou ); // halt trading for a while
-
-  inline void onFullCxling( const OrderUpdate& ou ) { _cancelingOrdersSet.insert(ou.id()); }
-  void onCxlRej( const OrderUpdate& ou ); /// remove the order from the canceling-orders set
-  void onFullCxled( const OrderUpdate& ou );  /// either remove order from set or go to onUnsolicitedCxl
-  void onUnsolicitedCxl( const OrderUpdate& ou ); /// halt trading for a while and report
-};
-/* Can we trade a particular cid [on a particular ECN [in a particular price]]
- * Based on: 
- * - market opened?
- * - Any recent rejections?
- * - User allows trading on a particular ECN?
- * - Recent unsolicited cancels in a particular ECN and price?
- */
-class TradeConstraints : public OrderHandler::listener, public TimeHandler::listener {
-public:  
-  TradeConstraints();
-  virtual ~TradeConstraints();
-
-  inline bool canPlace( int cid ) { return _perSymbolConstraints[cid] -> canPlace(); }
-  inline bool canPlace( int cid, ECN::ECN ecn ) const { return _perSymbolConstraints[cid] -> canPlace(ecn); } 
-  inline bool canPlace( int cid, ECN::ECN ecn, double price ) { return _perSymbolConstraints[cid] -> canPlace(ecn, price); }
+  inline bool canPlace( int cid, ECN::ECN ecn ) { return canPlace(cid) && (_state[cid].ecns & (1 << ecn)); } /// check for set of ECNs on which we can trade (set by user)
+  bool canPlace( int cid, ECN::ECN ecn, double price );           /// check for the set of ECNs as well as for recent unsolicited cancels
 
   void set( ECN::ECN ecn, bool allowedToTrade );
   void setOrderRate ( int OrderRate );
@@ -125,15 +68,68 @@ public:
   // it would then be possible for the system to violate order placement rate limits.
   // As suchm we instead use an explicit notification that an order is about to be placed.
   void onPlace(int cid);
+
+  /// Price holds kept per (cid, ECN); a further unsolicited cancel at a new price
+  /// replaces the hold that expires soonest.
+  static const int PRICE_HOLDS = 4;
+
 protected:
-  vector<PerSymbolConstraints*>  _perSymbolConstraints; /// one for each symbol
+  /// Everything canPlace(cid, ecn) reads about a symbol, half a cache line.
+  struct symbol_state {
+    int64_t  resume;                    /// ns: no trading before this, following a reject
+    uint32_t next;                      /// next slot in the symbol's order-placement ring
+    uint32_t filled;                    /// placements in the ring, up to the ring size
+    uint16_t ecns;                      /// bit per ECN the user allows trading on
+    uint8_t  open;                      /// known tradable: opened, no recent rejects (was _canBeTradedForSure)
+    uint8_t  holds[ECN::ECN_size];      /// price holds in use per ECN; 0 is the common case
+  };
+
+  /// Recent unsolicited cancels at one (cid, ECN): a tiny open-addressed table of
+  /// price (cmp<3>::idx) -> time to resume, one cache line.  until == 0 is empty.
+  struct price_holds {
+    int64_t until[PRICE_HOLDS];
+    int32_t px[PRICE_HOLDS];
+    char    pad_[64 - PRICE_HOLDS * 12];
+  };
+
+  /// Per symbol, in one allocation: _state[cid], then _opTimes[cid * _ringSize ...]
+  /// (times of the last _ringSize placements, a ring), then
+  /// _holds[cid * ECN::ECN_size + ecn].
+  char*         _block;
+  int           _ncids;
+  int           _ringSize;
+  symbol_state* _state;
+  int64_t*      _opTimes;
+  price_holds*  _holds;
+  int           _orderRate;
+
+  /// Orders (of any symbol) in a canceling state (fully canceling only)
+  __gnu_cxx::hash_set<int> _cancelingOrders;
 
-  factory<DataManager>::pointer  _dm;
-  factory<debug_stream>::pointer _logPrinter;
+  factory<DataManager>::pointer      _dm;
+  factory<debug_stream>::pointer     _logPrinter;
+  factory<debug_stream>::pointer     _unsolicitedCxlsLog;
+  factory<CentralOrderRepo>::pointer _centralOrderRepo;
+  factory<OpenTracker>::pointer      _openTracker;
+  factory<CapacityTracker>::pointer  _capTracker;
 
   virtual void update( const OrderUpdate& ou ); /// look for unsolicited cancels
   virtual void update( const TimeUpdate& t ); /// look for market-close message
 
+  /// (Re)lay out the block for a ring of ringSize placements per symbol,
+  /// keeping whatever state fits.
+  void allocate( int ringSize );
+
+  /// Check whether placing order (for stock cid) would violate risk-mgmt imposed/asked-for
+  ///   limits on order placement rate.
+  bool checkOPRateLimit( int cid );
+  nanotime getHaltTimeFollowingRejection( int cid, Mkt::OrderResult error ) const;
+
+  void onReject( const OrderUpdate& ou ); // halt trading for a while
+  void onCxlRej( const OrderUpdate& ou ); /// remove the order from the canceling-orders set
+  void onFullCxled( const OrderUpdate& ou );  /// either remove order from set or go to onUnsolicitedCxl
+  void onUnsolicitedCxl( const OrderUpdate& ou ); /// halt trading for a while and report
+  void holdPrice( int cid, ECN::ECN ecn, double price, nanotime until );
 };
 
 # endif // _TRADE_CONSTRAINTS_H_
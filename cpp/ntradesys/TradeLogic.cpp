@@ -1,10 +1,13 @@
  #include "TradeLogic.h"
  #include "CentralOrderRepo.h"
+#include <cl-util/trace.h>
+
+namespace trace = clite::util::trace;
 
  const int BUF_SIZE = 1024;
  static char buffer[BUF_SIZE];
 
- const TimeVal MAX_TIME_WITHOUT_TOUCH(0,100000); /// 0.1 sec. Add an artificial "touch" to a stock after 0.1 seconds without touch
+ const nanotime MAX_TIME_WITHOUT_TOUCH = nanotime::from_ms(100); /// 0.1 sec. Add an artificial "touch" to a stock after 0.1 seconds without touch
 
  TradeLogic::TradeLogic( TradeLogicComponent* component ) 
    : _stocksState( factory<StocksState>::get(only::one) ),
@@ -22,7 +25,7 @@
 
    _associations.resize( _dm->cidsize(), 0 );
    _numTouches.resize( _dm->cidsize(), 0 );
-   _lastTouch.resize( _dm->cidsize(), TimeVal(0) );
+   _lastTouch.resize( _dm->cidsize(), nanotime() );
    _currentlyTrading.resize( _dm->cidsize(), 0 );
    _errCount.resize( _dm->cidsize(), 0);
    _lastOrderResult.resize( _dm->cidsize(), Mkt::NO_REASON);
@@ -56,6 +59,7 @@
    int rnd = rand();
    if (rnd > _OrderProb * RAND_MAX)
      return false;
+   _dm->latency().stamp(clite::util::tick_to_trade::DECISION);
    
   // Check with DM whether this order can be placed (DM checks with RejectTracker, with lib2/lib3 etc.)
   int orderId;
@@ -68,13 +72,13 @@
 	newsize =  int(floor( _riskLimits->maxNotional() / price ) );
 	if ((ecn==ECN::NYSE) || (ecn==ECN::ARCA)){
 	  // Dont send odd lots to these places
-	  TAEL_PRINTF(_logPrinter.get(), TAEL_ERROR, "%-5s TL: Risk: Cant trade size=%d price=%.2f",
+	  DS_PRINTF(_logPrinter.get(), TAEL_ERROR, "%-5s TL: Risk: Cant trade size=%d price=%.2f",
 			       _dm->symbol(cid),size, price);
 	  return false;
 	}
 	
       }
-      TAEL_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s TL: Risk: resizing order to respect risk limits %d -> %d @ %.2f",
+      DS_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s TL: Risk: resizing order to respect risk limits %d -> %d @ %.2f",
 			   _dm->symbol(cid),size, newsize,price);
       size=newsize;
     }
@@ -83,7 +87,7 @@
   // Check to make sure that there are no know constraints that would prevent us
   //   from placing specified order.
   if (!_tradeConstraints->canPlace(cid, ecn, price)) {
-      TAEL_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s TL: TradeConstraints: Cant trade size=%d price=%.2f",
+      DS_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s TL: TradeConstraints: Cant trade size=%d price=%.2f",
 			       _dm->symbol(cid),size, price);
       return false;
   }
@@ -93,7 +97,8 @@
   //   placing an order, as opposed to waiting for a PLACED OrderUpdate.
   _tradeConstraints->onPlace(cid);
 
-  Mkt::OrderResult orst = _dm->placeOrder( cid, ecn, size, price, side, timeout, false, &orderId, ss->getOrderID(), ss->getMarking(), placementSugg.PlacementReasonDesc[(int)placementSugg._reason] );
+  Mkt::OrderResult orst = _dm->placeOrder( cid, ecn, size, price, side, timeout, false, &orderId, ss->getOrderID(), ss->getMarking(),
+                                           (Placement::Reason) placementSugg._reason, placementSugg._componentId );
   
   if (orst!=_lastOrderResult[cid]){
     _errCount[cid]=0;
@@ -104,15 +109,15 @@
 
   if( orst != Mkt::GOOD ) {
     if( _errCount[cid]%100==0 ) {
-      TAEL_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s dm->placeOrder returned %s, NOT placing order",
+      DS_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s dm->placeOrder returned %s, NOT placing order",
 			   _dm->symbol(cid), Mkt::OrderResultDesc[orst] );
-      TAEL_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s OrderDetails: ecn = %s, size = %d, price = %.2f, side = %s, timeout = %d",
+      DS_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s OrderDetails: ecn = %s, size = %d, price = %.2f, side = %s, timeout = %d",
 			   _dm->symbol(cid), ECN::desc(ecn), size, price, Mkt::SideDesc[side], timeout );
     }
     return false;
   }
   if( orderId < 0 ) {
-    TAEL_PRINTF(_logPrinter.get(), TAEL_ERROR, "%-5s BUG in TradeLogic::placeOrder. DM::placeOrder returned Mkt::GOOD but orderId is %d",
+    DS_PRINTF(_logPrinter.get(), TAEL_ERROR, "%-5s BUG in TradeLogic::placeOrder. DM::placeOrder returned Mkt::GOOD but orderId is %d",
 			 _dm->symbol( cid ), orderId );
     return false;
   }
@@ -129,14 +134,14 @@
 					     crossSide, timeout, false, marketImpactEst)) {  // Note - false should be ops._invisible.
       char buf[256];
       placementSugg.snprint(buf, 256);
-      TAEL_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s TL: MarketImpact: unable to estimate MI of order, using 0 : %s",
+      DS_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s TL: MarketImpact: unable to estimate MI of order, using 0 : %s",
 			   _dm->symbol(cid), buf);  
     } else {
       marketImpact = marketImpactEst.permanentImpact();
     }
   }
 
-  TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "%-5s TL::placeOrder: %s %4d shs on %s at %7.3f Reason = %s "
+  DS_PRINTF(_logPrinter.get(), TAEL_INFO, "%-5s TL::placeOrder: %s %4d shs on %s at %7.3f Reason = %s "
 		       "compId = %2d cbbo=(%.2f,%.2f) sizes=(%d,%d) id=%d pri=%.6f impact=%.8f", 
 		       _dm->symbol(cid), Mkt::SideDesc[side], size, ECN::desc(ecn), price, 
 		       OrderPlacementSuggestion::PlacementReasonDesc[placementSugg._reason], 
@@ -158,7 +163,7 @@ void TradeLogic::cancelOrder( OrderCancelSuggestion cancelSuggestion ) {
   // For logging
   const Order* order = _dm -> getOrder( orderId );
   if( order==NULL ) {
-    TAEL_PRINTF(_logPrinter.get(), TAEL_ERROR, "ERROR: In TradeLogic::cancelOrder encountered an OrderRecord with "
+    DS_PRINTF(_logPrinter.get(), TAEL_ERROR, "ERROR: In TradeLogic::cancelOrder encountered an OrderRecord with "
 			 "id (%d) DM doesn't know of", orderId );
     return; // Order not found in DM
   }
@@ -172,7 +177,7 @@ void TradeLogic::cancelOrder( OrderCancelSuggestion cancelSuggestion ) {
 
   if ((order->realecn() == ECN::NYSE) && (order->state() == Mkt::NEW)) {
 	  // SingleStockState *ss = _stocksState->getState( order->cid() );
-	  TAEL_PRINTF(_logPrinter.get(), TAEL_ERROR, "Trying to cancel NYSE order without getting a CNF. "
+	  DS_PRINTF(_logPrinter.get(), TAEL_ERROR, "Trying to cancel NYSE order without getting a CNF. "
 			      "%s (TL::cancelOrder): id=%d (%s,%3d@%.2f,%s) compId=%d %s",
 		          _dm->symbol(order->cid()), order->id(), Mkt::SideDesc[order->side()], order->sharesOpen(),
 		          order->price(), ECN::desc(order->ecn()), cancelSuggestion._componentId,
@@ -180,11 +185,12 @@ void TradeLogic::cancelOrder( OrderCancelSuggestion cancelSuggestion ) {
 	  return;
   }
 
+  _dm->latency().stamp(clite::util::tick_to_trade::DECISION);
   _dm->cancelOrder( orderId );
   _cancelsHandler->send( cancelSuggestion );
 
   SingleStockState *ss = _stocksState->getState( order->cid() );
-  TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "%-5s (TL::cancelOrder): id=%d (%s,%3d@%.2f,%s) compId=%d %s cbbo=(%.2f,%.2f) sizes=(%d,%d)",
+  DS_PRINTF(_logPrinter.get(), TAEL_INFO, "%-5s (TL::cancelOrder): id=%d (%s,%3d@%.2f,%s) compId=%d %s cbbo=(%.2f,%.2f) sizes=(%d,%d)",
 		       _dm->symbol(order->cid()), order->id(), Mkt::SideDesc[order->side()], order->sharesOpen(), order->price(), 
 		       ECN::desc(order->ecn()), cancelSuggestion._componentId, 
 		       OrderCancelSuggestion::CancelReasonDesc[cancelSuggestion._reason],
@@ -205,7 +211,10 @@ int TradeLogic::placeNewOrders( int cid, vector<OrderPlacementSuggestion> &place
 int TradeLogic::cancelUndesiredOrders( int cid, unsigned int bidCapacity, unsigned int askCapacity, double priority ) {
 
   vector<OrderCancelSuggestion> cancelSuggestions;
-  _mainTLComponent -> suggestOrderCancels( cid, bidCapacity, askCapacity, priority, _tradeLogicId, cancelSuggestions );
+  {
+    trace::span sp( "suggestOrderCancels", cid, &typeid(*_mainTLComponent) );
+    _mainTLComponent -> suggestOrderCancels( cid, bidCapacity, askCapacity, priority, _tradeLogicId, cancelSuggestions );
+  }
 
   // Cancel the specified orders.
   for( unsigned int i=0; i<cancelSuggestions.size(); i++ ) 
@@ -228,8 +237,9 @@ void TradeLogic::update( const WakeUpdate& wu ) {
     if( _associations[cid] == 0 ) continue;
     // stock not touched since last wakeup - no need to revisit trading decisions (unless some time has passed since the last touch.
     // After all, some of our trading decisions are based on time limits: trade-halting, JQ-backup,.. )
-    if( _lastTouch[cid] < _dm->curtv() - MAX_TIME_WITHOUT_TOUCH ) addTouch( cid );
+    if( _lastTouch[cid] < _dm->curtime() - MAX_TIME_WITHOUT_TOUCH ) addTouch( cid );
     if( numTouches(cid) < 1 ) continue;
+    trace::span cidSpan( "TradeLogic", cid, &typeid(*this) );
     
     numCancelled = numPlaced = numOutstanding = 0;  
     ss = _stocksState -> getState( cid );
@@ -252,10 +262,16 @@ void TradeLogic::update( const WakeUpdate& wu ) {
     // if trade not open yet for some reason / halted for this symbol ==> don't place new orders
     if( _tradeConstraints->canPlace( cid ) ) {
       subPlacementSuggs.clear();
-      _mainTLComponent -> suggestOrderPlacements( cid, Mkt::BID, _tradeLogicId, bidCapacity, priority, subPlacementSuggs );
+      {
+        trace::span sp( "suggestOrderPlacements", cid, &typeid(*_mainTLComponent) );
+        _mainTLComponent -> suggestOrderPlacements( cid, Mkt::BID, _tradeLogicId, bidCapacity, priority, subPlacementSuggs );
+      }
       placementSuggs.insert( placementSuggs.end(), subPlacementSuggs.begin(), subPlacementSuggs.end() );
       subPlacementSuggs.clear();
-      _mainTLComponent -> suggestOrderPlacements(cid, Mkt::ASK, _tradeLogicId, askCapacity, priority, subPlacementSuggs);
+      {
+        trace::span sp( "suggestOrderPlacements", cid, &typeid(*_mainTLComponent) );
+        _mainTLComponent -> suggestOrderPlacements(cid, Mkt::ASK, _tradeLogicId, askCapacity, priority, subPlacementSuggs);
+      }
       placementSuggs.insert( placementSuggs.end(), subPlacementSuggs.begin(), subPlacementSuggs.end() );
       if( placementSuggs.size() > 0 )
 	numPlaced = placeNewOrders( cid, placementSuggs ); 
@@ -270,7 +286,7 @@ void TradeLogic::update( const WakeUpdate& wu ) {
     //  Print some summary info about cancels/placements/outstanding orders.
     //  For efficiency, checking debug-level outside the printf function
     if( _logPrinter->configuration().threshold() >= TAEL_DATA && (numCancelled > 0 || numPlaced > 0) ) {
-    	TAEL_PRINTF(_logPrinter.get(), TAEL_DATA, "%-5s In TradeLogic::update(wakeup): #Cancelled = %d, #Placed = %d, #Outstanding = %d, "
+    	DS_PRINTF(_logPrinter.get(), TAEL_DATA, "%-5s In TradeLogic::update(wakeup): #Cancelled = %d, #Placed = %d, #Outstanding = %d, "
 			   "mkt = (BID %d) x (%.2f,%.2f) x (%d ASK)", 
 			   _dm->symbol(cid), numCancelled, numPlaced, numOutstanding, 
 			   ss->bestSize(Mkt::BID), ss->bestPrice(Mkt::BID), 
@@ -283,17 +299,17 @@ void TradeLogic::update( const WakeUpdate& wu ) {
 }
 
 void TradeLogic::update( const TradeRequest& tr ) {
-  //TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "Got a TradeRequest for %s initPos: %d prevTarget: %d newTarget: %d",
+  //DS_PRINTF(_logPrinter.get(), TAEL_INFO, "Got a TradeRequest for %s initPos: %d prevTarget: %d newTarget: %d",
   //            _dm->symbol(tr._cid), tr._initPos, tr._previousTarget, tr._targetPos);
   if( !_associations[tr._cid] ) return;
 
-  //TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "Setting currentlyTrading = 1");
+  //DS_PRINTF(_logPrinter.get(), TAEL_INFO, "Setting currentlyTrading = 1");
   _currentlyTrading[tr._cid] = 1;
   addTouch( tr._cid );
 
   // in case this is a stop request, and just in case we don't want to wait until the next wakeup to cancel our outstanding orders:
   if( tr._targetPos == _dm->position(tr._cid) && getMarketOrders(_dm->orderBook(), tr._cid)>0 ) {
-    TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "%-5s In TradeLogic::update(TradeRequest) cancelling all orders because request identified as "
+    DS_PRINTF(_logPrinter.get(), TAEL_INFO, "%-5s In TradeLogic::update(TradeRequest) cancelling all orders because request identified as "
 			 "a stop request", _dm->symbol(tr._cid) );
     cancelAllOrders( tr._cid , OrderCancelSuggestion::STOP_REQ );
   }
@@ -307,7 +323,7 @@ void TradeLogic::cancelAllOrders( int cid, OrderCancelSuggestion::CancelReason r
   vector<const OrderRecord*> orders = _centralRepo->getOrderRecords( cid );
   for( unsigned int i=0; i<orders.size(); i++ ) {
     OrderCancelSuggestion cxlSugg( orders[i]->orderId(), orders[i]->componentId(), reason, 
-				   ss->bestPrice(Mkt::BID),ss->bestPrice(Mkt::ASK),_dm->curtv() );
+				   ss->bestPrice(Mkt::BID),ss->bestPrice(Mkt::ASK),_dm->curtime() );
     _cancelsHandler->send( cxlSugg );
   }
 }
@@ -322,14 +338,14 @@ void TradeLogic::cancelAllOrders( int cid, ECN::ECN ecn, OrderCancelSuggestion::
     int orderId = ordRecs[i] -> orderId();
     const Order* order = _dm -> getOrder( orderId );
     if( order==NULL ) {
-      TAEL_PRINTF(_logPrinter.get(), TAEL_ERROR, "%-5s ERROR: In TradeLogic::cancelAllOrders(cid,ecn,reason) encountered an OrderRecord with "
+      DS_PRINTF(_logPrinter.get(), TAEL_ERROR, "%-5s ERROR: In TradeLogic::cancelAllOrders(cid,ecn,reason) encountered an OrderRecord with "
 			   "id (%d) DM doesn't know of", _dm->symbol(cid), orderId );
       continue; // Order not found in DM
     }
     if( order->ecn() != ecn ) continue; // Order on a different ECN
     if( order->isCanceling() ) continue; // Don't double-cancel an order
      if( !printedComment ) {
-      TAEL_PRINTF(_logPrinter.get(), TAEL_ERROR, "%-5s TL: cancelling all orders on %s (%s)",
+      DS_PRINTF(_logPrinter.get(), TAEL_ERROR, "%-5s TL: cancelling all orders on %s (%s)",
 			   _dm->symbol(cid), ECN::desc(ecn), 
 			   OrderCancelSuggestion::CancelReasonDesc[reason]);
       printedComment = true;
@@ -337,13 +353,13 @@ void TradeLogic::cancelAllOrders( int cid, ECN::ECN ecn, OrderCancelSuggestion::
     OrderCancelSuggestion cxlSugg( orderId, ordRecs[i]->componentId(), 
 				   reason, 
 				   ss->bestPrice(Mkt::BID),ss->bestPrice(Mkt::ASK),
-				   _dm->curtv() );
+				   _dm->curtime() );
     cancelOrder( cxlSugg );
   }
 }
 
 void TradeLogic::disconnect() {
-  TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "TradeLogic::disconnect called" );
+  DS_PRINTF(_logPrinter.get(), TAEL_INFO, "TradeLogic::disconnect called" );
   for( int cid=0; cid<_dm->cidsize(); cid++ ) {
     if( _associations[cid] ) {
       cancelAllOrders( cid, OrderCancelSuggestion::DISCONNECT );
@@ -355,14 +371,14 @@ void TradeLogic::disconnect() {
 // Tell TradeLogic that it has just been associated with a specified stock.
 bool TradeLogic::associate( int cid ) {
   _associations[ cid ] = 1;
-  TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "In TradeLogic::associate. Setting currentlyTrading = 1 for %s", _dm->symbol(cid));
+  DS_PRINTF(_logPrinter.get(), TAEL_INFO, "In TradeLogic::associate. Setting currentlyTrading = 1 for %s", _dm->symbol(cid));
   _currentlyTrading[ cid ] = 1;
   //   addTouch( cid );  // removed because addTouch uses _dm->curtv() which is not available on initialization
   return true;
 }
 
 bool TradeLogic::disassociate(int cid) {
-  TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "%-5s TradeLogic::disassociate called", _dm->symbol(cid) );
+  DS_PRINTF(_logPrinter.get(), TAEL_INFO, "%-5s TradeLogic::disassociate called", _dm->symbol(cid) );
   cancelAllOrders( cid, OrderCancelSuggestion::DISASSOCIATE );
   _associations[cid] = 0; 
   _currentlyTrading[ cid ] = 0;
@@ -371,6 +387,8 @@ bool TradeLogic::disassociate(int cid) {
 
 void TradeLogic::update( const OrderUpdate& ou ) { 
   addTouch(ou.cid()); 
-  ou.snprint( buffer, BUF_SIZE );
-  TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "%-5s TL::update(OU): %s", _dm->symbol(ou.cid()), buffer );
+  if (_logPrinter->enabled(TAEL_INFO)) {
+    ou.snprint( buffer, BUF_SIZE );
+    DS_PRINTF(_logPrinter.get(), TAEL_INFO, "%-5s TL::update(OU): %s", _dm->symbol(ou.cid()), buffer );
+  }
 }
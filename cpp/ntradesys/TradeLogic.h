@@ -46,7 +46,7 @@ protected:
 
   vector<char>    _associations;     // which symbols (cid-s) are associated with this TL?
   vector<int>     _numTouches;       // Number of packets that touched each stock, between last wakeup and current. 
-  vector<TimeVal> _lastTouch;        // The last time this stock has been touched (we artificially add touches after a whil without it)
+  vector<nanotime> _lastTouch;       // The last time this stock has been touched (we artificially add touches after a whil without it)
   vector<char>    _currentlyTrading; // are we currently trading each cid (i.e. we are not in target pos and/or have outstanding orders)
   
   vector<Mkt::OrderResult> _lastOrderResult; // last orderstate returned by placeorder
@@ -59,7 +59,7 @@ protected:
   bool placeOrder( int cid, OrderPlacementSuggestion& placementSugg );
 
   bool isAssociated( int cid ) const {return _associations[cid] == 1;}
-  void addTouch( int cid ) { _numTouches[cid]++; _lastTouch[cid]=_dm->curtv(); }
+  void addTouch( int cid ) { _numTouches[cid]++; _lastTouch[cid]=_dm->curtime(); }
   int  numTouches( int cid ) const { return _numTouches[cid]; }
   void clearTouches() { _numTouches.assign(_dm->cidsize(), 0); }
 
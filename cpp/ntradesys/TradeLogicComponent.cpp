@@ -47,7 +47,7 @@ void TradeLogicComponent::suggestOrderCancels( int cid, unsigned int bidCapacity
       SingleStockState *ss =_stocksState -> getState( cid );
       OrderCancelSuggestion cancelSugg( orderId, _componentId, cancelReason, 
 					ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK),
-					_dm->curtv() );
+					_dm->curtime() );
       cancelSuggestions.push_back( cancelSugg );
     }
   }
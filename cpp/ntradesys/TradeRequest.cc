@@ -5,7 +5,7 @@ using namespace clite::util;
 using trc::compat::util::DateTime;
 
 int TradeRequest::snprint(char *s, int n) const {
-    DateTime dt(_recvTime);
+    DateTime dt(_recvTime.to_timeval());
     int i = snprintf(s, n, "TR-REQ %02d:%02d:%02d:%06d  BPX%.2f  APX%.2f %i -> %i  P%.6f",
 		     dt.hh(), dt.mm(), dt.ss(), dt.usec(), _cbid, _cask, 
 		  _initPos, _targetPos, _priority);
@@ -3,6 +3,8 @@
 
 #include "c_util/Time.h"
 using trc::compat::util::TimeVal;
+#include <cl-util/nanotime.h>
+using clite::util::nanotime;
 
 #include "Markets.h"
 #include <clite/message.h>
@@ -32,13 +34,13 @@ class TradeRequest {
 
   double _cbid;           // Composite bid @ time of request.  Ignoring odd lots.
   double _cask;           // Composite ask @ time of request.  Ignoring odd lots.
-  TimeVal _recvTime;      // Time at which request was received.
+  nanotime _recvTime;     // Time at which request was received.
   Mkt::Marking _marking ; // User specified short marking
   long _orderID;          // User specified orderID
   int _clientId; //The client that requested the trade
 
   TradeRequest( int cid, int previousTarget, int initPos, int targetPos, double priority, 
-		double cbid, double cask, TimeVal recvTime, long orderID, int clientId, Mkt::Marking mark = Mkt::UNKWN )
+		double cbid, double cask, nanotime recvTime, long orderID, int clientId, Mkt::Marking mark = Mkt::UNKWN )
     : _cid(cid), _previousTarget(previousTarget), _initPos(initPos), 
       _targetPos(targetPos), _priority(priority), 
       _cbid(cbid), _cask(cask), _recvTime(recvTime), _orderID(orderID), _clientId(clientId), _marking(mark) {}
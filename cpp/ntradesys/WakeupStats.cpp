@@ -1,24 +1,22 @@
 #include "WakeupStats.h"
 using trc::compat::util::DateTime;
 
-#define MILLION (1000*1000)
-
 WakeupStats::WakeupStats()
   : _wakeupNumber( 0 ),
-    _lastWakeupTV( 0 ),
+    _lastWakeupTV( ),
     _maxDeltaUSec( 0 ),
-    _logPrinter( factory<debug_stream>::get(std::string("wakeups")) )
+    _logPrinter( factory<debug_stream>::get(std::string("wakeups")) ),
+    _dm( factory<DataManager>::find(only::one) )
 {
-  factory<DataManager>::pointer dm = factory<DataManager>::find(only::one);
-  if( !dm )
+  if( !_dm )
     throw std::runtime_error( "Failed to get DataManager from factory (in WakeupStats::WakeupStats)" );
-  //  dm -> add_listener_back( this );
-  dm -> add_listener( this );
+  //  _dm -> add_listener_back( this );
+  _dm -> add_listener( this );
   printFieldNames();
 }
 
 void WakeupStats::update( const WakeUpdate& wu ) {
-  int deltaUSec = (wu.tv.usec() - _lastWakeupTV.usec()) + MILLION * ( wu.tv.sec() - _lastWakeupTV.sec() );
+  int deltaUSec = (int) ((wu.tv - _lastWakeupTV).count() / 1000);
   if( deltaUSec > _maxDeltaUSec )
     _maxDeltaUSec = deltaUSec;
   _lastWakeupTV = wu.tv;
@@ -26,7 +24,7 @@ void WakeupStats::update( const WakeUpdate& wu ) {
   // Prints stats every 1000 wakeups
   _wakeupNumber++; 
   if( _wakeupNumber % 1000 == 0 )
-    flushStats( wu.tv );
+    flushStats( wu.tv.to_timeval() );
 }
 
 void WakeupStats::flushStats( TimeVal curtv ) {
@@ -34,6 +32,12 @@ void WakeupStats::flushStats( TimeVal curtv ) {
   TAEL_PRINTF(_logPrinter.get(), TAEL_INFO, "%02d:%02d:%02d.%06d %12d %12d",
 		       curDT.hh(), curDT.mm(), curDT.ss(), curDT.usec(), _wakeupNumber, _maxDeltaUSec ); 
   _maxDeltaUSec = 0;
+
+  perf_counters *pc = _dm->perfCounters();
+  if( pc ) {
+    pc->print( _logPrinter.get(), TAEL_INFO );
+    pc->clear();
+  }
 }
 
 void WakeupStats::printFieldNames() const {
@@ -8,14 +8,16 @@ using namespace clite::util;
 #include "DataManager.h"
 
 /*
- *  WakeupStats: a simple wakeup-listener that occasionally prints statisitcs about wakeups
+ *  WakeupStats: a simple wakeup-listener that occasionally prints statisitcs about wakeups,
+ *  along with the DataManager's perf-counter totals when those are enabled.
  */
 class WakeupStats : public WakeupHandler::listener {
 protected:
   int     _wakeupNumber;
-  TimeVal _lastWakeupTV;
+  nanotime _lastWakeupTV;
   int     _maxDeltaUSec; // the maximal delta between wakeups, in microsecs
   factory<debug_stream>::pointer _logPrinter;
+  factory<DataManager>::pointer _dm;
 
   void update( const WakeUpdate& wu );
   void flushStats( TimeVal curtv ); /// print stats and initialize member variables if needed
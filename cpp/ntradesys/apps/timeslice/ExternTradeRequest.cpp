@@ -77,7 +77,7 @@ void ExternTradeRequest::processAFill( const OrderUpdate& ou ) {
   
   // update the "fills" vector
   int signedSize = ou.thisShares() * ( ou.dir() == Mkt::BUY ? 1 : -1 );
-  ExternTradeFill* newFill = new ExternTradeFill( signedSize, ou.thisPrice(), ou.tv(), ou.totalFees() );
+  ExternTradeFill* newFill = new ExternTradeFill( signedSize, ou.thisPrice(), ou.tv().to_timeval(), ou.totalFees() );
   _fills.push_back( newFill );
   
   // If reached target ==> update the relevant internal variables and print a summary
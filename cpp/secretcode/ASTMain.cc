@@ -42,6 +42,8 @@ void ASTConfigHelper::setDefaultValues() {
   exchangeFile = "/apps/exec/param-files/exchanges.20090828";
   useVolume = false;
   printTicks = false;
+  batchTrades = false;
+  liveEtfBetaWeight = 0.0;
   exitOnClose = false;
   signalKFRTBasic = false;
   signalKFRTETF = false;
@@ -67,6 +69,8 @@ void ASTConfigHelper::setConfigOptions() {
   defOption("taelLogFile", &taelLogFile, "File to which TAEL logger should send output");
   defOption("useVolume", &useVolume, "Whether KFRT signal should attempt to use volume info in signal");
   defOption("printTicks", &printTicks, "Whether KFRT signal should print info about state update on every tick");
+  defOption("batchTrades", &batchTrades, "Whether KFRT signal should apply trades in batches, once per wakeup");
+  defOption("liveEtfBetaWeight", &liveEtfBetaWeight, "Weight (0-1) on live intraday ETF betas in KFRT-ETF signal, shrunk toward file betas (default 0 = off)", 0.0);
   defOption("exitOnClose", &exitOnClose, "Whether tester should exit when it sees market-close message");
   defOption("signalKFRTBasic", &signalKFRTBasic, "Include KFRT-Basic signal");
   defOption("signalKFRTETF", &signalKFRTETF, "Include KFRT-ETF signal");
@@ -157,6 +161,7 @@ int main(int argc, char **argv) {
   SpdTracker spdt(50, 60, 1000);  
   factory<BasicKFRTSignal>::pointer kfrtSignal = factory<BasicKFRTSignal>::get(only::one);
   kfrtSignal->setPrintTicks(cfgHelper.printTicks);
+  kfrtSignal->setBatchTrades(cfgHelper.batchTrades);
 
   AlphaSignal *signal;
 
@@ -180,6 +185,7 @@ int main(int argc, char **argv) {
   if (cfgHelper.signalKFRTETF == true) {
     factory<ETFKFRTSignal>::pointer etfKFRTSignal = factory<ETFKFRTSignal>::get(only::one);
     etfKFRTSignal->setPrintTicks(cfgHelper.printTicks);
+    etfKFRTSignal->setLiveBetaWeight(cfgHelper.liveEtfBetaWeight);
     signals.push_back(etfKFRTSignal.get());
   } 
   if (cfgHelper.signalPLSOB == true) {
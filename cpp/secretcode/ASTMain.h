@@ -23,6 +23,8 @@ public:
 
   bool useVolume;        // EW all trades (false), or treat each round-lot as separate data point (true).
   bool printTicks;       // Print debug/daignostic info on each incoming tick?
+  bool batchTrades;      // Apply trades to KFRT signals in batches, once per wakeup?
+  double liveEtfBetaWeight; // Weight on live intraday ETF betas in KFRT-ETF signal (0 = file betas only).
   bool exitOnClose;      // Exit when see market close message.
 
   // Booleans specifying whether to include signals of various flavors.
@@ -3,14 +3,129 @@
 
 /*
    Template class implementing a circular buffer.
-   Also includes functionality for getting mean & stdev of 
+   Also includes functionality for getting mean & stdev of
      elements in buffer.
+
+   Notes:
+   - Storage is a ring of size+1 elements (the extra slot holds the element
+     before the oldest, which trailing windows need).
+   - Mean & stdev of the whole buffer are kept as running moments (Welford,
+     with the evicted element taken out), recomputed from the contents every
+     time the ring wraps so rounding can't accumulate.
+   - Mean & stdev of the trailing numElem elements come from running prefix
+     sums, in O(1).  The prefix sums are of the elements less a reference
+     value (the mean as of the last wrap), which keeps the squares small for
+     price-like data.
+   - The two prefix-sum rings are only allocated (and built from the
+     contents) on the first trailing-window query.  A buffer that is only
+     asked for whole-buffer stats costs (size+1) elements, about what the
+     plain ring did; one used for trailing windows costs 3 * (size+1).
+   - Passes over the contents (the recomputation, getCor) use AVX2 kernels
+     for double when the CPU has it.
 */
 #include <cstddef>
 #include <iostream>
+#include <algorithm>
 
 #include "math.h"
 
+#include <immintrin.h>
+
+namespace circbuffer_kernels {
+
+  // Sums of (x-ref) & (x-ref)^2 over x[0..n), added to *s1 & *s2.
+  template<class T>
+  inline void moments( const T *x, int n, T ref, T *s1, T *s2 ) {
+    T a = 0, b = 0;
+    for (int i=0;i<n;i++) {
+      T d = x[i] - ref;
+      a += d;
+      b += d * d;
+    }
+    *s1 += a;
+    *s2 += b;
+  }
+
+  // Centered cross moments of x & y, added to *sxx, *syy, *sxy.
+  template<class T>
+  inline void comoments( const T *x, const T *y, int n, T ax, T ay, T *sxx, T *syy, T *sxy ) {
+    T a = 0, b = 0, c = 0;
+    for (int i=0;i<n;i++) {
+      T xt = x[i] - ax;
+      T yt = y[i] - ay;
+      a += xt * xt;
+      b += yt * yt;
+      c += xt * yt;
+    }
+    *sxx += a;
+    *syy += b;
+    *sxy += c;
+  }
+
+  inline bool haveAVX2() {
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+  }
+
+  __attribute__((target("avx2")))
+  inline void moments_avx2( const double *x, int n, double ref, double *s1, double *s2 ) {
+    __m256d r = _mm256_set1_pd(ref);
+    __m256d a = _mm256_setzero_pd(), b = _mm256_setzero_pd();
+    int i = 0;
+    for (;i+4<=n;i+=4) {
+      __m256d d = _mm256_sub_pd(_mm256_loadu_pd(x+i), r);
+      a = _mm256_add_pd(a, d);
+      b = _mm256_add_pd(b, _mm256_mul_pd(d, d));
+    }
+    double ta[4], tb[4];
+    _mm256_storeu_pd(ta, a);
+    _mm256_storeu_pd(tb, b);
+    *s1 += (ta[0] + ta[1]) + (ta[2] + ta[3]);
+    *s2 += (tb[0] + tb[1]) + (tb[2] + tb[3]);
+    moments(x+i, n-i, ref, s1, s2);
+  }
+
+  __attribute__((target("avx2")))
+  inline void comoments_avx2( const double *x, const double *y, int n, double ax, double ay,
+                              double *sxx, double *syy, double *sxy ) {
+    __m256d mx = _mm256_set1_pd(ax), my = _mm256_set1_pd(ay);
+    __m256d a = _mm256_setzero_pd(), b = _mm256_setzero_pd(), c = _mm256_setzero_pd();
+    int i = 0;
+    for (;i+4<=n;i+=4) {
+      __m256d xt = _mm256_sub_pd(_mm256_loadu_pd(x+i), mx);
+      __m256d yt = _mm256_sub_pd(_mm256_loadu_pd(y+i), my);
+      a = _mm256_add_pd(a, _mm256_mul_pd(xt, xt));
+      b = _mm256_add_pd(b, _mm256_mul_pd(yt, yt));
+      c = _mm256_add_pd(c, _mm256_mul_pd(xt, yt));
+    }
+    double ta[4], tb[4], tc[4];
+    _mm256_storeu_pd(ta, a);
+    _mm256_storeu_pd(tb, b);
+    _mm256_storeu_pd(tc, c);
+    *sxx += (ta[0] + ta[1]) + (ta[2] + ta[3]);
+    *syy += (tb[0] + tb[1]) + (tb[2] + tb[3]);
+    *sxy += (tc[0] + tc[1]) + (tc[2] + tc[3]);
+    comoments(x+i, y+i, n-i, ax, ay, sxx, syy, sxy);
+  }
+
+  inline void moments( const double *x, int n, double ref, double *s1, double *s2 ) {
+    if (haveAVX2()) {
+      moments_avx2(x, n, ref, s1, s2);
+      return;
+    }
+    moments<double>(x, n, ref, s1, s2);
+  }
+
+  inline void comoments( const double *x, const double *y, int n, double ax, double ay,
+                         double *sxx, double *syy, double *sxy ) {
+    if (haveAVX2()) {
+      comoments_avx2(x, y, n, ax, ay, sxx, syy, sxy);
+      return;
+    }
+    comoments<double>(x, y, n, ax, ay, sxx, syy, sxy);
+  }
+}
+
 template<class T>
 class CircBuffer {
   public:
@@ -39,76 +154,152 @@ class CircBuffer {
     // Estimate pearson correlation of contents of 2 CircBuffers.
     // - Both buffers should have same size.
     // - Uses all elements in both buffers.
-    static bool getCor(const CircBuffer<T> *x, const CircBuffer<T> *y, T* fv); 
+    static bool getCor(const CircBuffer<T> *x, const CircBuffer<T> *y, T* fv);
 
     // Estimate pearson correlation using trailing <numEleme> elements only.
     // - Both buffers should have at least that many elements.
-    static bool getCor(const CircBuffer<T> *x, const CircBuffer<T> *y, unsigned int numElem, T* fv); 
+    static bool getCor(const CircBuffer<T> *x, const CircBuffer<T> *y, unsigned int numElem, T* fv);
+
   private:
     int num; //number of elements in buffer
     int wIdx; //index to be written
-    T *buff;
     int maxSize;
-    T _sum;
-    T _sumsq;
+    int len; //ring length, maxSize + 1
+    T *buff;
+    //prefix sums of (x-_ref) and (x-_ref)^2, as of each element.  0 until the
+    //  first trailing-window query.
+    mutable T *pre1, *pre2;
+    long _adds; //elements added since cleared
+    mutable T _b1, _b2; //prefix sums before the 1st element since cleared
+    mutable T _p1, _p2; //prefix sums now
+    mutable T _ref;
+    T _mean, _m2; //running mean & sum of squared deviations of the buffer's contents
+    T _inv; //1/maxSize
+
+    CircBuffer( const CircBuffer<T> & );
+    CircBuffer<T> & operator = ( const CircBuffer<T> & );
+
+    // offset <= maxSize, so one wrap at most.
+    int at( int offset ) const { int i = wIdx - 1 - offset; return i < 0 ? i + len : i; }
+    // Sums of (x-ref) and (x-ref)^2 over the trailing numElem elements.
+    void trailingSums( unsigned int numElem, T *s1, T *s2 ) const;
+    // Recompute _mean & _m2 from the contents, and the prefix sums if kept.
+    void resync();
+    // (Re)build the prefix sums from the contents, referenced to the mean.
+    void rebuildPrefix() const;
 };
 
 template<class T>
 CircBuffer<T>::CircBuffer( int initSize ) :
-  num(0), wIdx(0), maxSize(initSize), _sum(0), _sumsq(0) 
+  num(0), wIdx(0), maxSize(initSize), len(initSize + 1), pre1(0), pre2(0)
 {
-  buff = new T[initSize];
-  for (int i=0;i<initSize;i++)
-    buff[i]=0;
+  buff = new T[len];
+  clear();
 }
 
 template<class T>
 CircBuffer<T>::~CircBuffer() {
   if (buff != NULL) delete [] buff;
+  if (pre1 != NULL) delete [] pre1;
   maxSize=0;
   num=0;
   wIdx=0;
 }
 
-template<class T> 
+template<class T>
 void CircBuffer<T>::add( const T & elem ) {
-  _sum-=buff[wIdx];
-  _sumsq-=buff[wIdx]*buff[wIdx];
+  if (_adds == 0)
+    _ref = elem;
+  // running moments: take out the element falling off, put in the new one
+  if (num < maxSize) {
+    num++;
+    T d = elem - _mean;
+    _mean += d / num;
+    _m2 += d * (elem - _mean);
+    if (num == maxSize)
+      _inv = T(1) / num;
+  } else {
+    T old = buff[at(maxSize - 1)];
+    T oldMean = _mean;
+    _mean += (elem - old) * _inv;
+    _m2 += (elem - old) * (elem - _mean + old - oldMean);
+    if (_m2 < 0) _m2 = 0;
+  }
   buff[wIdx] = elem;
-  wIdx++;
-  _sum+=elem;
-  _sumsq+=elem*elem;
-  if (wIdx == maxSize) {
+  if (pre1 != NULL) {
+    T d = elem - _ref;
+    _p1 += d;
+    _p2 += d * d;
+    pre1[wIdx] = _p1;
+    pre2[wIdx] = _p2;
+  }
+  _adds++;
+  if (++wIdx == len) {
     wIdx = 0;
+    resync();
   }
-  if (num < maxSize) {
-    num++;
+}
+
+template<class T>
+void CircBuffer<T>::resync() {
+  if (num == 0) return;
+  T s1 = 0, s2 = 0;
+  int start = at(num - 1);
+  int first = std::min(num, len - start);
+  circbuffer_kernels::moments(buff + start, first, _mean, &s1, &s2);
+  circbuffer_kernels::moments(buff, num - first, _mean, &s1, &s2);
+  T m = _mean;
+  _mean = m + s1 / num;
+  _m2 = s2 - s1 * s1 / num;
+  if (_m2 < 0) _m2 = 0;
+  if (pre1 != NULL)
+    rebuildPrefix();
+}
+
+template<class T>
+void CircBuffer<T>::rebuildPrefix() const {
+  if (pre1 == NULL) {
+    pre1 = new T[2 * len];
+    pre2 = pre1 + len;
+    for (int i=0;i<2*len;i++)
+      pre1[i] = 0;
   }
+  // re-reference the prefix sums to the current mean, so that they stay
+  // small and the squares don't cancel.  Only the trailing num elements
+  // (and the one before, which the spare slot keeps) are ever looked at.
+  _ref = _mean;
+  T p1 = 0, p2 = 0;
+  int i = at(num);
+  pre1[i] = pre2[i] = 0;
+  for (int k=num-1;k>=0;k--) {
+    i = at(k);
+    T d = buff[i] - _ref;
+    p1 += d;
+    p2 += d * d;
+    pre1[i] = p1;
+    pre2[i] = p2;
+  }
+  _b1 = _b2 = 0;
+  _p1 = p1;
+  _p2 = p2;
 }
 
-template<class T> 
+template<class T>
 bool CircBuffer<T>::getLast( T* lastVal) const {
   *lastVal = -1.0;
   if ( num == 0)
     return(false);
-  if (wIdx==0)
-    *lastVal = buff[maxSize-1];
-  else
-    *lastVal = buff[wIdx-1];
+  *lastVal = buff[at(0)];
   return true;
 }
 
-template<class T> 
+template<class T>
 bool CircBuffer<T>::getLast( unsigned int offset, T* lastVal) const {
   *lastVal = -1.0;
-  if (offset >= (unsigned int)num) { 
+  if (offset >= (unsigned int)num) {
     return false;
   }
-  int idx = wIdx - 1 - offset;
-  if (idx < 0) {
-    idx += maxSize;
-  }
-  *lastVal = buff[idx];
+  *lastVal = buff[at(offset)];
   return true;
 }
 
@@ -116,39 +307,51 @@ template<class T>
 void CircBuffer<T>::clear() {
   wIdx = 0;
   num = 0;
+  _adds = 0;
+  _b1 = _b2 = _p1 = _p2 = 0;
+  _ref = 0;
+  _mean = _m2 = 0;
+  for (int i=0;i<len;i++)
+    buff[i] = 0;
+  if (pre1 != NULL)
+    for (int i=0;i<2*len;i++)
+      pre1[i] = 0;
+}
+
+template<class T>
+void CircBuffer<T>::trailingSums( unsigned int numElem, T *s1, T *s2 ) const {
+  if (pre1 == NULL)
+    rebuildPrefix();
+  if ((long) numElem < _adds) {
+    int i = at(numElem);
+    *s1 = _p1 - pre1[i];
+    *s2 = _p2 - pre2[i];
+  } else {
+    *s1 = _p1 - _b1;
+    *s2 = _p2 - _b2;
+  }
 }
 
 
 template<class T>
 bool CircBuffer<T>::getAvg( T *avgVal ) const {
   if (num >0){
-    *avgVal = _sum/num;
+    *avgVal = _mean;
     return(true);
   }
   return(false);
-    
+
 }
 
 
 template<class T>
 bool CircBuffer<T>::getAvg( unsigned int numElem, T *avgVal ) const {
-  T sumElem = 0;
-  bool ret = false;
-  if ((int) numElem <= num) {
-    int rIdx = wIdx - 1;
-    for (unsigned int i=0; i<numElem; i++) {
-      if (rIdx < 0) {
-        //The read index is going off the beginning of the
-        //buffer so move it back to the end
-        rIdx = rIdx + maxSize;
-      }
-      sumElem += buff[rIdx];
-      rIdx--;
-    }
-    *avgVal = sumElem / numElem;
-    ret = true;
-  }  
-  return ret;
+  if ((int) numElem > num || numElem == 0)
+    return false;
+  T s1, s2;
+  trailingSums(numElem, &s1, &s2);
+  *avgVal = _ref + s1 / numElem;
+  return true;
 }
 
 
@@ -157,7 +360,7 @@ bool CircBuffer<T>::getAvg( unsigned int numElem, T *avgVal ) const {
 template<class T>
 bool CircBuffer<T>::getStdev( T *stdVal ) const {
   if (num >0){
-    *stdVal = pow(_sumsq/num- pow(_sum/num,2),0.5);
+    *stdVal = sqrt(_m2/num);
     return(true);
   }
   return(false);
@@ -170,43 +373,22 @@ bool CircBuffer<T>::getStdev( T *stdVal ) const {
 //Stdev value is returned in stdVal
 template<class T>
 bool CircBuffer<T>::getStdev( unsigned int numElem, T *stdVal ) const {
-  T sumElem = 0;
-  T avgElem = -1;
-  bool ret = false;
-  if ((int) numElem <= num) {
-    int rIdx = wIdx - 1;
-    unsigned int i;
-    for (i=0; i<numElem; i++) {
-      if (rIdx < 0) {
-        rIdx = rIdx + maxSize;
-      }
-      sumElem += buff[rIdx];
-      rIdx--;
-    }
-    avgElem = sumElem / numElem;
-
-    rIdx = wIdx -1;
-    sumElem = 0;
-    for (i=0; i<numElem; i++) {
-      if (rIdx < 0) {
-        rIdx = rIdx + maxSize;
-      }
-      sumElem += (buff[rIdx] - avgElem) *
-                 (buff[rIdx] - avgElem);
-      rIdx--;
-    }
-    *stdVal = pow(sumElem / numElem, 0.5);
-    ret = true;
-  }  
-  return ret;
+  if ((int) numElem > num || numElem == 0)
+    return false;
+  T s1, s2;
+  trailingSums(numElem, &s1, &s2);
+  T m = s1 / numElem;
+  T var = s2 / numElem - m * m;
+  *stdVal = sqrt(var > 0 ? var : 0);
+  return true;
 }
 
 template<class T>
 void CircBuffer<T>::print() const {
   T val;
   std::cout << "------------------CircBuffer-------------------" << std::endl;
-  std::cout << "num " << num << "  wIdx" << wIdx << "  maxSize" << maxSize << "  sum " << _sum 
-	    << "  _sumsq " << _sumsq << std::endl;
+  std::cout << "num " << num << "  wIdx" << wIdx << "  maxSize" << maxSize << "  mean " << _mean
+	    << "  _m2 " << _m2 << std::endl;
   unsigned int sz = (unsigned int) size();
   for (unsigned int i = sz - 1 ; i > 0 ; i--) {
     getLast(i, &val);
@@ -221,68 +403,34 @@ void CircBuffer<T>::print() const {
 const static double TINY = 1e-20;
 template<class T>
 bool CircBuffer<T>::getCor(const CircBuffer<T> *x, const CircBuffer<T> *y, T* fv) {
-    T yt, xt;
-    T syy = 0.0, sxy = 0.0, sxx = 0.0, ay = 0.0, ax = 0.0;
-    unsigned long j;
-    unsigned long n = x.size();
-    if (n == 0) {
-      fv = 0;
-      return false;
-    }
-
-    // Compute averages of both x and y.
-    x.getAvg(ax);            //ax = mean(x); 
-    y.getavg(ay);            //ay = mean(y);
-
-    // Compute correlation coefficient.
-    for (j=0;j<n;j++) {
-      // xt = x[j] - ax;
-      // yt = y[j] - ay;
-      x->getLast(j, &xt);  
-      y->getLast(j, &yt);
-      xt -= ax;
-      yt -= ay;
-      sxx += xt * xt;
-      syy += yt * yt;
-      sxy += xt * yt;
-    }
-
-    double ret = sxy / (sqrt(sxx * syy) + TINY);
-    fv = ret;
-    return true;  
+    return getCor(x, y, x->size(), fv);
 }
 
 template<class T>
 bool CircBuffer<T>::getCor(const CircBuffer<T> *x, const CircBuffer<T> *y, unsigned int numElem, T* fv) {
-    T yt, xt;
     T syy = 0.0, sxy = 0.0, sxx = 0.0, ay = 0.0, ax = 0.0;
-    unsigned long j;
-    unsigned long n = numElem;
-    if (n == 0 || n > (unsigned int)x->size() || n > (unsigned int)y->size()) {
-      fv = 0;
+    int n = numElem;
+    if (n == 0 || n > x->size() || n > y->size()) {
+      *fv = 0;
       return false;
     }
 
     // Compute averages of both x and y.
-    x->getAvg(numElem, &ax);            //ax = mean(x); 
+    x->getAvg(numElem, &ax);            //ax = mean(x);
     y->getAvg(numElem, &ay);            //ay = mean(y);
 
-    // Compute correlation coefficient.
-    for (j=0;j<n;j++) {
-      // xt = x[j] - ax;
-      // yt = y[j] - ay;
-      x->getLast(j, &xt);  
-      y->getLast(j, &yt);
-      xt -= ax;
-      yt -= ay;
-      sxx += xt * xt;
-      syy += yt * yt;
-      sxy += xt * yt;
+    // Compute correlation coefficient, over the runs where both are contiguous.
+    for (int done = 0; done < n; ) {
+      int i = x->at(n - 1 - done);
+      int j = y->at(n - 1 - done);
+      int run = std::min(n - done, std::min(x->len - i, y->len - j));
+      circbuffer_kernels::comoments(x->buff + i, y->buff + j, run, ax, ay, &sxx, &syy, &sxy);
+      done += run;
     }
 
     double ret = sxy / (sqrt(sxx * syy) + TINY);
     *fv = ret;
-    return true;  
+    return true;
 }
 
 #endif  //_CIRCBUFFER_H
@@ -0,0 +1,262 @@
+#include "CoMomentTracker.h"
+#include "OpenTracker.h"
+#include "HFUtils.h"
+#include "AlphaSignal.h"
+
+#include <emmintrin.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+const static double NO_RET = std::numeric_limits<double>::quiet_NaN();
+
+CoMomentTracker::CoMomentTracker(int sampleMilliSeconds, int numSamplePoints,
+                                 int minSamplePoints, AlphaSignal *fvSignal)
+  :
+  _sampleMilliSeconds(sampleMilliSeconds),
+  _numSamplePoints(std::max(1, numSamplePoints)),
+  _minSamplePoints(std::max(2, minSamplePoints)),
+  _fvSignal(fvSignal),
+  _timer(nanotime::from_ms(sampleMilliSeconds), nanotime()),
+  _marketOpen(false),
+  _havePrices(false),
+  _head(0)
+{
+  _dm = factory<DataManager>::find(only::one);
+  if( !_dm )
+    throw std::runtime_error( "Failed to get DataManager from factory (in CoMomentTracker::CoMomentTracker)" );
+  _openT = factory<OpenTracker>::get(only::one);
+  if( !_openT )
+    throw std::runtime_error( "Failed to get OpenTracker from factory (in CoMomentTracker::CoMomentTracker)" );
+  _exchangeT = factory<ExchangeTracker>::get(only::one);
+  if( !_exchangeT )
+    throw std::runtime_error( "Failed to get ExchangeTracker from factory (in CoMomentTracker::CoMomentTracker)" );
+
+  _lastPriceV.assign(_dm->cidsize(), -1.0);
+  _curPriceV.assign(_dm->cidsize(), -1.0);
+  _retV.assign(_dm->cidsize(), NO_RET);
+  _dm->addTimer(_timer);
+  _dm->add_listener(this);
+}
+
+CoMomentTracker::~CoMomentTracker() {
+  _dm->remove_listener(this);
+}
+
+int CoMomentTracker::findPair(int cid, int fcid) const {
+  for (unsigned int i = 0; i < _xCidV.size(); i++) {
+    if (_xCidV[i] == cid && _yCidV[i] == fcid) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int CoMomentTracker::addPair(int cid, int fcid) {
+  int ret = findPair(cid, fcid);
+  if (ret != -1) {
+    return ret;
+  }
+  _xCidV.push_back(cid);
+  _yCidV.push_back(fcid);
+  _cnt.push_back(0.0);
+  int n = _xCidV.size();
+  // The window is laid out for the new pair count on the next flush: windows
+  //   are meant to be set up before the open, so this just starts over.
+  _rx.clear();
+  return n - 1;
+}
+
+void CoMomentTracker::flush() {
+  size_t n = _xCidV.size();
+  _sx.assign(n, 0.0);
+  _sy.assign(n, 0.0);
+  _sxx.assign(n, 0.0);
+  _syy.assign(n, 0.0);
+  _sxy.assign(n, 0.0);
+  _cnt.assign(n, 0.0);
+  _rx.assign(_numSamplePoints * n, 0.0);
+  _ry.assign(_numSamplePoints * n, 0.0);
+  _rok.assign(_numSamplePoints * n, 0.0);
+  _xV.resize(n);
+  _yV.resize(n);
+  _head = 0;
+}
+
+/*
+  SSE2 (all x86-64 guarantees): two pairs a step, then the odd one out.
+*/
+void CoMomentTracker::windowKernel(double *sx, double *sy, double *sxx, double *syy, double *sxy,
+                                   double *cnt, double *vx, double *vy, double *ok,
+                                   const double *x, const double *y, int n) {
+  __m128d one = _mm_set1_pd(1.0);
+  int k = 0;
+  for (; k + 2 <= n; k += 2) {
+    __m128d a = _mm_loadu_pd(x + k);
+    __m128d b = _mm_loadu_pd(y + k);
+    __m128d m = _mm_and_pd(_mm_cmpord_pd(a, a), _mm_cmpord_pd(b, b));
+    a = _mm_and_pd(m, a);
+    b = _mm_and_pd(m, b);
+    __m128d oa = _mm_loadu_pd(vx + k);
+    __m128d ob = _mm_loadu_pd(vy + k);
+    _mm_storeu_pd(sx + k, _mm_add_pd(_mm_loadu_pd(sx + k), _mm_sub_pd(a, oa)));
+    _mm_storeu_pd(sy + k, _mm_add_pd(_mm_loadu_pd(sy + k), _mm_sub_pd(b, ob)));
+    _mm_storeu_pd(sxx + k, _mm_add_pd(_mm_loadu_pd(sxx + k),
+                                      _mm_sub_pd(_mm_mul_pd(a, a), _mm_mul_pd(oa, oa))));
+    _mm_storeu_pd(syy + k, _mm_add_pd(_mm_loadu_pd(syy + k),
+                                      _mm_sub_pd(_mm_mul_pd(b, b), _mm_mul_pd(ob, ob))));
+    _mm_storeu_pd(sxy + k, _mm_add_pd(_mm_loadu_pd(sxy + k),
+                                      _mm_sub_pd(_mm_mul_pd(a, b), _mm_mul_pd(oa, ob))));
+    __m128d p = _mm_and_pd(m, one);
+    _mm_storeu_pd(cnt + k, _mm_add_pd(_mm_loadu_pd(cnt + k), _mm_sub_pd(p, _mm_loadu_pd(ok + k))));
+    _mm_storeu_pd(vx + k, a);
+    _mm_storeu_pd(vy + k, b);
+    _mm_storeu_pd(ok + k, p);
+  }
+  for (; k < n; k++) {
+    bool present = (x[k] == x[k]) && (y[k] == y[k]);
+    double a = present ? x[k] : 0.0;
+    double b = present ? y[k] : 0.0;
+    sx[k] += a - vx[k];
+    sy[k] += b - vy[k];
+    sxx[k] += a * a - vx[k] * vx[k];
+    syy[k] += b * b - vy[k] * vy[k];
+    sxy[k] += a * b - vx[k] * vy[k];
+    cnt[k] += (present ? 1.0 : 0.0) - ok[k];
+    vx[k] = a;
+    vy[k] = b;
+    ok[k] = present ? 1.0 : 0.0;
+  }
+}
+
+void CoMomentTracker::resum() {
+  int n = _xCidV.size();
+  std::fill(_sx.begin(), _sx.end(), 0.0);
+  std::fill(_sy.begin(), _sy.end(), 0.0);
+  std::fill(_sxx.begin(), _sxx.end(), 0.0);
+  std::fill(_syy.begin(), _syy.end(), 0.0);
+  std::fill(_sxy.begin(), _sxy.end(), 0.0);
+  for (int w = 0; w < _numSamplePoints; w++) {
+    const double *a = &_rx[(size_t)w * n];
+    const double *b = &_ry[(size_t)w * n];
+    for (int i = 0; i < n; i++) {
+      _sx[i] += a[i];
+      _sy[i] += b[i];
+      _sxx[i] += a[i] * a[i];
+      _syy[i] += b[i] * b[i];
+      _sxy[i] += a[i] * b[i];
+    }
+  }
+}
+
+/*
+  Mid -> mid returns since the last sample, for every stock that has opened
+    and has a valid price at both ends.  NaN for the others.
+*/
+void CoMomentTracker::populateReturns() {
+  HFUtils::bestMids(_dm.get(), _lastPriceV, _curPriceV, _fvSignal);
+  for (unsigned int i = 0; i < _retV.size(); i++) {
+    double last = _lastPriceV[i], cur = _curPriceV[i];
+    ECN::ECN e = _exchangeT->getExchange(i);
+    if (_havePrices && last > 0 && cur > 0 && _openT->hasOpened(i, e)) {
+      _retV[i] = (cur - last)/last;
+    } else {
+      _retV[i] = NO_RET;
+    }
+  }
+  _lastPriceV.swap(_curPriceV);
+  _havePrices = true;
+}
+
+void CoMomentTracker::addSample() {
+  populateReturns();
+  int n = _xCidV.size();
+  if (n == 0) {
+    return;
+  }
+  if (_rx.size() != (size_t)_numSamplePoints * n) {
+    flush();
+  }
+  for (int i = 0; i < n; i++) {
+    _xV[i] = _retV[_xCidV[i]];
+    _yV[i] = _retV[_yCidV[i]];
+  }
+  size_t row = (size_t)_head * n;
+  windowKernel(&_sx[0], &_sy[0], &_sxx[0], &_syy[0], &_sxy[0], &_cnt[0],
+               &_rx[row], &_ry[row], &_rok[row], &_xV[0], &_yV[0], n);
+  if (++_head == _numSamplePoints) {
+    _head = 0;
+    resum();
+  }
+}
+
+bool CoMomentTracker::getCov(int pair, double &fv) const {
+  double n = _cnt[pair];
+  if (n < _minSamplePoints) {
+    fv = 0.0;
+    return false;
+  }
+  fv = _sxy[pair]/n - (_sx[pair]/n) * (_sy[pair]/n);
+  return true;
+}
+
+bool CoMomentTracker::getCor(int pair, double &fv) const {
+  double cov;
+  if (!getCov(pair, cov)) {
+    fv = 0.0;
+    return false;
+  }
+  double n = _cnt[pair];
+  double mx = _sx[pair]/n, my = _sy[pair]/n;
+  double vx = _sxx[pair]/n - mx * mx;
+  double vy = _syy[pair]/n - my * my;
+  if (vx <= 0 || vy <= 0) {
+    fv = 0.0;
+    return false;
+  }
+  fv = cov / sqrt(vx * vy);
+  return true;
+}
+
+bool CoMomentTracker::getBeta(int pair, double &fv) const {
+  double cov;
+  if (!getCov(pair, cov)) {
+    fv = 0.0;
+    return false;
+  }
+  double n = _cnt[pair];
+  double my = _sy[pair]/n;
+  double vy = _syy[pair]/n - my * my;
+  if (vy <= 0) {
+    fv = 0.0;
+    return false;
+  }
+  fv = cov / vy;
+  return true;
+}
+
+/*
+  UpdateListener functions
+*/
+void CoMomentTracker::update(const TimeUpdate &au) {
+  if (au.timer() == _dm->marketOpen()) {
+    onMarketOpen(au);
+  } else if (au.timer() == _dm->marketClose()) {
+    onMarketClose(au);
+  } else if (au.timer() == _timer && _marketOpen) {
+    addSample();
+  }
+}
+
+void CoMomentTracker::onMarketOpen(const TimeUpdate &au) {
+  _marketOpen = true;
+  _havePrices = false;
+  flush();
+  // Prices as of the open are the base for the 1st period's returns.
+  populateReturns();
+}
+
+void CoMomentTracker::onMarketClose(const TimeUpdate &au) {
+  _marketOpen = false;
+}
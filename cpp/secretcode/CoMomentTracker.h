@@ -0,0 +1,111 @@
+/*
+  CoMomentTracker.h
+
+  Widget that tracks windowed co-moments of per-period returns for registered
+    pairs of stocks, e.g. (stock, ETF) or (stock, factor proxy), and reports
+    their trailing covariance, correlation and beta.
+  Notes:
+  - Samples mid prices (optionally adjusted by an AlphaSignal, as per
+    VolatilityTracker) every _sampleMilliSeconds, while the market is open,
+    and turns them into mid -> mid returns.
+  - Each pair keeps running sums of x, y, x*x, y*y, x*y over the trailing
+    _numSamplePoints samples, where x is the stock's return and y the other
+    leg's.  A new sample adds the new returns and takes out the oldest ones,
+    so each sample is O(1) per pair, and so is each query - independent of
+    the window length.
+  - Storage is columnar, one array per quantity across all pairs, and the
+    per-sample update is a single pass across the pairs (SSE2, 2 pairs a step).
+  - A pair gets no sample for a period in which either leg has no return (no
+    valid price, or not opened yet).  The window is therefore the last
+    _numSamplePoints periods rather than the last _numSamplePoints samples.
+  - The running sums are recomputed from the window every time it wraps, so
+    rounding can't accumulate.
+  - Windows are emptied at the market open.
+*/
+
+#ifndef __COMOMENT_TRACKER_H__
+#define __COMOMENT_TRACKER_H__
+
+#include <vector>
+using std::vector;
+
+#include <cl-util/factory.h>
+using namespace clite::util;
+
+#include "DataManager.h"
+#include "ExchangeTracker.h"
+
+class OpenTracker;
+class AlphaSignal;
+
+class CoMomentTracker : public TimeHandler::listener {
+ protected:
+  factory<DataManager>::pointer _dm;
+  factory<OpenTracker>::pointer _openT;
+  factory<ExchangeTracker>::pointer _exchangeT;
+
+  int _sampleMilliSeconds;           // How freqently to sample mid-prices, in milli-seconds.
+  int _numSamplePoints;              // Window length, in sample periods.
+  int _minSamplePoints;              // Min number of samples in window for a pair to report anything.
+  AlphaSignal *_fvSignal;            // Signal used to adjust stated mid --> fv.  Null --> no adjustment.
+  Timer _timer;
+  bool _marketOpen;
+  bool _havePrices;                  // _lastPriceV holds the previous sample's prices.
+  int _head;                         // Next window row to write.
+
+  vector<int> _xCidV;                // Per pair: stock.
+  vector<int> _yCidV;                // Per pair: ETF/factor it's measured against.
+  vector<double> _lastPriceV;        // Per stock: mid as of the last sample, or -1.
+  vector<double> _curPriceV;         // Per stock: mid as of this sample, or -1.
+  vector<double> _retV;              // Per stock: this sample's return, NaN for none.
+  vector<double> _xV, _yV;           // Per pair: this sample's returns, gathered.
+
+  // Per pair, over the window:
+  vector<double> _sx, _sy, _sxx, _syy, _sxy, _cnt;
+  // [row][pair], the window's returns, 0 where the pair had no sample ...
+  vector<double> _rx, _ry;
+  //  ... and 1 where it had.
+  vector<double> _rok;
+
+  void addSample();
+  void populateReturns();
+  void flush();
+  // Recompute the running sums from the window.
+  void resum();
+
+  void onMarketOpen(const TimeUpdate &au);
+  void onMarketClose(const TimeUpdate &au);
+
+ public:
+  CoMomentTracker(int sampleMilliSeconds, int numSamplePoints, int minSamplePoints, AlphaSignal *fvSignal);
+  virtual ~CoMomentTracker();
+
+  // Register pair (cid, fcid) and return its id.  Registering an existing
+  //   pair returns the existing id.  Pairs should be registered before the
+  //   market opens.
+  int addPair(int cid, int fcid);
+  // Id of pair (cid, fcid), or -1.
+  int findPair(int cid, int fcid) const;
+  int numPairs() const {return _xCidV.size();}
+
+  // Number of samples in pair's window.
+  int nPts(int pair) const {return (int)_cnt[pair];}
+
+  // Trailing (population) covariance of the pair's returns.
+  bool getCov(int pair, double &fv) const;
+  // Trailing correlation.
+  bool getCor(int pair, double &fv) const;
+  // Trailing beta of stock returns on ETF/factor returns: cov(x,y)/var(y).
+  bool getBeta(int pair, double &fv) const;
+
+  // Push one sample of returns into the window (row v, ok), taking the row's old
+  //   samples out of the sums.  A pair is sampled where both x and y are not NaN.
+  //   Over n pairs; exposed for benchmarking.
+  static void windowKernel(double *sx, double *sy, double *sxx, double *syy, double *sxy,
+                           double *cnt, double *vx, double *vy, double *ok,
+                           const double *x, const double *y, int n);
+
+  virtual void update(const TimeUpdate &au);
+};
+
+#endif  // __COMOMENT_TRACKER_H__
@@ -24,7 +24,7 @@ class DumpAlpha: public TimeHandler::listener {
 	factory<ETFKFRTSignal>::pointer kfrtSignal;
 
 	bool marketOpen;
-	TimeVal lastPrintTV;
+	nanotime lastPrintTV;
 	tael::Logger alphalog;
 	boost::shared_ptr<tael::FdLogger> alphafld;
   public:
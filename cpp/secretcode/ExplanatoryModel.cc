@@ -2,6 +2,8 @@
 
 #include <cl-util/float_cmp.h>
 
+#include <emmintrin.h>
+
 // PerStockParams, plus some associated string-conversion functions.
 #include "PerStockParams.h"
 #include "StringConversion.h"
@@ -230,14 +232,29 @@ ERMLinearMultiFactor::ERMLinearMultiFactor(AlphaSignal *idxCFVSignal,
 					   bmatrixd &factorWeights, bmatrixd &factorBetas) :
   _S(factorWeights.size1()),
   _F(factorWeights.size2()),
-  _factorBetas(factorBetas),
-  _indeces(_F, NULL)
+  _indeces(_F, NULL),
+  _factorRetV(_F, 0.0),
+  _validRets(false),
+  _stale(true)
 {
+  _dm = factory<DataManager>::find(only::one);
+  if( !_dm )
+    throw std::runtime_error( "Failed to get DataManager from factory (in ERMLinearMultiFactor::ERMLinearMultiFactor)" );   
+
   vector<double> tweights;
   for (int f = 0;f < _F; f++) {
     copyWeights(factorWeights, _S, f, tweights);
-    _indeces[f] = new SyntheticIndexHF(idxCFVSignal, tweights);
+    if (SyntheticIndexSparseHF::isSparse(tweights)) {
+      _indeces[f] = new SyntheticIndexSparseHF(idxCFVSignal, tweights);
+    } else {
+      _indeces[f] = new SyntheticIndexHF(idxCFVSignal, tweights);
+    }
   }
+  packPanels(factorBetas, _betaPanels);
+  _fvV.assign((size_t)((_S + BETA_PANEL - 1) / BETA_PANEL) * BETA_PANEL, 1.0);
+  // After the indeces, so that they have seen each update by the time it marks
+  //   fair values stale.
+  _dm->add_listener(this);
 }
 
 ERMLinearMultiFactor::~ERMLinearMultiFactor() {
@@ -255,30 +272,88 @@ void ERMLinearMultiFactor::copyWeights(bmatrixd &factorWeights, int S, int f, ve
   }
 }
 
-bool ERMLinearMultiFactor::getFairValue(int cid, double &fv) {
-  double factorIV, factorCV, factorRet, factorBeta;
-  double sigma = 0.0;
-  // Walk through each factor, extracting:
-  // - current factor fv.
-  // - initial (market open) factor fv.
-  // ==> Factor return since open.
-  // - Factor beta.
-  // And summing factor-return * factor-beta. 
+/*
+  Panel p holds stocks p*BETA_PANEL ... p*BETA_PANEL + BETA_PANEL - 1, as
+    m[p*BETA_PANEL + 0, 0], m[p*BETA_PANEL + 1, 0], ... m[p*BETA_PANEL + 0, 1], ...
+  The last panel is padded with 0 betas.
+*/
+void ERMLinearMultiFactor::packPanels(const bmatrixd &m, vector<double> &panels) {
+  int S = m.size1(), F = m.size2();
+  int np = (S + BETA_PANEL - 1) / BETA_PANEL;
+  panels.assign((size_t)np * BETA_PANEL * F, 0.0);
+  for (int s = 0; s < S; s++) {
+    double *a = &panels[(size_t)(s / BETA_PANEL) * BETA_PANEL * F + s % BETA_PANEL];
+    for (int f = 0; f < F; f++) {
+      a[f * BETA_PANEL] = m(s, f);
+    }
+  }
+}
+
+/*
+  SSE2 (all x86-64 guarantees): 1 panel at a time, its 4 stocks in 2 registers,
+    adding each factor's betas * that factor's return.  Sums per stock in factor
+    order, as the scalar version did.
+*/
+void ERMLinearMultiFactor::panelGemv(const double *panels, int S, int F, const double *x, double *y) {
+  int np = (S + BETA_PANEL - 1) / BETA_PANEL;
+  __m128d one = _mm_set1_pd(1.0);
+  for (int p = 0; p < np; p++) {
+    const double *a = panels + (size_t)p * BETA_PANEL * F;
+    __m128d lo = _mm_setzero_pd();
+    __m128d hi = _mm_setzero_pd();
+    for (int f = 0; f < F; f++) {
+      __m128d xf = _mm_set1_pd(x[f]);
+      lo = _mm_add_pd(lo, _mm_mul_pd(_mm_loadu_pd(a), xf));
+      hi = _mm_add_pd(hi, _mm_mul_pd(_mm_loadu_pd(a + 2), xf));
+      a += BETA_PANEL;
+    }
+    _mm_storeu_pd(y + p * BETA_PANEL, _mm_add_pd(one, lo));
+    _mm_storeu_pd(y + p * BETA_PANEL + 2, _mm_add_pd(one, hi));
+  }
+}
+
+/*
+  Walk through each factor, extracting:
+  - current factor fv.
+  - initial (market open) factor fv.
+  ==> Factor return since open.
+  If all factors have one, and any changed, recompute all stocks' fair values.
+*/
+void ERMLinearMultiFactor::refresh() {
+  double factorIV, factorCV, factorRet;
+  bool changed = false;
+  _stale = false;
   for (int f = 0; f < _F; f++) {
     if (!_indeces[f]->getFairValue(factorCV) ||
 	!_indeces[f]->getInitialFairValue(factorIV)) {
-      fv = 1.0;
-      return false;
+      _validRets = false;
+      return;
     }
     factorRet = ((factorCV - factorIV)/factorIV);          // e.g. 0.02 for 2% return.
     if (isnan(factorRet)) {
       factorRet = 0.0;
     }
-    factorBeta = _factorBetas(cid, f);	                   // e.g. 1.5 for beta of 1.5
-    sigma = sigma + factorRet * factorBeta;
+    if (factorRet != _factorRetV[f]) {
+      _factorRetV[f] = factorRet;
+      changed = true;
+    }
+  }
+  if ((changed || !_validRets) && _F > 0) {
+    panelGemv(&_betaPanels[0], _S, _F, &_factorRetV[0], &_fvV[0]);
+  }
+  _validRets = true;
+}
+
+bool ERMLinearMultiFactor::getFairValue(int cid, double &fv) {
+  if (_stale) {
+    refresh();
+  }
+  if (!_validRets) {
+    fv = 1.0;
+    return false;
   }
   // Uses initial "fair value" of 1.0, assuming no movement in factor indeces.
-  fv = 1.0 + sigma;
+  fv = _fvV[cid];
   return true;
 }
 
@@ -286,3 +361,11 @@ bool ERMLinearMultiFactor::getInitialFairValue(int cid, double &fv) {
   fv = 1.0;
   return true;
 }
+
+void ERMLinearMultiFactor::update(const DataUpdate &du) {
+  _stale = true;
+}
+
+void ERMLinearMultiFactor::update(const TimeUpdate &au) {
+  _stale = true;
+}
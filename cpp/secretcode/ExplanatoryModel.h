@@ -150,12 +150,28 @@ class ERMETFMid : public ExplanatoryReturnModel, public TimeHandler::listener, p
   - Can then estimate return (from initial px) on each of these indeces.
   - For any stock S, "fair value" is then:
     1.0 + sigma(f)[factorBetas[s,f] * idx-return-from-initial-px(f)]
+  - Fair values are computed for all stocks at once, as 1 matrix * vector product
+    (factorBetas * factor-returns), and kept in a per-stock result vector:
+    - Any market data or timer update marks the results stale.  The 1st query after
+      that re-reads the F factor returns, and only if they changed recomputes all S
+      fair values.  Other queries are a lookup.
+    - factorBetas is stored in panels of BETA_PANEL stocks, each panel factor-major
+      (all of the panel's stocks' betas for factor 0, then factor 1 ...), so the 
+      product streams through the matrix once, SSE2, without horizontal sums.
 */
-class ERMLinearMultiFactor : public ExplanatoryReturnModel {
+class ERMLinearMultiFactor : public ExplanatoryReturnModel, public TimeHandler::listener, public MarketHandler::listener {
+  factory<DataManager>::pointer _dm;
   int _S;                             // Number of stocks.
   int _F;                             // Number of factors/synthetic indeces.
-  bmatrixd _factorBetas;              // Factor beta matrix.
+  vector<double> _betaPanels;         // Factor beta matrix, in panels (see above).
   vector<SyntheticIndex*> _indeces;   // Set of synthetic indeces corresponding to factors.
+  vector<double> _factorRetV;         // Per factor: return since initial fv, as of last refresh.
+  bool _validRets;                    // All factors had a current & initial fv, as of last refresh.
+  vector<double> _fvV;                // Per stock (padded to whole panels): fair value, as of last refresh.
+  bool _stale;                        // Market/timer update since last refresh.
+
+  // Re-read factor returns, and recompute fair values if they changed.
+  void refresh();
  public:
   
   ERMLinearMultiFactor(AlphaSignal *idxCFVSignal, bmatrixd &factorWeights, bmatrixd &factorBetas);
@@ -164,11 +180,25 @@ class ERMLinearMultiFactor : public ExplanatoryReturnModel {
   // Copy weights in matrix factorWeights[s, 1:F] into vector weights. 
   static void copyWeights(bmatrixd &factorWeights, int s, int F, vector<double> &weights);
 
+  // Stocks per panel of the stored beta matrix.
+  static const int BETA_PANEL = 4;
+  // Lay out S * F matrix m in panels, as per _betaPanels.  
+  static void packPanels(const bmatrixd &m, vector<double> &panels);
+  // y[s] = 1.0 + sigma(f)[m[s,f] * x[f]], for all S stocks, with m packed by packPanels.
+  //   y must have room for S rounded up to a whole panel.
+  static void panelGemv(const double *panels, int S, int F, const double *x, double *y);
+
   /*
     ExplanatoryReturnModel functions.
   */
   virtual bool getFairValue(int cid, double &fv);
   virtual bool getInitialFairValue(int cid, double &fv);
+
+  /*
+    UpdateListener functions.
+  */
+  virtual void update(const DataUpdate &du);
+  virtual void update(const TimeUpdate &au);
 };
 
 
@@ -24,7 +24,7 @@ ExplanatoryReturnModelTester::ExplanatoryReturnModelTester(ExplanatoryReturnMode
   _erm(erm),
   _fvSignal(fvSignal),
   _dlog(dlog),
-  _startTV(0),
+  _startTV(),
   _sampleNum(0),
   _marketOpen(false),
   _firstSampleIndex(firstSampleIndex),
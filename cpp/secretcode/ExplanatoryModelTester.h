@@ -55,7 +55,7 @@ class ExplanatoryReturnModelTester : public TimeHandler::listener {
   ExplanatoryReturnModel              *_erm;
   AlphaSignal                         *_fvSignal;  // Optional signal (can be specified as null/identity signal).
   tael::Logger                     &_dlog;      // Logger for output.
-  TimeVal                             _startTV;    // TimeVal of 1st sample point.
+  nanotime                            _startTV;    // Time of 1st sample point.
   int                                 _sampleNum;
   bool                                _marketOpen;
   int                                 _firstSampleIndex;   // Index of 1st stock in population set to start sampling.  Default = 0
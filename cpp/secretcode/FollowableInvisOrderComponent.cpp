@@ -155,7 +155,7 @@ void FollowableInvisOrderComponent::suggestOrderPlacements( int cid, Mkt::Side s
     OrderPlacementSuggestion ops( cid, e, side, osize, stepUpPx, DEFAULT_TIMEOUT,
 				  tradeLogicId, _componentId, allocateSeqNum(), 
 				  OrderPlacementSuggestion::FOLLOW_INVTRD,
-				  _dm->curtv(), ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK),
+				  _dm->curtime(), ss->bestPrice(Mkt::BID), ss->bestPrice(Mkt::ASK),
 				  priority);
     suggestions.push_back(ops);
   }
@@ -225,7 +225,7 @@ bool FollowableInvisOrderComponent::decideToCancel( int cid, const Order* order,
       return true;  
     }
     else if( order->confirmed() && order->confirmed().action()==Mkt::CONFIRMED &&
-	     HFUtils::milliSecondsBetween(order->confirmed().tv(),_dm->curtv()) >= K_FOLLOW_INVTRD_TIMEOUT_MSEC &&
+	     HFUtils::milliSecondsBetween(order->confirmed().tv(),_dm->curtime()) >= K_FOLLOW_INVTRD_TIMEOUT_MSEC &&
 	     getMarketOrders(_dm->subBook(order->ecn()), order->cid(), order->side(), order->price()) <= 1 ) { 
       cancelReason = OrderCancelSuggestion::NO_FOLLOWERS;
       return true;
@@ -233,8 +233,8 @@ bool FollowableInvisOrderComponent::decideToCancel( int cid, const Order* order,
   } else { 
     // Market is invalid. But pulling on every locked/crossed book leads to too-frequent order cancels.  
     // So, as comproise, we cancel only if the book stays invalid for more than, say, 1 second
-    TimeVal lastUpdateTV = ss->getLastChangeInMktStatus();
-    if (HFUtils::milliSecondsBetween(lastUpdateTV,_dm->curtv()) > HFUtils::INVALD_MKT_CANCEL_MS) {
+    nanotime lastUpdateTV = ss->getLastChangeInMktStatus();
+    if (HFUtils::milliSecondsBetween(lastUpdateTV,_dm->curtime()) > HFUtils::INVALD_MKT_CANCEL_MS) {
       cancelReason = OrderCancelSuggestion::NO_VALID_MARKET;
       return true;
     }
@@ -64,7 +64,7 @@ void ForwardTracker::update(const TimeUpdate& tu){
     for (OrderList::iterator it = _orders.end(); it!=_orders.begin();){
       it--;
       if ((*it)->tick()){
-	(*it)->fprint(tu.tv());
+	(*it)->fprint(tu.tv().to_timeval());
 	delete *it;
 	it = _orders.erase(it);
       }
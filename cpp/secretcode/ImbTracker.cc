@@ -16,11 +16,13 @@ using namespace std;
 // So many new lines
 
 #define DEFAULT_K_VAL -2.4
+#define IMB_CDF_PTS 101        // CDF points: 0 .. 100 round lots (10,000 shares).
 
 const string RELEVANT_LOG_FILE = "misc";
 const string K_FILE = "klist";
 
 #include <string>
+#include <map>
 #include <ext/hash_map>
 
 
@@ -46,8 +48,7 @@ ImbTracker::ImbTracker():
   _minpts(60),
   _nperiods(120),
   _msec(1000),
-  _buf(0),
-  _lastUpdateTV(),
+  _imbId(-1),
   _lastPrintTV(),
   _mktOpen(false),
   _Fv(0),
@@ -62,8 +63,8 @@ ImbTracker::ImbTracker():
   
   
   _Fv.resize(_dm->cidsize());
+  _depth.resize(_dm->cidsize());
   imb_cache.resize(_dm->cidsize());
-  _buf.resize(_dm->cidsize());
 
   _ddebug = factory<debug_stream>::get( RELEVANT_LOG_FILE );
 
@@ -90,34 +91,31 @@ ImbTracker::ImbTracker():
   TAEL_PRINTF(_ddebug.get(), TAEL_WARN, "ImbTracker::ImbTracker called: dm->cidsize = %i  minpts = %i  nperiods = %i  msec = %i",
 		  _dm->cidsize(), _minpts, _nperiods, _msec); 
   for ( int i=0;i<_dm->cidsize();i++) {
-    _buf[i] = new CircBuffer<double>(_nperiods);
-    _Fv[i].resize(101);
     imb_cache[i]=0;
+    _depth[i].valid=false;
     TAEL_PRINTF(_ddebug.get(), TAEL_WARN, "%-5s ImbTracker::ImbTracker k=%f",_dm->symbol(i),_klist[i]);
 
-    computeImbalanceProbabilities(_klist[i],_Fv[i]);
+    _Fv[i] = cdfTable(_klist[i]);
   }
-  clearAllStocks();
+  _rs = factory<RollingStats>::get(only::one);
+  _imbId = _rs->add("imb", this, _msec, RollingStats::MEAN, _nperiods);
   _dm->add_listener(this);
 }
 
 ImbTracker::~ImbTracker() {
-  for ( int i=0;i<_dm->cidsize();i++) {
-    delete _buf[i];
-  }
 }
 
 int ImbTracker::nPts(int cid) {
-  CircBuffer<double> *cb = _buf[cid];
-  return cb->size();
+  return _rs->count(_imbId, cid);
 }
 
 bool ImbTracker::getAImb(int cid, double &fv) {
-  if (nPts(cid) < _minpts) {
+  // The series keeps its window past the close; the average was always dropped there.
+  if (!_mktOpen || nPts(cid) < _minpts) {
     fv = 0.0;
     return false;
   }
-  return _buf[cid]->getAvg(&fv);
+  return _rs->value(_imbId, cid, fv);
 }
 
 bool ImbTracker::getDImb(int cid, double &fv) {
@@ -155,30 +153,13 @@ bool ImbTracker::getCDImb(int cid, double &fv, double &efv) {
 
 
 
-/*
-  Add a point estimate of spread for specified stock.
-*/
-void ImbTracker::addSampledImb(int cid, double fv) {
-  CircBuffer<double> *cb = _buf[cid];
-  cb->add(fv);
-}
-
-void ImbTracker::sampleAllStocks() {
-  int i, nstocks = _buf.size();
+void ImbTracker::sample(RollingStats &rs) {
+  int i, nstocks = _dm->cidsize();
   double imb;
+  double *in = rs.input(_imbId);
   for (i=0;i<nstocks;i++) {
-    if (!getImb(i, imb)) {
-      continue;
-    }
-    addSampledImb(i, imb);
-  }
-}
-
-
-void ImbTracker::clearAllStocks() {
-  int i, nstocks = _buf.size();
-  for (i=0;i<nstocks;i++) {
-    _buf[i]->clear();
+    if (getImb(i, imb))
+      in[i] = imb;
   }
 }
 
@@ -190,19 +171,18 @@ void ImbTracker::update(const TimeUpdate & t) {
   }
   if (t.timer() == _dm->marketClose()) {
     _mktOpen = false;
-    clearAllStocks();
   }
+  // Books may be reset around the open & close without per-stock updates.
+  for (unsigned int i=0;i<_depth.size();i++)
+    _depth[i].valid=false;
 }
 
-
-void ImbTracker::update(const WakeUpdate& wu){
-  double msb = HFUtils::milliSecondsBetween(_lastUpdateTV,_dm->curtv());
-  if ((msb >= _msec) && (_mktOpen == true)) {
-    sampleAllStocks();
-    _lastUpdateTV = _dm->curtv();
-  }
-    
+void ImbTracker::update(const DataUpdate& du){
+  if (du.isBook())
+    _depth[du.cid].valid=false;
 }
+
+
 void ImbTracker::computeImbalanceProbabilities( double k,
 					       vector<double> &Fv) {
   
@@ -225,6 +205,22 @@ void ImbTracker::computeImbalanceProbabilities( double k,
   //Fv = RVectorNumeric::divide(Fv, curSum);
 }
 
+/*
+  k values come from the klist file with a handful of decimals, and are mostly shared
+    across many stocks, so 1 table per distinct k rather than 1 per stock.  Keyed on
+    the exact k, so each stock's CDF is the one it would have computed itself.
+  Tables are never erased, so the pointers stay good.
+*/
+const double *ImbTracker::cdfTable(double k) {
+  static std::map<double, vector<double> > tables;
+  std::map<double, vector<double> >::iterator it = tables.find(k);
+  if (it == tables.end()) {
+    it = tables.insert(std::make_pair(k, vector<double>(IMB_CDF_PTS))).first;
+    computeImbalanceProbabilities(k, it->second);
+  }
+  return &it->second[0];
+}
+
 bool ImbTracker::getImb(int cid, double &imb){
   double truemid;
   return getImb(cid, imb,truemid);
@@ -258,94 +254,157 @@ bool ImbTracker::calcImb(int cid, double &imb, double &truemid) {
   return calcImb(cid, extraBidLevel, extraBidShs, extraAskLevel, extraAskShs, imb, truemid);
 }
 
-bool ImbTracker::calcImb(int cid, int extraBidLvl, size_t extraBidShs, int extraAskLvl, size_t extraAskShs, double &imb, double &truemid){
-  
-  // Compute the unconditional signal for the particular cid
-  int sz=_Fv[cid].size()-1;
-  double imb_ask=0;
-  double imb_bid=0;
-  int level=0;
-  int vol=0;
-  double lpx;
+/*
+  Walk 1 side of the book from the top, as far as the imbalance calculation needs:
+  - until 10,000 shares, or
+  - until a level more than 25bps through the best price (which isn't used), or
+  - until the book runs out (a failure).
+  Records the state of the walk before each level, so that a scenario with extra shares
+    at level l can pick up from there.  Extra shares only ever shorten the walk, so the
+    levels cached here are all any scenario needs.
+*/
+void ImbTracker::walkDepth(int cid, Mkt::Side side, double best, double mid, ImbSide &ds) {
+  const double *Fv = _Fv[cid];
+  int sz=IMB_CDF_PTS-1;
+  int vol=0, CurCntr=0, OldCntr=0, level=0;
+  double sum=0, lpx;
   size_t lsz;
-  imb=0;
-  truemid=-1;
-  double bid,ask;
-  
-  SingleStockState *ss = _stocksState->getState(cid);
- 
-  if (!ss->haveNormalMarket()){    // ss->haveNormalMarket()??
-    //TAEL_PRINTF(_ddebug, TAEL_INFO, "%-5s Couldn't calc Imbalance No Valid Market(%s)(%f,%f) ",_dm->symbol(cid),DateTime(_dm->curtv()).getfulltime(),bid,ask);
-    return(false);
-  }
-  ask = ss->bestPrice(Mkt::ASK);
-  bid = ss->bestPrice(Mkt::BID);
-  if (cmp<6>::LE(ask,bid)){
-    TAEL_PRINTF(_ddebug.get(), TAEL_INFO, "%-5s Couldn't calc Imbalance Locked Market (%f,%f)",_dm->symbol(cid),bid,ask);
-    return(false);
-  }
-  
 
-  double mid=(bid+ask)/2.0;
-  if (mid<1e-6){
-    return(false);
-  }
-  int CurCntr=0;
-  int OldCntr=0;
-  level=0;
+  ds.px.clear(); ds.sz.clear();
+  ds.vol.clear(); ds.cntr.clear(); ds.sum.clear();
+  ds.fail=false;
   while (vol<sz*100){
-    if (!getMarket(_dm->masterBook(),cid,Mkt::BID,level,&lpx,&lsz)){
-      TAEL_PRINTF(_ddebug.get(), TAEL_WARN, "%-5s Couldn't calc  Imb Not enough info on BID",_dm->symbol(cid));
-      return(false);
-    }
-    if (level == extraBidLvl) {     // For scenario analysis.
-      lsz += extraBidShs;
+    if (!getMarket(_dm->masterBook(),cid,side,level,&lpx,&lsz)){
+      ds.fail=true;
+      break;
     }
-    if ( (lpx-bid)/mid < -0.0025)
+    double through = (side == Mkt::BID) ? (best-lpx)/mid : (lpx-best)/mid;
+    if (through > 0.0025)
       break;
+    ds.px.push_back(lpx);
+    ds.sz.push_back(lsz);
+    ds.vol.push_back(vol);
+    ds.cntr.push_back(OldCntr);
+    ds.sum.push_back(sum);
     vol+=lsz;
     CurCntr=std::min((int)floor(vol/100),sz);
     if (CurCntr>0){
-      imb_bid+=(_Fv[cid][CurCntr]-_Fv[cid][OldCntr])*lpx;
+      sum+=(Fv[CurCntr]-Fv[OldCntr])*lpx;
     }
     OldCntr=CurCntr;
     level++;
   }
+  ds.vol.push_back(vol);
+  ds.cntr.push_back(CurCntr);
+  ds.sum.push_back(sum);
+  ds.px0 = sum/Fv[CurCntr];
+}
 
-  imb_bid/=_Fv[cid][CurCntr];
-
-  vol=0;
-  CurCntr=0;
-  OldCntr=0;
-  level=0;
-  while (vol<sz*100){
-    if (!getMarket(_dm->masterBook(),cid,Mkt::ASK,level,&lpx,&lsz)){
-      TAEL_PRINTF(_ddebug.get(), TAEL_WARN, "%-5s Couldn't calc  Imb Not enough info on ASK",_dm->symbol(cid));
+bool ImbTracker::refreshDepth(int cid) {
+  ImbDepth &d = _depth[cid];
+  // StocksState refreshes its book top on the wakeup, which can come after the book
+  //   update that invalidated the cache (and after a trade, which doesn't), so its
+  //   market is checked against the one the cache was built from on every call.
+  SingleStockState *ss = _stocksState->getState(cid);
+  bool normal = ss->haveNormalMarket();
+  double ask = ss->bestPrice(Mkt::ASK);
+  double bid = ss->bestPrice(Mkt::BID);
+  if (d.valid && normal == d.normal && bid == d.bid && ask == d.ask)
+    return d.ok;
+  d.valid=true;
+  d.ok=false;
+  d.normal=normal;
+  d.bid=bid;
+  d.ask=ask;
+
+  if (!normal){
+    return(false);
+  }
+  if (cmp<6>::LE(ask,bid)){
+    TAEL_PRINTF(_ddebug.get(), TAEL_INFO, "%-5s Couldn't calc Imbalance Locked Market (%f,%f)",_dm->symbol(cid),bid,ask);
+    return(false);
+  }
+  d.mid=(bid+ask)/2.0;
+  if (d.mid<1e-6){
+    return(false);
+  }
+  walkDepth(cid, Mkt::BID, bid, d.mid, d.side[0]);
+  walkDepth(cid, Mkt::ASK, ask, d.mid, d.side[1]);
+  if (d.side[0].fail)
+    TAEL_PRINTF(_ddebug.get(), TAEL_WARN, "%-5s Couldn't calc  Imb Not enough info on BID",_dm->symbol(cid));
+  else if (d.side[1].fail)
+    TAEL_PRINTF(_ddebug.get(), TAEL_WARN, "%-5s Couldn't calc  Imb Not enough info on ASK",_dm->symbol(cid));
+  d.ok=true;
+  return(true);
+}
 
-      return(false);
-    }
-    if (level == extraAskLvl) {
-      lsz += extraAskShs;
-    }
-    if ( (lpx-ask)/mid > 0.0025){
-      vol=sz*100;
+bool ImbTracker::sideImb(int cid, const ImbSide &ds, int lvl, size_t extraShs, double &px) {
+  int nlvl = ds.px.size();
+  if (extraShs == 0 || lvl < 0 || lvl >= nlvl) {
+    // Stated book, as far as the walk is concerned.
+    px = ds.px0;
+    return !ds.fail;
+  }
+  const double *Fv = _Fv[cid];
+  int sz=IMB_CDF_PTS-1;
+  int vol=ds.vol[lvl], OldCntr=ds.cntr[lvl], CurCntr=OldCntr;
+  double sum=ds.sum[lvl];
+  for (int level=lvl; vol<sz*100; level++){
+    if (level == nlvl){
+      if (ds.fail)
+	return(false);
       break;
     }
+    size_t lsz = ds.sz[level];
+    if (level == lvl)
+      lsz += extraShs;
     vol+=lsz;
     CurCntr=std::min((int)floor(vol/100),sz);
     if (CurCntr>0){
-      imb_ask+=(_Fv[cid][CurCntr]-_Fv[cid][OldCntr])*lpx;
+      sum+=(Fv[CurCntr]-Fv[OldCntr])*ds.px[level];
     }
     OldCntr=CurCntr;
-    level++;
   }
+  px = sum/Fv[CurCntr];
+  return(true);
+}
 
-  imb_ask/=_Fv[cid][CurCntr];
-  imb= (imb_ask+imb_bid)/(2*mid)-1;
+bool ImbTracker::calcImb(int cid, int extraBidLvl, size_t extraBidShs, int extraAskLvl, size_t extraAskShs, double &imb, double &truemid){
+  imb=0;
+  truemid=-1;
+  if (!refreshDepth(cid))
+    return(false);
+  const ImbDepth &d = _depth[cid];
+  double imb_bid, imb_ask;
+  if (!sideImb(cid, d.side[0], extraBidLvl, extraBidShs, imb_bid) ||
+      !sideImb(cid, d.side[1], extraAskLvl, extraAskShs, imb_ask))
+    return(false);
+  imb= (imb_ask+imb_bid)/(2*d.mid)-1;
   truemid = (imb_ask+imb_bid)/2.0;
-
   return(true);
-  
+}
+
+int ImbTracker::calcImbScenarios(int cid, Mkt::Side side, int n, const int *lvl, const size_t *extraShs,
+				 double *imb, double *truemid, bool *ok) {
+  int ret=0;
+  bool good = refreshDepth(cid);
+  const ImbDepth &d = _depth[cid];
+  int s = (side == Mkt::BID) ? 0 : 1;
+  double other=0;
+  if (good)
+    good = sideImb(cid, d.side[1-s], -1, 0, other);
+  for (int i=0;i<n;i++) {
+    double px;
+    imb[i]=0;
+    truemid[i]=-1;
+    ok[i] = good && sideImb(cid, d.side[s], lvl[i], extraShs[i], px);
+    if (ok[i]) {
+      imb[i] = (px+other)/(2*d.mid)-1;
+      truemid[i] = (px+other)/2.0;
+      ret++;
+    }
+  }
+  return ret;
 }
 
 bool ImbTracker::getAlpha(int cid, double &alphaEst) {
@@ -10,8 +10,8 @@
 #ifndef __IMBTRACKER_H__
 #define __IMBTRACKER_H__
 
-#include "CircBuffer.h"
 #include "DataManager.h"
+#include "RollingStats.h"
 #include "c_util/Time.h"
 using trc::compat::util::TimeVal;
 
@@ -25,7 +25,13 @@ using trc::compat::util::TimeVal;
 
 using namespace clite::util;
 
-class ImbTracker : public AlphaSignal, public WakeupHandler::listener, public TimeHandler::listener {
+/*
+  Trailing imbalance is averaged through RollingStats, over the last _nperiods ticks
+    of _msec, emptied at the open.  Ticks on which a stock's imbalance can't be had
+    count toward the window.
+*/
+class ImbTracker : public AlphaSignal, public TimeHandler::listener,
+		   public MarketHandler::listener, public RollingStats::sampler {
  protected:
   /*
     Internal state:
@@ -33,25 +39,54 @@ class ImbTracker : public AlphaSignal, public WakeupHandler::listener, public Ti
   factory<DataManager>::pointer _dm;
   factory<debug_stream>::pointer _ddebug;
   factory<StocksState>::pointer       _stocksState;
+  factory<RollingStats>::pointer _rs;  // Exists externally.
 
   int _minpts;         // Minimum # of points for computing spread info.
   int _nperiods;       // Number of trailing periods over which to compute average spreads.
   int _msec;           // Length of period, in milliseconds.
-  vector< CircBuffer<double> *> _buf;  // Exists internally.  Holds sampled aspd data points.
-  TimeVal _lastUpdateTV;
+  int _imbId;          // Sampled imbalance series (RollingStats).
   TimeVal _lastPrintTV;
   bool _mktOpen;       
-  vector< vector<double> > _Fv;  // Precomputed CDFs per cid
+  vector<const double*> _Fv;     // Precomputed CDF per cid.  Shared by all stocks with the same k (see cdfTable).
   vector<double> imb_cache;
   vector<double> _klist;         // K-estimates per stock.
 
-  // Add a point estimate of spread for specified stock.
-  void addSampledImb(int cid, double fv);
-  void sampleAllStocks();
-  // Clear sampled values for all stocks.
-  void clearAllStocks();
   // Precompute CDFs
   void computeImbalanceProbabilities(double k,vector<double> &Fv);
+  // CDF for specified k.  Built on first use & shared thereafter.
+  const double *cdfTable(double k);
+
+  /*
+    Depth cache.  Per stock, the book levels calcImb walks on each side, with the state of
+      the walk before each level, as of the last book update for the stock.  Rebuilt lazily,
+      on the 1st calcImb after a book update or a change in the stock's StocksState market,
+      so the stated-book imbalance is O(1) and a scenario only re-walks the levels from the
+      one it adds shares to.
+  */
+  struct ImbSide {
+    vector<double> px;     // Levels walked: price ...
+    vector<size_t> sz;     //   ... & shares.
+    vector<int> vol;       // Before each level (and after the last): cumulative shares,
+    vector<int> cntr;      //   CDF index,
+    vector<double> sum;    //   & weighted price sum.
+    bool fail;             // Walk ran out of book (getMarket failed) after the last level.
+    double px0;            // Stated-book result: weighted price.
+  };
+  struct ImbDepth {
+    bool valid;            // Rebuilt since the last book update.
+    bool ok;               // Market good enough to calculate imbalance.
+    bool normal;           // StocksState market it was rebuilt from: normal?,
+    double bid, ask;       //   & best prices.
+    double mid;
+    ImbSide side[2];       // BID, ASK.
+  };
+  vector<ImbDepth> _depth;
+  // Rebuild cid's depth cache if needed.  Returns its ok.
+  bool refreshDepth(int cid);
+  void walkDepth(int cid, Mkt::Side side, double best, double mid, ImbSide &ds);
+  // Weighted price for 1 side of cid's cached depth, with extraShs extra shares at level lvl.
+  //   False if the walk runs out of book.
+  bool sideImb(int cid, const ImbSide &ds, int lvl, size_t extraShs, double &px);
 
  public:
   ImbTracker();
@@ -79,6 +114,11 @@ class ImbTracker : public AlphaSignal, public WakeupHandler::listener, public Ti
   //   of extra shares on bid size (level, starting with 0, plus number of shares) and
   //   1 clump on ask side.
   bool calcImb(int cid, int extraBidLvl, size_t extraBidShs, int extraAskLvl, size_t extraAskShs, double &fvImb, double &truemid);
+  // Vectorized scenario analysis - n scenarios at once, each with extraShs[i] extra shares at
+  //   level lvl[i] on specified side (the other side as per stated book).  Results as per
+  //   calcImb, in fvImb[i], truemid[i] & ok[i].  Returns number of scenarios calculated.
+  int calcImbScenarios(int cid, Mkt::Side side, int n, const int *lvl, const size_t *extraShs,
+		       double *fvImb, double *truemid, bool *ok);
 
   /*
     Functions that try to calculate imbalance, but use cached value if unable to do so.
@@ -88,8 +128,10 @@ class ImbTracker : public AlphaSignal, public WakeupHandler::listener, public Ti
   // Current # of sampled points.  Only includes pts still in buffer, aka pts that have
   //   "fallen off" the end of the buffer are subtracted out from this total.
   int nPts(int cid);
+  // For all stocks: sample imbalance (getImb) into the imbalance series.
+  virtual void sample(RollingStats &rs);
   virtual void update( const TimeUpdate & t );
-  virtual void update( const WakeUpdate& wu );
+  virtual void update( const DataUpdate& du );
  
   // AlphaSignal interface functions.
   virtual bool getAlpha(int cid, double &alphaEst);
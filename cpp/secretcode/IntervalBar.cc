@@ -165,7 +165,7 @@ TradeIntervalBarTracker::TradeIntervalBarTracker(int intervalMSec) :
   _dm(),
   _intervalNumber(0),
   _intervalMSec(intervalMSec),
-  _startTV(0),
+  _startTV(),
   _marketOpen(false),
   _currentBars(0),
   _mostRecentBars(0),
@@ -105,7 +105,7 @@ class TradeIntervalBarTracker : public IntervalBarTracker, public TimeHandler::l
   int _intervalMSec; 
 
   // TimeVal at which 1st interval started.
-  TimeVal _startTV;
+  nanotime _startTV;
 
   // Is market currently open for trading?
   bool _marketOpen;
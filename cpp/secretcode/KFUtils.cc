@@ -7,6 +7,7 @@
 #include "KFUtils.h"
 
 #include <math.h>
+#include <emmintrin.h>
 
 /*
   Rounding error variance.
@@ -147,3 +148,54 @@ bool KFUtils::simpleScalarKalmanFilter(double lastEst, double lastEstVar,
 }
 
 
+
+/*
+  n observations with the same value & measurement error R, after the 1st of which
+    the variance is P (including process innovation):
+  - Sequentially, the variance goes P --> PR/(R+P) --> PR/(R+2P) --> ... --> PR/(R+nP),
+  - and the estimate moves by the weight nP/(R+nP) towards the observation.
+*/
+bool KFUtils::multiObsScalarKalmanFilter(double lastEst, double lastEstVar, 
+					 double thisObs, double thisME, double thisPI, int nObs,
+					 double &thisEst, double &thisEstVar,
+					 double &lastEstWeight, double &thisObsWeight) {
+  if ((lastEstVar < 0.0) || (thisME < 0.0) || (thisPI < 0.0) || (nObs < 1)) {
+    return false;
+  }
+
+  lastEstVar = lastEstVar + thisPI;
+  double nVar = nObs * lastEstVar;
+  lastEstWeight = thisME/(thisME + nVar);
+  thisObsWeight = nVar/(thisME + nVar);
+  thisEst = (lastEstWeight * lastEst) + (thisObsWeight * thisObs);
+  thisEstVar = lastEstVar * lastEstWeight;
+  return true;
+}
+
+/*
+  SSE2 (all x86-64 guarantees): 2 filters a step, then the odd one out.
+*/
+void KFUtils::batchScalarKalmanFilter(double *est, double *estVar, 
+				      const double *obs, const double *me, const double *pi,
+				      const double *nObs, int n) {
+  int i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d p = _mm_add_pd(_mm_loadu_pd(estVar + i), _mm_loadu_pd(pi + i));
+    __m128d r = _mm_loadu_pd(me + i);
+    __m128d np = _mm_mul_pd(_mm_loadu_pd(nObs + i), p);
+    __m128d inv = _mm_div_pd(_mm_set1_pd(1.0), _mm_add_pd(r, np));
+    __m128d lw = _mm_mul_pd(r, inv);
+    __m128d ow = _mm_mul_pd(np, inv);
+    __m128d e = _mm_add_pd(_mm_mul_pd(lw, _mm_loadu_pd(est + i)), _mm_mul_pd(ow, _mm_loadu_pd(obs + i)));
+    _mm_storeu_pd(est + i, e);
+    _mm_storeu_pd(estVar + i, _mm_mul_pd(p, lw));
+  }
+  for (; i < n; i++) {
+    double p = estVar[i] + pi[i];
+    double np = nObs[i] * p;
+    double lw = me[i]/(me[i] + np);
+    double ow = np/(me[i] + np);
+    est[i] = (lw * est[i]) + (ow * obs[i]);
+    estVar[i] = p * lw;
+  }
+}
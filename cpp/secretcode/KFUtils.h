@@ -43,4 +43,21 @@ class KFUtils {
 				       double thisObs, double thisME, double thisPI,
 				       double &thisEst, double &thisEstVar,
 				       double &lastEstWeight, double &thisObsWeight);
+
+  // As simpleScalarKalmanFilter, applied nObs times with the same observation &
+  //   measurement error, and with process innovation before the 1st only (aka nObs
+  //   simultaneous observations).  Closed form: same as 1 observation with 
+  //   measurement error thisME/nObs.
+  // lastEstWeight & thisObsWeight are the total weights across all nObs.
+  static bool multiObsScalarKalmanFilter(double lastEst, double lastEstVar, 
+					 double thisObs, double thisME, double thisPI, int nObs,
+					 double &thisEst, double &thisEstVar,
+					 double &lastEstWeight, double &thisObsWeight);
+
+  // multiObsScalarKalmanFilter over n independent filters at once, in place:
+  //   est[i] & estVar[i] are updated from obs[i], me[i], pi[i], nObs[i].
+  // Inputs should be valid (non-negative variances, nObs >= 1).
+  static void batchScalarKalmanFilter(double *est, double *estVar, 
+				      const double *obs, const double *me, const double *pi,
+				      const double *nObs, int n);
 };
@@ -27,13 +27,28 @@ bool MarketImpactModel::marketImpactFill(int cid, ECN::ECN ecn, int size, double
 /********************************************************************
   TakeLiquidityMarketImpactModel code.
 ********************************************************************/
+// Memoized fill estimates kept per stock.
+const static int MEMO_SLOTS = 8;
+
 TakeLiquidityMarketImpactModel::TakeLiquidityMarketImpactModel() :
-  MarketImpactModel()
+  MarketImpactModel(),
+  _epoch(0),
+  _queries(0),
+  _hits(0)
 {
   _sig = factory<ETFKFRTSignal>::get(only::one);
   if( !_sig )
     throw std::runtime_error( "Failed to get ETFKFRTSignal from factory (in TakeLiquidityMarketImpactModel::TakeLiquidityMarketImpactModel)" ); 
+  _dm = factory<DataManager>::find(only::one);
+  if( !_dm )
+    throw std::runtime_error( "Failed to get DataManager from factory (in TakeLiquidityMarketImpactModel::TakeLiquidityMarketImpactModel)" ); 
+  _ddebug = factory<debug_stream>::get(std::string("misc"));
  
+  _memo.resize(_dm->cidsize());
+  _memoNext.assign(_dm->cidsize(), 0);
+  // Ahead of most consumers (created later), so that the memo is invalidated before
+  //   they react to an update.
+  _dm->add_listener(this);
 }
 TakeLiquidityMarketImpactModel::~TakeLiquidityMarketImpactModel() {
 
@@ -63,7 +78,7 @@ bool TakeLiquidityMarketImpactModel::marketImpactFill(int cid, ECN::ECN ecn, int
     return false;
   }
   int usize = std::max(size, 100);
-  if (!_sig->marketImpactFill(cid, ecn, usize, price, side, timeout, invisible, fv)) {
+  if (!signalImpactFill(cid, ecn, usize, price, side, timeout, invisible, fv)) {
     fv.setImpact(cid, 0, Mkt::BUY, false, 0.0, 0.0);
     return false;
   }
@@ -74,3 +89,58 @@ bool TakeLiquidityMarketImpactModel::marketImpactFill(int cid, ECN::ECN ecn, int
   fv.scaleSize(scale, 1.0, pow(scale, 0.5));    // size, temporary impact, permanent impact
   return true;
 }
+
+bool TakeLiquidityMarketImpactModel::signalImpactFill(int cid, ECN::ECN ecn, int usize, double price,
+    Mkt::Side side, int timeout, bool invisible, MarketImpactEstimate &fv) {
+  nanotime t = _dm->curtime();
+  int lots = usize / 100;
+  vector<FillMemo> &memo = _memo[cid];
+  _queries++;
+  for (unsigned int i = 0; i < memo.size(); i++) {
+    const FillMemo &m = memo[i];
+    if (m.epoch == _epoch && m.t == t && m.side == side && m.ecn == ecn &&
+	m.lots == lots && m.price == price && m.invisible == invisible) {
+      _hits++;
+      // Same estimate, for this size.
+      fv = m.fv;
+      if (fv.size() > 0 && fv.size() != usize) {
+	fv.scaleSize((double)usize/(double)fv.size(), 1.0, 1.0);
+      }
+      return m.ok;
+    }
+  }
+
+  FillMemo m;
+  m.ok = _sig->marketImpactFill(cid, ecn, usize, price, side, timeout, invisible, m.fv);
+  // Any trades the signal had queued came in as DataUpdates, so are already part of
+  //   this epoch.
+  m.epoch = _epoch;
+  m.t = t;
+  m.side = side;
+  m.ecn = ecn;
+  m.lots = lots;
+  m.price = price;
+  m.invisible = invisible;
+  if ((int)memo.size() < MEMO_SLOTS) {
+    memo.push_back(m);
+  } else {
+    memo[_memoNext[cid]] = m;
+    _memoNext[cid] = (_memoNext[cid] + 1) % MEMO_SLOTS;
+  }
+  fv = m.fv;
+  return m.ok;
+}
+
+void TakeLiquidityMarketImpactModel::update(const DataUpdate &du) {
+  _epoch++;
+}
+
+void TakeLiquidityMarketImpactModel::update(const TimeUpdate &au) {
+  _epoch++;
+  if (au.timer() == _dm->marketOpen()) {
+    _queries = _hits = 0;
+  } else if (au.timer() == _dm->marketClose()) {
+    TAEL_PRINTF(_ddebug.get(), TAEL_INFO, "TakeLiquidityMarketImpactModel: %ld fill estimates, %ld (%.1f%%) from memo",
+		_queries, _hits, 100.0 * memoHitRate());
+  }
+}
@@ -34,6 +34,8 @@
 #include <cl-util/factory.h>
 using namespace clite::util;
 
+#include <cl-util/debug_stream.h>
+
 #include "DataManager.h"
 #include "AlphaSignal.h"
 #include "ExchangeTracker.h"
@@ -128,9 +130,43 @@ class MarketImpactModel {
   Notes:  
   - Current version of TakeLiquidityMarketImpactModel assumes that ETFKFRTSignal
     is favored KFRT signal variant for production use....
+  - Fill estimates are memoized:  the same stock tends to be queried several times per 
+    wakeup (TradeLogic placements, PriorityCutoffComponent, RealizedMarketImpactTracker), 
+    and each query replays a hypothetical trade through the signal.
+    - Keyed on (cid, side, ecn, round lots, price, invisible), and only good for the
+      market state it was computed in:  the current time, and no DataUpdate or TimeUpdate
+      since (either of which can move the signal's state, including via other stocks,
+      e.g. ETF prices).
+    - The signal's result only depends on size via round lots, so this is exact.
+    - Hit rates are logged at the close.
 */
-class TakeLiquidityMarketImpactModel : public MarketImpactModel {
+class TakeLiquidityMarketImpactModel : public MarketImpactModel, 
+				       public MarketHandler::listener, public TimeHandler::listener {
   factory<ETFKFRTSignal>::pointer _sig;
+  factory<DataManager>::pointer _dm;
+  factory<debug_stream>::pointer _ddebug;
+
+  // Memoized fill estimate.
+  struct FillMemo {
+    unsigned long epoch;
+    nanotime t;
+    Mkt::Side side;
+    ECN::ECN ecn;
+    int lots;
+    double price;
+    bool invisible;
+    bool ok;
+    MarketImpactEstimate fv;
+  };
+  vector< vector<FillMemo> > _memo;   // Per stock:  up to MEMO_SLOTS estimates, round-robin.
+  vector<int> _memoNext;              // Per stock:  next slot to overwrite.
+  unsigned long _epoch;               // Bumped on every DataUpdate & TimeUpdate.
+  long _queries;                      // Fill estimates asked for, since the open ...
+  long _hits;                         //   ... and answered from the memo.
+
+  // Signal's fill estimate for usize (>= 100) shares, memoized.
+  bool signalImpactFill(int cid, ECN::ECN ecn, int usize, double price,
+			Mkt::Side side, int timeout, bool invisible, MarketImpactEstimate &fv);
  public:
   TakeLiquidityMarketImpactModel();
   virtual ~TakeLiquidityMarketImpactModel();
@@ -144,6 +180,15 @@ class TakeLiquidityMarketImpactModel : public MarketImpactModel {
   //   the market impact while the order is oustanding.
   virtual bool marketImpactFill(int cid, ECN::ECN ecn, int size, double price,
 				       Mkt::Side side, int timeout, bool invisible, MarketImpactEstimate &fv);
+
+  // Memo hit rate since the open (0 if no queries).
+  double memoHitRate() const {return _queries > 0 ? (double)_hits/_queries : 0.0;}
+
+  /*
+    UpdateListener functions.
+  */
+  virtual void update(const DataUpdate &du);
+  virtual void update(const TimeUpdate &au);
 };
 
 
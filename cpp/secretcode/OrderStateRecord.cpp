@@ -25,8 +25,8 @@ OrderStateRecord::OrderStateRecord( const OrderUpdate &ou):
   _id(ou.id()),
   side(ou.side()),
   price(ou.price()),
-  _tv(TimeVal(0)),
-  outv(ou.tv()),
+  _tv(),
+  outv(ou.tv().to_timeval()),
   ecn(ou.ecn()),
   cid(ou.cid()),
   size(ou.size()),
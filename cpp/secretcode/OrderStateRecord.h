@@ -15,7 +15,8 @@ class OrderStateRecord {
   int _id;       // BookElem id.  Used to map from order record to original order in data manager.       
   Mkt::Side side;
   double price;
-  TimeVal _tv,outv; // Add tv and orderupdate tv (cached)
+  nanotime _tv;  // Add tv
+  TimeVal outv;  // orderupdate tv (cached), compared against lib3 add times
   ECN::ECN ecn;
   int cid;
   int size;
@@ -190,7 +190,7 @@ bool SOBOrderRepo::queuePositionUnfavorable( const Order* order, double *normFV)
   double h2= p2p/(p2a+1.0);
   double dpull=(p1p-p2p)/(p1p+p2p+1.0);
   int p2=p2a-p2p;
-  double tm = HFUtils::milliSecondsBetween(order->confirmed().tv(), _dm->curtv());
+  double tm = HFUtils::milliSecondsBetween(order->confirmed().tv(), _dm->curtime());
   double ltm = log(1.0 + tm);
   
   // imbAlpha is calculated with absolute sign, not trade relative sign.
@@ -99,18 +99,18 @@ void PriorityCutoffComponent::update(const TradeRequest &tr) {
 
   // Estimate expected 50% completion time & estimated 100% completion time for trade request.
   // - These estimates are for the incremental part of the TR that has not yet been filled.
-  TimeVal estMidTV, estEndTV;
+  TimeVal estMidTV, estEndTV, recvTV = tr._recvTime.to_timeval();
   estimateCompletionTime(tr._cid, additionalSize, pRate * 2.0, curtv,  estMidTV);    // ESTIMATE TR 1/2 LIFE TIME;
   estimateCompletionTime(tr._cid, additionalSize, pRate,       curtv,  estEndTV);    // ESTIMATE TR END TIME;
 
   // Estimate realized alpha (clean of our trading) to end of 100% completion time trajectory.
-  estimateSignalProfile(tr._cid, dir, tr._priority, tr._recvTime, curtv, estEndTV, endTraj);
+  estimateSignalProfile(tr._cid, dir, tr._priority, recvTV, curtv, estEndTV, endTraj);
   // Estimate realized alpha (clean of our trading) to 1/2 life of request.
-  estimateSignalProfile(tr._cid, dir, tr._priority, tr._recvTime, curtv, estMidTV, midTraj);
+  estimateSignalProfile(tr._cid, dir, tr._priority, recvTV, curtv, estMidTV, midTraj);
   
   // Estimate average transaction costs across entire request.
   double avgTC;
-  estimateTransactionCosts(tr._cid, additionalSize, dir, tr._priority, tr._recvTime, curtv, avgTC);
+  estimateTransactionCosts(tr._cid, additionalSize, dir, tr._priority, recvTV, curtv, avgTC);
 
   // Print summary info with guesstimates of market impact & alpha trajectory for request.
   TAEL_PRINTF(_logPrinter.get(), TAEL_WARN, "%-5s  CID%i  IC-TC-EST  :  PTGT %i  IPOS %i  TPOS %i  EST-MI-TL-SLOW %.6f  EST-MI-PL %.6f  EST-MID-TRAJ  %.6f  EST-END-TRAJ  %.6f  EST-AVG-TC %.6f",
@@ -235,8 +235,9 @@ double PriorityCutoffComponent::componentPriority(int cid, Mkt::Side side, int t
   double signalProfilePL;
   double signalProfileTL;
   TradeRequest tr = _rmiTracker->lastTR(cid);
-  if (!estimateSignalProfile(cid, dir, tlPriority, tr._recvTime, curtv, endTVPL, signalProfilePL) ||  
-      !estimateSignalProfile(cid, dir, tlPriority, tr._recvTime, curtv, endTVTL, signalProfileTL)) {
+  TimeVal recvTV = tr._recvTime.to_timeval();
+  if (!estimateSignalProfile(cid, dir, tlPriority, recvTV, curtv, endTVPL, signalProfilePL) ||  
+      !estimateSignalProfile(cid, dir, tlPriority, recvTV, curtv, endTVTL, signalProfileTL)) {
     return defaultRet;
   }
 
@@ -13,7 +13,7 @@ const static string RMI_LOG_FILE = "realizedmarketimpact";
 RealizedMarketImpactTracker::RealizedMarketImpactTracker() :
   _printMS(60 * 1000 * 10),
   _marketOpen(false),
-  _lastPrintTV(0),
+  _lastPrintTV(),
   _shsTL(0),
   _shsPL(0),
   _shsAccTL(0),
@@ -55,7 +55,7 @@ class RealizedMarketImpactTracker : public OrderHandler::listener,   // listens
   factory<CentralOrderRepo>::pointer    _orderRepo;      // Used to map from orderID --> order details.   
   int                                   _printMS;        // How frequently to print summary info, in MS.
   bool                                  _marketOpen;     // Is market currently open for normal trading session?
-  TimeVal                               _lastPrintTV;    // Time as of last suammry printing.
+  nanotime                              _lastPrintTV;    // Time as of last suammry printing.
   // Shares traded, in current request (per stock):
   // - deliberately taking liquidity.
   // - deliberarely providing liquidity.
@@ -26,8 +26,6 @@ SpdTracker::SpdTracker() :
   _minpts(50),
   _nperiods(60),
   _msec(1000),
-  _buf(),
-  _lastUpdateTV(),
   _lastPrintTV(),
   _mktOpen(false)
 {
@@ -44,10 +42,8 @@ SpdTracker::SpdTracker() :
 		 _dm->cidsize(), _minpts, _nperiods, _msec); 
   //std::cout << "SpdTracker::SpdTracker : dm->cidsize = " << dm->cidsize() <<
   //  " minpts = " << minpts << " nperiods " << nperiods << " msec " << msec << std::endl;
-  _buf.resize(_dm->cidsize());
-  for (int i=0;i<_dm->cidsize();i++) {
-    _buf[i] = new CircBuffer<double>(_nperiods);
-  }
+  _rs = factory<RollingStats>::get(only::one);
+  _spdId = _rs->add("spd", this, _msec, RollingStats::MEAN, _nperiods);
   _dm->add_listener(this);
 }
 
@@ -55,8 +51,6 @@ SpdTracker::SpdTracker(int minpts, int nperiods, int msec) :
   _minpts(minpts),
   _nperiods(nperiods),
   _msec(msec),
-  _buf(),
-  _lastUpdateTV(),
   _lastPrintTV(),
   _mktOpen(false)
 {
@@ -73,22 +67,13 @@ SpdTracker::SpdTracker(int minpts, int nperiods, int msec) :
 		 _dm->cidsize(), _minpts, _nperiods, _msec); 
   //std::cout << "SpdTracker::SpdTracker : dm->cidsize = " << dm->cidsize() <<
   //  " minpts = " << minpts << " nperiods " << nperiods << " msec " << msec << std::endl;
-  _buf.resize(_dm->cidsize());
-  for (int i=0;i<_dm->cidsize();i++) {
-    _buf[i] = new CircBuffer<double>(_nperiods);
-  }
+  _rs = factory<RollingStats>::get(only::one);
+  _spdId = _rs->add("spd", this, _msec, RollingStats::MEAN, _nperiods);
   _dm->add_listener(this);
 }
 
-SpdTracker::~SpdTracker() {
-  for (int i=0;i<_dm->cidsize();i++) {
-    delete _buf[i];
-  }
-}
-
 int SpdTracker::nPts(int cid) {
-  CircBuffer<double> *cb = _buf[cid];
-  return cb->size();
+  return _rs->count(_spdId, cid);
 }
 
 bool SpdTracker::getASpd(int cid, double &fv) {
@@ -96,7 +81,7 @@ bool SpdTracker::getASpd(int cid, double &fv) {
     fv = 0.0;
     return false;
   }
-  return _buf[cid]->getAvg(&fv);
+  return _rs->value(_spdId, cid, fv);
 }
 
 bool SpdTracker::getDSpd(int cid, double &fv) {
@@ -140,28 +125,20 @@ bool SpdTracker::getMkt(int cid, double &bid, double &ask) {
   return true;
 }
 
-/*
-  Add a point estimate of spread for specified stock.
-*/
-void SpdTracker::addSampledSpd(int cid, double fv) {
-  //std::cout << "SpdTracker::addSampledSpd : cid = " << cid << " fv =  " << fv << std::endl;
-  CircBuffer<double> *cb = _buf[cid];
-  cb->add(fv);
-}
-
-void SpdTracker::sampleAllStocks() {
-  int i, nstocks = _buf.size();
+void SpdTracker::sample(RollingStats &rs) {
+  int i, nstocks = _dm->cidsize();
   double spd;
+  double *in = rs.input(_spdId);
   for (i=0;i<nstocks;i++) {
     if (!getSpd(i, spd)) {
       continue;
     }
-    addSampledSpd(i, spd);
+    in[i] = spd;
   }
 }
 
 void SpdTracker::printAllStocks() {
-  int i, nstocks = _buf.size();
+  int i, nstocks = _dm->cidsize();
   double bid, ask;
   DateTime dt(_dm->curtv());
   TAEL_PRINTF(_ddebug.get(), TAEL_INFO, "SpdTracker::printAllStocks called - curTV = (HH)%i, (MM)%i, (SS)%i, (US)%i",
@@ -174,32 +151,17 @@ void SpdTracker::printAllStocks() {
   }
 }
 
-void SpdTracker::clearAllStocks() {
-  int i, nstocks = _buf.size();
-  for (i=0;i<nstocks;i++) {
-    _buf[i]->clear();
-  }
-}
-
 void SpdTracker::update(const TimeUpdate &au) {
-  if ( clite::util::cmp<4>::EQ(_msec, 0.0) ) {
-    sampleAllStocks();
-  }
   processTimeUpdate(au);   
 }
 
 /*
-  Process incoming admin update.  Should only be called if _msec > 0.
+  Process incoming admin update.  Sampling itself is done by RollingStats.
 */
 void SpdTracker::processTimeUpdate(const TimeUpdate &au) {
 
-  double msb = HFUtils::milliSecondsBetween(_lastUpdateTV, au.tv());
-  if ((msb >= _msec) && (_mktOpen == true)) {
-    sampleAllStocks();
-    _lastUpdateTV = au.tv();
-  }
   // Temporary for debugging.
-  msb = HFUtils::milliSecondsBetween(_lastPrintTV, au.tv());
+  double msb = HFUtils::milliSecondsBetween(_lastPrintTV, au.tv());
   if ((msb >= 60000) && (_mktOpen == true)) {
     printAllStocks();
     _lastPrintTV = au.tv();
@@ -207,10 +169,8 @@ void SpdTracker::processTimeUpdate(const TimeUpdate &au) {
   
   if (au.timer() == _dm->marketOpen()) {
     _mktOpen = true;
-    clearAllStocks();
   }
   if (au.timer() == _dm->marketClose()) {
     _mktOpen = false;
   }
 }
-
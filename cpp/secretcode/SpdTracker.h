@@ -16,8 +16,8 @@
 #include <cl-util/factory.h>
 using namespace clite::util;
 
-#include "CircBuffer.h"
 #include "DataManager.h"
+#include "RollingStats.h"
 #include "c_util/Time.h"
 using trc::compat::util::TimeVal;
 
@@ -25,40 +25,35 @@ using trc::compat::util::TimeVal;
   A simple trailing spread tracking widget.  Keeps data for specified trailing # of periods.
   Tries to sample every _msec millseconds.  _msec can be set to 0 to mean sample
     on every wakeup.
+  Samples and averages through RollingStats: only while the market is open, from
+    a fresh window at the open, and the window is the last _nperiods periods (periods
+    without a valid spread count toward it).
   Notes:  
-  - Current implementation makes use with _msec = 0 expensive (sample all stocks every wakeup).
+  - Current implementation makes use with _msec = 0 expensive (sample all stocks every timer update).
     May want to change so that keeps internal set of stocks for which it has seen a DataUpdate
     since last wakeup, and only re-samples those stocks.
   - Current implementation only tracks/reports spread information across all subscribed
     books.  probably should change to allow some access to CBBO spread, plus per book
     spreads.
 */
-class SpdTracker : public TimeHandler::listener {
+class SpdTracker : public TimeHandler::listener, public RollingStats::sampler {
  protected:
   /*
     Internal state:
   */
   factory<DataManager>::pointer _dm;               // Exists externally.
   factory<debug_stream>::pointer _ddebug;          // Exists externally.
+  factory<RollingStats>::pointer _rs;              // Exists externally.
   int _minpts;         // Minimum # of points for computing spread info.
   int _nperiods;       // Number of trailing periods over which to compute average spreads.
   int _msec;           // Length of period, in milliseconds.
-  vector< CircBuffer<double> *> _buf;  // Exists internally.  Holds sampled aspd data points.
-  TimeVal _lastUpdateTV;
-  TimeVal _lastPrintTV;
+  int _spdId;          // Sampled spd series (RollingStats).
+  nanotime _lastPrintTV;
   bool _mktOpen;       // Is market open or closed?
 
   /*
     Protected member functions:
   */
-  // Add a point estimate of spread for specified stock.
-  void addSampledSpd(int cid, double fv);
-  // For all stocks in _dm->populationSet:
-  //   sample spread (getSpd).
-  //   write to _buf (addSampledSpd).
-  void sampleAllStocks();
-  // Clear sampled values for all stocks.
-  void clearAllStocks();
   // Dump some state info in human readable form.
   void printAllStocks();
 
@@ -73,7 +68,9 @@ class SpdTracker : public TimeHandler::listener {
   //   last 1 minute of wall/sim time.
   SpdTracker();
   SpdTracker(int minpts, int nperiods, int msec);
-  virtual ~SpdTracker();
+
+  // For all stocks: sample spread (getSpd) into the spd series.
+  virtual void sample(RollingStats &rs);
 
   // Get current trailing average spread. Requires at least _minpts data point to calculate.
   bool getASpd(int cid, double &fv);
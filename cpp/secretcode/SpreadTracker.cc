@@ -9,32 +9,20 @@ SpreadTracker::SpreadTracker():
   _dm(factory<DataManager>::find(only::one)),
   _ddebug(factory<debug_stream>::get( RELEVANT_LOG_FILE )),
   _stocksState( factory<StocksState>::get(only::one) ) ,
-  _sample(Timer(TimeVal(1,0),TimeVal(0,0)))
+  _rs( factory<RollingStats>::get(only::one) )
 {
-  //  _sample = Timer(TimeVal(1,0),TimeVal(0,0));
-  _dm->addTimer(_sample);
-  _spdbuffer.resize(_dm->cidsize());
-  for ( int i=0;i<_dm->cidsize();i++) {
-    _spdbuffer[i] = new CircBuffer<double>(_nperiods);
-  }
-  _dm->add_listener(this);
-}
-
-SpreadTracker::~SpreadTracker(){
-    for ( int i=0;i<_dm->cidsize();i++) 
-      delete _spdbuffer[i];
+  _spdId = _rs->add("spread.lastNormal", this, 1000, RollingStats::MEAN, _nperiods);
 }
 
-void SpreadTracker::update( const TimeUpdate &t){
-  if (t.timer() == _sample){
-    for (int cid=0;cid<_dm->cidsize();cid++){
-      double spd;
-      _stocksState->getState(cid)->lastNormalSpread(&spd);
-      _spdbuffer[cid]->add(spd);
-    }
+void SpreadTracker::sample( RollingStats &rs ){
+  double *in = rs.input(_spdId);
+  for (int cid=0;cid<_dm->cidsize();cid++){
+    double spd;
+    if (_stocksState->getState(cid)->lastNormalSpread(&spd))
+      in[cid] = spd;
   }
 }
 
 bool SpreadTracker::getAvgspd(int cid, double *aspd){
-  return (_spdbuffer[cid]->getAvg(aspd));
+  return _rs->value(_spdId, cid, *aspd);
 }
@@ -1,8 +1,8 @@
 #ifndef __SPREADDTRACKER_H__
 #define __SPREADDTRACKER_H__
 
-#include "CircBuffer.h"
 #include "DataManager.h"
+#include "RollingStats.h"
 #include "c_util/Time.h"
 using trc::compat::util::TimeVal;
 
@@ -15,7 +15,7 @@ using trc::compat::util::TimeVal;
 
 using namespace clite::util;
 
-class SpreadTracker : public TimeHandler::listener {
+class SpreadTracker : public RollingStats::sampler {
   
  protected:
   /*
@@ -24,12 +24,13 @@ class SpreadTracker : public TimeHandler::listener {
   factory<DataManager>::pointer _dm;
   factory<debug_stream>::pointer _ddebug;
   factory<StocksState>::pointer       _stocksState;
-  vector< CircBuffer<double> *> _spdbuffer;
-  Timer _sample;
+  factory<RollingStats>::pointer      _rs;
+  int _spdId;   // the last normal spread, sampled every second; mean over the last 2 minutes
+                // (120 ticks, holes included).  Only sampled while the market is open, and
+                // only for stocks where lastNormalSpread succeeds.
  public:
   SpreadTracker();
-  virtual ~SpreadTracker();
-  virtual void update(const TimeUpdate &t);
+  virtual void sample(RollingStats &rs);
   bool getAvgspd(int cid,double *aspd);
   
 };
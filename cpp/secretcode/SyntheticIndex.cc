@@ -89,22 +89,51 @@ int SyntheticIndex::constituentFairValues(DataManager *dm, AlphaSignal *asignal,
 /*************************************************************************
   SyntheticIndexHF code.
 *************************************************************************/
+// How often to recompute the running fv total from scratch.
+const static int RESUM_MSEC = 60000;
+// Fraction of non-zero weights below which an index is sparse.
+const static double SPARSE_FRACTION = 0.25;
+
+SyntheticIndexHF::SyntheticIndexHF(AlphaSignal *asignal) :
+  SyntheticIndex(),
+  _asignal(asignal),
+  _numInvalid(0),
+  _sum(0.0),
+  _resumTimer(nanotime::from_ms(RESUM_MSEC), nanotime()),
+  _validFV(false),
+  _fv(0.0),
+  _marketOpen(false),
+  _initialValidFV(false),
+  _initialFV(0.0)
+{
+  initialize();
+}
+
 SyntheticIndexHF::SyntheticIndexHF(AlphaSignal *asignal, vector<double> &weights) :
   SyntheticIndex(),
   _asignal(asignal),
-  _weights(weights),
-  _midPrices(weights.size(), 0.0),
-  _validPrices(weights.size(), (char)false),
+  _numInvalid(0),
+  _sum(0.0),
+  _resumTimer(nanotime::from_ms(RESUM_MSEC), nanotime()),
   _validFV(false),
   _fv(0.0),
   _marketOpen(false),
   _initialValidFV(false),
   _initialFV(0.0)
 {
+  initialize();
+  for (unsigned int i=0;i<weights.size();i++) {
+    addConstituent(i, weights[i]);
+  }
+}
+
+void SyntheticIndexHF::initialize() {
   _dm = factory<DataManager>::find(only::one);
   if( !_dm )
     throw std::runtime_error( "Failed to get DataManager from factory (in SyntheticIndex::SyntheticIndex)" );   
 
+  _slots.assign(_dm->cidsize(), -1);
+  _dm->addTimer(_resumTimer);
   _dm->add_listener(this);
 }
 
@@ -112,8 +141,18 @@ SyntheticIndexHF::~SyntheticIndexHF() {
 
 }
 
+void SyntheticIndexHF::addConstituent(int cid, double weight) {
+  _slots[cid] = _cids.size();
+  _cids.push_back(cid);
+  _weights.push_back(weight);
+  _midPrices.push_back(0.0);
+  _validPrices.push_back((char)false);
+  _numInvalid++;
+}
+
 /*
-  Process TimeUpdate - just checks for market open/close messages.
+  Process TimeUpdate - checks for market open/close messages, and recomputes
+    the running fv total.
 */
 void SyntheticIndexHF::update(const TimeUpdate &au) {
   if (au.timer() == _dm->marketOpen()) {
@@ -122,6 +161,8 @@ void SyntheticIndexHF::update(const TimeUpdate &au) {
     aggregateFV();
   } else if (au.timer() == _dm->marketClose()) {
     _marketOpen = false;
+  } else if (au.timer() == _resumTimer && _marketOpen) {
+    aggregateFV();
   }
 }
 
@@ -132,52 +173,60 @@ void SyntheticIndexHF::update(const DataUpdate &du) {
   if (!_marketOpen) {
     return;
   }
-  getPrice(du.cid);
+  int slot = _slots[du.cid];
+  if (slot < 0) {
+    return;
+  }
+  getPrice(slot);
 }
 
 /*
-  Query MasterBook for mid price for specified stock.
-  Sets _midPrices[i] and _validPrices[i].
-  If _validPrices[i] flips from false --> true, may trigger call to
-    aggregateFV.
+  Query MasterBook for mid price for constituent in specified slot, and
+    apply it to the running fv.
 */
-void SyntheticIndexHF::getPrice(int cid) {
+void SyntheticIndexHF::getPrice(int slot) {
   double midPx;
-  bool oldValid;
-  if (!constituentFairValue(_dm.get(), _asignal, cid, midPx)) {
-    _validPrices[cid] = (char)false;
-    setFV(false, 0.0);
-    return;
-  }
-  oldValid = _validPrices[cid];
-  _validPrices[cid] = true;
-  if (oldValid == (char)false) {
-    aggregateFV();
-  } 
-  if (_validFV == true) {
-    adjustFV(cid, midPx);
-  }
+  bool valid = constituentFairValue(_dm.get(), _asignal, _cids[slot], midPx);
+  adjustFV(slot, valid, midPx);
 }
 
 /*
-  Adjust fair-value based on new price for specified stock.
-  Should *only* be called when:
-  _validFV is true.
-  _validPrices[cid] is true.
-  _midPrices[cid] holds an accurate value representing the last known
-    mid prices for stock cid (and that value does not represent some 
-    error condition).
+  Adjust fair-value based on new price (or lack of one) for constituent in 
+    specified slot.
   Effects:
-  - Replaces _midPrices[cid] with new value.
-  - Adjusts _fv by delta(mid px) * weight[cid].
+  - Replaces _midPrices[slot] and _validPrices[slot] with new values.
+  - Adjusts _sum by delta(mid px) * weight[slot], adding or taking out the 
+    whole term if the constituent gains or loses its valid price, and
+    _numInvalid to match.
+  - Sets fv from _sum, valid iff all constituents have valid prices.
 */
-void SyntheticIndexHF::adjustFV(int cid, double mid) {
-  assert(_validFV == true);
-  assert(_validPrices[cid] == (char)true);
-  double oldMid = _midPrices[cid];
-  double weight = _weights[cid];
-  _midPrices[cid] = mid;
-  _fv = _fv + weight * (mid - oldMid);
+void SyntheticIndexHF::adjustFV(int slot, bool valid, double mid) {
+  double weight = _weights[slot];
+  double oldMid = _midPrices[slot];
+  if (_validPrices[slot] == (char)true) {
+    if (!valid) {
+      _sum -= weight * oldMid;
+      _numInvalid++;
+      mid = 0.0;
+    } else if (mid == oldMid) {
+      return;
+    } else {
+      _sum += weight * (mid - oldMid);
+    }
+  } else {
+    if (!valid) {
+      return;
+    }
+    _sum += weight * mid;
+    _numInvalid--;
+  }
+  _midPrices[slot] = mid;
+  _validPrices[slot] = (char)valid;
+  if (_numInvalid == 0) {
+    setFV(true, _sum);
+  } else {
+    setFV(false, 0.0);
+  }
 }
 
 
@@ -188,11 +237,11 @@ void SyntheticIndexHF::initializePrices() {
   int nidx;
   double midPx;
 
-  nidx = _midPrices.size();
+  nidx = _cids.size();
   for (int i=0;i<nidx;i++) {
-    // cidx of index constituent i.
-    if (!constituentFairValue(_dm.get(), _asignal, i, midPx)) {
+    if (!constituentFairValue(_dm.get(), _asignal, _cids[i], midPx)) {
       _validPrices[i] = (char)false;
+      _midPrices[i] = 0.0;
     } else {
       _validPrices[i] = (char)true;
       _midPrices[i] = midPx;
@@ -201,21 +250,28 @@ void SyntheticIndexHF::initializePrices() {
 }
 
 /*
-  Attempt to aggregate prices * weights for all constituents.
+  Recompute running total of prices * weights, and count of constituents without
+    valid prices, from scratch.
 */
 bool SyntheticIndexHF::aggregateFV() {
   int nidx;
 
-  nidx = _midPrices.size();
+  nidx = _cids.size();
   double tfv = 0.0;
+  int ninvalid = 0;
   for (int i=0;i<nidx;i++) {
     if (_validPrices[i] == (char)false) {
-      _validFV = false;
-      _fv = 0.0;
-      return false;
+      ninvalid++;
+      continue;
     }
     tfv += _weights[i] * _midPrices[i];
   }
+  _sum = tfv;
+  _numInvalid = ninvalid;
+  if (_numInvalid > 0) {
+    setFV(false, 0.0);
+    return false;
+  }
   setFV(true, tfv);
   return true;
 }
@@ -247,3 +303,40 @@ bool SyntheticIndexHF::getInitialFairValue(double &fv) {
   fv = _initialFV;
   return true;
 }
+
+/*************************************************************************
+  SyntheticIndexSparseHF code.
+*************************************************************************/
+SyntheticIndexSparseHF::SyntheticIndexSparseHF(AlphaSignal *asignal, vector<double> &weights) :
+  SyntheticIndexHF(asignal)
+{
+  for (unsigned int i=0;i<weights.size();i++) {
+    if (weights[i] != 0.0) {
+      addConstituent(i, weights[i]);
+    }
+  }
+}
+
+SyntheticIndexSparseHF::SyntheticIndexSparseHF(AlphaSignal *asignal, vector<int> &cids, vector<double> &weights) :
+  SyntheticIndexHF(asignal)
+{
+  if (cids.size() != weights.size())
+    throw std::runtime_error( "Mismatched constituent & weight counts (in SyntheticIndexSparseHF::SyntheticIndexSparseHF)" );
+  for (unsigned int i=0;i<cids.size();i++) {
+    if (_slots[cids[i]] >= 0)
+      throw std::runtime_error( "Duplicate constituent (in SyntheticIndexSparseHF::SyntheticIndexSparseHF)" );
+    addConstituent(cids[i], weights[i]);
+  }
+}
+
+SyntheticIndexSparseHF::~SyntheticIndexSparseHF() {
+
+}
+
+bool SyntheticIndexSparseHF::isSparse(const vector<double> &weights) {
+  int nz = 0;
+  for (unsigned int i=0;i<weights.size();i++) {
+    if (weights[i] != 0.0) nz++;
+  }
+  return nz < SPARSE_FRACTION * weights.size();
+}
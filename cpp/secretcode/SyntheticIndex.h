@@ -65,7 +65,8 @@ class SyntheticIndex {
   Specific implementation of SyntheticIndex:
   - Hooked into client-lite high-frequency event handling mechanisms.
   - Optimized for use with non-sparse indeces, aka indeces for which most of 
-    the stocks in the program population set have non-zero weights.
+    the stocks in the program population set have non-zero weights.  See
+    SyntheticIndexSparseHF for the sparse version.
   - Calculates constituent prices using composite (L1) bid & ask prices, potentially
     adjusted to "fair-value" based on some alpha signal.
   - Attempts to be efficient about event processing & index fv calculation time.
@@ -73,22 +74,22 @@ class SyntheticIndex {
      In particular:
      - Does not allow (successful) query for index FV when has at least 1 constituent with
        no known valid price.
-     - Does not gracefully handle the case where stocks initially do not have valid markets,
-       and then get valid markets.
    - Does not consider whether stocks are "opened" for trading:
      - Assumes that each stock should have *some* market price during trading hours.
      - Used stated top-level bid & ask for stocks, even though those may be wide/non-indicative
        before a particular stock is opened for trading.
 
   Internal State:
-  - Object keeps vector of most recent trade prices for each stock, which is updated on every DataUpdate
-    for the stock.
-  - This allows object to keep running total of cumulative "fair-value".
-    - Avoid need to cycle through all stocks when computing "fair-value", at the cost of additional
-      processing time on each data update.
-    - Code structure is thus optimized for large synthetic indeces (those with many members), as opposed
-      to sparse synthetic indeces (those with few members).
-    - May want to add additional class that efficiently handles sparse synthetic indeces.
+  - Object keeps vector of most recent mid prices for each constituent, which is updated on every
+    DataUpdate for the stock.
+  - This allows object to keep running total of weight * mid over the constituents with valid
+    prices, plus a count of those without:
+    - Each DataUpdate that changes a constituent's mid applies weight * delta(mid) to the total,
+      and a constituent gaining or losing a valid price adds or takes out its term, so no
+      DataUpdate needs to cycle through all constituents.
+    - The total is recomputed from scratch every RESUM_MSEC, so rounding can't accumulate.
+  - Constituents are held in slots, with a per-stock slot index (-1 for non-constituents).
+    The dense version makes every stock in the population set a constituent (slot == cid).
 */
 class SyntheticIndexHF : public SyntheticIndex, public MarketHandler::listener, public TimeHandler::listener {
  protected:
@@ -97,9 +98,14 @@ class SyntheticIndexHF : public SyntheticIndex, public MarketHandler::listener,
   */
   factory<DataManager>::pointer _dm;         // Exists externally.  Accessed via factory system.
   AlphaSignal *_asignal;                     // Exists externally.  Passed in via constructor param.
-  vector<double> _weights;                   // Index weights, applying to stocks in population set.
-  vector<double> _midPrices;                 // Stock prices, applying to stocks in population set.
-  vector<char> _validPrices;                 // Whether have a known last valid mid price, for each stock.
+  vector<int> _cids;                         // Per slot:  constituent stock.
+  vector<int> _slots;                        // Per stock: slot, or -1 for non-constituents.
+  vector<double> _weights;                   // Per slot:  index weight.
+  vector<double> _midPrices;                 // Per slot:  last known valid mid price (0 if none).
+  vector<char> _validPrices;                 // Per slot:  whether have a known last valid mid price.
+  int _numInvalid;                           // Number of constituents without a valid price.
+  double _sum;                               // Sum of weight * mid over constituents with a valid price.
+  Timer _resumTimer;                         // Recompute _sum from scratch.
   bool _validFV;                             // Do we believe that we currently have a picture of the market state 
                                              //   that allows us to calculate an accurate current fair-value.
   double _fv;                                // FV price.        
@@ -112,19 +118,25 @@ class SyntheticIndexHF : public SyntheticIndex, public MarketHandler::listener,
   /*
     Member Functions:
   */
-  // Attempt to calculate index fv given current available price.
+  // For subclasses, which add their own constituents.
+  SyntheticIndexHF(AlphaSignal *asignal);
+  void initialize();
+  void addConstituent(int cid, double weight);
+  // Recalculate index fv from scratch given current known prices.
   // Returns whether successful (have valid prices for all constituents) or 
   //   unsuccessful (no valid prices for at least one constituent).
   // Sets _validFV and _fv depending on success/failure.
   bool aggregateFV();
   void initializePrices();
   void setFV(bool valid, double fv);
-  void getPrice(int cid);
-  void adjustFV(int cid, double midPx);
+  void getPrice(int slot);
+  void adjustFV(int slot, bool valid, double midPx);
  public:
   SyntheticIndexHF(AlphaSignal *asignal, vector<double> &weights);
   virtual ~SyntheticIndexHF();
 
+  int numConstituents() const {return _cids.size();}
+
   /*
     UpdateListener functions.
   */
@@ -141,5 +153,27 @@ class SyntheticIndexHF : public SyntheticIndex, public MarketHandler::listener,
   virtual bool getInitialFairValue(double &fv);
 };
 
+/*
+  Sparse version of SyntheticIndexHF, for indeces with few members relative to the
+    population set (e.g. Barra industry factors).
+  - Only stocks with non-zero weight are constituents:  DataUpdates for other stocks
+    are dropped after 1 lookup, and only constituents need valid prices for the index
+    to have a valid FV.
+  - Initialization & periodic recomputation are O(# constituents) rather than
+    O(# stocks).
+*/
+class SyntheticIndexSparseHF : public SyntheticIndexHF {
+ public:
+  // weights as per SyntheticIndexHF, one per stock in population set.
+  SyntheticIndexSparseHF(AlphaSignal *asignal, vector<double> &weights);
+  // Explicit constituent list:  stock cids[i] with weight weights[i].
+  SyntheticIndexSparseHF(AlphaSignal *asignal, vector<int> &cids, vector<double> &weights);
+  virtual ~SyntheticIndexSparseHF();
+
+  // Whether an index with these weights is better handled by this class than
+  //   by SyntheticIndexHF.
+  static bool isSparse(const vector<double> &weights);
+};
+
 
 #endif   //__SYNTHETICINDEX_H__
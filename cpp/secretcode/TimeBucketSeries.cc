@@ -151,7 +151,7 @@ double TimeBucketSeries::sumsq() const {
 TimeBucketSeriesTracker::TimeBucketSeriesTracker(int bucketLength, int numBuckets, int minBucketsWithSamples) :
   _bucketLength(bucketLength),
   _numBuckets(numBuckets),
-  _startTV(0),
+  _startTV(),
   _marketOpen(false),
   _intervalNumber(0)
 {
@@ -84,7 +84,7 @@ class TimeBucketSeriesTracker : public TimeHandler::listener {
   int _numBuckets;                                    // Number of buckets per series.
   factory<DataManager>::pointer     _dm;              // Connection to underlying HF data.
   vector<TimeBucketSeries>          _payload;         // 1 per stock.
-  TimeVal _startTV;                                   // TimeVal at which 1st interval started.
+  nanotime _startTV;                                  // Time at which 1st interval started.
   bool    _marketOpen;                                // Is market currently open for trading?
   int     _intervalNumber;                            // Sample number of current interval.
 
@@ -63,7 +63,7 @@ void TradeTickPrinter::update(const TimeUpdate &au) {
 }
 
 void TradeTickPrinter::printTradeTick(DataManager *dm, const DataUpdate &du, double cbid, double cask, bool addEndl) {
-  DateTime dt(du.tv);
+  DateTime dt(du.tv.to_timeval());
   std::cout << "TRADE " <<  du.cid << " " << dm->symbol(du.cid) << " " << ECN::desc(du.ecn) << " ";
   std::cout << Mkt::SideDesc[du.side] << " " << du.size << " " << du.price <<  " ";
   std::cout << dt.getfulltime() << " ";
@@ -125,7 +125,7 @@ const string AVG_TRADING_IMPACT_MODEL_LOG_FILE = "avgtradingimpactmodel";
 AverageTradingImpactModel::AverageTradingImpactModel() :
   TradingImpactModel(),
   _marketOpen(false),
-  _lastPrintTV(0)
+  _lastPrintTV()
 {
   _dm = factory<DataManager>::find(only::one);
   if( !_dm )
@@ -196,7 +196,7 @@ ImbTradingImpactModel::ImbTradingImpactModel() :
   _numSamplePoints(1200),        // trailing 20 minutes worth of data.
   _minSamplePoints(480),         // min of 8 minutes to "warm up".
   _sampleNumber(0),
-  _startTV(0),
+  _startTV(),
   _marketOpen(false),
   _lotImpactV(0),
   _queueSizeV(0)
@@ -228,7 +228,7 @@ ImbTradingImpactModel::ImbTradingImpactModel(ImbTracker *imbSignal) :
   _numSamplePoints(1200),        // trailing 20 minutes worth of data.
   _minSamplePoints(480),         // min of 8 minutes to "warm up".
   _sampleNumber(0),
-  _startTV(0),
+  _startTV(),
   _marketOpen(false),
   _lotImpactV(0),
   _queueSizeV(0)
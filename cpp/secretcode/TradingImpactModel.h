@@ -21,6 +21,7 @@ using namespace clite::util;
 #include "ExchangeTracker.h"
 #include "SpdTracker.h"
 #include "FeeCalc.h"
+#include "CircBuffer.h"
 
 #include "MarketImpactEstimate.h"
 
@@ -138,7 +139,7 @@ class AverageTradingImpactModel : public TradingImpactModel, public TimeHandler:
   factory<debug_stream>::pointer _ddebug;    // Exists externally.  Accessed via factory system.
   factory<AverageTradingImpactTracker>::pointer _atiTracker;  // Exists externally.  Accessed via factory system.
   bool _marketOpen;  
-  TimeVal _lastPrintTV;    
+  nanotime _lastPrintTV;   
   
  public:
   AverageTradingImpactModel();
@@ -201,7 +202,7 @@ class ImbTradingImpactModel : public TradingImpactModel, public TimeHandler::lis
   int _numSamplePoints;              // Max number of sample points to keep (per stock).
   int _minSamplePoints;              // Min number of sample points to use for volatility estimation (per stock).
   int _sampleNumber;                 // Current sampling point (starts at 0).
-  TimeVal _startTV;                  // Time at 1st sampling point.
+  nanotime _startTV;                 // Time at 1st sampling point.
   bool _marketOpen;                  // is market currently open for regular session trading.
   vector<CBD*> _lotImpactV;          // Impact estimate series, of 1 round-lot marketed passively 
                                      //   at top-level queue, per stock.
@@ -13,9 +13,8 @@ VolatilityTracker::VolatilityTracker(int sampleMilliSeconds, int numSamplePoints
   _numSamplePoints(numSamplePoints),
   _minSamplePoints(minSamplePoints),
   _sampleNumber(0),
-  _retBufV(0),
+  _retId(-1),
   _lastPriceV(0),
-  _sampleStartTime(),
   _marketOpen(false),
   _fvSignal(fvSignal)
 {
@@ -32,32 +31,21 @@ VolatilityTracker::VolatilityTracker(int sampleMilliSeconds, int numSamplePoints
   if( !_ddebug )
     throw std::runtime_error( "Failed to get DebugStream from factory (in VolatilityTracker::VolatilityTracker)" ); 
 
-  _retBufV.resize(_dm->cidsize());
   _lastPriceV.assign(_dm->cidsize(), 0.0);
-  //_sampleStartTime = _dm->curtv();    Unclear what happens when _dm->curtv() is called before event loop starts.
-  // with this commented out, need to ensure that addSample() sets _sampleStartTime on the 1st received sample.
 
-  for (int i=0;i<_dm->cidsize();i++) {
-    _retBufV[i] = new CircBuffer<double>(numSamplePoints);
-  }  
+  _rs = factory<RollingStats>::get(only::one);
+  _retId = _rs->add("vol-ret", this, _sampleMilliSeconds, RollingStats::STDEV, _numSamplePoints);
   _dm->add_listener(this);
 }
 
 VolatilityTracker::~VolatilityTracker() {
-  for (int i=0;i<_dm->cidsize();i++) {
-    delete _retBufV[i];
-  }
 }
 
-void VolatilityTracker::addSample() {
+void VolatilityTracker::sample(RollingStats &rs) {
   // 1st sample:
   // Just get mid-prices.
   if (_sampleNumber++ == 0) {
     populateCurrentPrices();
-    //_sampleStartTime = _dm->curtv();  Should be set from market open TimerUpdate.tv(),
-    //  not _dm_>curtv(), as these two timers can sometimes have different usec resolution,
-    //  and as other timer-based widgets generally use market open TimerUpdate.tv() for
-    //  sample start TV.
   } else {
     // Subsequent sample:
     // Copy last sample point mid prices, so that they can be used
@@ -82,27 +70,12 @@ void VolatilityTracker::populateCurrentPrices() {
 void VolatilityTracker::addReturnSamples(vector<double> &retV) {
   unsigned int rvs = retV.size();
   assert(rvs == (unsigned int)_dm->cidsize());
+  double *in = _rs->input(_retId);
+  // Only stocks that have opened for trading take a sample.
   for (unsigned int i=0;i<rvs;i++) {
-    // Check whether stock has opened for trading.
     ECN::ECN  e    = _exchangeT -> getExchange( i );
-    if (!_openT->hasOpened(i, e)) {
-      continue;
-    }
-    double tsample = retV[i];
-    CBD *tbuf = _retBufV[i];
-    tbuf->add(tsample);
-
-    // Temporary - For Debugging.
-    //std::cout << "VolatilityTracker::addReturnSamples - adding sample: stock " << i 
-    //	      << " sample " << tsample << std::endl;
-  }
-}
-
-void VolatilityTracker::flushReturnSamples() {
-  unsigned int sz = _retBufV.size();
-  for (unsigned int i=0;i<sz;i++) {
-    CBD *tbuf = _retBufV[i];
-    tbuf ->clear();
+    if (_openT->hasOpened(i, e))
+      in[i] = retV[i];
   }
 }
 
@@ -124,14 +97,13 @@ void VolatilityTracker::populateReturns(vector<double> &lastMidV,
 }
 
 bool VolatilityTracker::getVolatility(int cid, double &fv) {
-  assert((cid >= 0) && (((unsigned int)cid) < _retBufV.size()));
-  CBD *tbuf = _retBufV[cid];
-  int nsp = tbuf->size();
+  assert((cid >= 0) && (cid < _dm->cidsize()));
+  int nsp = _rs->count(_retId, cid);
   if (nsp < _minSamplePoints) {
     return false;
   }
   double fvt;
-  if (!tbuf->getStdev(&fvt)) {
+  if (!_rs->value(_retId, cid, fvt)) {
     return false;
   }
   // Convert unscaled volatility to per minute volatility.
@@ -146,7 +118,8 @@ bool VolatilityTracker::getVolatility(int cid, double &fv) {
 
 
 /*
-  UpdateListener functions
+  UpdateListener functions.  Sampling itself is done by RollingStats, which also
+    empties the returns series at the open.
 */
 void VolatilityTracker::update(const TimeUpdate &au) {
   if (au.timer() == _dm->marketOpen()) {
@@ -154,26 +127,13 @@ void VolatilityTracker::update(const TimeUpdate &au) {
   } else if (au.timer() == _dm->marketClose()) {
     onMarketClose(au);
   } 
-  onTimerUpdate(au);
 }
 
 void VolatilityTracker::onMarketOpen(const TimeUpdate &au) {
   _marketOpen = true;
-  _sampleStartTime = au.tv();
   _sampleNumber = 0;
-  flushReturnSamples();
 }
 
 void VolatilityTracker::onMarketClose(const TimeUpdate &au) {
   _marketOpen = false;
 }
-
-void VolatilityTracker::onTimerUpdate(const TimeUpdate &au) {
-  if (!_marketOpen) {
-    return;
-  }
-  double msdiff = HFUtils::milliSecondsBetween(_sampleStartTime, au.tv());
-  if (msdiff >= (_sampleNumber * _sampleMilliSeconds)) {
-    addSample();
-  }
-}
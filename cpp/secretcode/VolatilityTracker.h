@@ -15,11 +15,11 @@
     May want to switch to weighted estimation using e.g. exponential decay (a la Barra).
   - Current version of VolatiltyTracker only starts sampling vol (for each stock)
     when the stock has been opened for trading.  It also stops sampling on market close.
-  - Current version of VolatilityTracker only tries to sample prices on timer 
-    updates (technically on the 1st wakeup after a timer update).  This implies that
-    if the timer-freq is set to a value >> _sampleMilliSeconds, then the sampling
-    will not actuall occur every _sampleMilliSeconds, and the per-minute volum estimate
-    returned will be incorrect....
+  - Returns are sampled and reduced through RollingStats, on its timer ticks every
+    _sampleMilliSeconds (multiples of the period, which coincide with offsets from
+    the open when the open is on a whole period).  The window is the last
+    _numSamplePoints ticks: ticks on which a stock had not yet opened count toward
+    it, so _minSamplePoints is reached later after a late open.
 */
 
 #ifndef __VOLATILITY_TRACKER_H__
@@ -32,7 +32,7 @@ using std::vector;
 using namespace clite::util;
 
 #include "DataManager.h"
-#include "CircBuffer.h"
+#include "RollingStats.h"
 #include "ExchangeTracker.h"
 
 #include "c_util/Time.h"
@@ -42,40 +42,34 @@ class OpenTracker;
 class DataManager;
 class AlphaSignal;
 
-typedef CircBuffer<double> CBD;
-
-class VolatilityTracker : public TimeHandler::listener {
+class VolatilityTracker : public TimeHandler::listener, public RollingStats::sampler {
  protected:
   factory<DataManager>::pointer _dm;                  // 
   factory<OpenTracker>::pointer _openT;               // Keeps track of whether each stock has been "opened" for trading, and also
                                                       //  whether the MARKET_CLOSE message has been received.
   factory<ExchangeTracker>::pointer _exchangeT;       // Keeps track of primary listing ecn for each stock.
   factory<debug_stream>::pointer _ddebug;             // For debug/error logging.
+  factory<RollingStats>::pointer _rs;                 // Exists externally.
 
   int _sampleMilliSeconds;           // How freqently to sample mid-prices, in milli-seconds.
   int _numSamplePoints;              // Max number of sample points to keep (per stock).
   int _minSamplePoints;              // Min number of sample points to use for volatility estimation (per stock).
   int _sampleNumber;                 // Current sampling point (starts at 0).
-  vector<CBD *> _retBufV;            // Vector of circbuffers, each holding per period returns per stock.
+  int _retId;                        // Per period returns series (RollingStats).
   vector<double> _lastPriceV;        // Holds stock prices (one per stock) as of last sampling point.
-  TimeVal _sampleStartTime;          // Time at which mid-price sampling started.
   bool _marketOpen; 
   AlphaSignal * _fvSignal;           // Signal used to adjust stated mid --> fv when doing returtn calculations.
                                      // Null --> No adjustment.
 
-  // Add a single time point sample (cross sectionally, aka for all stocks).
-  virtual void addSample();
   // Populate _midPriceV with current prices.
   virtual void populateCurrentPrices();
-  // Add retunrs to _retBufV.
+  // Add retunrs to the returns series, for stocks that have opened.
   virtual void addReturnSamples(vector<double> &retV);
-  virtual void flushReturnSamples();
   // Populae retV with returns from lastMidV --> curMidV.
   static void populateReturns(vector<double> &lastMidV, vector<double> &curMidV, vector<double> &retV);
 
   virtual void onMarketOpen(const TimeUpdate &au);
   virtual void onMarketClose(const TimeUpdate &au);
-  virtual void onTimerUpdate(const TimeUpdate &au);
   
  public:
   VolatilityTracker(int sampleMilliSeconds, int numSamplePoints, int minSamplePoints, AlphaSignal *fvSignal);
@@ -84,9 +78,9 @@ class VolatilityTracker : public TimeHandler::listener {
   // Query for SD of per-minute returns, for specified stock.
   virtual bool getVolatility(int cid, double &fv);
 
-  // Allows access to underlying buffer holding return series.
-  // Advanced swim only. 
-  virtual const CBD *retBuffer(int cid) {return _retBufV[cid];}
+  // Add a single time point sample (cross sectionally, aka for all stocks).
+  // 1st sample after the open only records prices.
+  virtual void sample(RollingStats &rs);
 
   /*
     Update listener functions.
@@ -0,0 +1,46 @@
+#!/usr/bin/env python
+# Compare two runs of hotpath-bench (cpp/bench), e.g.
+#   hotpath-bench --tag=`git rev-parse --short HEAD` > new.json
+#   bench_compare.py old.json new.json [threshold]
+# Prints the median ns/op of every fixture in both runs and the ratio
+# new/old, marking those slower by more than threshold (default 0.10).
+# Exits 1 if any fixture regressed, so it can gate a build.
+from __future__ import print_function
+import json
+import sys
+
+def load(path):
+  runs = {}
+  for line in open(path):
+    line = line.strip()
+    if not line.startswith("{"):
+      continue
+    r = json.loads(line)
+    key = r["bench"] if "arg" not in r else "%s/%d" % (r["bench"], r["arg"])
+    runs[key] = r
+  return runs
+
+def main():
+  if len(sys.argv) < 3:
+    print("usage: %s OLD NEW [threshold]" % sys.argv[0], file=sys.stderr)
+    return 2
+  old, new = load(sys.argv[1]), load(sys.argv[2])
+  threshold = float(sys.argv[3]) if len(sys.argv) > 3 else 0.10
+  regressed = 0
+  print("%-56s %12s %12s %8s" % ("bench", "old ns", "new ns", "ratio"))
+  for key in sorted(set(old) & set(new)):
+    o, n = old[key]["ns_median"], new[key]["ns_median"]
+    ratio = n / o if o > 0 else float("inf")
+    flag = ""
+    if ratio > 1 + threshold:
+      flag = "  SLOWER"
+      regressed += 1
+    elif ratio < 1 - threshold:
+      flag = "  faster"
+    print("%-56s %12.1f %12.1f %8.3f%s" % (key, o, n, ratio, flag))
+  for key in sorted(set(old) ^ set(new)):
+    print("%-56s only in %s" % (key, sys.argv[1] if key in old else sys.argv[2]))
+  return 1 if regressed else 0
+
+if __name__ == "__main__":
+  sys.exit(main())
@@ -0,0 +1,64 @@
+#!/usr/bin/env python
+# Read a StreamingTCTracker record file (guillotine server.tc-record-file), e.g.
+#   tc_records.py exec_logs/tc.bin [cid ...]
+# Prints one line per completed TradeRequest (optionally only those for the
+# given cids), then totals.  Records are TCRecord (cpp/ntradesys/TCTracking.h):
+# fixed size, native byte order, no padding.
+from __future__ import print_function
+import struct
+import sys
+
+RECORD = struct.Struct("=qqqqdddddiiiiiiiiii")
+FIELDS = ("orderID", "recvNs", "firstFillNs", "lastFillNs",
+          "priority", "cbid", "cask", "sumFillPx", "notional",
+          "cid", "clientId", "initPos", "targetPos", "numPlaces",
+          "numCancels", "numFills", "shsFilled", "absShsFilled", "completion")
+COMPLETION = {0: "REPLACED", 1: "CLOSE"}
+
+def records(path):
+  f = open(path, "rb")
+  while True:
+    buf = f.read(RECORD.size)
+    if len(buf) < RECORD.size:
+      break
+    yield dict(zip(FIELDS, RECORD.unpack(buf)))
+
+def slippage(r):
+  # As TCRecord::wAvgSlippage: per share vs initial mid, + = made $.
+  if r["absShsFilled"] <= 0 or r["cbid"] <= 0 or r["cask"] <= 0:
+    return 0.0
+  mid = (r["cbid"] + r["cask"]) / 2.0
+  wafp = r["notional"] / r["absShsFilled"]
+  return mid - wafp if r["targetPos"] >= r["initPos"] else wafp - mid
+
+def main():
+  if len(sys.argv) < 2:
+    print("usage: %s FILE [cid ...]" % sys.argv[0], file=sys.stderr)
+    return 2
+  cids = set(int(c) for c in sys.argv[2:])
+  n = nfilled = shs = 0
+  notional = slip = 0.0
+  print("%-12s %6s %8s %8s %6s %6s %6s %8s %10s %10s %-8s" %
+        ("orderID", "cid", "initPos", "target", "plcs", "cxls", "fills",
+         "shs", "wafp", "slip", "done"))
+  for r in records(sys.argv[1]):
+    if cids and r["cid"] not in cids:
+      continue
+    n += 1
+    s = slippage(r)
+    if r["numFills"] > 0:
+      nfilled += 1
+    shs += r["absShsFilled"]
+    notional += r["notional"]
+    slip += s * r["absShsFilled"]
+    wafp = r["notional"] / r["absShsFilled"] if r["absShsFilled"] > 0 else 0.0
+    print("%-12d %6d %8d %8d %6d %6d %6d %8d %10.4f %10.4f %-8s" %
+          (r["orderID"], r["cid"], r["initPos"], r["targetPos"], r["numPlaces"],
+           r["numCancels"], r["numFills"], r["shsFilled"], wafp, s,
+           COMPLETION.get(r["completion"], str(r["completion"]))))
+  print("requests %d  filled %d  shares %d  notional %.2f  slippage $ %.2f" %
+        (n, nfilled, shs, notional, slip))
+  return 0
+
+if __name__ == "__main__":
+  sys.exit(main())